@@ -0,0 +1,570 @@
+#include "AABBTree.h"
+
+#include <stdlib.h>
+#include <math.h>
+
+static void findPairs(void* const self, ColliderSphere* bounds, int count, DynamicArray* pairs);
+static void deleteBroadphase(void* const self);
+
+/*
+ * Box helpers
+ */
+static scalar minScalar(scalar a, scalar b) {
+	return a < b ? a : b;
+}
+
+static scalar maxScalar(scalar a, scalar b) {
+	return a > b ? a : b;
+}
+
+static AABB combine(const AABB* a, const AABB* b) {
+	AABB box;
+	box.min = manVec3.create(NULL, minScalar(a->min.x, b->min.x), minScalar(a->min.y, b->min.y), minScalar(a->min.z, b->min.z));
+	box.max = manVec3.create(NULL, maxScalar(a->max.x, b->max.x), maxScalar(a->max.y, b->max.y), maxScalar(a->max.z, b->max.z));
+	return box;
+}
+
+/* Half the surface area, only ever compared so the factor of two is dropped. */
+static scalar perimeter(const AABB* box) {
+	scalar dx = box->max.x - box->min.x;
+	scalar dy = box->max.y - box->min.y;
+	scalar dz = box->max.z - box->min.z;
+	return dx*dy + dy*dz + dz*dx;
+}
+
+static bool contains(const AABB* outer, const AABB* inner) {
+	return (outer->min.x <= inner->min.x) && (outer->min.y <= inner->min.y) && (outer->min.z <= inner->min.z) &&
+	       (outer->max.x >= inner->max.x) && (outer->max.y >= inner->max.y) && (outer->max.z >= inner->max.z);
+}
+
+static bool overlaps(const AABB* a, const AABB* b) {
+	return (a->min.x <= b->max.x) && (a->max.x >= b->min.x) &&
+	       (a->min.y <= b->max.y) && (a->max.y >= b->min.y) &&
+	       (a->min.z <= b->max.z) && (a->max.z >= b->min.z);
+}
+
+static AABB boxFromSphere(const ColliderSphere* sphere) {
+	AABB box;
+	scalar r = sphere->radius;
+	box.min = manVec3.create(NULL, sphere->center.x - r, sphere->center.y - r, sphere->center.z - r);
+	box.max = manVec3.create(NULL, sphere->center.x + r, sphere->center.y + r, sphere->center.z + r);
+	return box;
+}
+
+/*
+ * Node pool
+ */
+static int allocateNode(AABBTree* tree) {
+	if (tree->freeList == AABB_TREE_NULL_NODE) {
+		int oldCapacity = tree->nodeCapacity;
+		tree->nodeCapacity = oldCapacity == 0 ? 16 : oldCapacity*2;
+		tree->nodes = realloc(tree->nodes, sizeof(AABBTreeNode)*tree->nodeCapacity);
+
+		for(int i = oldCapacity; i < tree->nodeCapacity; i++) {
+			tree->nodes[i].parent = i+1 < tree->nodeCapacity ? i+1 : AABB_TREE_NULL_NODE;
+			tree->nodes[i].height = -1;
+		}
+		tree->freeList = oldCapacity;
+	}
+
+	int id = tree->freeList;
+	AABBTreeNode* node = &tree->nodes[id];
+	tree->freeList = node->parent;
+
+	node->parent = AABB_TREE_NULL_NODE;
+	node->left = AABB_TREE_NULL_NODE;
+	node->right = AABB_TREE_NULL_NODE;
+	node->height = 0;
+	node->userID = -1;
+	tree->nodeCount++;
+
+	return id;
+}
+
+static void freeNode(AABBTree* tree, int id) {
+	tree->nodes[id].parent = tree->freeList;
+	tree->nodes[id].height = -1;
+	tree->freeList = id;
+	tree->nodeCount--;
+}
+
+static bool isLeaf(const AABBTreeNode* node) {
+	return node->left == AABB_TREE_NULL_NODE;
+}
+
+/*
+ * Balancing
+ */
+static int maxInt(int a, int b) {
+	return a > b ? a : b;
+}
+
+/*
+ * Performs a left or right rotation if node a is imbalanced.
+ * Returns the new root of the sub-tree.
+ */
+static int balance(AABBTree* tree, int iA) {
+	AABBTreeNode* A = &tree->nodes[iA];
+	if (isLeaf(A) || A->height < 2)
+		return iA;
+
+	int iB = A->left;
+	int iC = A->right;
+	AABBTreeNode* B = &tree->nodes[iB];
+	AABBTreeNode* C = &tree->nodes[iC];
+
+	int balanceFactor = C->height - B->height;
+
+	//Rotate C up
+	if (balanceFactor > 1) {
+		int iF = C->left;
+		int iG = C->right;
+		AABBTreeNode* F = &tree->nodes[iF];
+		AABBTreeNode* G = &tree->nodes[iG];
+
+		C->left = iA;
+		C->parent = A->parent;
+		A->parent = iC;
+
+		if (C->parent != AABB_TREE_NULL_NODE) {
+			if (tree->nodes[C->parent].left == iA)
+				tree->nodes[C->parent].left = iC;
+			else
+				tree->nodes[C->parent].right = iC;
+		} else {
+			tree->root = iC;
+		}
+
+		if (F->height > G->height) {
+			C->right = iF;
+			A->right = iG;
+			G->parent = iA;
+			A->box = combine(&B->box, &G->box);
+			C->box = combine(&A->box, &F->box);
+			A->height = 1 + maxInt(B->height, G->height);
+			C->height = 1 + maxInt(A->height, F->height);
+		} else {
+			C->right = iG;
+			A->right = iF;
+			F->parent = iA;
+			A->box = combine(&B->box, &F->box);
+			C->box = combine(&A->box, &G->box);
+			A->height = 1 + maxInt(B->height, F->height);
+			C->height = 1 + maxInt(A->height, G->height);
+		}
+
+		return iC;
+	}
+
+	//Rotate B up
+	if (balanceFactor < -1) {
+		int iD = B->left;
+		int iE = B->right;
+		AABBTreeNode* D = &tree->nodes[iD];
+		AABBTreeNode* E = &tree->nodes[iE];
+
+		B->left = iA;
+		B->parent = A->parent;
+		A->parent = iB;
+
+		if (B->parent != AABB_TREE_NULL_NODE) {
+			if (tree->nodes[B->parent].left == iA)
+				tree->nodes[B->parent].left = iB;
+			else
+				tree->nodes[B->parent].right = iB;
+		} else {
+			tree->root = iB;
+		}
+
+		if (D->height > E->height) {
+			B->right = iD;
+			A->left = iE;
+			E->parent = iA;
+			A->box = combine(&C->box, &E->box);
+			B->box = combine(&A->box, &D->box);
+			A->height = 1 + maxInt(C->height, E->height);
+			B->height = 1 + maxInt(A->height, D->height);
+		} else {
+			B->right = iE;
+			A->left = iD;
+			D->parent = iA;
+			A->box = combine(&C->box, &D->box);
+			B->box = combine(&A->box, &E->box);
+			A->height = 1 + maxInt(C->height, D->height);
+			B->height = 1 + maxInt(A->height, E->height);
+		}
+
+		return iB;
+	}
+
+	return iA;
+}
+
+/* Walks from the given node to the root fixing heights and boxes. */
+static void fixUpwards(AABBTree* tree, int index) {
+	while(index != AABB_TREE_NULL_NODE) {
+		index = balance(tree, index);
+
+		AABBTreeNode* node = &tree->nodes[index];
+		AABBTreeNode* left = &tree->nodes[node->left];
+		AABBTreeNode* right = &tree->nodes[node->right];
+
+		node->height = 1 + maxInt(left->height, right->height);
+		node->box = combine(&left->box, &right->box);
+
+		index = node->parent;
+	}
+}
+
+/*
+ * Insertion and removal of leaves
+ */
+static void insertLeaf(AABBTree* tree, int leaf) {
+	if (tree->root == AABB_TREE_NULL_NODE) {
+		tree->root = leaf;
+		tree->nodes[leaf].parent = AABB_TREE_NULL_NODE;
+		return;
+	}
+
+	//Find the best sibling using the surface area heuristic.
+	AABB leafBox = tree->nodes[leaf].box;
+	int index = tree->root;
+	while(!isLeaf(&tree->nodes[index])) {
+		AABBTreeNode* node = &tree->nodes[index];
+		int left = node->left;
+		int right = node->right;
+
+		scalar area = perimeter(&node->box);
+		AABB combined = combine(&node->box, &leafBox);
+		scalar combinedArea = perimeter(&combined);
+
+		//Cost of making a new parent for this node and the new leaf.
+		scalar cost = 2*combinedArea;
+		//Minimum cost of pushing the leaf further down the tree.
+		scalar inheritanceCost = 2*(combinedArea - area);
+
+		AABB leftBox = combine(&leafBox, &tree->nodes[left].box);
+		scalar costLeft = perimeter(&leftBox) + inheritanceCost;
+		if (!isLeaf(&tree->nodes[left]))
+			costLeft -= perimeter(&tree->nodes[left].box);
+
+		AABB rightBox = combine(&leafBox, &tree->nodes[right].box);
+		scalar costRight = perimeter(&rightBox) + inheritanceCost;
+		if (!isLeaf(&tree->nodes[right]))
+			costRight -= perimeter(&tree->nodes[right].box);
+
+		if ((cost < costLeft) && (cost < costRight))
+			break;
+
+		index = costLeft < costRight ? left : right;
+	}
+
+	int sibling = index;
+
+	//Create a new parent for the sibling and the leaf.
+	int oldParent = tree->nodes[sibling].parent;
+	int newParent = allocateNode(tree);
+	tree->nodes[newParent].parent = oldParent;
+	tree->nodes[newParent].box = combine(&leafBox, &tree->nodes[sibling].box);
+	tree->nodes[newParent].height = tree->nodes[sibling].height + 1;
+	tree->nodes[newParent].left = sibling;
+	tree->nodes[newParent].right = leaf;
+	tree->nodes[sibling].parent = newParent;
+	tree->nodes[leaf].parent = newParent;
+
+	if (oldParent != AABB_TREE_NULL_NODE) {
+		if (tree->nodes[oldParent].left == sibling)
+			tree->nodes[oldParent].left = newParent;
+		else
+			tree->nodes[oldParent].right = newParent;
+	} else {
+		tree->root = newParent;
+	}
+
+	fixUpwards(tree, tree->nodes[leaf].parent);
+}
+
+static void removeLeaf(AABBTree* tree, int leaf) {
+	if (leaf == tree->root) {
+		tree->root = AABB_TREE_NULL_NODE;
+		return;
+	}
+
+	int parent = tree->nodes[leaf].parent;
+	int grandParent = tree->nodes[parent].parent;
+	int sibling = tree->nodes[parent].left == leaf ? tree->nodes[parent].right : tree->nodes[parent].left;
+
+	if (grandParent != AABB_TREE_NULL_NODE) {
+		if (tree->nodes[grandParent].left == parent)
+			tree->nodes[grandParent].left = sibling;
+		else
+			tree->nodes[grandParent].right = sibling;
+
+		tree->nodes[sibling].parent = grandParent;
+		freeNode(tree, parent);
+
+		fixUpwards(tree, grandParent);
+	} else {
+		tree->root = sibling;
+		tree->nodes[sibling].parent = AABB_TREE_NULL_NODE;
+		freeNode(tree, parent);
+	}
+}
+
+static AABB fatten(AABBTree* tree, const AABB* box) {
+	AABB fat;
+	fat.min = manVec3.create(NULL, box->min.x - tree->margin, box->min.y - tree->margin, box->min.z - tree->margin);
+	fat.max = manVec3.create(NULL, box->max.x + tree->margin, box->max.y + tree->margin, box->max.z + tree->margin);
+	return fat;
+}
+
+/*
+ * Manager functions
+ */
+static AABBTree* new(scalar margin) {
+	AABBTree* tree = malloc(sizeof(AABBTree));
+
+	tree->nodes = NULL;
+	tree->nodeCapacity = 0;
+	tree->nodeCount = 0;
+	tree->freeList = AABB_TREE_NULL_NODE;
+	tree->root = AABB_TREE_NULL_NODE;
+	tree->margin = margin;
+
+	tree->proxies = NULL;
+	tree->proxyCount = 0;
+	tree->proxyCapacity = 0;
+
+	tree->stack = NULL;
+	tree->stackCapacity = 0;
+
+	tree->lastReinsertCount = 0;
+
+	tree->broadphase.self = tree;
+	tree->broadphase.jobSystem = NULL;
+	tree->broadphase.resting = NULL;
+	tree->broadphase.findPairs = findPairs;
+	tree->broadphase.delete = deleteBroadphase;
+
+	return tree;
+}
+
+static int insert(AABBTree* tree, const AABB* box, int userID) {
+	int leaf = allocateNode(tree);
+
+	tree->nodes[leaf].box = fatten(tree, box);
+	tree->nodes[leaf].userID = userID;
+	tree->nodes[leaf].height = 0;
+
+	insertLeaf(tree, leaf);
+
+	return leaf;
+}
+
+static void remove(AABBTree* tree, int proxy) {
+	removeLeaf(tree, proxy);
+	freeNode(tree, proxy);
+}
+
+static bool move(AABBTree* tree, int proxy, const AABB* box) {
+	if (contains(&tree->nodes[proxy].box, box))
+		return false;
+
+	removeLeaf(tree, proxy);
+	tree->nodes[proxy].box = fatten(tree, box);
+	insertLeaf(tree, proxy);
+
+	return true;
+}
+
+static void pushStack(AABBTree* tree, int* top, int node) {
+	if (*top >= tree->stackCapacity) {
+		tree->stackCapacity = tree->stackCapacity == 0 ? 64 : tree->stackCapacity*2;
+		tree->stack = realloc(tree->stack, sizeof(int)*tree->stackCapacity);
+	}
+	tree->stack[(*top)++] = node;
+}
+
+static void queryRegion(AABBTree* tree, const AABB* region, DynamicArray* results) {
+	manDynamicArray.clear(results);
+
+	if (tree->root == AABB_TREE_NULL_NODE)
+		return;
+
+	int top = 0;
+	pushStack(tree, &top, tree->root);
+
+	while(top > 0) {
+		AABBTreeNode* node = &tree->nodes[tree->stack[--top]];
+
+		if (!overlaps(&node->box, region))
+			continue;
+
+		if (isLeaf(node)) {
+			manDynamicArray.append(results, &node->userID);
+		} else {
+			pushStack(tree, &top, node->left);
+			pushStack(tree, &top, node->right);
+		}
+	}
+}
+
+/* Slab test of a ray segment against a box. */
+static bool rayHitsBox(const AABB* box, const Vec3* origin, const Vec3* direction, scalar maxFraction) {
+	scalar tMin = 0;
+	scalar tMax = maxFraction;
+
+	const scalar o[3] = {origin->x, origin->y, origin->z};
+	const scalar d[3] = {direction->x, direction->y, direction->z};
+	const scalar lo[3] = {box->min.x, box->min.y, box->min.z};
+	const scalar hi[3] = {box->max.x, box->max.y, box->max.z};
+
+	for(int a = 0; a < 3; a++) {
+		if (fabs(d[a]) < 1e-12) {
+			if ((o[a] < lo[a]) || (o[a] > hi[a]))
+				return false;
+		} else {
+			scalar inv = 1/d[a];
+			scalar t1 = (lo[a] - o[a])*inv;
+			scalar t2 = (hi[a] - o[a])*inv;
+
+			if (t1 > t2) {
+				scalar tmp = t1;
+				t1 = t2;
+				t2 = tmp;
+			}
+
+			tMin = maxScalar(tMin, t1);
+			tMax = minScalar(tMax, t2);
+
+			if (tMin > tMax)
+				return false;
+		}
+	}
+
+	return true;
+}
+
+static void queryRay(AABBTree* tree, const Vec3* origin, const Vec3* direction, scalar maxFraction, DynamicArray* results) {
+	manDynamicArray.clear(results);
+
+	if (tree->root == AABB_TREE_NULL_NODE)
+		return;
+
+	int top = 0;
+	pushStack(tree, &top, tree->root);
+
+	while(top > 0) {
+		AABBTreeNode* node = &tree->nodes[tree->stack[--top]];
+
+		if (!rayHitsBox(&node->box, origin, direction, maxFraction))
+			continue;
+
+		if (isLeaf(node)) {
+			manDynamicArray.append(results, &node->userID);
+		} else {
+			pushStack(tree, &top, node->left);
+			pushStack(tree, &top, node->right);
+		}
+	}
+}
+
+static int getHeight(AABBTree* tree) {
+	if (tree->root == AABB_TREE_NULL_NODE)
+		return 0;
+
+	return tree->nodes[tree->root].height;
+}
+
+static void delete(AABBTree* tree) {
+	free(tree->nodes);
+	free(tree->proxies);
+	free(tree->stack);
+
+	tree->nodes = NULL;
+	tree->proxies = NULL;
+	tree->stack = NULL;
+	tree->nodeCapacity = 0;
+	tree->nodeCount = 0;
+	tree->proxyCount = 0;
+	tree->proxyCapacity = 0;
+	tree->stackCapacity = 0;
+	tree->freeList = AABB_TREE_NULL_NODE;
+	tree->root = AABB_TREE_NULL_NODE;
+}
+
+/*
+ * Broadphase
+ */
+static void deleteBroadphase(void* const self) {
+	Broadphase* broadphase = (Broadphase*)self;
+	delete((AABBTree*)broadphase->self);
+}
+
+static void findPairs(void* const self, ColliderSphere* bounds, int count, DynamicArray* pairs) {
+	Broadphase* broadphase = (Broadphase*)self;
+	AABBTree* tree = (AABBTree*)broadphase->self;
+
+	manDynamicArray.clear(pairs);
+
+	if (count > tree->proxyCapacity) {
+		tree->proxyCapacity = count;
+		tree->proxies = realloc(tree->proxies, sizeof(int)*count);
+	}
+
+	//Colliders are never removed from a resolver, but drop any extra leaves if it happens.
+	while(tree->proxyCount > count)
+		remove(tree, tree->proxies[--tree->proxyCount]);
+
+	//Refit existing leaves, only ones that left their fat box are re-inserted.
+	tree->lastReinsertCount = 0;
+	for(int i = 0; i < tree->proxyCount; i++) {
+		AABB box = boxFromSphere(&bounds[i]);
+		if (move(tree, tree->proxies[i], &box))
+			tree->lastReinsertCount++;
+	}
+
+	//Add leaves for new colliders.
+	for(int i = tree->proxyCount; i < count; i++) {
+		AABB box = boxFromSphere(&bounds[i]);
+		tree->proxies[i] = insert(tree, &box, i);
+	}
+	tree->proxyCount = count;
+
+	if (tree->root == AABB_TREE_NULL_NODE)
+		return;
+
+	//Query the tree with each collider, keeping only pairs where it is the lower ID. Resting colliders
+	//aren't queried with, the colliders that can move find their pairs with them whichever ID is lower.
+	const bool* resting = broadphase->resting;
+	for(int i = 0; i < count; i++) {
+		if (resting != NULL && resting[i])
+			continue;
+
+		AABB box = boxFromSphere(&bounds[i]);
+
+		int top = 0;
+		pushStack(tree, &top, tree->root);
+
+		while(top > 0) {
+			AABBTreeNode* node = &tree->nodes[tree->stack[--top]];
+
+			if (!overlaps(&node->box, &box))
+				continue;
+
+			if (isLeaf(node)) {
+				int other = node->userID;
+				bool counted = (other > i) || (other < i && resting != NULL && resting[other]);
+				if (counted && manBroadphase.overlaps(&bounds[i], &bounds[other])) {
+					BroadphasePair pair = {i < other ? i : other, i < other ? other : i};
+					manDynamicArray.append(pairs, &pair);
+				}
+			} else {
+				pushStack(tree, &top, node->left);
+				pushStack(tree, &top, node->right);
+			}
+		}
+	}
+}
+
+const AABBTreeManager manAABBTree = {new, boxFromSphere, insert, remove, move, queryRegion, queryRay, getHeight, delete};
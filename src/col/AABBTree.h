@@ -0,0 +1,159 @@
+#ifndef COH_AABBTREE_H
+#define COH_AABBTREE_H
+
+#include <stdbool.h>
+
+#include "col/Broadphase.h"
+#include "util/DynamicArray.h"
+
+#define AABB_TREE_NULL_NODE -1
+
+/**
+ *	Axis aligned bounding box.
+ */
+typedef struct AABB_s {
+	Vec3 min;
+	Vec3 max;
+} AABB;
+
+/**
+ *	A node of the tree. Leaves hold a user ID, internal nodes always have two children.
+ *	Free nodes are chained through parent.
+ */
+typedef struct AABBTreeNode_s {
+	AABB box;
+	int parent;
+	int left;
+	int right;
+	/** Height of the node, leaves are 0 and free nodes are -1. **/
+	int height;
+	/** The ID given when the leaf was inserted. **/
+	int userID;
+} AABBTreeNode;
+
+/**
+ *	Dynamic bounding volume hierarchy.
+ *
+ *	Leaves store a fattened copy of the box they were given, so small motions
+ *	can be absorbed without touching the tree. The tree is kept balanced with
+ *	rotations on insert and remove so queries stay O(log n).
+ *
+ *	The tree can also be used as a broadphase, in which case it tracks one
+ *	leaf per collider and moves them each tick.
+ */
+typedef struct AABBTree_s {
+	/**
+	 *	Broadphase instance to use.
+	 */
+	Broadphase broadphase;
+
+	AABBTreeNode* nodes;
+	int nodeCapacity;
+	int nodeCount;
+	int freeList;
+	int root;
+
+	/** How far every leaf box is grown in each direction. **/
+	scalar margin;
+
+	/** Broadphase state, the leaf for each collider. **/
+	int* proxies;
+	int proxyCount;
+	int proxyCapacity;
+
+	/** Traversal stack reused between queries. **/
+	int* stack;
+	int stackCapacity;
+
+	/** Number of leaves that had to be re-inserted in the last broadphase tick. **/
+	int lastReinsertCount;
+} AABBTree;
+
+/**
+ *	Manager for AABB trees.
+ */
+typedef struct AABBTreeManager_s {
+	/**
+	 *	Creates a new, empty tree.
+	 *
+	 *	@param	margin	scalar, how far to fatten leaf boxes in each direction.
+	 *	@return			pointer to AABBTree, the new tree.
+	 */
+	AABBTree*(* new)(scalar margin);
+
+	/**
+	 *	Creates the box that tightly bounds the given sphere.
+	 *
+	 *	@param	sphere	pointer to ColliderSphere to bound.
+	 *	@return			AABB bounding the sphere.
+	 */
+	AABB(* boxFromSphere)(const ColliderSphere* sphere);
+
+	/**
+	 *	Inserts a leaf into the tree.
+	 *
+	 *	@param	tree	pointer to AABBTree to insert into.
+	 *	@param	box		pointer to AABB, the tight bounds of the leaf.
+	 *	@param	userID	int, value reported by queries for this leaf.
+	 *	@return			int, the proxy to use when moving or removing the leaf.
+	 */
+	int(* insert)(AABBTree* tree, const AABB* box, int userID);
+
+	/**
+	 *	Removes a leaf from the tree.
+	 *
+	 *	@param	tree	pointer to AABBTree to remove from.
+	 *	@param	proxy	int, the proxy returned by insert.
+	 */
+	void(* remove)(AABBTree* tree, int proxy);
+
+	/**
+	 *	Refits a leaf to its new bounds. The leaf is only re-inserted if the new
+	 *	bounds have left its fattened box.
+	 *
+	 *	@param	tree	pointer to AABBTree the leaf is in.
+	 *	@param	proxy	int, the proxy returned by insert.
+	 *	@param	box		pointer to AABB, the new tight bounds.
+	 *	@return			bool, true if the leaf was re-inserted.
+	 */
+	bool(* move)(AABBTree* tree, int proxy, const AABB* box);
+
+	/**
+	 *	Finds all leaves whose fat box overlaps the given region.
+	 *
+	 *	@param	tree	pointer to AABBTree to query.
+	 *	@param	region	pointer to AABB, region to test against.
+	 *	@param	results	pointer to DynamicArray of int, cleared then filled with the user IDs found.
+	 */
+	void(* queryRegion)(AABBTree* tree, const AABB* region, DynamicArray* results);
+
+	/**
+	 *	Finds all leaves whose fat box is hit by the given ray segment.
+	 *
+	 *	@param	tree		pointer to AABBTree to query.
+	 *	@param	origin		pointer to Vec3, start of the ray.
+	 *	@param	direction	pointer to Vec3, direction of the ray, need not be normalised.
+	 *	@param	maxFraction	scalar, how many lengths of direction the ray extends.
+	 *	@param	results		pointer to DynamicArray of int, cleared then filled with the user IDs hit.
+	 */
+	void(* queryRay)(AABBTree* tree, const Vec3* origin, const Vec3* direction, scalar maxFraction, DynamicArray* results);
+
+	/**
+	 *	Gets the height of the tree, useful for checking balance.
+	 *
+	 *	@param	tree	pointer to AABBTree.
+	 *	@return			int, the height of the root, or 0 for an empty tree.
+	 */
+	int(* getHeight)(AABBTree* tree);
+
+	/**
+	 *	Frees all memory associated with the tree, not including the tree itself.
+	 *
+	 *	@param	tree	pointer to AABBTree to delete.
+	 */
+	void(* delete)(AABBTree* tree);
+} AABBTreeManager;
+
+extern const AABBTreeManager manAABBTree;
+
+#endif
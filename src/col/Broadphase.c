@@ -0,0 +1,134 @@
+#include "Broadphase.h"
+
+#include <stdlib.h>
+
+static bool overlaps(ColliderSphere* obj1, ColliderSphere* obj2) {
+	scalar dx = obj2->center.x - obj1->center.x;
+	scalar dy = obj2->center.y - obj1->center.y;
+	scalar dz = obj2->center.z - obj1->center.z;
+	scalar rad = obj1->radius + obj2->radius;
+
+	return dx*dx + dy*dy + dz*dz - rad*rad <= 0;
+}
+
+static bool bothResting(Broadphase* broadphase, int collider1, int collider2) {
+	return broadphase->resting != NULL && broadphase->resting[collider1] && broadphase->resting[collider2];
+}
+
+/*
+ * The brute-force broadphase. Keeps a pair buffer per job so rows can be tested in parallel.
+ */
+typedef struct BruteForce_s {
+	Broadphase broadphase;
+
+	DynamicArray** rowPairs;
+	int rowPairsCount;
+} BruteForce;
+
+typedef struct BruteForceJob_s {
+	BruteForce* bruteForce;
+	const bool* resting;
+	ColliderSphere* bounds;
+	int count;
+} BruteForceJob;
+
+static void findPairsInRows(ColliderSphere* bounds, const bool* resting, int count, int start, int end, DynamicArray* pairs) {
+	for(int i = start; i < end; i++) {
+		bool iResting = resting != NULL && resting[i];
+
+		for(int j = i+1; j < count; j++) {
+			if (iResting && resting[j])
+				continue;
+
+			if (overlaps(&bounds[i], &bounds[j])) {
+				BroadphasePair pair = {i, j};
+				manDynamicArray.append(pairs, &pair);
+			}
+		}
+	}
+}
+
+static void findPairsJob(void* data, int start, int end, int threadIndex) {
+	BruteForceJob* job = (BruteForceJob*)data;
+	DynamicArray* pairs = job->bruteForce->rowPairs[start/BROADPHASE_BRUTE_FORCE_ROWS];
+
+	manDynamicArray.clear(pairs);
+	findPairsInRows(job->bounds, job->resting, job->count, start, end, pairs);
+}
+
+static void findPairsBruteForce(void* const self, ColliderSphere* bounds, int count, DynamicArray* pairs) {
+	Broadphase* broadphase = (Broadphase*)self;
+	BruteForce* bruteForce = (BruteForce*)broadphase->self;
+
+	manDynamicArray.clear(pairs);
+
+	int jobCount = (count + BROADPHASE_BRUTE_FORCE_ROWS - 1)/BROADPHASE_BRUTE_FORCE_ROWS;
+	if (manJobSystem.getThreadCount(broadphase->jobSystem) == 1 || jobCount <= 1) {
+		findPairsInRows(bounds, broadphase->resting, count, 0, count, pairs);
+		return;
+	}
+
+	//Buffers are kept between ticks, so this only allocates while the collider count grows.
+	if (jobCount > bruteForce->rowPairsCount) {
+		bruteForce->rowPairs = realloc(bruteForce->rowPairs, sizeof(DynamicArray*)*jobCount);
+		for(int i = bruteForce->rowPairsCount; i < jobCount; i++)
+			bruteForce->rowPairs[i] = manDynamicArray.new(16, sizeof(BroadphasePair));
+		bruteForce->rowPairsCount = jobCount;
+	}
+
+	BruteForceJob job = {bruteForce, broadphase->resting, bounds, count};
+	manJobSystem.parallelFor(broadphase->jobSystem, count, BROADPHASE_BRUTE_FORCE_ROWS, findPairsJob, &job);
+
+	for(int i = 0; i < jobCount; i++) {
+		DynamicArray* rows = bruteForce->rowPairs[i];
+		for(int p = 0; p < rows->size; p++)
+			manDynamicArray.append(pairs, manDynamicArray.get(rows, p));
+	}
+}
+
+static void deleteBruteForce(void* const self) {
+	BruteForce* bruteForce = (BruteForce*)((Broadphase*)self)->self;
+
+	for(int i = 0; i < bruteForce->rowPairsCount; i++) {
+		manDynamicArray.delete(bruteForce->rowPairs[i]);
+		free(bruteForce->rowPairs[i]);
+	}
+	free(bruteForce->rowPairs);
+}
+
+static Broadphase* newBruteForce() {
+	BruteForce* bruteForce = malloc(sizeof(BruteForce));
+
+	bruteForce->broadphase.self = bruteForce;
+	bruteForce->broadphase.jobSystem = NULL;
+	bruteForce->broadphase.resting = NULL;
+	bruteForce->broadphase.findPairs = findPairsBruteForce;
+	bruteForce->broadphase.delete = deleteBruteForce;
+	bruteForce->rowPairs = NULL;
+	bruteForce->rowPairsCount = 0;
+
+	return &bruteForce->broadphase;
+}
+
+static int comparePairs(const void* p1, const void* p2) {
+	const BroadphasePair* pair1 = (const BroadphasePair*)p1;
+	const BroadphasePair* pair2 = (const BroadphasePair*)p2;
+
+	if (pair1->collider1 != pair2->collider1)
+		return pair1->collider1 < pair2->collider1 ? -1 : 1;
+
+	if (pair1->collider2 != pair2->collider2)
+		return pair1->collider2 < pair2->collider2 ? -1 : 1;
+
+	return 0;
+}
+
+static void sortPairs(DynamicArray* pairs) {
+	qsort(pairs->contents, pairs->size, pairs->elementSize, comparePairs);
+}
+
+static void delete(Broadphase* broadphase) {
+	broadphase->delete(broadphase);
+}
+
+const BroadphaseManager manBroadphase = {newBruteForce, overlaps, bothResting, sortPairs, delete};
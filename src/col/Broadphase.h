@@ -0,0 +1,116 @@
+#ifndef COH_BROADPHASE_H
+#define COH_BROADPHASE_H
+
+#include "col/CollisionMesh.h"
+#include "util/DynamicArray.h"
+#include "util/JobSystem.h"
+
+/** Number of rows of the pair matrix each job tests when the brute-force broadphase runs in parallel. **/
+#define BROADPHASE_BRUTE_FORCE_ROWS 32
+
+/**
+ *	A pair of colliders, by index, that may be colliding and should
+ *	be handed to the narrowphase. collider1 is always less than collider2.
+ */
+typedef struct BroadphasePair_s {
+	int collider1;
+	int collider2;
+} BroadphasePair;
+
+/**
+ *	Broadphase stage of the collision resolver.
+ *
+ *	All broadphases must 'inherit' this class by having a Broadphase as
+ *	the first member of their structure, the same way force generators do.
+ */
+typedef struct Broadphase_s {
+	/**
+	 *	Pointer to the start of the structure using this broadphase.
+	 */
+	void* self;
+
+	/**
+	 *	Job system the broadphase may split its work over, set by the collision resolver. Not owned.
+	 *	Broadphases that don't split their work ignore it.
+	 */
+	JobSystem* jobSystem;
+
+	/**
+	 *	Whether each collider, by index, is resting this tick, asleep or immovable, set by the collision resolver
+	 *	before findPairs. Nothing can change between two resting colliders, so findPairs leaves those pairs out.
+	 *	NULL while none are resting. Not owned.
+	 */
+	const bool* resting;
+
+	/**
+	 *	Finds all the candidate pairs for this tick.
+	 *
+	 *	@param	self	const pointer to void, pointer to the Broadphase.
+	 *	@param	bounds	pointer to ColliderSphere, the transformed broadphase spheres, indexed by collider.
+	 *	@param	count	int, the number of spheres in bounds.
+	 *	@param	pairs	pointer to DynamicArray of BroadphasePair, cleared and then filled with the overlapping pairs,
+	 *					apart from those where both colliders are resting.
+	 */
+	void(* findPairs)(void* const self, ColliderSphere* bounds, int count, DynamicArray* pairs);
+
+	/**
+	 *	Frees any memory owned by the broadphase, not including the broadphase itself.
+	 *
+	 *	@param	self	const pointer to void, pointer to the Broadphase.
+	 */
+	void(* delete)(void* const self);
+} Broadphase;
+
+/**
+ *	Manager for broadphases.
+ */
+typedef struct BroadphaseManager_s {
+	/**
+	 *	Creates a broadphase that tests every pair of spheres against each other.
+	 *	This is the original O(n^2) behaviour of the collision resolver.
+	 *	With a job system the rows of the pair matrix are split across threads,
+	 *	and each row's pairs are gathered back in order.
+	 *
+	 *	@return	pointer to Broadphase, the new brute-force broadphase.
+	 */
+	Broadphase*(* newBruteForce)();
+
+	/**
+	 *	Sphere vs sphere overlap test shared by all broadphases.
+	 *
+	 *	@param	obj1	pointer to ColliderSphere, first sphere.
+	 *	@param	obj2	pointer to ColliderSphere, second sphere.
+	 *	@return			bool, true if the spheres overlap or touch.
+	 */
+	bool(* overlaps)(ColliderSphere* obj1, ColliderSphere* obj2);
+
+	/**
+	 *	Whether both colliders of a pair are resting, so the pair is left out.
+	 *
+	 *	@param	broadphase	pointer to Broadphase, the broadphase finding the pair.
+	 *	@param	collider1	int, index of the first collider.
+	 *	@param	collider2	int, index of the second collider.
+	 *	@return				bool, true if neither collider can move this tick.
+	 */
+	bool(* bothResting)(Broadphase* broadphase, int collider1, int collider2);
+
+	/**
+	 *	Sorts the given pairs so the narrowphase visits them in the same order
+	 *	as the brute-force loop would.
+	 *
+	 *	@param	pairs	pointer to DynamicArray of BroadphasePair to sort.
+	 */
+	void(* sortPairs)(DynamicArray* pairs);
+
+	/**
+	 *	Frees all memory associated with the given broadphase.
+	 *	The broadphase itself is not freed.
+	 *
+	 *	@param	broadphase	pointer to Broadphase to delete.
+	 */
+	void(* delete)(Broadphase* broadphase);
+} BroadphaseManager;
+
+extern const BroadphaseManager manBroadphase;
+
+#endif
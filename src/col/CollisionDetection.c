@@ -5,6 +5,7 @@
 #include <stdio.h>
 
 #include "col/SAT.h"
+#include "col/GJK.h"
 #include "math/Mat4.h"
 
 static CollisionResult satOverlapCollision(SATOverlap* overlap) {
@@ -20,7 +21,23 @@ static CollisionResult satOverlapCollision(SATOverlap* overlap) {
 	return result;
 }
 
-static bool doSimpleMeshvsSimpleMesh(SATOverlap* result, ColliderSimpleMesh* mesh1, ColliderSimpleMesh* mesh2) {
+/*
+ * The vertex of each mesh on the side facing the other along an axis, where the next test's searches start.
+ */
+static void findNearVerts(SATProjection* proj1, SATProjection* proj2, int minVert1, int maxVert1, int minVert2, int maxVert2, int* near1, int* near2) {
+	bool below = (proj1->max - proj2->min) <= (proj2->max - proj1->min);
+	*near1 = below ? maxVert1 : minVert1;
+	*near2 = below ? minVert2 : maxVert2;
+}
+
+/*
+ * Tests mesh1's normals, with the searches on each mesh starting from near1 and near2. They are
+ * set to the vertices facing each other along the axis result ends up with.
+ */
+static bool doSimpleMeshvsSimpleMesh(SATOverlap* result, ColliderSimpleMesh* mesh1, ColliderSimpleMesh* mesh2, int* near1, int* near2) {
+	//Where the last projection of each mesh found its extremes, neighbouring normals often share them.
+	int minVert1 = *near1, maxVert1 = *near1, minVert2 = *near2, maxVert2 = *near2;
+
 	for(int i = 0; i < mesh1->satMesh.nCount; i++) {
 		SATProjection mesh1Proj, mesh2Proj;
 		mesh1Proj.axis = mesh1->satMesh.norms[i];
@@ -34,15 +51,20 @@ static bool doSimpleMeshvsSimpleMesh(SATOverlap* result, ColliderSimpleMesh* mes
 		if ((mesh1->minPointForAxis!=NULL) && (mesh1->maxPointForAxis!=NULL)) {
 			//If we know the min and max point, then we only need to project them.
 			//Significantly reduces calculation complexity.
-			sat.projectPoint(&mesh1Proj, &mesh1->satMesh.verts[mesh1->minPointForAxis[i]]);
-			sat.projectPoint(&mesh1Proj, &mesh1->satMesh.verts[mesh1->maxPointForAxis[i]]);
+			minVert1 = mesh1->minPointForAxis[i];
+			maxVert1 = mesh1->maxPointForAxis[i];
+			sat.projectPoint(&mesh1Proj, &mesh1->satMesh.verts[minVert1]);
+			sat.projectPoint(&mesh1Proj, &mesh1->satMesh.verts[maxVert1]);
 		} else {
 			//If we don't have the cache data availble, then do the normal calculation.
-			sat.projectMesh(&mesh1Proj, &mesh1->satMesh);
+			sat.projectMeshFrom(&mesh1Proj, &mesh1->satMesh, &minVert1, &maxVert1);
 		}
 
 
-		if ((mesh2->minPointForAxis!=NULL) && (mesh2->maxPointForAxis!=NULL)) {
+		//Climbing the hull is cheaper than looking for a matching normal to use the cache with.
+		bool climbs = (mesh2->satMesh.adjacency!=NULL) && (mesh2->satMesh.vCount >= SAT_CLIMB_MIN_VERTS);
+
+		if (!climbs && (mesh2->minPointForAxis!=NULL) && (mesh2->maxPointForAxis!=NULL)) {
 			int j;
 			bool matchNormFlag = false;
 			for(j = 0; j < mesh2->satMesh.nCount; j++) {
@@ -56,25 +78,29 @@ static bool doSimpleMeshvsSimpleMesh(SATOverlap* result, ColliderSimpleMesh* mes
 			if (matchNormFlag) {
 				//If we know the min and max point, then we only need to project them.
 				//Significantly reduces calculation complexity.
-				sat.projectPoint(&mesh2Proj, &mesh2->satMesh.verts[mesh2->minPointForAxis[j]]);
-				sat.projectPoint(&mesh2Proj, &mesh2->satMesh.verts[mesh2->maxPointForAxis[j]]);
+				minVert2 = mesh2->minPointForAxis[j];
+				maxVert2 = mesh2->maxPointForAxis[j];
+				sat.projectPoint(&mesh2Proj, &mesh2->satMesh.verts[minVert2]);
+				sat.projectPoint(&mesh2Proj, &mesh2->satMesh.verts[maxVert2]);
 			} else {
 				//If we don't have the cache data availble, then do the normal calculation.
-				sat.projectMesh(&mesh2Proj, &mesh2->satMesh);
+				sat.projectMeshFrom(&mesh2Proj, &mesh2->satMesh, &minVert2, &maxVert2);
 			}
 		} else {
 			//If we don't have the cache data availble, then do the normal calculation.
-			sat.projectMesh(&mesh2Proj, &mesh2->satMesh);
+			sat.projectMeshFrom(&mesh2Proj, &mesh2->satMesh, &minVert2, &maxVert2);
 		}
 
 		SATOverlap overlap = sat.overlap(&mesh1Proj, &mesh2Proj);
 
 		if(!overlap.isTouching) {
 			*result = overlap;
+			findNearVerts(&mesh1Proj, &mesh2Proj, minVert1, maxVert1, minVert2, maxVert2, near1, near2);
 			return false;
 		} else {
 			if (fabs(overlap.push) < fabs(result->push)) {
 				*result = overlap;
+				findNearVerts(&mesh1Proj, &mesh2Proj, minVert1, maxVert1, minVert2, maxVert2, near1, near2);
 			}
 		}
 	}
@@ -92,23 +118,28 @@ static bool fastSphereVsSphere(ColliderSphere* bf1, ColliderSphere* bf2) {
 	return sqrDist<= 0;
 }
 
-static CollisionResult simpleMeshVsSimpleMesh(ColliderSimpleMesh* mesh1, ColliderSimpleMesh* mesh2) {
+static CollisionResult simpleMeshVsSimpleMesh(ColliderSimpleMesh* mesh1, ColliderSimpleMesh* mesh2, int* vertex1, int* vertex2) {
 	SATOverlap overlap;
 	overlap.push = SCALAR_MAX_VAL;
 
-	if (doSimpleMeshvsSimpleMesh(&overlap, mesh1, mesh2)) {
-		SATOverlap overlap2;
-		overlap2.push = overlap.push;
+	if (doSimpleMeshvsSimpleMesh(&overlap, mesh1, mesh2, vertex1, vertex2)) {
+		//Start from the first pass's overlap, so the axis and flags are set even if no axis of mesh2 beats it.
+		SATOverlap overlap2 = overlap;
+		int near1 = *vertex1, near2 = *vertex2;
 
-		if (doSimpleMeshvsSimpleMesh(&overlap2, mesh2, mesh1)) {
+		if (doSimpleMeshvsSimpleMesh(&overlap2, mesh2, mesh1, &near2, &near1)) {
 			overlap2.push = -overlap2.push;
 			if (overlap2.push<overlap.push) {
 				overlap = overlap2;
+				*vertex1 = near1;
+				*vertex2 = near2;
 			}
 		} else {
 			overlap2.push = -overlap2.push;
 			if (overlap2.push>overlap.push) {
 				overlap = overlap2;
+				*vertex1 = near1;
+				*vertex2 = near2;
 			}
 		}
 	}
@@ -116,12 +147,184 @@ static CollisionResult simpleMeshVsSimpleMesh(ColliderSimpleMesh* mesh1, Collide
 	return satOverlapCollision(&overlap);
 }
 
+/*
+ * Whether the spheres touch at any point in the tick, given where they end and how far they moved.
+ * Relative to the first sphere the second moves in a straight line, so this finds the closest it gets.
+ */
+static bool sweptSphereVsSphere(ColliderSphere* bf1, Vec3* move1, ColliderSphere* bf2, Vec3* move2) {
+	Vec3 disp = manVec3.sub(&bf2->center, &bf1->center);
+	Vec3 move = manVec3.sub(move2, move1);
+	scalar rad = bf1->radius+bf2->radius;
+
+	//How far back along the move from the end position the spheres are closest.
+	scalar moveSqr = manVec3.dot(&move, &move);
+	scalar back = moveSqr > 0 ? manVec3.dot(&disp, &move)/moveSqr : 0;
+	back = back < 0 ? 0 : (back > 1 ? 1 : back);
+
+	Vec3 backMove = manVec3.preMulScalar(back, &move);
+	Vec3 closest = manVec3.sub(&disp, &backMove);
+
+	return manVec3.dot(&closest, &closest) <= rad*rad;
+}
+
+static void projectSimpleMesh(SATProjection* proj, ColliderSimpleMesh* mesh, int axis, int* minVert, int* maxVert) {
+	proj->min = SCALAR_MAX_VAL;
+	proj->max = SCALAR_MIN_VAL;
+
+	if ((axis >= 0) && (mesh->minPointForAxis!=NULL) && (mesh->maxPointForAxis!=NULL)) {
+		*minVert = mesh->minPointForAxis[axis];
+		*maxVert = mesh->maxPointForAxis[axis];
+		sat.projectPoint(proj, &mesh->satMesh.verts[*minVert]);
+		sat.projectPoint(proj, &mesh->satMesh.verts[*maxVert]);
+	} else {
+		sat.projectMeshFrom(proj, &mesh->satMesh, minVert, maxVert);
+	}
+}
+
+/*
+ * Narrows [enter, exit] to the times the meshes overlap along each of mesh1's normals.
+ * At time t mesh2 is offset from its end position by (t - 1)*move along the axis.
+ * The searches on each mesh start from near1 and near2, which are left at the vertices
+ * facing each other along the axis the meshes enter on, if it is one of mesh1's.
+ */
+static bool sweepAxes(ColliderSimpleMesh* mesh1, ColliderSimpleMesh* mesh2, Vec3* move, scalar* enter, scalar* exit, Vec3* enterAxis, int* near1, int* near2) {
+	int minVert1 = *near1, maxVert1 = *near1, minVert2 = *near2, maxVert2 = *near2;
+
+	for(int i = 0; i < mesh1->satMesh.nCount; i++) {
+		SATProjection mesh1Proj, mesh2Proj;
+		mesh1Proj.axis = mesh1->satMesh.norms[i];
+		mesh2Proj.axis = mesh1->satMesh.norms[i];
+		projectSimpleMesh(&mesh1Proj, mesh1, i, &minVert1, &maxVert1);
+		projectSimpleMesh(&mesh2Proj, mesh2, -1, &minVert2, &maxVert2);
+
+		//The offsets mesh2 overlaps mesh1 between.
+		scalar low = mesh1Proj.min - mesh2Proj.max;
+		scalar high = mesh1Proj.max - mesh2Proj.min;
+		scalar speed = manVec3.dot(move, &mesh1Proj.axis);
+
+		if (speed == 0) {
+			if ((low >= 0) || (high <= 0))
+				return false;
+			continue;
+		}
+
+		scalar t1 = 1 + low/speed;
+		scalar t2 = 1 + high/speed;
+		scalar axisEnter = t1 < t2 ? t1 : t2;
+		scalar axisExit = t1 < t2 ? t2 : t1;
+
+		if (axisEnter > *enter) {
+			*enter = axisEnter;
+			*enterAxis = mesh1Proj.axis;
+			findNearVerts(&mesh1Proj, &mesh2Proj, minVert1, maxVert1, minVert2, maxVert2, near1, near2);
+		}
+		if (axisExit < *exit)
+			*exit = axisExit;
+
+		if (*enter > *exit)
+			return false;
+	}
+
+	return true;
+}
+
+/*
+ * Swept separating axis test, the time of impact is when the last axis to stop separating
+ * the meshes does. Like the static test only face normals are used, so it is exact for the
+ * same shapes the static test is.
+ */
+static CollisionResult sweptSimpleMeshVsSimpleMesh(ColliderSimpleMesh* mesh1, Vec3* move1, ColliderSimpleMesh* mesh2, Vec3* move2, scalar* timeOfImpact, int* vertex1, int* vertex2) {
+	CollisionResult result;
+	result.isTouching = false;
+	result.isColliding = false;
+	result.isContained = false;
+	result.isMatch = false;
+	result.distance = 0;
+	result.axis = manVec3.create(NULL, 0, 0, 0);
+
+	//Each pass moves the second mesh it is given relative to the first.
+	Vec3 move = manVec3.sub(move2, move1);
+	Vec3 reverseMove = manVec3.invert(&move);
+	scalar enter = -SCALAR_MAX_VAL;
+	scalar exit = SCALAR_MAX_VAL;
+	Vec3 axis = result.axis;
+
+	if (!sweepAxes(mesh1, mesh2, &move, &enter, &exit, &axis, vertex1, vertex2) || !sweepAxes(mesh2, mesh1, &reverseMove, &enter, &exit, &axis, vertex2, vertex1))
+		return result;
+
+	if ((enter > 1) || (exit < 0))
+		return result;
+
+	//Point the axis from mesh2 to mesh1, the way resolving pushes collider1.
+	if (manVec3.dot(&axis, &move) < 0)
+		axis = manVec3.invert(&axis);
+
+	result.axis = axis;
+	result.isTouching = true;
+	result.isColliding = true;
+	*timeOfImpact = enter < 0 ? 0 : enter;
+
+	return result;
+}
+
 bool checkStaticBroadphase(ColliderSphere* obj1, ColliderSphere* obj2) {
 	return fastSphereVsSphere(obj1, obj2);
 }
 
+CollisionResult checkStaticNarrowphaseFrom(ColliderSimpleMesh* obj1, ColliderSimpleMesh* obj2, int* vertex1, int* vertex2) {
+	return simpleMeshVsSimpleMesh(obj1, obj2, vertex1, vertex2);
+}
+
 CollisionResult checkStaticNarrowphase(ColliderSimpleMesh* obj1, ColliderSimpleMesh* obj2) {
-	return simpleMeshVsSimpleMesh(obj1, obj2);
+	int vertex1 = 0, vertex2 = 0;
+	return simpleMeshVsSimpleMesh(obj1, obj2, &vertex1, &vertex2);
+}
+
+CollisionResult checkGJKNarrowphaseFrom(ColliderSimpleMesh* obj1, ColliderSimpleMesh* obj2, int* vertex1, int* vertex2) {
+	CollisionResult result;
+	result.isTouching = false;
+	result.isColliding = false;
+	result.isContained = false;
+	result.isMatch = false;
+	result.distance = 0;
+	result.axis = manVec3.create(NULL, 0, 0, 0);
+
+	GJKSimplex simplex;
+	simplex.vertex1 = *vertex1;
+	simplex.vertex2 = *vertex2;
+	if (gjk.intersect(&obj1->satMesh, &obj2->satMesh, &simplex)) {
+		Vec3 normal;
+		scalar depth;
+		result.isTouching = true;
+		if (gjk.penetration(&obj1->satMesh, &obj2->satMesh, &simplex, &normal, &depth) && depth > 0) {
+			//EPA gives the way to move obj2, the result is the way to move obj1.
+			result.isColliding = true;
+			result.axis = manVec3.invert(&normal);
+			result.distance = depth;
+		}
+	}
+
+	*vertex1 = simplex.vertex1;
+	*vertex2 = simplex.vertex2;
+	return result;
+}
+
+CollisionResult checkGJKNarrowphase(ColliderSimpleMesh* obj1, ColliderSimpleMesh* obj2) {
+	int vertex1 = 0, vertex2 = 0;
+	return checkGJKNarrowphaseFrom(obj1, obj2, &vertex1, &vertex2);
+}
+
+bool checkSweptBroadphase(ColliderSphere* obj1, Vec3* move1, ColliderSphere* obj2, Vec3* move2) {
+	return sweptSphereVsSphere(obj1, move1, obj2, move2);
+}
+
+CollisionResult checkSweptNarrowphaseFrom(ColliderSimpleMesh* obj1, Vec3* move1, ColliderSimpleMesh* obj2, Vec3* move2, scalar* timeOfImpact, int* vertex1, int* vertex2) {
+	return sweptSimpleMeshVsSimpleMesh(obj1, move1, obj2, move2, timeOfImpact, vertex1, vertex2);
+}
+
+CollisionResult checkSweptNarrowphase(ColliderSimpleMesh* obj1, Vec3* move1, ColliderSimpleMesh* obj2, Vec3* move2, scalar* timeOfImpact) {
+	int vertex1 = 0, vertex2 = 0;
+	return sweptSimpleMeshVsSimpleMesh(obj1, move1, obj2, move2, timeOfImpact, &vertex1, &vertex2);
 }
 
-const CollisionDetectionManager manColDetection = {checkStaticBroadphase, checkStaticNarrowphase};
+const CollisionDetectionManager manColDetection = {checkStaticBroadphase, checkStaticNarrowphase, checkStaticNarrowphaseFrom, checkGJKNarrowphase, checkGJKNarrowphaseFrom, checkSweptBroadphase, checkSweptNarrowphase, checkSweptNarrowphaseFrom};
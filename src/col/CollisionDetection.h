@@ -18,6 +18,53 @@ typedef struct CollisionResult_s {
 typedef struct CollisionDetectionManager_s {
 	bool(* checkStaticBroadphase)(ColliderSphere* obj1, ColliderSphere* obj2);
 	CollisionResult(* checkStaticNarrowphase)(ColliderSimpleMesh* obj1, ColliderSimpleMesh* obj2);
+
+	/**
+	 * checkStaticNarrowphase with the projections of each mesh starting their searches at vertex1 and vertex2,
+	 * see SATManager.projectMeshFrom. Both are set to the vertices of the meshes facing each other along the
+	 * result's axis, ready for the next test of the same pair.
+	 */
+	CollisionResult(* checkStaticNarrowphaseFrom)(ColliderSimpleMesh* obj1, ColliderSimpleMesh* obj2, int* vertex1, int* vertex2);
+
+	/**
+	 * Checks two convex meshes with GJK, and finds how deep they overlap with EPA if they do.
+	 * Unlike checkStaticNarrowphase it finds separation along edge-edge axes, and its result's
+	 * axis points from obj2 to obj1 with a positive distance, the depth.
+	 */
+	CollisionResult(* checkGJKNarrowphase)(ColliderSimpleMesh* obj1, ColliderSimpleMesh* obj2);
+
+	/**
+	 * checkGJKNarrowphase with its support searches starting at vertex1 and vertex2, see GJKSimplex.
+	 * Both are set to where the searches finished, ready for the next test of the same pair.
+	 */
+	CollisionResult(* checkGJKNarrowphaseFrom)(ColliderSimpleMesh* obj1, ColliderSimpleMesh* obj2, int* vertex1, int* vertex2);
+
+	/**
+	 * Whether two broadphase spheres touch at any point during a tick.
+	 * @param obj1 The first sphere, where it is at the end of the tick.
+	 * @param move1 How far the first sphere moved during the tick.
+	 * @param obj2 The second sphere, where it is at the end of the tick.
+	 * @param move2 How far the second sphere moved during the tick.
+	 */
+	bool(* checkSweptBroadphase)(ColliderSphere* obj1, Vec3* move1, ColliderSphere* obj2, Vec3* move2);
+
+	/**
+	 * Finds when during a tick two meshes moving in straight lines first touch, so fast meshes can't pass through each other between ticks.
+	 * The result's axis points from obj2 to obj1 and its distance is 0, as the meshes are only just touching at the time of impact.
+	 * @param obj1 The first mesh, where it is at the end of the tick.
+	 * @param move1 How far the first mesh moved during the tick.
+	 * @param obj2 The second mesh, where it is at the end of the tick.
+	 * @param move2 How far the second mesh moved during the tick.
+	 * @param timeOfImpact Set to the fraction of the tick, from 0 to 1, the meshes first touch at, if they do.
+	 *                     0 if they were already overlapping at the start of the tick.
+	 */
+	CollisionResult(* checkSweptNarrowphase)(ColliderSimpleMesh* obj1, Vec3* move1, ColliderSimpleMesh* obj2, Vec3* move2, scalar* timeOfImpact);
+
+	/**
+	 * checkSweptNarrowphase with the searches on each mesh starting at vertex1 and vertex2, which are set to
+	 * the vertices facing each other along the axis the meshes first touch on, as checkStaticNarrowphaseFrom does.
+	 */
+	CollisionResult(* checkSweptNarrowphaseFrom)(ColliderSimpleMesh* obj1, Vec3* move1, ColliderSimpleMesh* obj2, Vec3* move2, scalar* timeOfImpact, int* vertex1, int* vertex2);
 } CollisionDetectionManager;
 
 extern const CollisionDetectionManager manColDetection;
@@ -1,5 +1,8 @@
 #include "CollisionMesh.h"
 
+#include <math.h>
+#include "util/DynamicArray.h"
+
 static const Vec3 xAxis = {1, 0, 0};
 static const Vec3 yAxis = {0, 1, 0};
 static const Vec3 zAxis = {0, 0, 1};
@@ -11,6 +14,8 @@ static ColliderSimpleMesh* newSimpleMesh(int vertCount, Vec3* verts, int normCou
 	newMesh->satMesh.verts = verts;
 	newMesh->satMesh.nCount = normCount;
 	newMesh->satMesh.norms = norms;
+	newMesh->satMesh.adjacencyStart = NULL;
+	newMesh->satMesh.adjacency = NULL;
 	newMesh->minPointForAxis = minPoints;
 	newMesh->maxPointForAxis = maxPoints;
 
@@ -50,12 +55,7 @@ static scalar max(scalar n1, scalar n2) {
 
 static void transformSphere(SATSphere* sphere, Mat4* matrix, Vec3* vScale) {
 	if (sphere!=NULL) {
-		Vec4 tmp = manVec4.createFromVec3(NULL, &sphere->center, 1);
-
-		tmp = manMat4.postMulVec4(matrix, &tmp);
-		sphere->center.x = tmp.x;
-		sphere->center.y = tmp.y;
-		sphere->center.z = tmp.z;
+		manMat4.transformPoints(matrix, &sphere->center, &sphere->center, 1);
 
 		scalar scale = max(max(vScale->x, vScale->y),vScale->z);
 		sphere->radius *= scale;
@@ -76,6 +76,7 @@ static ColliderSimpleMesh copyMesh(ColliderSimpleMesh* mesh) {
 		dest.satMesh.norms[i] = mesh->satMesh.norms[i];
 	}
 
+	dest.minPointForAxis = NULL;
 	if (mesh->minPointForAxis != NULL) {
 		dest.minPointForAxis = malloc(sizeof(Vec3)*dest.satMesh.nCount);
 		for(int i = 0; i < dest.satMesh.nCount; i++) {
@@ -83,6 +84,7 @@ static ColliderSimpleMesh copyMesh(ColliderSimpleMesh* mesh) {
 		}
 	}
 
+	dest.maxPointForAxis = NULL;
 	if (mesh->maxPointForAxis != NULL) {
 		dest.maxPointForAxis = malloc(sizeof(Vec3)*dest.satMesh.nCount);
 		for(int i = 0; i < dest.satMesh.nCount; i++) {
@@ -90,32 +92,272 @@ static ColliderSimpleMesh copyMesh(ColliderSimpleMesh* mesh) {
 		}
 	}
 
+	dest.satMesh.adjacencyStart = NULL;
+	dest.satMesh.adjacency = NULL;
+	if (mesh->satMesh.adjacency != NULL) {
+		int adjacencyCount = mesh->satMesh.adjacencyStart[dest.satMesh.vCount];
+		dest.satMesh.adjacencyStart = malloc(sizeof(int)*(dest.satMesh.vCount+1));
+		dest.satMesh.adjacency = malloc(sizeof(int)*adjacencyCount);
+		for(int i = 0; i <= dest.satMesh.vCount; i++) {
+			dest.satMesh.adjacencyStart[i] = mesh->satMesh.adjacencyStart[i];
+		}
+		for(int i = 0; i < adjacencyCount; i++) {
+			dest.satMesh.adjacency[i] = mesh->satMesh.adjacency[i];
+		}
+	}
+
 	return dest;
 }
 
 static void transformSimpleMesh(ColliderSimpleMesh* mesh, Mat4* matrix) {
-	for(int i = 0; i < mesh->satMesh.vCount; i++) {
-		Vec4 tmp = manVec4.createFromVec3(NULL, &mesh->satMesh.verts[i], 1);
-		tmp = manMat4.postMulVec4(matrix, &tmp);
+	manMat4.transformPoints(matrix, mesh->satMesh.verts, mesh->satMesh.verts, mesh->satMesh.vCount);
+	manMat4.transformDirections(matrix, mesh->satMesh.norms, mesh->satMesh.norms, mesh->satMesh.nCount);
+}
+
+static void transformSimpleMeshInto(ColliderSimpleMesh* dest, const ColliderSimpleMesh* src, Mat4* matrix) {
+	dest->satMesh.vCount = src->satMesh.vCount;
+	dest->satMesh.nCount = src->satMesh.nCount;
+	dest->minPointForAxis = src->minPointForAxis;
+	dest->maxPointForAxis = src->maxPointForAxis;
+	dest->satMesh.adjacencyStart = src->satMesh.adjacencyStart;
+	dest->satMesh.adjacency = src->satMesh.adjacency;
 
-		mesh->satMesh.verts[i].x = tmp.x;
-		mesh->satMesh.verts[i].y = tmp.y;
-		mesh->satMesh.verts[i].z = tmp.z;
+	manMat4.transformPoints(matrix, src->satMesh.verts, dest->satMesh.verts, src->satMesh.vCount);
+	manMat4.transformDirections(matrix, src->satMesh.norms, dest->satMesh.norms, src->satMesh.nCount);
+}
+
+typedef struct HullFace_s {
+	int a, b, c;
+	/** Outward unit normal, and the face's distance from the origin along it. **/
+	Vec3 normal;
+	scalar distance;
+} HullFace;
+
+typedef struct HullEdge_s {
+	int a, b;
+} HullEdge;
+
+/*
+ * Makes the face wound so its normal points away from inside, which must be within the hull.
+ */
+static bool makeHullFace(HullFace* face, Vec3* verts, Vec3* inside, int a, int b, int c) {
+	Vec3 ab = manVec3.sub(&verts[b], &verts[a]);
+	Vec3 ac = manVec3.sub(&verts[c], &verts[a]);
+	Vec3 normal = manVec3.cross(&ab, &ac);
+	scalar length = manVec3.magnitude(&normal);
+
+	if (length == 0)
+		return false;
+
+	face->normal = manVec3.postMulScalar(&normal, 1/length);
+	face->distance = manVec3.dot(&face->normal, &verts[a]);
+	face->a = a;
+	face->b = b;
+	face->c = c;
+
+	if (manVec3.dot(&face->normal, inside) > face->distance) {
+		face->normal = manVec3.invert(&face->normal);
+		face->distance = -face->distance;
+		face->b = c;
+		face->c = b;
 	}
 
-	for(int i = 0; i < mesh->satMesh.nCount; i++) {
-		Vec4 tmp = manVec4.createFromVec3(NULL, &mesh->satMesh.norms[i], 0);
-		tmp = manMat4.postMulVec4(matrix, &tmp);
+	return true;
+}
 
-		mesh->satMesh.norms[i].x = tmp.x;
-		mesh->satMesh.norms[i].y = tmp.y;
-		mesh->satMesh.norms[i].z = tmp.z;
+/*
+ * Adds the edge to the horizon, or removes it if the face on its other side was also removed.
+ */
+static void addHorizonEdge(DynamicArray* edges, int a, int b) {
+	for(int i = 0; i < edges->size; i++) {
+		HullEdge* edge = (HullEdge*)manDynamicArray.get(edges, i);
+		if (edge->a == b && edge->b == a) {
+			*edge = *(HullEdge*)manDynamicArray.get(edges, edges->size-1);
+			edges->size--;
+			return;
+		}
+	}
+
+	HullEdge edge = {a, b};
+	manDynamicArray.append(edges, &edge);
+}
+
+/*
+ * Picks four vertices spanning a tetrahedron with volume to start the hull from.
+ * @return false if the vertices are all within epsilon of a plane.
+ */
+static bool findStartTetrahedron(SATMesh* mesh, int* start, scalar* epsilon) {
+	Vec3* verts = mesh->verts;
+
+	start[0] = 0;
+	for(int i = 1; i < mesh->vCount; i++) {
+		if (verts[i].x < verts[start[0]].x)
+			start[0] = i;
 	}
+
+	scalar best = 0;
+	start[1] = start[0];
+	for(int i = 0; i < mesh->vCount; i++) {
+		Vec3 offset = manVec3.sub(&verts[i], &verts[start[0]]);
+		scalar distance = manVec3.dot(&offset, &offset);
+		if (distance > best) {
+			best = distance;
+			start[1] = i;
+		}
+	}
+
+	*epsilon = sqrt(best)*COLLISION_MESH_HULL_TOLERANCE;
+	if (best == 0)
+		return false;
+
+	Vec3 line = manVec3.sub(&verts[start[1]], &verts[start[0]]);
+	best = 0;
+	start[2] = start[0];
+	for(int i = 0; i < mesh->vCount; i++) {
+		Vec3 offset = manVec3.sub(&verts[i], &verts[start[0]]);
+		Vec3 area = manVec3.cross(&line, &offset);
+		scalar distance = manVec3.dot(&area, &area);
+		if (distance > best) {
+			best = distance;
+			start[2] = i;
+		}
+	}
+
+	if (sqrt(best)/manVec3.magnitude(&line) <= *epsilon)
+		return false;
+
+	Vec3 side = manVec3.sub(&verts[start[2]], &verts[start[0]]);
+	Vec3 normal = manVec3.cross(&line, &side);
+	normal = manVec3.normalize(&normal);
+	best = 0;
+	start[3] = start[0];
+	for(int i = 0; i < mesh->vCount; i++) {
+		Vec3 offset = manVec3.sub(&verts[i], &verts[start[0]]);
+		scalar distance = fabs(manVec3.dot(&normal, &offset));
+		if (distance > best) {
+			best = distance;
+			start[3] = i;
+		}
+	}
+
+	return best > *epsilon;
+}
+
+static void buildAdjacency(ColliderSimpleMesh* mesh) {
+	SATMesh* satMesh = &mesh->satMesh;
+	Vec3* verts = satMesh->verts;
+
+	free(satMesh->adjacencyStart);
+	free(satMesh->adjacency);
+	satMesh->adjacencyStart = NULL;
+	satMesh->adjacency = NULL;
+
+	int start[4];
+	scalar epsilon;
+	if (satMesh->vCount < 4 || !findStartTetrahedron(satMesh, start, &epsilon))
+		return;
+
+	Vec3 inside = manVec3.create(NULL, 0, 0, 0);
+	for(int i = 0; i < 4; i++)
+		inside = manVec3.sum(&inside, &verts[start[i]]);
+	inside = manVec3.postMulScalar(&inside, 0.25);
+
+	DynamicArray* faces = manDynamicArray.new(32, sizeof(HullFace));
+	DynamicArray* edges = manDynamicArray.new(16, sizeof(HullEdge));
+
+	static const int tetrahedron[4][3] = {{0, 1, 2}, {0, 3, 1}, {0, 2, 3}, {1, 3, 2}};
+	for(int f = 0; f < 4; f++) {
+		HullFace face;
+		if (makeHullFace(&face, verts, &inside, start[tetrahedron[f][0]], start[tetrahedron[f][1]], start[tetrahedron[f][2]]))
+			manDynamicArray.append(faces, &face);
+	}
+
+	//Add each vertex in turn, replacing the faces it can see with a fan from their horizon to it.
+	for(int v = 0; v < satMesh->vCount; v++) {
+		if (v == start[0] || v == start[1] || v == start[2] || v == start[3])
+			continue;
+
+		manDynamicArray.clear(edges);
+		for(int f = 0; f < faces->size; f++) {
+			HullFace* face = (HullFace*)manDynamicArray.get(faces, f);
+			if (manVec3.dot(&face->normal, &verts[v]) - face->distance > epsilon) {
+				addHorizonEdge(edges, face->a, face->b);
+				addHorizonEdge(edges, face->b, face->c);
+				addHorizonEdge(edges, face->c, face->a);
+				*face = *(HullFace*)manDynamicArray.get(faces, faces->size-1);
+				faces->size--;
+				f--;
+			}
+		}
+
+		for(int e = 0; e < edges->size; e++) {
+			HullEdge* edge = (HullEdge*)manDynamicArray.get(edges, e);
+			HullFace face;
+			if (makeHullFace(&face, verts, &inside, edge->a, edge->b, v))
+				manDynamicArray.append(faces, &face);
+		}
+	}
+
+	//Each edge is listed from both faces it borders, so take both directions and drop the repeats.
+	int* degree = calloc(satMesh->vCount+1, sizeof(int));
+	for(int f = 0; f < faces->size; f++) {
+		HullFace* face = (HullFace*)manDynamicArray.get(faces, f);
+		degree[face->a] += 2;
+		degree[face->b] += 2;
+		degree[face->c] += 2;
+	}
+
+	int* adjacencyStart = malloc(sizeof(int)*(satMesh->vCount+1));
+	adjacencyStart[0] = 0;
+	for(int v = 0; v < satMesh->vCount; v++)
+		adjacencyStart[v+1] = adjacencyStart[v] + degree[v];
+
+	int* adjacency = malloc(sizeof(int)*(adjacencyStart[satMesh->vCount] + 1));
+	for(int v = 0; v < satMesh->vCount; v++)
+		degree[v] = 0;
+
+	for(int f = 0; f < faces->size; f++) {
+		HullFace* face = (HullFace*)manDynamicArray.get(faces, f);
+		int corners[3] = {face->a, face->b, face->c};
+		for(int c = 0; c < 3; c++) {
+			int from = corners[c];
+			int to1 = corners[(c+1)%3];
+			int to2 = corners[(c+2)%3];
+			adjacency[adjacencyStart[from] + degree[from]++] = to1;
+			adjacency[adjacencyStart[from] + degree[from]++] = to2;
+		}
+	}
+
+	int count = 0;
+	for(int v = 0; v < satMesh->vCount; v++) {
+		int first = count;
+		for(int i = adjacencyStart[v]; i < adjacencyStart[v] + degree[v]; i++) {
+			bool repeat = false;
+			for(int j = first; j < count && !repeat; j++)
+				repeat = adjacency[j] == adjacency[i];
+
+			if (!repeat)
+				adjacency[count++] = adjacency[i];
+		}
+		adjacencyStart[v] = first;
+	}
+	adjacencyStart[satMesh->vCount] = count;
+
+	satMesh->adjacencyStart = adjacencyStart;
+	satMesh->adjacency = realloc(adjacency, sizeof(int)*(count + 1));
+
+	free(degree);
+	manDynamicArray.delete(faces);
+	manDynamicArray.delete(edges);
+	free(faces);
+	free(edges);
 }
 
 static void deleteSimpleMesh(ColliderSimpleMesh* mesh) {
 	free(mesh->satMesh.norms);
 	free(mesh->satMesh.verts);
+	free(mesh->satMesh.adjacencyStart);
+	free(mesh->satMesh.adjacency);
 	free(mesh->minPointForAxis);
 	free(mesh->maxPointForAxis);
 }
@@ -125,4 +367,4 @@ static void deleteColliderSphere(ColliderSphere* mesh) {
 }
 
 
-const CollisionMeshManager manColMesh = {newSimpleMesh, newColliderSphere, makeTransformationMatrix, transformSphere, copyMesh, transformSimpleMesh, deleteSimpleMesh, deleteColliderSphere};
+const CollisionMeshManager manColMesh = {newSimpleMesh, newColliderSphere, makeTransformationMatrix, transformSphere, copyMesh, transformSimpleMesh, transformSimpleMeshInto, buildAdjacency, deleteSimpleMesh, deleteColliderSphere};
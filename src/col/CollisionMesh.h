@@ -5,6 +5,9 @@
 #include "math/Mat4.h"
 #include "math/Vec3.h"
 
+/** How far, as a fraction of the mesh's size, a vertex must be outside the hull to be added to it. **/
+#define COLLISION_MESH_HULL_TOLERANCE 1e-5
+
 typedef SATSphere ColliderSphere;
 typedef struct ColliderSimpleMesh_s {
 	SATMesh satMesh;
@@ -20,6 +23,18 @@ typedef struct CollisionMeshManager_s {
 	void(* transformSphere)(SATSphere* sphere, Mat4* matrix, Vec3* vScale);
 	ColliderSimpleMesh(* copyMesh)(ColliderSimpleMesh* mesh);
 	void(* transformSimpleMesh)(ColliderSimpleMesh* mesh, Mat4* matrix);
+	/**
+	 * Transforms the vertices and normals of src into the buffers already held by dest,
+	 * which must have room for them. The min/max point caches and adjacency of dest are pointed at those of src,
+	 * as transforming does not change which vertex is extreme along which normal, or which vertices share an edge.
+	 */
+	void(* transformSimpleMeshInto)(ColliderSimpleMesh* dest, const ColliderSimpleMesh* src, Mat4* matrix);
+	/**
+	 * Builds the convex hull of the mesh's vertices and stores which vertices share its edges, so support
+	 * queries can walk the hull instead of trying every vertex. Vertices inside the hull get no neighbours.
+	 * Leaves the mesh without adjacency if its vertices are flat.
+	 */
+	void(* buildAdjacency)(ColliderSimpleMesh* mesh);
 
 	void(* deleteSimpleMesh)(ColliderSimpleMesh* mesh);
 	void(* deleteColliderSphere)(ColliderSphere* mesh);
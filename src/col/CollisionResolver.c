@@ -1,27 +1,55 @@
 #include "col/CollisionResolver.h"
 
+#include <math.h>
+#include <string.h>
+#include <stddef.h>
+
 static CollisionResolver* new() {
 	CollisionResolver* collisionResolver = malloc(sizeof(CollisionResolver));
 	collisionResolver->colliders = manDynamicArray.new(1, sizeof(PhysicsCollider*));
-	collisionResolver->collisionRecords = NULL;
-	collisionResolver->transformedColliders = NULL;
+	collisionResolver->collisionRecords = manDynamicArray.new(16, sizeof(CollisionRecord));
+	collisionResolver->transformedColliders = manDynamicArray.new(16, sizeof(TransformedCollider));
+	collisionResolver->colliderStates = manDynamicArray.new(16, sizeof(ColliderState));
+	collisionResolver->staleTransforms = false;
+	collisionResolver->defaultBroadphase = manBroadphase.newBruteForce();
+	collisionResolver->broadphase = collisionResolver->defaultBroadphase;
+	collisionResolver->bounds = manDynamicArray.new(16, sizeof(ColliderSphere));
+	collisionResolver->resting = manDynamicArray.new(16, sizeof(bool));
+	collisionResolver->pairs = manDynamicArray.new(16, sizeof(BroadphasePair));
+	collisionResolver->contactPairs = manDynamicArray.new(16, sizeof(ContactPair));
+	collisionResolver->lastContactPairs = manDynamicArray.new(16, sizeof(ContactPair));
+	collisionResolver->jobSystem = NULL;
+	collisionResolver->meshQueue = manDynamicArray.new(16, sizeof(int));
+	collisionResolver->threadRecords = NULL;
+	collisionResolver->threadRecordsCount = 0;
+	collisionResolver->sleepEnabled = false;
+	collisionResolver->islands = manDynamicArray.new(16, sizeof(ContactIsland));
+	collisionResolver->solverSettings.velocityIterations = COLLISION_RESOLVER_VELOCITY_ITERATIONS;
+	collisionResolver->solverSettings.positionIterations = COLLISION_RESOLVER_POSITION_ITERATIONS;
+	collisionResolver->solverSettings.restitution = 1;
+	collisionResolver->solverSettings.friction = 0;
+	collisionResolver->constraints = manDynamicArray.new(16, sizeof(ContactConstraint));
+	collisionResolver->corrections = manDynamicArray.new(16, sizeof(Vec3));
+	collisionResolver->velocityIterationsUsed = 0;
+	collisionResolver->positionIterationsUsed = 0;
 	return collisionResolver;
 }
 
 static void resetTransformMesh(TransformedCollider* tCol) {
-	if (tCol->collider.nPhase.satMesh.verts != NULL) {
-		free(tCol->collider.nPhase.maxPointForAxis);
-		free(tCol->collider.nPhase.minPointForAxis);
-		free(tCol->collider.nPhase.satMesh.norms);
-		free(tCol->collider.nPhase.satMesh.verts);
-
-		tCol->collider.nPhase.maxPointForAxis = NULL;
-		tCol->collider.nPhase.minPointForAxis = NULL;
-		tCol->collider.nPhase.satMesh.norms = NULL;
-		tCol->collider.nPhase.satMesh.verts = NULL;
-		tCol->collider.nPhase.satMesh.vCount = 0;
-		tCol->collider.nPhase.satMesh.nCount = 0;
-	}
+	free(tCol->collider.nPhase.satMesh.norms);
+	free(tCol->collider.nPhase.satMesh.verts);
+
+	//The min/max point caches and adjacency belong to the original collider.
+	tCol->collider.nPhase.maxPointForAxis = NULL;
+	tCol->collider.nPhase.minPointForAxis = NULL;
+	tCol->collider.nPhase.satMesh.adjacencyStart = NULL;
+	tCol->collider.nPhase.satMesh.adjacency = NULL;
+	tCol->collider.nPhase.satMesh.norms = NULL;
+	tCol->collider.nPhase.satMesh.verts = NULL;
+	tCol->collider.nPhase.satMesh.vCount = 0;
+	tCol->collider.nPhase.satMesh.nCount = 0;
+	tCol->vertCapacity = 0;
+	tCol->normCapacity = 0;
 }
 
 static void delete(CollisionResolver* collisionResolver) {
@@ -34,164 +62,936 @@ static void delete(CollisionResolver* collisionResolver) {
 	}
 	manDynamicArray.delete(collisionResolver->transformedColliders);
 	free(collisionResolver->transformedColliders);
+	manDynamicArray.delete(collisionResolver->colliderStates);
+	free(collisionResolver->colliderStates);
 
 	manDynamicArray.delete(collisionResolver->collisionRecords);
 	free(collisionResolver->collisionRecords);
+
+	manBroadphase.delete(collisionResolver->defaultBroadphase);
+	free(collisionResolver->defaultBroadphase);
+
+	manDynamicArray.delete(collisionResolver->bounds);
+	free(collisionResolver->bounds);
+	manDynamicArray.delete(collisionResolver->resting);
+	free(collisionResolver->resting);
+	manDynamicArray.delete(collisionResolver->pairs);
+	free(collisionResolver->pairs);
+	manDynamicArray.delete(collisionResolver->contactPairs);
+	free(collisionResolver->contactPairs);
+	manDynamicArray.delete(collisionResolver->lastContactPairs);
+	free(collisionResolver->lastContactPairs);
+
+	manDynamicArray.delete(collisionResolver->meshQueue);
+	free(collisionResolver->meshQueue);
+	for(int i = 0; i < collisionResolver->threadRecordsCount; i++) {
+		manDynamicArray.delete(collisionResolver->threadRecords[i]);
+		free(collisionResolver->threadRecords[i]);
+	}
+	free(collisionResolver->threadRecords);
+
+	manDynamicArray.delete(collisionResolver->islands);
+	free(collisionResolver->islands);
+
+	manDynamicArray.delete(collisionResolver->constraints);
+	free(collisionResolver->constraints);
+	manDynamicArray.delete(collisionResolver->corrections);
+	free(collisionResolver->corrections);
 }
 
-static void addCollider(CollisionResolver* collisionResolver, PhysicsCollider* collider) {
+static int addCollider(CollisionResolver* collisionResolver, PhysicsCollider* collider) {
 	if (collider!=NULL) {
 		manDynamicArray.append(collisionResolver->colliders, &collider);
+		return collisionResolver->colliders->size - 1;
 	}
+
+	return -1;
 }
 
-static void reset(CollisionResolver* collisionResolver) {
-	if (collisionResolver->transformedColliders!=NULL) {
-		for(int i = 0; i < collisionResolver->transformedColliders->size; i++) {
-			TransformedCollider* tCol = ((TransformedCollider*)manDynamicArray.get(collisionResolver->transformedColliders, i));
-			resetTransformMesh(tCol);
-		}
-		manDynamicArray.delete(collisionResolver->transformedColliders);
-		free(collisionResolver->transformedColliders);
-	}
-	collisionResolver->transformedColliders = manDynamicArray.new(collisionResolver->colliders->size, sizeof(TransformedCollider));
+static void setBroadphase(CollisionResolver* collisionResolver, Broadphase* broadphase) {
+	if (broadphase != NULL)
+		collisionResolver->broadphase = broadphase;
+	else
+		collisionResolver->broadphase = collisionResolver->defaultBroadphase;
 
-	for(int i = 0; i < collisionResolver->colliders->size; i++) {
-		PhysicsCollider* collider = *(PhysicsCollider**)manDynamicArray.get(collisionResolver->colliders, i);
+	collisionResolver->broadphase->jobSystem = collisionResolver->jobSystem;
+}
+
+static void setJobSystem(CollisionResolver* collisionResolver, JobSystem* jobs) {
+	collisionResolver->jobSystem = jobs;
+	collisionResolver->defaultBroadphase->jobSystem = jobs;
+	collisionResolver->broadphase->jobSystem = jobs;
+}
+
+static void setSolverSettings(CollisionResolver* collisionResolver, ContactSolverSettings* settings) {
+	collisionResolver->solverSettings = *settings;
+}
+
+static void reset(CollisionResolver* collisionResolver) {
+	//Only colliders added since the last reset need a new cache entry.
+	for(int i = collisionResolver->transformedColliders->size; i < collisionResolver->colliders->size; i++) {
 		TransformedCollider tCollider;
 
-		PhysicsCollider* transformedCollider = manPhysCollider.new(collider->position, collider->rotation, collider->scale, collider->velocity, collider->inverseMass);
-		tCollider.collider = *transformedCollider;
 		tCollider.collider.nPhase.maxPointForAxis = NULL;
 		tCollider.collider.nPhase.minPointForAxis = NULL;
+		tCollider.collider.nPhase.satMesh.adjacencyStart = NULL;
+		tCollider.collider.nPhase.satMesh.adjacency = NULL;
 		tCollider.collider.nPhase.satMesh.norms = NULL;
 		tCollider.collider.nPhase.satMesh.verts = NULL;
 		tCollider.collider.nPhase.satMesh.nCount = 0;
 		tCollider.collider.nPhase.satMesh.vCount = 0;
 		tCollider.hasMeshTransformed = false;
-
-		free(transformedCollider);
+		tCollider.vertCapacity = 0;
+		tCollider.normCapacity = 0;
+		tCollider.timeOfImpact = 1;
+
+		//Zeroed first, so the padding snapshots copy is always the same.
+		ColliderState state;
+		memset(&state, 0, sizeof(ColliderState));
+		state.hasTransform = false;
+		state.stillTime = 0;
+		state.sleepNext = -1;
+		state.sweep = manVec3.create(NULL, 0, 0, 0);
+		state.sweepStart = state.sweep;
 
 		manDynamicArray.append(collisionResolver->transformedColliders, &tCollider);
+		manDynamicArray.append(collisionResolver->colliderStates, &state);
+	}
+
+	for(int i = 0; i < collisionResolver->colliders->size; i++) {
+		PhysicsCollider* collider = *(PhysicsCollider**)manDynamicArray.get(collisionResolver->colliders, i);
+		TransformedCollider* tCol = (TransformedCollider*)manDynamicArray.get(collisionResolver->transformedColliders, i);
+
+		tCol->collider.position = collider->position;
+		tCol->collider.rotation = collider->rotation;
+		tCol->collider.scale = collider->scale;
+		tCol->collider.velocity = collider->velocity;
+		tCol->collider.inverseMass = collider->inverseMass;
 	}
 }
 
-static void prepare(CollisionResolver* collisionResolver) {
-	if (collisionResolver->collisionRecords!=NULL) {
-			manDynamicArray.delete(collisionResolver->collisionRecords);
-			free(collisionResolver->collisionRecords);
+static bool vec3Equals(const Vec3* v1, const Vec3* v2) {
+	return (v1->x == v2->x) && (v1->y == v2->y) && (v1->z == v2->z);
+}
+
+static bool hasMoved(ColliderState* state, PhysicsCollider* col) {
+	return !state->hasTransform ||
+	       !vec3Equals(&state->lastPosition, col->position) ||
+	       !vec3Equals(&state->lastRotation, col->rotation) ||
+	       !vec3Equals(&state->lastScale, col->scale) ||
+	       !vec3Equals(&state->lastBPhase.center, &col->bPhase.center) ||
+	       (state->lastBPhase.radius != col->bPhase.radius);
+}
+
+/*
+ * Transforms the broadphase collider if it has moved since it was last transformed, or if stale.
+ */
+static void updateTransform(TransformedCollider* tCol, ColliderState* state, PhysicsCollider* col, bool stale) {
+	if (stale || hasMoved(state, col)) {
+		tCol->transform = manColMesh.makeTransformationMatrix(col->position, col->rotation, col->scale);
+		tCol->collider.bPhase = col->bPhase;
+		manColMesh.transformSphere(&tCol->collider.bPhase, &tCol->transform, col->scale);
+
+		state->lastPosition = *col->position;
+		state->lastRotation = *col->rotation;
+		state->lastScale = *col->scale;
+		state->lastBPhase = col->bPhase;
+		state->hasTransform = true;
+		tCol->hasMeshTransformed = false;
 	}
-	collisionResolver->collisionRecords = manDynamicArray.new(1, sizeof(CollisionRecord));
+}
+
+/*
+ * Transforms the broadphase colliders in [start, end) that have moved since they were last transformed.
+ * Sleeping colliders haven't, or they would have been woken, so they keep what they had and aren't read.
+ * Each collider only touches its own cache entry, so ranges can run in parallel.
+ */
+static void prepareRange(void* data, int start, int end, int threadIndex) {
+	CollisionResolver* collisionResolver = (CollisionResolver*)data;
+
+	for(int i = start; i < end; i++) {
+		ColliderState* state = (ColliderState*)manDynamicArray.get(collisionResolver->colliderStates, i);
+		if (state->sleepNext >= 0 && !collisionResolver->staleTransforms)
+			continue;
 
-	//Transform all broadphase colliders.
-	for(int i = 0; i < collisionResolver->transformedColliders->size; i++) {
 		TransformedCollider* tCol = ((TransformedCollider*)manDynamicArray.get(collisionResolver->transformedColliders, i));
 		PhysicsCollider* col = *(PhysicsCollider**)manDynamicArray.get(collisionResolver->colliders, i);
 
-		Mat4 transformationMatrix = manColMesh.makeTransformationMatrix(col->position, col->rotation, col->scale);
-		tCol->collider.bPhase = col->bPhase;
 		tCol->collider.immovable = col->immovable;
+		tCol->collider.continuous = col->continuous;
+		tCol->collider.narrowphase = col->narrowphase;
+
+		if (state->hasTransform)
+			state->sweep = manVec3.sub(col->position, &state->sweepStart);
+		else
+			state->sweep = manVec3.create(NULL, 0, 0, 0);
+		state->sweepStart = *col->position;
+		tCol->timeOfImpact = 1;
 
-		manColMesh.transformSphere(&tCol->collider.bPhase, &transformationMatrix, col->scale);
+		updateTransform(tCol, state, col, collisionResolver->staleTransforms);
 	}
 }
 
-static void transformMesh(TransformedCollider* dest, PhysicsCollider* orginal) {
-	dest->collider.nPhase = manColMesh.copyMesh(&orginal->nPhase);
-	Mat4 transformationMatrix = manColMesh.makeTransformationMatrix(orginal->position, orginal->rotation, orginal->scale);
-	manColMesh.transformSimpleMesh(&dest->collider.nPhase, &transformationMatrix);
+static PhysicsCollider* getCollider(CollisionResolver* collisionResolver, int i) {
+	return *(PhysicsCollider**)manDynamicArray.get(collisionResolver->colliders, i);
 }
 
-static bool check(CollisionResolver* collisionResolver) {
-	bool flag = false;
-	//Do collision checks
+static TransformedCollider* getTransformed(CollisionResolver* collisionResolver, int i) {
+	return (TransformedCollider*)manDynamicArray.get(collisionResolver->transformedColliders, i);
+}
+
+static ColliderState* getState(CollisionResolver* collisionResolver, int i) {
+	return (ColliderState*)manDynamicArray.get(collisionResolver->colliderStates, i);
+}
+
+static void wake(CollisionResolver* collisionResolver, int collider) {
+	//Colliders added since the last reset have no cache entry yet, and can't be asleep.
+	if (collider >= collisionResolver->transformedColliders->size)
+		return;
+
+	ColliderState* state = getState(collisionResolver, collider);
+	state->stillTime = 0;
+
+	if (!getCollider(collisionResolver, collider)->sleeping)
+		return;
+
+	//Walk the island's circular list, unlinking as we go.
+	int i = collider;
+	do {
+		state = getState(collisionResolver, i);
+		int next = state->sleepNext;
+
+		getCollider(collisionResolver, i)->sleeping = false;
+		state->stillTime = 0;
+		state->sleepNext = -1;
+
+		i = next;
+	} while(i >= 0 && i != collider);
+}
+
+static void setSleepEnabled(CollisionResolver* collisionResolver, bool enabled) {
+	collisionResolver->sleepEnabled = enabled;
+
+	if (!enabled) {
+		for(int i = 0; i < collisionResolver->transformedColliders->size; i++)
+			wake(collisionResolver, i);
+	}
+}
+
+static void prepare(CollisionResolver* collisionResolver) {
+	manDynamicArray.clear(collisionResolver->collisionRecords);
+	manDynamicArray.clear(collisionResolver->bounds);
+	manDynamicArray.clear(collisionResolver->resting);
+
+	//Something other than the physics moved a sleeping collider, so its island may no longer be at rest.
+	if (collisionResolver->sleepEnabled) {
+		for(int i = 0; i < collisionResolver->transformedColliders->size; i++) {
+			if (getState(collisionResolver, i)->sleepNext >= 0 && hasMoved(getState(collisionResolver, i), getCollider(collisionResolver, i)))
+				wake(collisionResolver, i);
+		}
+	}
+
+	manJobSystem.parallelFor(collisionResolver->jobSystem, collisionResolver->transformedColliders->size, COLLISION_RESOLVER_PREPARE_CHUNK, prepareRange, collisionResolver);
+	collisionResolver->staleTransforms = false;
+
 	for(int i = 0; i < collisionResolver->transformedColliders->size; i++) {
-		TransformedCollider* collider1 = (TransformedCollider*)manDynamicArray.get(collisionResolver->transformedColliders, i);
-
-		//Compare against remaining objects
-		for(int j = i+1; j < collisionResolver->transformedColliders->size; j++) {
-			TransformedCollider* collider2 = (TransformedCollider*)manDynamicArray.get(collisionResolver->transformedColliders, j);
-
-			if (manColDetection.checkStaticBroadphase(&collider1->collider.bPhase, &collider2->collider.bPhase)) {
-				//Transform mesh if it needs to be.
-				if (!collider1->hasMeshTransformed) {
-					PhysicsCollider* orginal = *(PhysicsCollider**)manDynamicArray.get(collisionResolver->colliders, i);
-					resetTransformMesh(collider1);
-					transformMesh(collider1, orginal);
-					collider1->hasMeshTransformed = true;
-				}
+		TransformedCollider* tCol = ((TransformedCollider*)manDynamicArray.get(collisionResolver->transformedColliders, i));
+		ColliderSphere bounds = tCol->collider.bPhase;
 
-				//Transform mesh if it needs to be.
-				if (!collider2->hasMeshTransformed) {
-					PhysicsCollider* orginal = *(PhysicsCollider**)manDynamicArray.get(collisionResolver->colliders, j);
-					resetTransformMesh(collider2);
-					transformMesh(collider2, orginal);
-					collider2->hasMeshTransformed = true;
-				}
+		//Continuous colliders are bounded over their whole sweep, so the broadphase finds anything they passed.
+		if (tCol->collider.continuous) {
+			Vec3 halfSweep = manVec3.preMulScalar(0.5, &getState(collisionResolver, i)->sweep);
+			bounds.center = manVec3.sub(&bounds.center, &halfSweep);
+			bounds.radius += manVec3.magnitude(&halfSweep);
+		}
+
+		manDynamicArray.append(collisionResolver->bounds, &bounds);
+
+		bool resting = getState(collisionResolver, i)->sleepNext >= 0 || tCol->collider.immovable;
+		manDynamicArray.append(collisionResolver->resting, &resting);
+	}
+}
+
+static void transformMesh(TransformedCollider* dest, PhysicsCollider* orginal) {
+	//Buffers only grow, so once every mesh has been seen this does not allocate.
+	if (orginal->nPhase.satMesh.vCount > dest->vertCapacity) {
+		dest->vertCapacity = orginal->nPhase.satMesh.vCount;
+		dest->collider.nPhase.satMesh.verts = realloc(dest->collider.nPhase.satMesh.verts, sizeof(Vec3)*dest->vertCapacity);
+	}
+
+	if (orginal->nPhase.satMesh.nCount > dest->normCapacity) {
+		dest->normCapacity = orginal->nPhase.satMesh.nCount;
+		dest->collider.nPhase.satMesh.norms = realloc(dest->collider.nPhase.satMesh.norms, sizeof(Vec3)*dest->normCapacity);
+	}
+
+	manColMesh.transformSimpleMeshInto(&dest->collider.nPhase, &orginal->nPhase, &dest->transform);
+}
+
+/*
+ * Queues the collider's mesh to be transformed if it isn't already, so each mesh
+ * is transformed once, up front, and the narrowphase only reads them.
+ */
+static void queueMeshIfNeeded(CollisionResolver* collisionResolver, TransformedCollider* collider, int id) {
+	if (!collider->hasMeshTransformed) {
+		collider->hasMeshTransformed = true;
+		manDynamicArray.append(collisionResolver->meshQueue, &id);
+	}
+}
+
+static void transformMeshRange(void* data, int start, int end, int threadIndex) {
+	CollisionResolver* collisionResolver = (CollisionResolver*)data;
+
+	for(int i = start; i < end; i++) {
+		int id = *(int*)manDynamicArray.get(collisionResolver->meshQueue, i);
+		TransformedCollider* collider = (TransformedCollider*)manDynamicArray.get(collisionResolver->transformedColliders, id);
+		PhysicsCollider* orginal = *(PhysicsCollider**)manDynamicArray.get(collisionResolver->colliders, id);
+		transformMesh(collider, orginal);
+	}
+}
+
+static CollisionResult staticNarrowphase(TransformedCollider* collider1, TransformedCollider* collider2, ContactPair* contact) {
+	if (collider1->collider.narrowphase == COL_NARROWPHASE_GJK || collider2->collider.narrowphase == COL_NARROWPHASE_GJK)
+		return manColDetection.checkGJKNarrowphaseFrom(&collider1->collider.nPhase, &collider2->collider.nPhase, &contact->vertex1, &contact->vertex2);
+
+	return manColDetection.checkStaticNarrowphaseFrom(&collider1->collider.nPhase, &collider2->collider.nPhase, &contact->vertex1, &contact->vertex2);
+}
+
+/*
+ * Whether the pair's last result still holds, because neither collider has moved relative to the other
+ * since it was found. Continuous colliders are always checked, as their result depends on their sweeps too.
+ */
+static bool canReuse(ContactPair* contact, TransformedCollider* collider1, TransformedCollider* collider2) {
+	if (!contact->hasResult || collider1->collider.continuous || collider2->collider.continuous)
+		return false;
+
+	Vec3 offset = manVec3.sub(collider2->collider.position, collider1->collider.position);
+	return vec3Equals(&contact->offset, &offset) &&
+	       vec3Equals(&contact->rotation1, collider1->collider.rotation) &&
+	       vec3Equals(&contact->rotation2, collider2->collider.rotation) &&
+	       vec3Equals(&contact->scale1, collider1->collider.scale) &&
+	       vec3Equals(&contact->scale2, collider2->collider.scale);
+}
+
+/*
+ * Builds this tick's contact pairs from the pairs, carrying on last tick's entry for each pair
+ * found then too. Both are sorted by collider, so one walk through each finds every match.
+ */
+static void updateContactPairs(CollisionResolver* collisionResolver) {
+	DynamicArray* last = collisionResolver->contactPairs;
+	collisionResolver->contactPairs = collisionResolver->lastContactPairs;
+	collisionResolver->lastContactPairs = last;
+	manDynamicArray.clear(collisionResolver->contactPairs);
+
+	int l = 0;
+	for(int p = 0; p < collisionResolver->pairs->size; p++) {
+		BroadphasePair* pair = (BroadphasePair*)manDynamicArray.get(collisionResolver->pairs, p);
+		ContactPair* previous = NULL;
+
+		while(l < last->size) {
+			previous = (ContactPair*)manDynamicArray.get(last, l);
+			if (previous->collider1 > pair->collider1 || (previous->collider1 == pair->collider1 && previous->collider2 >= pair->collider2))
+				break;
+			l++;
+		}
+
+		ContactPair contact;
+		if (l < last->size && previous->collider1 == pair->collider1 && previous->collider2 == pair->collider2) {
+			contact = *previous;
+		} else {
+			contact.collider1 = pair->collider1;
+			contact.collider2 = pair->collider2;
+			contact.hasResult = false;
+			contact.manifold.count = 0;
+			contact.vertex1 = 0;
+			contact.vertex2 = 0;
+		}
 
-				CollisionResult result = manColDetection.checkStaticNarrowphase(&collider1->collider.nPhase, &collider2->collider.nPhase);
-				if (result.isColliding) {
-					CollisionRecord record;
-					record.collider1 = i;
-					record.collider2 = j;
-					record.collisionInfo = result;
-					manDynamicArray.append(collisionResolver->collisionRecords, &record);
-					flag = true;
+		contact.reused = canReuse(&contact, getTransformed(collisionResolver, pair->collider1), getTransformed(collisionResolver, pair->collider2));
+		manDynamicArray.append(collisionResolver->contactPairs, &contact);
+	}
+}
+
+/*
+ * Stores what the narrowphase found for the pair, building its manifold and carrying on the impulses
+ * of last tick's manifold.
+ */
+static void updateContact(ContactPair* contact, TransformedCollider* collider1, TransformedCollider* collider2, CollisionResult* result, scalar timeOfImpact) {
+	ContactManifold previous = contact->manifold;
+	Vec3 moved = manVec3.create(NULL, 0, 0, 0);
+	if (contact->hasResult)
+		moved = manVec3.sub(collider1->collider.position, &contact->position1);
+	else
+		previous.count = 0;
+
+	contact->result = *result;
+	contact->manifold.count = 0;
+	if (result->isColliding && timeOfImpact == 1) {
+		manContactManifold.generate(&contact->manifold, &collider1->collider.nPhase.satMesh, &collider2->collider.nPhase.satMesh, &result->axis, &contact->vertex1, &contact->vertex2);
+		manContactManifold.translate(&previous, &moved);
+		manContactManifold.warmStart(&contact->manifold, &previous);
+	} else if (result->isColliding) {
+		contact->manifold.normal = result->axis;
+		contact->manifold.depth = result->distance;
+	}
+
+	contact->hasResult = true;
+	contact->position1 = *collider1->collider.position;
+	contact->offset = manVec3.sub(collider2->collider.position, collider1->collider.position);
+	contact->rotation1 = *collider1->collider.rotation;
+	contact->rotation2 = *collider2->collider.rotation;
+	contact->scale1 = *collider1->collider.scale;
+	contact->scale2 = *collider2->collider.scale;
+}
+
+static void narrowphase(CollisionResolver* collisionResolver, int start, int end, DynamicArray* records) {
+	for(int p = start; p < end; p++) {
+		BroadphasePair* pair = (BroadphasePair*)manDynamicArray.get(collisionResolver->pairs, p);
+		ContactPair* contact = (ContactPair*)manDynamicArray.get(collisionResolver->contactPairs, p);
+		TransformedCollider* collider1 = (TransformedCollider*)manDynamicArray.get(collisionResolver->transformedColliders, pair->collider1);
+		TransformedCollider* collider2 = (TransformedCollider*)manDynamicArray.get(collisionResolver->transformedColliders, pair->collider2);
+
+		CollisionResult result;
+		scalar timeOfImpact = 1;
+
+		if (contact->reused) {
+			//Both moved together, so the manifold only needs to follow them.
+			Vec3 moved = manVec3.sub(collider1->collider.position, &contact->position1);
+			manContactManifold.translate(&contact->manifold, &moved);
+			contact->position1 = *collider1->collider.position;
+			result = contact->result;
+		} else {
+			if (collider1->collider.continuous || collider2->collider.continuous) {
+				//Sweep first, as a fast collider can end up past, or deep inside, what it hit.
+				result.isColliding = false;
+				Vec3* sweep1 = &getState(collisionResolver, pair->collider1)->sweep;
+				Vec3* sweep2 = &getState(collisionResolver, pair->collider2)->sweep;
+				if (manColDetection.checkSweptBroadphase(&collider1->collider.bPhase, sweep1, &collider2->collider.bPhase, sweep2))
+					result = manColDetection.checkSweptNarrowphaseFrom(&collider1->collider.nPhase, sweep1, &collider2->collider.nPhase, sweep2, &timeOfImpact, &contact->vertex1, &contact->vertex2);
+
+				//Already overlapping at the start of the tick, there's no time of impact to go back to.
+				if (!result.isColliding || timeOfImpact == 0) {
+					result = staticNarrowphase(collider1, collider2, contact);
+					timeOfImpact = 1;
 				}
+			} else {
+				result = staticNarrowphase(collider1, collider2, contact);
 			}
 
+			updateContact(contact, collider1, collider2, &result, timeOfImpact);
+		}
+
+		if (result.isColliding) {
+			CollisionRecord record;
+			record.collider1 = pair->collider1;
+			record.collider2 = pair->collider2;
+			record.collisionInfo = result;
+			record.timeOfImpact = timeOfImpact;
+			record.pair = p;
+			manDynamicArray.append(records, &record);
+		}
+	}
+}
+
+static void narrowphaseRange(void* data, int start, int end, int threadIndex) {
+	CollisionResolver* collisionResolver = (CollisionResolver*)data;
+	narrowphase(collisionResolver, start, end, collisionResolver->threadRecords[threadIndex]);
+}
+
+static int compareRecords(const void* r1, const void* r2) {
+	const CollisionRecord* record1 = (const CollisionRecord*)r1;
+	const CollisionRecord* record2 = (const CollisionRecord*)r2;
+
+	if (record1->collider1 != record2->collider1)
+		return record1->collider1 < record2->collider1 ? -1 : 1;
+
+	if (record1->collider2 != record2->collider2)
+		return record1->collider2 < record2->collider2 ? -1 : 1;
+
+	return 0;
+}
+
+/*
+ * Runs the narrowphase with each thread appending to its own buffer, then merges the
+ * buffers back into pair order, which is the order the serial narrowphase records in.
+ */
+static void narrowphaseParallel(CollisionResolver* collisionResolver, int threadCount) {
+	if (threadCount > collisionResolver->threadRecordsCount) {
+		collisionResolver->threadRecords = realloc(collisionResolver->threadRecords, sizeof(DynamicArray*)*threadCount);
+		for(int i = collisionResolver->threadRecordsCount; i < threadCount; i++)
+			collisionResolver->threadRecords[i] = manDynamicArray.new(16, sizeof(CollisionRecord));
+		collisionResolver->threadRecordsCount = threadCount;
+	}
+
+	for(int i = 0; i < collisionResolver->threadRecordsCount; i++)
+		manDynamicArray.clear(collisionResolver->threadRecords[i]);
+
+	manJobSystem.parallelFor(collisionResolver->jobSystem, collisionResolver->pairs->size, COLLISION_RESOLVER_NARROWPHASE_CHUNK, narrowphaseRange, collisionResolver);
+
+	for(int i = 0; i < collisionResolver->threadRecordsCount; i++) {
+		DynamicArray* records = collisionResolver->threadRecords[i];
+		for(int r = 0; r < records->size; r++)
+			manDynamicArray.append(collisionResolver->collisionRecords, manDynamicArray.get(records, r));
+	}
+
+	//Pairs are unique and sorted, so sorting by collider puts the records back in pair order.
+	qsort(collisionResolver->collisionRecords->contents, collisionResolver->collisionRecords->size, sizeof(CollisionRecord), compareRecords);
+}
+
+static bool check(CollisionResolver* collisionResolver) {
+	//Find candidate pairs, in the same order the all-pairs loop visits them. Nothing moves a pair where
+	//neither collider can move, so with sleep enabled the broadphase leaves those out.
+	Broadphase* broadphase = collisionResolver->broadphase;
+	broadphase->resting = collisionResolver->sleepEnabled ? (const bool*)collisionResolver->resting->contents : NULL;
+	broadphase->findPairs(broadphase, (ColliderSphere*)collisionResolver->bounds->contents, collisionResolver->bounds->size, collisionResolver->pairs);
+	manBroadphase.sortPairs(collisionResolver->pairs);
+
+	updateContactPairs(collisionResolver);
+
+	//Transform the meshes of every collider in a pair before any narrowphase runs, so the narrowphase never writes to shared colliders.
+	manDynamicArray.clear(collisionResolver->meshQueue);
+	for(int p = 0; p < collisionResolver->pairs->size; p++) {
+		BroadphasePair* pair = (BroadphasePair*)manDynamicArray.get(collisionResolver->pairs, p);
+		if (((ContactPair*)manDynamicArray.get(collisionResolver->contactPairs, p))->reused)
+			continue;
+
+		queueMeshIfNeeded(collisionResolver, (TransformedCollider*)manDynamicArray.get(collisionResolver->transformedColliders, pair->collider1), pair->collider1);
+		queueMeshIfNeeded(collisionResolver, (TransformedCollider*)manDynamicArray.get(collisionResolver->transformedColliders, pair->collider2), pair->collider2);
+	}
+	manJobSystem.parallelFor(collisionResolver->jobSystem, collisionResolver->meshQueue->size, COLLISION_RESOLVER_MESH_CHUNK, transformMeshRange, collisionResolver);
+
+	//Do collision checks
+	int threadCount = manJobSystem.getThreadCount(collisionResolver->jobSystem);
+	if (threadCount > 1 && collisionResolver->pairs->size > COLLISION_RESOLVER_NARROWPHASE_CHUNK)
+		narrowphaseParallel(collisionResolver, threadCount);
+	else
+		narrowphase(collisionResolver, 0, collisionResolver->pairs->size, collisionResolver->collisionRecords);
+
+	//A moving collider touched a sleeping one, so wake its island before the collision is resolved.
+	if (collisionResolver->sleepEnabled) {
+		for(int r = 0; r < collisionResolver->collisionRecords->size; r++) {
+			CollisionRecord* record = (CollisionRecord*)manDynamicArray.get(collisionResolver->collisionRecords, r);
+			if (getCollider(collisionResolver, record->collider1)->sleeping)
+				wake(collisionResolver, record->collider1);
+			if (getCollider(collisionResolver, record->collider2)->sleeping)
+				wake(collisionResolver, record->collider2);
+		}
+	}
+
+	return collisionResolver->collisionRecords->size > 0;
+}
+
+/*
+ * Moves colliders that hit something part way through the tick back to where they first touched it,
+ * the earliest time of impact of each is used if it hit more than one thing.
+ */
+static void rewindToImpacts(CollisionResolver* collisionResolver) {
+	DynamicArray* records = collisionResolver->collisionRecords;
+
+	for(int i = 0; i < records->size; i++) {
+		CollisionRecord* cr = (CollisionRecord*)manDynamicArray.get(records, i);
+		if (cr->timeOfImpact < 1) {
+			TransformedCollider* collider1 = getTransformed(collisionResolver, cr->collider1);
+			TransformedCollider* collider2 = getTransformed(collisionResolver, cr->collider2);
+			collider1->timeOfImpact = fminf(collider1->timeOfImpact, cr->timeOfImpact);
+			collider2->timeOfImpact = fminf(collider2->timeOfImpact, cr->timeOfImpact);
+		}
+	}
+
+	for(int i = 0; i < records->size; i++) {
+		CollisionRecord* cr = (CollisionRecord*)manDynamicArray.get(records, i);
+		if (cr->timeOfImpact == 1)
+			continue;
+
+		int ids[2] = {cr->collider1, cr->collider2};
+		for(int c = 0; c < 2; c++) {
+			TransformedCollider* tCol = getTransformed(collisionResolver, ids[c]);
+			ColliderState* state = getState(collisionResolver, ids[c]);
+			if (tCol->timeOfImpact < 1 && !tCol->collider.immovable) {
+				Vec3 back = manVec3.preMulScalar(1 - tCol->timeOfImpact, &state->sweep);
+				*tCol->collider.position = manVec3.sub(tCol->collider.position, &back);
+				state->sweepStart = *tCol->collider.position;
+				tCol->hasMeshTransformed = false;
+			}
+			tCol->timeOfImpact = 1;
 		}
 	}
+}
 
-	return flag;
+static scalar getInverseMass(TransformedCollider* tCol) {
+	return tCol->collider.immovable ? 0 : *tCol->collider.inverseMass;
 }
 
-void momentumCollisionResponse(Vec3* out1, Vec3* out2, Vec3 vel1, Vec3 vel2, scalar mass1, scalar mass2, bool immovable1, bool immovable2) {
-	scalar v1LeftM = (mass1 - mass2)/(mass1 + mass2);
-	scalar v1RightM = (2*mass2)/(mass1 + mass2);
-	Vec3 v1Left = manVec3.preMulScalar(v1LeftM, &vel1);
-	Vec3 v1Right = manVec3.preMulScalar(v1RightM, &vel2);
-	if (!immovable1)
-		*out1 = manVec3.sum(&v1Left, &v1Right);
+/*
+ * Adds a constraint for each point of the record's manifold, and applies the impulses
+ * the points had last tick to start from.
+ */
+static void addConstraints(CollisionResolver* collisionResolver, CollisionRecord* record) {
+	TransformedCollider* collider1 = getTransformed(collisionResolver, record->collider1);
+	TransformedCollider* collider2 = getTransformed(collisionResolver, record->collider2);
+	scalar inverseMass1 = getInverseMass(collider1);
+	scalar inverseMass2 = getInverseMass(collider2);
+	if (inverseMass1 + inverseMass2 == 0)
+		return;
+
+	ContactManifold* manifold = &((ContactPair*)manDynamicArray.get(collisionResolver->contactPairs, record->pair))->manifold;
+	if (manifold->count == 0) {
+		//Colliders that hit part way through the tick have been moved back to just touching, so get one point with no overlap.
+		if (manVec3.dot(&record->collisionInfo.axis, &record->collisionInfo.axis) == 0)
+			return;
+		manifold->normal = manVec3.normalize(&record->collisionInfo.axis);
+		manifold->depth = 0;
+		manifold->points[0].position = manVec3.sum(collider1->collider.position, collider2->collider.position);
+		manifold->points[0].position = manVec3.postMulScalar(&manifold->points[0].position, 0.5);
+		manifold->points[0].depth = 0;
+		manifold->points[0].normalImpulse = 0;
+		manifold->points[0].tangentImpulse[0] = 0;
+		manifold->points[0].tangentImpulse[1] = 0;
+		manifold->count = 1;
+	}
+
+	ContactConstraint constraint;
+	constraint.collider1 = record->collider1;
+	constraint.collider2 = record->collider2;
+	constraint.normal = manifold->normal;
+	manContactManifold.tangents(&constraint.normal, &constraint.tangent1, &constraint.tangent2);
+	constraint.inverseMass1 = inverseMass1;
+	constraint.inverseMass2 = inverseMass2;
+	constraint.mass = 1/(inverseMass1 + inverseMass2);
+	constraint.positionImpulse = 0;
+
+	//Bounce off the closing speed from before any impulses this tick, unless it is slow enough to be resting.
+	Vec3 relative = manVec3.sub(collider1->collider.velocity, collider2->collider.velocity);
+	scalar closing = manVec3.dot(&relative, &constraint.normal);
+	constraint.bounce = closing < -COLLISION_RESOLVER_RESTITUTION_THRESHOLD ? -collisionResolver->solverSettings.restitution*closing : 0;
+
+	for(int i = 0; i < manifold->count; i++) {
+		constraint.point = &manifold->points[i];
+		manDynamicArray.append(collisionResolver->constraints, &constraint);
+	}
+
+	for(int i = 0; i < manifold->count; i++) {
+		ContactPoint* point = &manifold->points[i];
+		Vec3 normal = manVec3.postMulScalar(&constraint.normal, point->normalImpulse);
+		Vec3 tangent1 = manVec3.postMulScalar(&constraint.tangent1, point->tangentImpulse[0]);
+		Vec3 tangent2 = manVec3.postMulScalar(&constraint.tangent2, point->tangentImpulse[1]);
+		Vec3 impulse = manVec3.sum(&normal, &tangent1);
+		impulse = manVec3.sum(&impulse, &tangent2);
+
+		Vec3 change1 = manVec3.postMulScalar(&impulse, inverseMass1);
+		Vec3 change2 = manVec3.postMulScalar(&impulse, inverseMass2);
+		*collider1->collider.velocity = manVec3.sum(collider1->collider.velocity, &change1);
+		*collider2->collider.velocity = manVec3.sub(collider2->collider.velocity, &change2);
+	}
+}
 
-	scalar v2LeftM = (mass2 - mass1)/(mass1 + mass2);
-	scalar v2RightM = (2*mass1)/(mass1 + mass2);
-	Vec3 v2Left = manVec3.preMulScalar(v2LeftM, &vel2);
-	Vec3 v2Right = manVec3.preMulScalar(v2RightM, &vel1);
-	if (!immovable2)
-		*out2 = manVec3.sum(&v2Left, &v2Right);
+/*
+ * Applies an impulse along direction to a constraint's colliders, pushing collider1 along it and collider2 against it.
+ */
+static void applyImpulse(CollisionResolver* collisionResolver, ContactConstraint* constraint, Vec3* direction, scalar impulse) {
+	Vec3* velocity1 = getTransformed(collisionResolver, constraint->collider1)->collider.velocity;
+	Vec3* velocity2 = getTransformed(collisionResolver, constraint->collider2)->collider.velocity;
+	Vec3 change1 = manVec3.postMulScalar(direction, impulse*constraint->inverseMass1);
+	Vec3 change2 = manVec3.postMulScalar(direction, impulse*constraint->inverseMass2);
+	*velocity1 = manVec3.sum(velocity1, &change1);
+	*velocity2 = manVec3.sub(velocity2, &change2);
+}
+
+static scalar relativeSpeed(CollisionResolver* collisionResolver, ContactConstraint* constraint, Vec3* direction) {
+	Vec3* velocity1 = getTransformed(collisionResolver, constraint->collider1)->collider.velocity;
+	Vec3* velocity2 = getTransformed(collisionResolver, constraint->collider2)->collider.velocity;
+	Vec3 relative = manVec3.sub(velocity1, velocity2);
+	return manVec3.dot(&relative, direction);
+}
+
+/*
+ * Adds impulse to an accumulated impulse, keeping the total within min and max, and returns how much was added.
+ */
+static scalar accumulate(scalar* total, scalar impulse, scalar min, scalar max) {
+	scalar old = *total;
+	*total = fmaxf(min, fminf(old + impulse, max));
+	return *total - old;
+}
+
+static void solveVelocities(CollisionResolver* collisionResolver) {
+	DynamicArray* constraints = collisionResolver->constraints;
+	scalar friction = collisionResolver->solverSettings.friction;
+
+	collisionResolver->velocityIterationsUsed = 0;
+	for(int iteration = 0; iteration < collisionResolver->solverSettings.velocityIterations; iteration++) {
+		scalar largest = 0;
+
+		for(int i = 0; i < constraints->size; i++) {
+			ContactConstraint* constraint = (ContactConstraint*)manDynamicArray.get(constraints, i);
+			ContactPoint* point = constraint->point;
+
+			//Friction first, limited by the normal impulse from the last iteration.
+			scalar limit = friction*point->normalImpulse;
+			Vec3* tangents[2] = {&constraint->tangent1, &constraint->tangent2};
+			for(int t = 0; t < 2; t++) {
+				scalar speed = relativeSpeed(collisionResolver, constraint, tangents[t]);
+				scalar impulse = accumulate(&point->tangentImpulse[t], -constraint->mass*speed, -limit, limit);
+				applyImpulse(collisionResolver, constraint, tangents[t], impulse);
+				largest = fmaxf(largest, fabsf(impulse));
+			}
+
+			scalar speed = relativeSpeed(collisionResolver, constraint, &constraint->normal);
+			scalar impulse = accumulate(&point->normalImpulse, constraint->mass*(constraint->bounce - speed), 0, INFINITY);
+			applyImpulse(collisionResolver, constraint, &constraint->normal, impulse);
+			largest = fmaxf(largest, fabsf(impulse));
+		}
+
+		collisionResolver->velocityIterationsUsed = iteration + 1;
+		if (largest < COLLISION_RESOLVER_SOLVER_TOLERANCE)
+			break;
+	}
+}
+
+/*
+ * Pushes overlapping colliders apart, keeping how far each moves in corrections rather than changing
+ * velocities, so resolving overlap never adds energy. Each point's overlap is its depth from the
+ * narrowphase less how far the corrections so far have separated it.
+ */
+static void solvePositions(CollisionResolver* collisionResolver) {
+	DynamicArray* constraints = collisionResolver->constraints;
+	DynamicArray* corrections = collisionResolver->corrections;
+
+	Vec3 zero = manVec3.create(NULL, 0, 0, 0);
+	while(corrections->size < collisionResolver->transformedColliders->size)
+		manDynamicArray.append(corrections, &zero);
+	for(int i = 0; i < corrections->size; i++)
+		*(Vec3*)manDynamicArray.get(corrections, i) = zero;
+
+	collisionResolver->positionIterationsUsed = 0;
+	for(int iteration = 0; iteration < collisionResolver->solverSettings.positionIterations; iteration++) {
+		scalar largest = 0;
+
+		for(int i = 0; i < constraints->size; i++) {
+			ContactConstraint* constraint = (ContactConstraint*)manDynamicArray.get(constraints, i);
+			Vec3* correction1 = (Vec3*)manDynamicArray.get(corrections, constraint->collider1);
+			Vec3* correction2 = (Vec3*)manDynamicArray.get(corrections, constraint->collider2);
+
+			Vec3 separated = manVec3.sub(correction1, correction2);
+			scalar depth = constraint->point->depth - manVec3.dot(&separated, &constraint->normal);
+			scalar push = constraint->mass*COLLISION_RESOLVER_POSITION_CORRECTION*(depth - COLLISION_RESOLVER_SLOP);
+			push = accumulate(&constraint->positionImpulse, push, 0, INFINITY);
+
+			Vec3 change1 = manVec3.postMulScalar(&constraint->normal, push*constraint->inverseMass1);
+			Vec3 change2 = manVec3.postMulScalar(&constraint->normal, push*constraint->inverseMass2);
+			*correction1 = manVec3.sum(correction1, &change1);
+			*correction2 = manVec3.sub(correction2, &change2);
+			largest = fmaxf(largest, fabsf(push));
+		}
+
+		collisionResolver->positionIterationsUsed = iteration + 1;
+		if (largest < COLLISION_RESOLVER_SOLVER_TOLERANCE)
+			break;
+	}
+
+	for(int i = 0; i < corrections->size; i++) {
+		Vec3* correction = (Vec3*)manDynamicArray.get(corrections, i);
+		if (correction->x == 0 && correction->y == 0 && correction->z == 0)
+			continue;
+
+		TransformedCollider* tCol = getTransformed(collisionResolver, i);
+		*tCol->collider.position = manVec3.sum(tCol->collider.position, correction);
+		tCol->hasMeshTransformed = false;
+	}
 }
 
 static void resolve(CollisionResolver* collisionResolver) {
-	for(int i = 0; i < collisionResolver->collisionRecords->size; i++) {
-		CollisionRecord* cr = (CollisionRecord*)manDynamicArray.get(collisionResolver->collisionRecords, i);
-		TransformedCollider* collider1 = (TransformedCollider*)manDynamicArray.get(collisionResolver->transformedColliders, cr->collider1);
-		TransformedCollider* collider2 = (TransformedCollider*)manDynamicArray.get(collisionResolver->transformedColliders, cr->collider2);
+	rewindToImpacts(collisionResolver);
+
+	collisionResolver->constraints->size = 0;
+	for(int i = 0; i < collisionResolver->collisionRecords->size; i++)
+		addConstraints(collisionResolver, (CollisionRecord*)manDynamicArray.get(collisionResolver->collisionRecords, i));
 
-		Vec3 translation = manVec3.preMulScalar(cr->collisionInfo.distance/2, &cr->collisionInfo.axis);
+	solveVelocities(collisionResolver);
+	solvePositions(collisionResolver);
+}
 
-		if (!collider1->collider.immovable)
-			*collider1->collider.position = manVec3.sum(collider1->collider.position, &translation);
+static int findIsland(ContactIsland* islands, int i) {
+	while(islands[i].parent != i) {
+		//Path halving keeps the trees shallow.
+		islands[i].parent = islands[islands[i].parent].parent;
+		i = islands[i].parent;
+	}
+	return i;
+}
 
-		if ((!collider1->collider.immovable) && (collider2->collider.immovable))
-			*collider1->collider.position = manVec3.sum(collider1->collider.position, &translation);
+static void updateSleep(CollisionResolver* collisionResolver, scalar tickDelta) {
+	if (!collisionResolver->sleepEnabled)
+		return;
 
-		translation = manVec3.invert(&translation);
+	int count = collisionResolver->transformedColliders->size;
+	while(collisionResolver->islands->size < count) {
+		ContactIsland island;
+		manDynamicArray.append(collisionResolver->islands, &island);
+	}
+	ContactIsland* islands = (ContactIsland*)collisionResolver->islands->contents;
 
-		if (!collider2->collider.immovable)
-			*collider2->collider.position = manVec3.sum(collider2->collider.position, &translation);
+	scalar sleepVelocitySquared = COLLISION_RESOLVER_SLEEP_VELOCITY*COLLISION_RESOLVER_SLEEP_VELOCITY;
+	for(int i = 0; i < count; i++) {
+		PhysicsCollider* col = getCollider(collisionResolver, i);
+		ColliderState* state = getState(collisionResolver, i);
 
-		if ((!collider2->collider.immovable) && (collider1->collider.immovable))
-			*collider2->collider.position = manVec3.sum(collider2->collider.position, &translation);
+		islands[i].parent = i;
+		islands[i].canSleep = true;
+		islands[i].last = -1;
 
-		collider1->hasMeshTransformed = false;
-		collider2->hasMeshTransformed = false;
+		if (col->sleeping || col->immovable)
+			continue;
 
-		momentumCollisionResponse(collider1->collider.velocity,  collider2->collider.velocity,
-		                         *collider1->collider.velocity, *collider2->collider.velocity,
-		                          1/(*collider1->collider.inverseMass), 1/(*collider2->collider.inverseMass),
-								  collider1->collider.immovable, collider2->collider.immovable);
+		if (manVec3.dot(col->velocity, col->velocity) < sleepVelocitySquared)
+			state->stillTime += tickDelta;
+		else
+			state->stillTime = 0;
+	}
+
+	//Join everything touching into islands. Immovable colliders don't join islands, or everything resting on the ground would be one island.
+	for(int r = 0; r < collisionResolver->collisionRecords->size; r++) {
+		CollisionRecord* record = (CollisionRecord*)manDynamicArray.get(collisionResolver->collisionRecords, r);
+		if (getCollider(collisionResolver, record->collider1)->immovable || getCollider(collisionResolver, record->collider2)->immovable)
+			continue;
+
+		int island1 = findIsland(islands, record->collider1);
+		int island2 = findIsland(islands, record->collider2);
+		if (island1 != island2)
+			islands[island1 > island2 ? island1 : island2].parent = island1 > island2 ? island2 : island1;
+	}
+
+	for(int i = 0; i < count; i++) {
+		PhysicsCollider* col = getCollider(collisionResolver, i);
+		if (col->sleeping || col->immovable || getState(collisionResolver, i)->stillTime < COLLISION_RESOLVER_SLEEP_TIME)
+			islands[findIsland(islands, i)].canSleep = false;
+	}
+
+	//Put the still islands to sleep, linking each into a circular list so touching any of it wakes all of it.
+	for(int i = 0; i < count; i++) {
+		int root = findIsland(islands, i);
+		if (!islands[root].canSleep)
+			continue;
+
+		//Resolving this tick's collisions may have moved it, catch the transform up so prepare doesn't take that for a knock.
+		//prepare skips it from here on, so its sweep is left as it would be for a collider that hasn't moved.
+		PhysicsCollider* col = getCollider(collisionResolver, i);
+		ColliderState* state = getState(collisionResolver, i);
+		col->sleeping = true;
+		*col->velocity = manVec3.create(NULL, 0, 0, 0);
+		updateTransform(getTransformed(collisionResolver, i), state, col, false);
+		state->sweep = manVec3.create(NULL, 0, 0, 0);
+		state->sweepStart = *col->position;
+		getTransformed(collisionResolver, i)->timeOfImpact = 1;
+
+		if (islands[root].last >= 0)
+			getState(collisionResolver, islands[root].last)->sleepNext = i;
+		islands[root].last = i;
+		getState(collisionResolver, i)->sleepNext = root;
+	}
+}
+
+/*
+ * Contact pairs are snapshotted without the manifold points they don't use, which are at the end. The
+ * padding after the pair's flags is zeroed, so the same pairs always give the same bytes.
+ */
+#define CONTACT_PAIR_HEAD offsetof(ContactPair, manifold.points)
+#define CONTACT_PAIR_FLAGS_END (offsetof(ContactPair, reused) + sizeof(bool))
+#define CONTACT_PAIR_PADDING (offsetof(ContactPair, result) - CONTACT_PAIR_FLAGS_END)
+
+/*
+ * Rounds a size up so what comes after it starts aligned.
+ */
+static int padToInt(int size) {
+	return (size + sizeof(int) - 1)/sizeof(int)*sizeof(int);
+}
+
+/*
+ * The collider and contact pair counts, then the ColliderState of every collider as it is kept, then the
+ * number of manifold points of each contact pair as an unsigned char, then the contact pairs. The point
+ * counts let restore check the size of the pairs without reading them. Whether a collider sleeps is kept
+ * by its state too, as sleepNext, so the colliders themselves aren't read. The transforms and meshes are
+ * left out, they are made again from the rest at the next prepare, as are the colliders' settings.
+ * Every pair is allowed a full manifold here, so the pairs are only read once, when they are written.
+ */
+static int getSnapshotSize(CollisionResolver* collisionResolver) {
+	int pairCount = collisionResolver->contactPairs->size;
+	return 2*sizeof(int) + collisionResolver->colliders->size*sizeof(ColliderState) + padToInt(pairCount) + pairCount*sizeof(ContactPair);
+}
+
+static int snapshot(CollisionResolver* collisionResolver, char* data) {
+	//Colliders added since the last tick have no cache entry yet.
+	if (collisionResolver->transformedColliders->size < collisionResolver->colliders->size)
+		reset(collisionResolver);
+
+	int counts[2] = {collisionResolver->colliders->size, collisionResolver->contactPairs->size};
+	memcpy(data, counts, sizeof(counts));
+	memcpy(data + sizeof(counts), collisionResolver->colliderStates->contents, counts[0]*sizeof(ColliderState));
+
+	unsigned char* pointCounts = (unsigned char*)(data + sizeof(counts) + counts[0]*sizeof(ColliderState));
+	char* pairData = (char*)pointCounts + padToInt(counts[1]);
+	memset(pointCounts, 0, padToInt(counts[1]));
+	ContactPair* contacts = (ContactPair*)collisionResolver->contactPairs->contents;
+	for(int p = 0; p < counts[1]; p++) {
+		pointCounts[p] = contacts[p].manifold.count;
+		memcpy(pairData, &contacts[p], CONTACT_PAIR_HEAD);
+		memset(pairData + CONTACT_PAIR_FLAGS_END, 0, CONTACT_PAIR_PADDING);
+		pairData += CONTACT_PAIR_HEAD;
+		for(int c = 0; c < pointCounts[p]; c++, pairData += sizeof(ContactPoint))
+			memcpy(pairData, &contacts[p].manifold.points[c], sizeof(ContactPoint));
+	}
+	return pairData - data;
+}
+
+static bool restore(CollisionResolver* collisionResolver, const char* data, int size) {
+	int counts[2];
+	if (size < sizeof(counts))
+		return false;
+	memcpy(counts, data, sizeof(counts));
+	if (counts[0] != collisionResolver->colliders->size || counts[1] < 0 || counts[1] > size/CONTACT_PAIR_HEAD ||
+	    size < sizeof(counts) + counts[0]*sizeof(ColliderState) + padToInt(counts[1]))
+		return false;
+
+	//Check the contact pairs fill the rest exactly, and hold no more points than a manifold can, before changing anything.
+	const ColliderState* states = (const ColliderState*)(data + sizeof(counts));
+	const unsigned char* pointCounts = (const unsigned char*)&states[counts[0]];
+	const char* pairData = (const char*)pointCounts + padToInt(counts[1]);
+	long pairSize = counts[1]*(long)CONTACT_PAIR_HEAD;
+	bool pointsFit = true;
+	for(int p = 0; p < counts[1]; p++) {
+		pointsFit = pointsFit && pointCounts[p] <= CONTACT_MANIFOLD_MAX_POINTS;
+		pairSize += pointCounts[p]*sizeof(ContactPoint);
+	}
+	if (!pointsFit || pairData + pairSize != data + size)
+		return false;
+
+	if (collisionResolver->transformedColliders->size < collisionResolver->colliders->size)
+		reset(collisionResolver);
+
+	//Only the colliders that fell asleep or woke since the snapshot are written to, the rest aren't fetched at all.
+	ColliderState* kept = (ColliderState*)collisionResolver->colliderStates->contents;
+	for(int i = 0; i < counts[0]; i++) {
+		if ((kept[i].sleepNext >= 0) != (states[i].sleepNext >= 0))
+			getCollider(collisionResolver, i)->sleeping = states[i].sleepNext >= 0;
+	}
+	memcpy(kept, states, counts[0]*sizeof(ColliderState));
+	collisionResolver->staleTransforms = true;
+
+	DynamicArray* pairs = collisionResolver->contactPairs;
+	if (pairs->capacity < counts[1]) {
+		pairs->capacity = counts[1];
+		pairs->contents = realloc(pairs->contents, pairs->capacity*pairs->elementSize);
+	}
+	ContactPair* contacts = (ContactPair*)pairs->contents;
+	for(int p = 0; p < counts[1]; p++) {
+		//Fixed size copies the compiler can inline, the pairs are too small for memcpy's call to pay off.
+		memcpy(&contacts[p], pairData, CONTACT_PAIR_HEAD);
+		pairData += CONTACT_PAIR_HEAD;
+		for(int c = 0; c < pointCounts[p]; c++, pairData += sizeof(ContactPoint))
+			memcpy(&contacts[p].manifold.points[c], pairData, sizeof(ContactPoint));
+		//The count is taken from the checked table, whatever the pair itself holds.
+		contacts[p].manifold.count = pointCounts[p];
 	}
+	pairs->size = counts[1];
+	return true;
 }
 
-const CollisionResolverManager manColResolver = {new, addCollider, reset, prepare, check, resolve, delete};
+const CollisionResolverManager manColResolver = {new, addCollider, setBroadphase, setJobSystem, setSolverSettings, reset, prepare, check, resolve, setSleepEnabled, updateSleep, wake, getSnapshotSize, snapshot, restore, delete};
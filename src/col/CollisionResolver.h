@@ -2,34 +2,295 @@
 #define COH_COLLISIONRESPONSE_H
 
 #include "col/CollisionDetection.h"
+#include "col/ContactManifold.h"
+#include "col/Broadphase.h"
 #include "util/DynamicArray.h"
+#include "util/JobSystem.h"
+
+/** Number of colliders each job transforms when prepare runs in parallel. **/
+#define COLLISION_RESOLVER_PREPARE_CHUNK 64
+/** Number of meshes each job transforms before the narrowphase. **/
+#define COLLISION_RESOLVER_MESH_CHUNK 16
+/** Number of pairs each job runs the narrowphase on. **/
+#define COLLISION_RESOLVER_NARROWPHASE_CHUNK 8
+/** Speed, in units per second, below which a body counts as still. **/
+#define COLLISION_RESOLVER_SLEEP_VELOCITY 0.1
+/** How long, in seconds, a whole island must stay still before it sleeps. **/
+#define COLLISION_RESOLVER_SLEEP_TIME 1.0
+/** Most times a tick resolve goes over every contact correcting velocities, unless set otherwise. **/
+#define COLLISION_RESOLVER_VELOCITY_ITERATIONS 10
+/** Most times a tick resolve goes over every contact pushing overlapping colliders apart, unless set otherwise. **/
+#define COLLISION_RESOLVER_POSITION_ITERATIONS 4
+/** Largest change in impulse an iteration can make for the contacts to count as solved, so the solver stops early. **/
+#define COLLISION_RESOLVER_SOLVER_TOLERANCE 1e-4
+/** Closing speed, in units per second, below which contacts don't bounce, so resting bodies stay at rest. **/
+#define COLLISION_RESOLVER_RESTITUTION_THRESHOLD 1.0
+/** How far, in units, colliders can overlap without being pushed apart, so resting contacts stay touching. **/
+#define COLLISION_RESOLVER_SLOP 0.01
+/** Fraction of the overlap beyond the slop each position iteration removes. **/
+#define COLLISION_RESOLVER_POSITION_CORRECTION 0.2
 
 typedef struct CollisionRecord_s {
 	int collider1;
 	int collider2;
 	CollisionResult collisionInfo;
+	/** Fraction of the tick the colliders first touched at, 1 for collisions found at the end of the tick. **/
+	scalar timeOfImpact;
+	/** Index of the pair in the resolver's contactPairs, which holds its contact manifold. **/
+	int pair;
 } CollisionRecord;
 
+/**
+ * What the narrowphase found for a pair of colliders. Kept from tick to tick for as long as the broadphase
+ * keeps finding the pair, so the manifold's impulses can carry on and the narrowphase can be skipped while
+ * neither collider moves relative to the other.
+ */
+typedef struct ContactPair_s {
+	int collider1;
+	int collider2;
+	/** Whether result and manifold hold an earlier narrowphase of the pair. **/
+	bool hasResult;
+	/** Whether this tick reused them instead of running the narrowphase. **/
+	bool reused;
+	CollisionResult result;
+
+	/** The transforms of the colliders when result was found, with collider2's position relative to collider1. **/
+	Vec3 position1;
+	Vec3 offset;
+	Vec3 rotation1;
+	Vec3 rotation2;
+	Vec3 scale1;
+	Vec3 scale2;
+
+	/** Where the next support searches on each collider's mesh start. **/
+	int vertex1;
+	int vertex2;
+
+	/**
+	 * Where the colliders touch while result.isColliding. Collisions found part way through the tick
+	 * by continuous collision have no points, as the colliders are moved back before resolving.
+	 * Last, so a pair can be copied without the manifold points it doesn't use.
+	 */
+	ContactManifold manifold;
+} ContactPair;
+
+/**
+ * How resolve solves contacts.
+ */
+typedef struct ContactSolverSettings_s {
+	/** Most iterations of the velocity and position solvers, each stops early once its contacts are solved. **/
+	int velocityIterations;
+	int positionIterations;
+	/** How much of the closing speed contacts bounce back with, 1 for perfectly elastic. **/
+	scalar restitution;
+	/** Coulomb friction coefficient, how much of the impulse pushing colliders apart can oppose sliding. **/
+	scalar friction;
+} ContactSolverSettings;
+
+/**
+ * One point of a contact manifold, set up for the solver.
+ */
+typedef struct ContactConstraint_s {
+	int collider1;
+	int collider2;
+	/** The manifold point being solved, which keeps its impulses for the next tick to start from. **/
+	ContactPoint* point;
+	/** The manifold's normal, from collider2 to collider1, and the two friction directions. **/
+	Vec3 normal;
+	Vec3 tangent1;
+	Vec3 tangent2;
+	/** Inverse masses of the colliders, 0 for immovable ones. **/
+	scalar inverseMass1;
+	scalar inverseMass2;
+	/** The impulse that changes the colliders' relative velocity by one unit. **/
+	scalar mass;
+	/** Speed along the normal the colliders should part at, from restitution. **/
+	scalar bounce;
+	/** Total push the position solver has given the point this tick, which moves colliders without changing their velocity. **/
+	scalar positionImpulse;
+} ContactConstraint;
+
+/**
+ * What the resolver keeps of a collider from tick to tick, besides its world space copy. Kept apart from the
+ * TransformedColliders, in an array of their own, so a snapshot copies them all in one go.
+ */
+typedef struct ColliderState_s {
+	/** Whether the transform below has been made yet. **/
+	bool hasTransform;
+	/** The position, rotation and scale the collider was last transformed with. **/
+	Vec3 lastPosition;
+	Vec3 lastRotation;
+	Vec3 lastScale;
+	/** The untransformed broadphase sphere it was last transformed with. **/
+	ColliderSphere lastBPhase;
+
+	/** How far the collider moved between the last two prepares, what continuous collision sweeps along. **/
+	Vec3 sweep;
+	/** Where the collider was at the last prepare, or where it was moved back to if it hit something. **/
+	Vec3 sweepStart;
+
+	/** How long the collider has been still for, in seconds. **/
+	scalar stillTime;
+	/** While sleeping, the next collider in its island, the islands are circular lists. -1 while awake. **/
+	int sleepNext;
+} ColliderState;
+
+/**
+ * World space copy of a collider. Kept between ticks, so the vertex and normal
+ * buffers are reused and the mesh is only transformed again once the collider moves.
+ */
 typedef struct TransformedCollider_s {
 	PhysicsCollider collider;
 	bool hasMeshTransformed;
+
+	/** The transformation matrix for the cached transform. **/
+	Mat4 transform;
+
+	/** The earliest time of impact of the collider this tick, it is moved back to there before resolving. **/
+	scalar timeOfImpact;
+
+	/** Number of vertices and normals the mesh buffers can hold. **/
+	int vertCapacity;
+	int normCapacity;
 } TransformedCollider;
 
+/**
+ * A collider's entry in the union-find that groups colliders touching each other into islands.
+ */
+typedef struct ContactIsland_s {
+	/** The next collider up towards the island's root, the root is its own parent. **/
+	int parent;
+	/** On the root, whether every collider in the island has been still for long enough to sleep. **/
+	bool canSleep;
+	/** On the root, the last collider linked into the island's sleep list so far, or -1. **/
+	int last;
+} ContactIsland;
+
 typedef struct CollisionResolver_s {
 	DynamicArray* colliders;
 	DynamicArray* transformedColliders;
+	/** The ColliderState of each collider, as many as there are transformedColliders. **/
+	DynamicArray* colliderStates;
+	/** Whether every cached transform must be made again at the next prepare, even if its collider hasn't moved, after a restore. **/
+	bool staleTransforms;
 	DynamicArray* collisionRecords;
+
+	/** The broadphase used to find candidate pairs. Not owned unless it is defaultBroadphase. **/
+	Broadphase* broadphase;
+	/** The brute-force broadphase the resolver starts with. **/
+	Broadphase* defaultBroadphase;
+	/** The transformed broadphase spheres for this tick, indexed by collider. **/
+	DynamicArray* bounds;
+	/** Whether each collider is asleep or immovable this tick, as bools indexed by collider, handed to the broadphase while sleep is enabled. **/
+	DynamicArray* resting;
+	/** The candidate pairs found by the broadphase this tick. **/
+	DynamicArray* pairs;
+	/** The ContactPair of each of this tick's pairs, in the same order. **/
+	DynamicArray* contactPairs;
+	/** Last tick's contactPairs, which the new ones are carried on from. **/
+	DynamicArray* lastContactPairs;
+
+	/** Job system the resolver and its broadphase split work over, or NULL for the calling thread. Not owned. **/
+	JobSystem* jobSystem;
+	/** Colliders whose meshes must be transformed before this tick's narrowphase. **/
+	DynamicArray* meshQueue;
+	/** A CollisionRecord buffer per thread for the parallel narrowphase, threadRecordsCount long. **/
+	DynamicArray** threadRecords;
+	int threadRecordsCount;
+
+	/** How resolve solves contacts. **/
+	ContactSolverSettings solverSettings;
+	/** A ContactConstraint for every point of every manifold being resolved this tick. **/
+	DynamicArray* constraints;
+	/** How far the position solver has moved each collider this tick, indexed by collider. **/
+	DynamicArray* corrections;
+	/** How many iterations the velocity and position solvers took on the last resolve. **/
+	int velocityIterationsUsed;
+	int positionIterationsUsed;
+
+	/** Whether bodies at rest are put to sleep, off by default. **/
+	bool sleepEnabled;
+	/** The ContactIsland of every collider, rebuilt by updateSleep. **/
+	DynamicArray* islands;
 } CollisionResolver;
 
 typedef struct CollisionResolverManager_s {
 	CollisionResolver*(* new)();
-	void(* addCollider)(CollisionResolver* collisionResolver, PhysicsCollider* collider);
+	/**
+	 * Adds a collider to the resolver.
+	 * @return The index of the collider, used in CollisionRecords and to wake it, or -1 if collider is NULL.
+	 */
+	int(* addCollider)(CollisionResolver* collisionResolver, PhysicsCollider* collider);
+	/**
+	 * Sets the broadphase used to find candidate pairs, or the resolver's brute-force one when broadphase is NULL.
+	 * The caller owns the broadphase: the resolver never deletes it, so keep it alive while the resolver uses it
+	 * and delete and free it once the resolver is deleted or given another.
+	 */
+	void(* setBroadphase)(CollisionResolver* collisionResolver, Broadphase* broadphase);
+	/**
+	 * Sets the job system prepare and the broadphase spread their work over.
+	 * Results are the same, in the same order, whatever the number of threads.
+	 */
+	void(* setJobSystem)(CollisionResolver* collisionResolver, JobSystem* jobs);
+
+	/**
+	 * Sets how resolve solves contacts. Starts with COLLISION_RESOLVER_VELOCITY_ITERATIONS and
+	 * COLLISION_RESOLVER_POSITION_ITERATIONS iterations, perfectly elastic and without friction,
+	 * like the single momentum exchange resolve did before it had a solver.
+	 */
+	void(* setSolverSettings)(CollisionResolver* collisionResolver, ContactSolverSettings* settings);
 
 	void(* reset)(CollisionResolver* collisionResolver);
 	void(* prepare)(CollisionResolver* collisionResolver);
 	bool(* check)(CollisionResolver* collisionResolver);
+	/**
+	 * Solves every contact check found together, with sequential impulses. Velocity iterations apply impulses
+	 * at each contact point, with restitution and friction, starting from the impulses the points had last tick.
+	 * Position iterations then push overlapping colliders apart without adding to their velocities.
+	 */
 	void(* resolve)(CollisionResolver* collisionResolver);
 
+	/**
+	 * Enables or disables sleeping. Sleeping colliders are only checked against awake colliders
+	 * that can move, and wake their whole island when one of those touches them.
+	 * Disabling it wakes every collider.
+	 */
+	void(* setSleepEnabled)(CollisionResolver* collisionResolver, bool enabled);
+
+	/**
+	 * Groups the colliders into islands of bodies in contact, using this tick's collision records,
+	 * and puts islands to sleep once every body in them has been still for COLLISION_RESOLVER_SLEEP_TIME.
+	 * Call once a tick after resolve. Does nothing unless sleeping is enabled.
+	 * @param tickDelta The time the tick simulated, in seconds.
+	 */
+	void(* updateSleep)(CollisionResolver* collisionResolver, scalar tickDelta);
+
+	/**
+	 * Wakes the collider at the given index, and every other collider in its island.
+	 * An awake collider has its still time reset, so it stays awake for at least another COLLISION_RESOLVER_SLEEP_TIME.
+	 */
+	void(* wake)(CollisionResolver* collisionResolver, int collider);
+
+	/**
+	 * Gets the most bytes snapshot can write for the resolver as it is now, found without walking the contact pairs.
+	 */
+	int(* getSnapshotSize)(CollisionResolver* collisionResolver);
+
+	/**
+	 * Writes the state the resolver keeps between ticks: each collider's sleep state, motion and cached
+	 * transform, and the contact pair cache. Takes at most getSnapshotSize bytes.
+	 * Call between ticks, after updateSleep.
+	 * @return How many bytes were written.
+	 */
+	int(* snapshot)(CollisionResolver* collisionResolver, char* data);
+
+	/**
+	 * Reads back what snapshot wrote, into a resolver with the same colliders added in the same order,
+	 * so the next tick carries on exactly as it would have after the snapshot. Meshes are transformed again when next needed.
+	 * @return false, changing nothing, if the data is for a different number of colliders or isn't size bytes long.
+	 */
+	bool(* restore)(CollisionResolver* collisionResolver, const char* data, int size);
+
 	void(* delete)(CollisionResolver* collisionResolver);
 } CollisionResolverManager;
 
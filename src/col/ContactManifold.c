@@ -0,0 +1,373 @@
+#include "ContactManifold.h"
+
+#include <math.h>
+
+/*
+ * Finds the vertices of the mesh within CONTACT_MANIFOLD_FEATURE_TOLERANCE of the furthest along the
+ * direction, top, which is the vertex, edge or face the mesh touches with. With adjacency this spreads
+ * out over the hull from top, as the vertices of a flat face are joined by the hull's edges.
+ */
+static int findFeature(SATMesh* mesh, Vec3* direction, int top, Vec3* feature) {
+	scalar limit = manVec3.dot(&mesh->verts[top], direction) - CONTACT_MANIFOLD_FEATURE_TOLERANCE;
+	int count = 0;
+
+	bool onHull = (mesh->adjacency != NULL) && (mesh->adjacencyStart[top] < mesh->adjacencyStart[top+1]);
+	if (!onHull) {
+		for(int i = 0; i < mesh->vCount && count < CONTACT_MANIFOLD_MAX_FEATURE; i++) {
+			if (manVec3.dot(&mesh->verts[i], direction) >= limit)
+				feature[count++] = mesh->verts[i];
+		}
+		return count;
+	}
+
+	int found[CONTACT_MANIFOLD_MAX_FEATURE];
+	found[count++] = top;
+	for(int f = 0; f < count; f++) {
+		for(int i = mesh->adjacencyStart[found[f]]; i < mesh->adjacencyStart[found[f]+1] && count < CONTACT_MANIFOLD_MAX_FEATURE; i++) {
+			int neighbour = mesh->adjacency[i];
+			if (manVec3.dot(&mesh->verts[neighbour], direction) < limit)
+				continue;
+
+			bool seen = false;
+			for(int j = 0; j < count && !seen; j++)
+				seen = found[j] == neighbour;
+
+			if (!seen)
+				found[count++] = neighbour;
+		}
+	}
+
+	for(int f = 0; f < count; f++)
+		feature[f] = mesh->verts[found[f]];
+
+	return count;
+}
+
+/*
+ * Two unit vectors at right angles to the normal and each other.
+ */
+static void planeBasis(Vec3* normal, Vec3* u, Vec3* v) {
+	Vec3 other = fabs(normal->x) < 0.57 ? manVec3.create(NULL, 1, 0, 0) : manVec3.create(NULL, 0, 1, 0);
+	*u = manVec3.cross(normal, &other);
+	*u = manVec3.normalize(u);
+	*v = manVec3.cross(normal, u);
+}
+
+/*
+ * Sorts points lying roughly in a plane into order around their centre, so they form a convex polygon.
+ */
+static void orderPolygon(Vec3* points, int count, Vec3* normal) {
+	if (count < 3)
+		return;
+
+	Vec3 centre = manVec3.create(NULL, 0, 0, 0);
+	for(int i = 0; i < count; i++)
+		centre = manVec3.sum(&centre, &points[i]);
+	centre = manVec3.postMulScalar(&centre, 1.0/count);
+
+	Vec3 u, v;
+	planeBasis(normal, &u, &v);
+
+	scalar angles[CONTACT_MANIFOLD_MAX_FEATURE];
+	for(int i = 0; i < count; i++) {
+		Vec3 offset = manVec3.sub(&points[i], &centre);
+		angles[i] = scalar_atan2(manVec3.dot(&offset, &v), manVec3.dot(&offset, &u));
+	}
+
+	for(int i = 1; i < count; i++) {
+		Vec3 point = points[i];
+		scalar angle = angles[i];
+		int j = i - 1;
+		for(; j >= 0 && angles[j] > angle; j--) {
+			points[j+1] = points[j];
+			angles[j+1] = angles[j];
+		}
+		points[j+1] = point;
+		angles[j+1] = angle;
+	}
+}
+
+/*
+ * Sutherland-Hodgman, keeps the part of the polygon where dot(planeNormal, x) >= planeDistance.
+ */
+static int clipPolygon(Vec3* in, int inCount, Vec3* out, int capacity, Vec3* planeNormal, scalar planeDistance) {
+	int outCount = 0;
+
+	for(int i = 0; i < inCount && outCount < capacity - 1; i++) {
+		Vec3* current = &in[i];
+		Vec3* previous = &in[(i + inCount - 1)%inCount];
+		scalar currentSide = manVec3.dot(planeNormal, current) - planeDistance;
+		scalar previousSide = manVec3.dot(planeNormal, previous) - planeDistance;
+
+		if ((currentSide >= 0) != (previousSide >= 0)) {
+			Vec3 edge = manVec3.sub(current, previous);
+			edge = manVec3.postMulScalar(&edge, previousSide/(previousSide - currentSide));
+			out[outCount++] = manVec3.sum(previous, &edge);
+		}
+
+		if (currentSide >= 0)
+			out[outCount++] = *current;
+	}
+
+	return outCount;
+}
+
+/*
+ * Closest points between the segments a1-b1 and a2-b2.
+ */
+static void closestSegmentPoints(Vec3* a1, Vec3* b1, Vec3* a2, Vec3* b2, Vec3* point1, Vec3* point2) {
+	Vec3 d1 = manVec3.sub(b1, a1);
+	Vec3 d2 = manVec3.sub(b2, a2);
+	Vec3 r = manVec3.sub(a1, a2);
+	scalar a = manVec3.dot(&d1, &d1);
+	scalar e = manVec3.dot(&d2, &d2);
+	scalar f = manVec3.dot(&d2, &r);
+	scalar s = 0, t = 0;
+
+	if (a > 0 && e > 0) {
+		scalar b = manVec3.dot(&d1, &d2);
+		scalar c = manVec3.dot(&d1, &r);
+		scalar denominator = a*e - b*b;
+
+		if (denominator > 0)
+			s = fminf(fmaxf((b*f - c*e)/denominator, 0), 1);
+
+		t = (b*s + f)/e;
+		if (t < 0) {
+			t = 0;
+			s = fminf(fmaxf(-c/a, 0), 1);
+		} else if (t > 1) {
+			t = 1;
+			s = fminf(fmaxf((b - c)/a, 0), 1);
+		}
+	} else if (e > 0) {
+		t = fminf(fmaxf(f/e, 0), 1);
+	} else if (a > 0) {
+		s = fminf(fmaxf(-manVec3.dot(&d1, &r)/a, 0), 1);
+	}
+
+	d1 = manVec3.postMulScalar(&d1, s);
+	d2 = manVec3.postMulScalar(&d2, t);
+	*point1 = manVec3.sum(a1, &d1);
+	*point2 = manVec3.sum(a2, &d2);
+}
+
+static void addPoint(ContactPoint* points, int* count, Vec3* position, scalar depth) {
+	for(int i = 0; i < *count; i++) {
+		Vec3 offset = manVec3.sub(&points[i].position, position);
+		if (manVec3.dot(&offset, &offset) < 1e-12)
+			return;
+	}
+
+	points[*count].position = *position;
+	points[*count].depth = depth;
+	points[*count].normalImpulse = 0;
+	points[*count].tangentImpulse[0] = 0;
+	points[*count].tangentImpulse[1] = 0;
+	(*count)++;
+}
+
+static scalar signedArea(Vec3* a, Vec3* b, Vec3* c, Vec3* normal) {
+	Vec3 ab = manVec3.sub(b, a);
+	Vec3 ac = manVec3.sub(c, a);
+	Vec3 cross = manVec3.cross(&ab, &ac);
+	return manVec3.dot(&cross, normal);
+}
+
+/*
+ * Keeps the deepest point, the point furthest from it, and the two making the largest triangles
+ * either side of the line between them, which covers most of the area the points do.
+ */
+static void reducePoints(ContactManifold* manifold, ContactPoint* points, int count) {
+	if (count <= CONTACT_MANIFOLD_MAX_POINTS) {
+		for(int i = 0; i < count; i++)
+			manifold->points[i] = points[i];
+		manifold->count = count;
+		return;
+	}
+
+	int keep[4] = {0, -1, -1, -1};
+	for(int i = 1; i < count; i++) {
+		if (points[i].depth > points[keep[0]].depth)
+			keep[0] = i;
+	}
+
+	scalar best = -1;
+	for(int i = 0; i < count; i++) {
+		Vec3 offset = manVec3.sub(&points[i].position, &points[keep[0]].position);
+		scalar distance = manVec3.dot(&offset, &offset);
+		if (i != keep[0] && distance > best) {
+			best = distance;
+			keep[1] = i;
+		}
+	}
+
+	scalar most = 0, least = 0;
+	for(int i = 0; i < count; i++) {
+		if (i == keep[0] || i == keep[1])
+			continue;
+
+		scalar area = signedArea(&points[keep[0]].position, &points[keep[1]].position, &points[i].position, &manifold->normal);
+		if (keep[2] < 0 || area > most) {
+			most = area;
+			keep[2] = i;
+		}
+		if (keep[3] < 0 || area < least) {
+			least = area;
+			keep[3] = i;
+		}
+	}
+
+	manifold->count = 0;
+	for(int k = 0; k < 4; k++) {
+		bool repeat = false;
+		for(int j = 0; j < k; j++)
+			repeat = repeat || keep[j] == keep[k];
+
+		if (!repeat)
+			manifold->points[manifold->count++] = points[keep[k]];
+	}
+}
+
+static bool generate(ContactManifold* manifold, SATMesh* mesh1, SATMesh* mesh2, Vec3* axis, int* vertex1, int* vertex2) {
+	scalar length = manVec3.magnitude(axis);
+	manifold->count = 0;
+	if (length == 0)
+		return false;
+
+	//Try the axis both ways, the mesh1 side is the one that needs the shorter push.
+	Vec3 normal = manVec3.postMulScalar(axis, 1/length);
+	Vec3 opposite = manVec3.invert(&normal);
+	int bottom1 = sat.support(mesh1, &opposite, *vertex1);
+	int top2 = sat.support(mesh2, &normal, *vertex2);
+	int top1 = sat.support(mesh1, &normal, bottom1);
+	int bottom2 = sat.support(mesh2, &opposite, top2);
+	scalar forward = manVec3.dot(&mesh2->verts[top2], &normal) - manVec3.dot(&mesh1->verts[bottom1], &normal);
+	scalar backward = manVec3.dot(&mesh1->verts[top1], &normal) - manVec3.dot(&mesh2->verts[bottom2], &normal);
+
+	if (backward < forward) {
+		normal = opposite;
+		opposite = manVec3.invert(&normal);
+		forward = backward;
+		bottom1 = top1;
+		top2 = bottom2;
+	}
+
+	*vertex1 = bottom1;
+	*vertex2 = top2;
+	manifold->normal = normal;
+	manifold->depth = forward;
+
+	Vec3 feature1[CONTACT_MANIFOLD_MAX_FEATURE];
+	Vec3 feature2[CONTACT_MANIFOLD_MAX_FEATURE];
+	int count1 = findFeature(mesh1, &opposite, bottom1, feature1);
+	int count2 = findFeature(mesh2, &normal, top2, feature2);
+
+	ContactPoint points[CONTACT_MANIFOLD_MAX_FEATURE*2];
+	int pointCount = 0;
+
+	if (count1 < 3 && count2 < 3) {
+		//Vertices and edges touch at a single point.
+		Vec3 point1 = feature1[0];
+		Vec3 point2 = feature2[0];
+		if (count1 == 2 && count2 == 2) {
+			closestSegmentPoints(&feature1[0], &feature1[1], &feature2[0], &feature2[1], &point1, &point2);
+		} else if (count1 == 2) {
+			closestSegmentPoints(&feature1[0], &feature1[1], &feature2[0], &feature2[0], &point1, &point2);
+		} else if (count2 == 2) {
+			closestSegmentPoints(&feature1[0], &feature1[0], &feature2[0], &feature2[1], &point1, &point2);
+		}
+
+		Vec3 middle = manVec3.sum(&point1, &point2);
+		middle = manVec3.postMulScalar(&middle, 0.5);
+		addPoint(points, &pointCount, &middle, forward);
+	} else {
+		//The feature with more vertices is the reference face, the other is clipped to its sides.
+		bool referenceIs1 = count1 >= count2;
+		Vec3* reference = referenceIs1 ? feature1 : feature2;
+		Vec3* incident = referenceIs1 ? feature2 : feature1;
+		int referenceCount = referenceIs1 ? count1 : count2;
+		int incidentCount = referenceIs1 ? count2 : count1;
+
+		//Depth is how far an incident point is past the reference face, towards the reference mesh's inside.
+		scalar side = referenceIs1 ? 1 : -1;
+		scalar faceDistance = manVec3.dot(&reference[0], &normal);
+
+		orderPolygon(reference, referenceCount, &normal);
+		orderPolygon(incident, incidentCount, &normal);
+
+		Vec3 centre = manVec3.create(NULL, 0, 0, 0);
+		for(int i = 0; i < referenceCount; i++)
+			centre = manVec3.sum(&centre, &reference[i]);
+		centre = manVec3.postMulScalar(&centre, 1.0/referenceCount);
+
+		Vec3 buffers[2][CONTACT_MANIFOLD_MAX_FEATURE*2];
+		int clippedCount = incidentCount;
+		int current = 0;
+		for(int i = 0; i < incidentCount; i++)
+			buffers[current][i] = incident[i];
+
+		for(int i = 0; i < referenceCount && clippedCount > 0; i++) {
+			Vec3 edge = manVec3.sub(&reference[(i+1)%referenceCount], &reference[i]);
+			Vec3 inward = manVec3.cross(&normal, &edge);
+			Vec3 toCentre = manVec3.sub(&centre, &reference[i]);
+			if (manVec3.dot(&inward, &inward) == 0)
+				continue;
+			if (manVec3.dot(&inward, &toCentre) < 0)
+				inward = manVec3.invert(&inward);
+
+			clippedCount = clipPolygon(buffers[current], clippedCount, buffers[1-current], CONTACT_MANIFOLD_MAX_FEATURE*2, &inward, manVec3.dot(&inward, &reference[i]));
+			current = 1 - current;
+		}
+
+		for(int i = 0; i < clippedCount; i++) {
+			Vec3* point = &buffers[current][i];
+			scalar depth = side*(manVec3.dot(point, &normal) - faceDistance);
+			if (depth < -CONTACT_MANIFOLD_FEATURE_TOLERANCE)
+				continue;
+			depth = fmaxf(depth, 0);
+
+			Vec3 toMiddle = manVec3.preMulScalar(-side*depth/2, &normal);
+			Vec3 middle = manVec3.sum(point, &toMiddle);
+			addPoint(points, &pointCount, &middle, depth);
+		}
+
+		//Clipping can lose every point when the features only just overlap, fall back to the deepest vertex.
+		if (pointCount == 0) {
+			Vec3 point = referenceIs1 ? mesh2->verts[top2] : mesh1->verts[bottom1];
+			Vec3 toMiddle = manVec3.preMulScalar(-side*forward/2, &normal);
+			Vec3 middle = manVec3.sum(&point, &toMiddle);
+			addPoint(points, &pointCount, &middle, forward);
+		}
+	}
+
+	reducePoints(manifold, points, pointCount);
+	return true;
+}
+
+static void translate(ContactManifold* manifold, Vec3* offset) {
+	for(int i = 0; i < manifold->count; i++)
+		manifold->points[i].position = manVec3.sum(&manifold->points[i].position, offset);
+}
+
+static void warmStart(ContactManifold* manifold, const ContactManifold* previous) {
+	if (manVec3.dot(&manifold->normal, &previous->normal) < CONTACT_MANIFOLD_MATCH_NORMAL)
+		return;
+
+	scalar matchSquared = CONTACT_MANIFOLD_MATCH_DISTANCE*CONTACT_MANIFOLD_MATCH_DISTANCE;
+	for(int i = 0; i < manifold->count; i++) {
+		scalar best = matchSquared;
+		for(int j = 0; j < previous->count; j++) {
+			Vec3 offset = manVec3.sub(&manifold->points[i].position, &previous->points[j].position);
+			scalar distance = manVec3.dot(&offset, &offset);
+			if (distance <= best) {
+				best = distance;
+				manifold->points[i].normalImpulse = previous->points[j].normalImpulse;
+				manifold->points[i].tangentImpulse[0] = previous->points[j].tangentImpulse[0];
+				manifold->points[i].tangentImpulse[1] = previous->points[j].tangentImpulse[1];
+			}
+		}
+	}
+}
+
+const ContactManifoldManager manContactManifold = {generate, translate, warmStart, planeBasis};
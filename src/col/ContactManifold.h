@@ -0,0 +1,82 @@
+#ifndef COH_CONTACTMANIFOLD_H
+#define COH_CONTACTMANIFOLD_H
+
+#include <stdbool.h>
+#include "math/Vec3.h"
+#include "col/SAT.h"
+
+/** Most contact points a manifold keeps, enough to hold a face resting on a face still. **/
+#define CONTACT_MANIFOLD_MAX_POINTS 4
+/** Most vertices taken from each mesh as the feature it touches with. **/
+#define CONTACT_MANIFOLD_MAX_FEATURE 32
+/** How far, in units, a vertex can be short of the furthest one along the normal and still be part of the touching feature. **/
+#define CONTACT_MANIFOLD_FEATURE_TOLERANCE 1e-3
+/** How close, in units, a contact must be to one from the last manifold of the pair to carry on its impulse. **/
+#define CONTACT_MANIFOLD_MATCH_DISTANCE 0.05
+/** Least dot product of the normals of two manifolds of a pair for their points to match. **/
+#define CONTACT_MANIFOLD_MATCH_NORMAL 0.95
+
+typedef struct ContactPoint_s {
+	/** Where the contact is in world space, halfway between the two surfaces. **/
+	Vec3 position;
+	/** How far the surfaces overlap at the point, along the manifold's normal. **/
+	scalar depth;
+	/** Impulse along the normal the solver applied at the point, kept so the next tick can start from it. **/
+	scalar normalImpulse;
+	/** Friction impulse the solver applied along each of the tangents manifoldTangents gives for the normal. **/
+	scalar tangentImpulse[2];
+} ContactPoint;
+
+/**
+ *	Where two convex meshes touch, as up to CONTACT_MANIFOLD_MAX_POINTS points sharing a normal.
+ */
+typedef struct ContactManifold_s {
+	/** Unit normal pointing from the second mesh to the first, the way the first must move to separate them. **/
+	Vec3 normal;
+	/** The deepest any point overlaps. **/
+	scalar depth;
+	int count;
+	/** Only the first count are in use, so the manifold can be copied without the rest. **/
+	ContactPoint points[CONTACT_MANIFOLD_MAX_POINTS];
+} ContactManifold;
+
+/**
+ *	Manager for building contact manifolds from a separating axis. Each mesh's feature facing
+ * 	the other, a vertex, edge or face, is found with its support function. The one with more vertices
+ * 	is the reference face and the other is clipped against its sides, so resting faces get a point
+ * 	at each corner of where they overlap rather than a single point.
+ */
+typedef struct ContactManifoldManager_s {
+	/**
+	 *	Builds the manifold of two overlapping meshes from the axis they overlap least along.
+	 * 	The axis can point either way, the way with the shallower overlap is used.
+	 * 	The points start with no impulse.
+	 *
+	 * 	@param 	vertex1 	Where to start the support searches on mesh1, see SATManager.support. Updated.
+	 * 	@param 	vertex2 	Where to start the support searches on mesh2. Updated.
+	 * 	@return 			false if the axis has no length.
+	 */
+	bool(* generate)(ContactManifold* manifold, SATMesh* mesh1, SATMesh* mesh2, Vec3* axis, int* vertex1, int* vertex2);
+
+	/**
+	 *	Moves every point of the manifold by offset.
+	 */
+	void(* translate)(ContactManifold* manifold, Vec3* offset);
+
+	/**
+	 *	Gives each point of the manifold the impulse of the nearest point of the previous manifold
+	 * 	of the same pair, normal and friction, if it is within CONTACT_MANIFOLD_MATCH_DISTANCE and the normals agree to CONTACT_MANIFOLD_MATCH_NORMAL.
+	 * 	The previous manifold must already have been moved to where it would be now.
+	 */
+	void(* warmStart)(ContactManifold* manifold, const ContactManifold* previous);
+
+	/**
+	 *	Two unit tangents at right angles to the normal and each other, the same ones every time for the same normal
+	 * 	so friction impulses can carry on between ticks.
+	 */
+	void(* tangents)(Vec3* normal, Vec3* tangent1, Vec3* tangent2);
+} ContactManifoldManager;
+
+extern const ContactManifoldManager manContactManifold;
+
+#endif
@@ -0,0 +1,339 @@
+#include "GJK.h"
+
+#include <math.h>
+#include "math/Precision.h"
+
+typedef struct EPAFace_s {
+	int a, b, c;
+	/** Outward unit normal, and the face's distance from the origin along it. **/
+	Vec3 normal;
+	scalar distance;
+} EPAFace;
+
+typedef struct EPAEdge_s {
+	int a, b;
+} EPAEdge;
+
+static Vec3 support(SATMesh* mesh, Vec3* direction) {
+	return mesh->verts[sat.support(mesh, direction, 0)];
+}
+
+/*
+ * Support point of the Minkowski difference mesh2 - mesh1.
+ */
+static Vec3 supportDifference(SATMesh* mesh1, SATMesh* mesh2, Vec3* direction, GJKSimplex* simplex) {
+	Vec3 opposite = manVec3.invert(direction);
+	simplex->vertex2 = sat.support(mesh2, direction, simplex->vertex2);
+	simplex->vertex1 = sat.support(mesh1, &opposite, simplex->vertex1);
+	Vec3 point2 = mesh2->verts[simplex->vertex2];
+	Vec3 point1 = mesh1->verts[simplex->vertex1];
+
+	simplex->supportCalls += 2;
+	return manVec3.sub(&point2, &point1);
+}
+
+static bool sameDirection(Vec3* v1, Vec3* v2) {
+	return manVec3.dot(v1, v2) > 0;
+}
+
+static Vec3 tripleCross(Vec3* v1, Vec3* v2, Vec3* v3) {
+	Vec3 cross = manVec3.cross(v1, v2);
+	return manVec3.cross(&cross, v3);
+}
+
+/*
+ * The simplex cases below keep the part of the simplex nearest the origin and point the
+ * next search towards it. points[0] is always the newest point.
+ */
+static void doLine(GJKSimplex* simplex, Vec3* direction) {
+	Vec3 a = simplex->points[0];
+	Vec3 b = simplex->points[1];
+	Vec3 ab = manVec3.sub(&b, &a);
+	Vec3 ao = manVec3.invert(&a);
+
+	if (sameDirection(&ab, &ao)) {
+		*direction = tripleCross(&ab, &ao, &ab);
+	} else {
+		simplex->count = 1;
+		*direction = ao;
+	}
+}
+
+static void doTriangle(GJKSimplex* simplex, Vec3* direction) {
+	Vec3 a = simplex->points[0];
+	Vec3 b = simplex->points[1];
+	Vec3 c = simplex->points[2];
+	Vec3 ab = manVec3.sub(&b, &a);
+	Vec3 ac = manVec3.sub(&c, &a);
+	Vec3 ao = manVec3.invert(&a);
+	Vec3 abc = manVec3.cross(&ab, &ac);
+
+	Vec3 acNormal = manVec3.cross(&abc, &ac);
+	Vec3 abNormal = manVec3.cross(&ab, &abc);
+
+	if (sameDirection(&acNormal, &ao)) {
+		if (sameDirection(&ac, &ao)) {
+			simplex->points[1] = c;
+			simplex->count = 2;
+			*direction = tripleCross(&ac, &ao, &ac);
+		} else {
+			simplex->count = 2;
+			doLine(simplex, direction);
+		}
+	} else if (sameDirection(&abNormal, &ao)) {
+		simplex->count = 2;
+		doLine(simplex, direction);
+	} else if (sameDirection(&abc, &ao)) {
+		*direction = abc;
+	} else {
+		//Below the triangle, flip it so the winding faces the origin.
+		simplex->points[1] = c;
+		simplex->points[2] = b;
+		*direction = manVec3.invert(&abc);
+	}
+}
+
+static bool doTetrahedron(GJKSimplex* simplex, Vec3* direction) {
+	Vec3 a = simplex->points[0];
+	Vec3 b = simplex->points[1];
+	Vec3 c = simplex->points[2];
+	Vec3 d = simplex->points[3];
+	Vec3 ab = manVec3.sub(&b, &a);
+	Vec3 ac = manVec3.sub(&c, &a);
+	Vec3 ad = manVec3.sub(&d, &a);
+	Vec3 ao = manVec3.invert(&a);
+
+	Vec3 abc = manVec3.cross(&ab, &ac);
+	Vec3 acd = manVec3.cross(&ac, &ad);
+	Vec3 adb = manVec3.cross(&ad, &ab);
+
+	simplex->count = 3;
+	if (sameDirection(&abc, &ao)) {
+		doTriangle(simplex, direction);
+		return false;
+	}
+
+	if (sameDirection(&acd, &ao)) {
+		simplex->points[1] = c;
+		simplex->points[2] = d;
+		doTriangle(simplex, direction);
+		return false;
+	}
+
+	if (sameDirection(&adb, &ao)) {
+		simplex->points[1] = d;
+		simplex->points[2] = b;
+		doTriangle(simplex, direction);
+		return false;
+	}
+
+	simplex->count = 4;
+	return true;
+}
+
+static bool intersect(SATMesh* mesh1, SATMesh* mesh2, GJKSimplex* simplex) {
+	Vec3 direction = manVec3.sub(&mesh2->verts[0], &mesh1->verts[0]);
+	if (manVec3.dot(&direction, &direction) == 0)
+		direction = manVec3.create(NULL, 1, 0, 0);
+
+	simplex->supportCalls = 0;
+	simplex->points[0] = supportDifference(mesh1, mesh2, &direction, simplex);
+	simplex->count = 1;
+	direction = manVec3.invert(&simplex->points[0]);
+
+	for(int i = 0; i < GJK_MAX_ITERATIONS; i++) {
+		//The origin is on the simplex, so the meshes at least touch. EPA sorts out how deep.
+		if (manVec3.dot(&direction, &direction) == 0)
+			return true;
+
+		Vec3 point = supportDifference(mesh1, mesh2, &direction, simplex);
+		if (manVec3.dot(&point, &direction) <= 0)
+			return false;
+
+		for(int p = simplex->count; p > 0; p--)
+			simplex->points[p] = simplex->points[p-1];
+		simplex->points[0] = point;
+		simplex->count++;
+
+		if (simplex->count == 2)
+			doLine(simplex, &direction);
+		else if (simplex->count == 3)
+			doTriangle(simplex, &direction);
+		else if (doTetrahedron(simplex, &direction))
+			return true;
+	}
+
+	return false;
+}
+
+/*
+ * GJK can finish on fewer than 4 points when the origin lies on the simplex. Adds support
+ * points until it is a tetrahedron with volume, as EPA needs one to start from.
+ */
+static bool completeSimplex(SATMesh* mesh1, SATMesh* mesh2, GJKSimplex* simplex) {
+	static const Vec3 directions[6] = {{1,0,0}, {-1,0,0}, {0,1,0}, {0,-1,0}, {0,0,1}, {0,0,-1}};
+	const scalar epsilon = 1e-6;
+
+	for(int d = 0; d < 6 && simplex->count < 4; d++) {
+		Vec3 direction = directions[d];
+
+		//Search off the line or plane the simplex spans, if it does.
+		if (simplex->count == 2) {
+			Vec3 line = manVec3.sub(&simplex->points[1], &simplex->points[0]);
+			direction = manVec3.cross(&line, &directions[d]);
+		} else if (simplex->count == 3) {
+			Vec3 ab = manVec3.sub(&simplex->points[1], &simplex->points[0]);
+			Vec3 ac = manVec3.sub(&simplex->points[2], &simplex->points[0]);
+			direction = manVec3.cross(&ab, &ac);
+			if (d%2 == 1)
+				direction = manVec3.invert(&direction);
+		}
+
+		if (manVec3.dot(&direction, &direction) < epsilon)
+			continue;
+
+		Vec3 point = supportDifference(mesh1, mesh2, &direction, simplex);
+
+		bool adds = false;
+		if (simplex->count == 1) {
+			Vec3 offset = manVec3.sub(&point, &simplex->points[0]);
+			adds = manVec3.dot(&offset, &offset) > epsilon;
+		} else if (simplex->count == 2) {
+			Vec3 line = manVec3.sub(&simplex->points[1], &simplex->points[0]);
+			Vec3 offset = manVec3.sub(&point, &simplex->points[0]);
+			Vec3 area = manVec3.cross(&line, &offset);
+			adds = manVec3.dot(&area, &area) > epsilon;
+		} else {
+			Vec3 ab = manVec3.sub(&simplex->points[1], &simplex->points[0]);
+			Vec3 ac = manVec3.sub(&simplex->points[2], &simplex->points[0]);
+			Vec3 normal = manVec3.cross(&ab, &ac);
+			Vec3 offset = manVec3.sub(&point, &simplex->points[0]);
+			adds = fabs(manVec3.dot(&normal, &offset)) > epsilon;
+		}
+
+		if (adds) {
+			simplex->points[simplex->count++] = point;
+			//Start the directions over, the next point needs one off the new span.
+			d = -1;
+		}
+	}
+
+	return simplex->count == 4;
+}
+
+static bool makeFace(EPAFace* face, Vec3* points, int a, int b, int c) {
+	Vec3 ab = manVec3.sub(&points[b], &points[a]);
+	Vec3 ac = manVec3.sub(&points[c], &points[a]);
+	Vec3 normal = manVec3.cross(&ab, &ac);
+	scalar length = manVec3.magnitude(&normal);
+
+	if (length == 0)
+		return false;
+
+	face->normal = manVec3.postMulScalar(&normal, 1/length);
+	face->distance = manVec3.dot(&face->normal, &points[a]);
+	face->a = a;
+	face->b = b;
+	face->c = c;
+
+	//Wind the face so its normal points away from the origin, which is inside the polytope.
+	if (face->distance < 0) {
+		face->normal = manVec3.invert(&face->normal);
+		face->distance = -face->distance;
+		face->b = c;
+		face->c = b;
+	}
+
+	return true;
+}
+
+/*
+ * Adds the edge to the horizon, or removes it if the face on its other side was also removed,
+ * so the horizon ends up as the loop of edges around the removed faces.
+ */
+static void addHorizonEdge(EPAEdge* edges, int* edgeCount, int a, int b) {
+	for(int i = 0; i < *edgeCount; i++) {
+		if (edges[i].a == b && edges[i].b == a) {
+			edges[i] = edges[--(*edgeCount)];
+			return;
+		}
+	}
+
+	edges[*edgeCount].a = a;
+	edges[*edgeCount].b = b;
+	(*edgeCount)++;
+}
+
+static bool penetration(SATMesh* mesh1, SATMesh* mesh2, GJKSimplex* simplex, Vec3* normal, scalar* depth) {
+	if (simplex->count < 4 && !completeSimplex(mesh1, mesh2, simplex))
+		return false;
+
+	Vec3 points[EPA_MAX_ITERATIONS + 4];
+	EPAFace faces[EPA_MAX_FACES];
+	EPAEdge edges[EPA_MAX_FACES*3];
+	int pointCount = 4;
+	int faceCount = 0;
+
+	for(int i = 0; i < 4; i++)
+		points[i] = simplex->points[i];
+
+	static const int tetrahedron[4][3] = {{0, 1, 2}, {0, 3, 1}, {0, 2, 3}, {1, 3, 2}};
+	for(int f = 0; f < 4; f++) {
+		if (makeFace(&faces[faceCount], points, tetrahedron[f][0], tetrahedron[f][1], tetrahedron[f][2]))
+			faceCount++;
+	}
+
+	if (faceCount < 4)
+		return false;
+
+	int closest = 0;
+	for(int iteration = 0; ; iteration++) {
+		closest = 0;
+		for(int f = 1; f < faceCount; f++) {
+			if (faces[f].distance < faces[closest].distance)
+				closest = f;
+		}
+
+		if (iteration == EPA_MAX_ITERATIONS)
+			break;
+
+		Vec3 searchNormal = faces[closest].normal;
+		Vec3 point = supportDifference(mesh1, mesh2, &searchNormal, simplex);
+
+		//The closest face is on the boundary of the difference, it can't be pushed out any further.
+		if (manVec3.dot(&point, &searchNormal) - faces[closest].distance < EPA_TOLERANCE)
+			break;
+
+		//Remove every face the new point can see, keeping the loop of edges around them.
+		int edgeCount = 0;
+		for(int f = 0; f < faceCount; f++) {
+			Vec3 offset = manVec3.sub(&point, &points[faces[f].a]);
+			if (manVec3.dot(&faces[f].normal, &offset) > 0) {
+				addHorizonEdge(edges, &edgeCount, faces[f].a, faces[f].b);
+				addHorizonEdge(edges, &edgeCount, faces[f].b, faces[f].c);
+				addHorizonEdge(edges, &edgeCount, faces[f].c, faces[f].a);
+				faces[f--] = faces[--faceCount];
+			}
+		}
+
+		if (faceCount + edgeCount > EPA_MAX_FACES)
+			break;
+
+		points[pointCount] = point;
+		for(int e = 0; e < edgeCount; e++) {
+			if (makeFace(&faces[faceCount], points, edges[e].a, edges[e].b, pointCount))
+				faceCount++;
+		}
+		pointCount++;
+
+		if (faceCount == 0)
+			return false;
+	}
+
+	*normal = manVec3.invert(&faces[closest].normal);
+	*depth = faces[closest].distance;
+
+	return true;
+}
+
+const GJKManager gjk = {support, intersect, penetration};
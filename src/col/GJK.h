@@ -0,0 +1,67 @@
+#ifndef COH_GJK_H
+#define COH_GJK_H
+
+#include <stdbool.h>
+#include "math/Vec3.h"
+#include "col/SAT.h"
+
+/** Most points GJK adds before giving up, only reached on degenerate input. **/
+#define GJK_MAX_ITERATIONS 64
+/** Most points EPA adds to the polytope before taking the closest face it has. **/
+#define EPA_MAX_ITERATIONS 64
+/** Most faces the EPA polytope can have. **/
+#define EPA_MAX_FACES 256
+/** How close, in units, EPA must get to the true penetration depth. **/
+#define EPA_TOLERANCE 1e-4
+
+/**
+ *	The points of the Minkowski difference GJK has kept, from 1 to 4 of them.
+ * 	A tetrahedron around the origin when the meshes intersect, which EPA starts from.
+ */
+typedef struct GJKSimplex_s {
+	Vec3 points[4];
+	int count;
+	/** Number of times either mesh's support function has been called, by GJK and EPA together. **/
+	int supportCalls;
+	/**
+	 * The vertex of each mesh the last support point came from. The next search on that mesh starts there,
+	 * so set both before intersect, to 0 or to where an earlier test of the same meshes finished.
+	 */
+	int vertex1;
+	int vertex2;
+} GJKSimplex;
+
+/**
+ *	Manager for Gilbert-Johnson-Keerthi intersection tests, and finding penetration with the
+ * 	Expanding Polytope Algorithm. Both only touch the meshes through their support functions,
+ * 	so their cost grows with how many times those are called rather than with face count.
+ * 	The meshes must be convex, the normals are not used.
+ */
+typedef struct GJKManager_s {
+	/**
+	 *	Finds the vertex of the mesh furthest along a direction.
+	 */
+	Vec3(* support)(SATMesh* mesh, Vec3* direction);
+
+	/**
+	 *	Whether two convex meshes overlap. Meshes only touching don't.
+	 *
+	 * 	@param 	simplex 	Its vertex1 and vertex2 must be set. Filled with the simplex GJK finished on,
+	 * 						pass it to penetration if they overlap.
+	 */
+	bool(* intersect)(SATMesh* mesh1, SATMesh* mesh2, GJKSimplex* simplex);
+
+	/**
+	 *	Finds the shortest way to separate two overlapping meshes.
+	 *
+	 * 	@param 	simplex 	The simplex intersect finished on.
+	 * 	@param 	normal 		Set to the unit direction to move mesh2 in to separate them.
+	 * 	@param 	depth 		Set to how far mesh2 must move along normal.
+	 * 	@return 			false if the simplex was too degenerate to find a depth from.
+	 */
+	bool(* penetration)(SATMesh* mesh1, SATMesh* mesh2, GJKSimplex* simplex, Vec3* normal, scalar* depth);
+} GJKManager;
+
+extern const GJKManager gjk;
+
+#endif
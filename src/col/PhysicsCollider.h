@@ -11,6 +11,12 @@ typedef enum COL_TYPE_E {
 	COL_TYPE_COMPLEX_MESH
 } COL_TYPE;
 
+/** Which test finds whether two meshes collide. A pair uses GJK if either collider asks for it. **/
+typedef enum COL_NARROWPHASE_E {
+	COL_NARROWPHASE_SAT,
+	COL_NARROWPHASE_GJK
+} COL_NARROWPHASE;
+
 typedef struct PhysicsCollider_s {
 	Vec3* position;
 	Vec3* rotation;
@@ -22,6 +28,12 @@ typedef struct PhysicsCollider_s {
 	ColliderSimpleMesh nPhase;
 
 	bool immovable;
+	/** The narrowphase test to use against this collider, SAT unless set. **/
+	COL_NARROWPHASE narrowphase;
+	/** Whether to sweep the collider along its motion each tick, so it can't pass through thin colliders when moving fast. **/
+	bool continuous;
+	/** Whether the collider's body is at rest and being skipped, set by the CollisionResolver it is in. **/
+	bool sleeping;
 } PhysicsCollider;
 
 typedef struct PhysicsColliderManager_s {
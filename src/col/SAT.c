@@ -57,6 +57,56 @@ static void satProjectMesh(SATProjection* proj, SATMesh* mesh) {
 	proj->pntMax = mesh->verts[maxID];
 }
 
+static int satSupport(SATMesh* mesh, Vec3* direction, int start) {
+	bool climbs = (mesh->adjacency != NULL) && (mesh->vCount >= SAT_CLIMB_MIN_VERTS) && (start >= 0) &&
+	              (start < mesh->vCount) && (mesh->adjacencyStart[start] < mesh->adjacencyStart[start+1]);
+
+	if (!climbs) {
+		int best = 0;
+		scalar bestDot = manVec3.dot(&mesh->verts[0], direction);
+		for(int i = 1; i < mesh->vCount; i++) {
+			scalar dot = manVec3.dot(&mesh->verts[i], direction);
+			if (dot > bestDot) {
+				bestDot = dot;
+				best = i;
+			}
+		}
+		return best;
+	}
+
+	//On a convex hull a vertex with no neighbour further along is the furthest of all.
+	int current = start;
+	scalar currentDot = manVec3.dot(&mesh->verts[current], direction);
+	for(;;) {
+		int next = current;
+		for(int i = mesh->adjacencyStart[current]; i < mesh->adjacencyStart[current+1]; i++) {
+			scalar dot = manVec3.dot(&mesh->verts[mesh->adjacency[i]], direction);
+			if (dot > currentDot) {
+				currentDot = dot;
+				next = mesh->adjacency[i];
+			}
+		}
+
+		if (next == current)
+			return current;
+		current = next;
+	}
+}
+
+static void satProjectMeshFrom(SATProjection* proj, SATMesh* mesh, int* minVert, int* maxVert) {
+	if ((mesh->adjacency == NULL) || (mesh->vCount < SAT_CLIMB_MIN_VERTS)) {
+		satProjectMesh(proj, mesh);
+		return;
+	}
+
+	Vec3 opposite = manVec3.invert(&proj->axis);
+	*minVert = satSupport(mesh, &opposite, *minVert);
+	*maxVert = satSupport(mesh, &proj->axis, *maxVert);
+
+	satProjectPoint(proj, &mesh->verts[*minVert]);
+	satProjectPoint(proj, &mesh->verts[*maxVert]);
+}
+
 static SATOverlap satOverlap(SATProjection* p1, SATProjection* p2){
 	assert(p1->axis.x == p2->axis.x && "SAT Axis Mismatch.");
 	assert(p1->axis.y == p2->axis.y && "SAT Axis Mismatch.");
@@ -147,4 +197,4 @@ static SATOverlap satOverlap(SATProjection* p1, SATProjection* p2){
 	return ol;
 }
 
-const SATManager sat = {satProjectPoint, satProjectSphere, satProjectMesh, satOverlap};
+const SATManager sat = {satProjectPoint, satProjectSphere, satProjectMesh, satSupport, satProjectMeshFrom, satOverlap};
@@ -4,6 +4,13 @@
 #include <stdbool.h>
 #include "math/Vec3.h"
 
+/**
+ * Meshes with fewer vertices are projected by trying them all, which is quicker than climbing so few.
+ * Timing a projection of hulls of 8 to 64 vertices both ways, climbing from the last one's vertices,
+ * puts the crossover between 20 and 24 vertices.
+ **/
+#define SAT_CLIMB_MIN_VERTS 24
+
 /**
  *	Seperating Axis Theorum projection.
  */	
@@ -38,6 +45,12 @@ typedef struct SATMesh_s {
 	int vCount;
 	Vec3* norms;
 	int nCount;
+	/**
+	 * The vertices joined to vertex i by an edge of the mesh's convex hull are adjacency[adjacencyStart[i]]
+	 * up to adjacency[adjacencyStart[i+1]]. Both are NULL when the hull hasn't been built.
+	 */
+	int* adjacencyStart;
+	int* adjacency;
 } SATMesh;
 
 /**
@@ -47,6 +60,21 @@ typedef struct SATManager_s {
 	void(* projectPoint)(SATProjection* proj, Vec3* point);
 	void(* projectSphere)(SATProjection* proj, SATSphere* sphere);
 	void(* projectMesh)(SATProjection* proj, SATMesh* mesh);
+
+	/**
+	 *	Finds the index of the vertex furthest along a direction. When the mesh has adjacency and at least
+	 * 	SAT_CLIMB_MIN_VERTS vertices this climbs the hull from start towards the direction, so it is cheapest
+	 * 	when start is the result of a nearby direction. Otherwise, or when start isn't on the hull,
+	 * 	every vertex is tried.
+	 */
+	int(* support)(SATMesh* mesh, Vec3* direction, int start);
+
+	/**
+	 *	Projects a mesh using support, starting from and updating minVert and maxVert,
+	 * 	so projecting onto a run of similar axes reuses the last result. Meshes support
+	 * 	wouldn't climb are projected with projectMesh.
+	 */
+	void(* projectMeshFrom)(SATProjection* proj, SATMesh* mesh, int* minVert, int* maxVert);
 	SATOverlap(* overlap)(SATProjection* p1, SATProjection* p2);
 } SATManager;
 
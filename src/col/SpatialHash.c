@@ -0,0 +1,255 @@
+#include "SpatialHash.h"
+
+#include <math.h>
+#include <stdlib.h>
+
+static void findPairs(void* const self, ColliderSphere* bounds, int count, DynamicArray* pairs);
+static void deleteBroadphase(void* const self);
+
+static SpatialHash* new(scalar cellSize) {
+	SpatialHash* hash = malloc(sizeof(SpatialHash));
+
+	hash->cellSize = cellSize;
+	hash->activeCellSize = cellSize;
+
+	hash->entries = NULL;
+	hash->sorted = NULL;
+	hash->entryCount = 0;
+	hash->entryCapacity = 0;
+
+	hash->bucketStart = NULL;
+	hash->bucketCount = 0;
+
+	hash->minCells = NULL;
+	hash->oversized = NULL;
+	hash->colliderCapacity = 0;
+	hash->oversizedCount = 0;
+
+	hash->broadphase.self = hash;
+	hash->broadphase.jobSystem = NULL;
+	hash->broadphase.resting = NULL;
+	hash->broadphase.findPairs = findPairs;
+	hash->broadphase.delete = deleteBroadphase;
+
+	return hash;
+}
+
+static void delete(SpatialHash* hash) {
+	free(hash->entries);
+	free(hash->sorted);
+	free(hash->bucketStart);
+	free(hash->minCells);
+	free(hash->oversized);
+
+	hash->entries = NULL;
+	hash->sorted = NULL;
+	hash->bucketStart = NULL;
+	hash->minCells = NULL;
+	hash->oversized = NULL;
+	hash->entryCapacity = 0;
+	hash->colliderCapacity = 0;
+	hash->bucketCount = 0;
+}
+
+static void deleteBroadphase(void* const self) {
+	Broadphase* broadphase = (Broadphase*)self;
+	delete((SpatialHash*)broadphase->self);
+}
+
+static int toCell(scalar value, scalar cellSize) {
+	return (int)floor(value/cellSize);
+}
+
+static unsigned int hashCell(int x, int y, int z, int bucketCount) {
+	unsigned int h = ((unsigned int)x*73856093u) ^ ((unsigned int)y*19349663u) ^ ((unsigned int)z*83492791u);
+	return h & (unsigned int)(bucketCount-1);
+}
+
+static void reserveColliders(SpatialHash* hash, int count) {
+	if (count > hash->colliderCapacity) {
+		hash->colliderCapacity = count;
+		hash->minCells = realloc(hash->minCells, sizeof(int)*3*count);
+		hash->oversized = realloc(hash->oversized, sizeof(int)*count);
+	}
+}
+
+static void pushEntry(SpatialHash* hash, int x, int y, int z, int collider) {
+	if (hash->entryCount >= hash->entryCapacity) {
+		hash->entryCapacity = hash->entryCapacity == 0 ? 64 : hash->entryCapacity*2;
+		hash->entries = realloc(hash->entries, sizeof(SpatialHashEntry)*hash->entryCapacity);
+		hash->sorted = realloc(hash->sorted, sizeof(SpatialHashEntry)*hash->entryCapacity);
+	}
+
+	SpatialHashEntry* entry = &hash->entries[hash->entryCount++];
+	entry->x = x;
+	entry->y = y;
+	entry->z = z;
+	entry->collider = collider;
+}
+
+static scalar pickCellSize(SpatialHash* hash, ColliderSphere* bounds, int count) {
+	if (hash->cellSize > 0)
+		return hash->cellSize;
+
+	scalar total = 0;
+	for(int i = 0; i < count; i++)
+		total += 2*bounds[i].radius;
+
+	scalar mean = count > 0 ? total/count : 1;
+	return mean > 0 ? mean : 1;
+}
+
+static void insertAll(SpatialHash* hash, ColliderSphere* bounds, int count) {
+	scalar cs = hash->activeCellSize;
+
+	hash->entryCount = 0;
+	hash->oversizedCount = 0;
+
+	for(int i = 0; i < count; i++) {
+		ColliderSphere* s = &bounds[i];
+		int minX = toCell(s->center.x - s->radius, cs), maxX = toCell(s->center.x + s->radius, cs);
+		int minY = toCell(s->center.y - s->radius, cs), maxY = toCell(s->center.y + s->radius, cs);
+		int minZ = toCell(s->center.z - s->radius, cs), maxZ = toCell(s->center.z + s->radius, cs);
+
+		hash->minCells[i*3+0] = minX;
+		hash->minCells[i*3+1] = minY;
+		hash->minCells[i*3+2] = minZ;
+
+		long cells = (long)(maxX-minX+1) * (long)(maxY-minY+1) * (long)(maxZ-minZ+1);
+		if (cells > SPATIAL_HASH_MAX_CELLS) {
+			hash->oversized[hash->oversizedCount++] = i;
+			continue;
+		}
+
+		for(int x = minX; x <= maxX; x++)
+			for(int y = minY; y <= maxY; y++)
+				for(int z = minZ; z <= maxZ; z++)
+					pushEntry(hash, x, y, z, i);
+	}
+}
+
+/*
+ * Counting sort of the entries into buckets. Linear in the number of
+ * entries and does not allocate once the tables have grown.
+ */
+static void bucketEntries(SpatialHash* hash) {
+	int wanted = 1;
+	while(wanted < hash->entryCount*2)
+		wanted <<= 1;
+
+	if (wanted > hash->bucketCount) {
+		hash->bucketCount = wanted;
+		hash->bucketStart = realloc(hash->bucketStart, sizeof(int)*(wanted+1));
+	}
+
+	for(int i = 0; i <= hash->bucketCount; i++)
+		hash->bucketStart[i] = 0;
+
+	for(int i = 0; i < hash->entryCount; i++) {
+		SpatialHashEntry* e = &hash->entries[i];
+		hash->bucketStart[hashCell(e->x, e->y, e->z, hash->bucketCount)+1]++;
+	}
+
+	for(int i = 0; i < hash->bucketCount; i++)
+		hash->bucketStart[i+1] += hash->bucketStart[i];
+
+	//Scatter, using bucketStart as the write cursor and restoring it afterwards.
+	for(int i = 0; i < hash->entryCount; i++) {
+		SpatialHashEntry* e = &hash->entries[i];
+		unsigned int b = hashCell(e->x, e->y, e->z, hash->bucketCount);
+		hash->sorted[hash->bucketStart[b]++] = *e;
+	}
+
+	for(int i = hash->bucketCount; i > 0; i--)
+		hash->bucketStart[i] = hash->bucketStart[i-1];
+	hash->bucketStart[0] = 0;
+}
+
+static int maxInt(int a, int b) {
+	return a > b ? a : b;
+}
+
+/*
+ * Two colliders can share several cells. Only report the pair from the cell that holds
+ * the lowest corner of the overlap of their cell ranges so each pair is found once.
+ */
+static bool isOwningCell(SpatialHash* hash, SpatialHashEntry* cell, int c1, int c2) {
+	int* min1 = &hash->minCells[c1*3];
+	int* min2 = &hash->minCells[c2*3];
+
+	return (cell->x == maxInt(min1[0], min2[0])) &&
+	       (cell->y == maxInt(min1[1], min2[1])) &&
+	       (cell->z == maxInt(min1[2], min2[2]));
+}
+
+static void appendPair(DynamicArray* pairs, int c1, int c2) {
+	BroadphasePair pair;
+	pair.collider1 = c1 < c2 ? c1 : c2;
+	pair.collider2 = c1 < c2 ? c2 : c1;
+	manDynamicArray.append(pairs, &pair);
+}
+
+static void findPairs(void* const self, ColliderSphere* bounds, int count, DynamicArray* pairs) {
+	Broadphase* broadphase = (Broadphase*)self;
+	SpatialHash* hash = (SpatialHash*)broadphase->self;
+
+	manDynamicArray.clear(pairs);
+
+	hash->activeCellSize = pickCellSize(hash, bounds, count);
+	reserveColliders(hash, count);
+	insertAll(hash, bounds, count);
+	bucketEntries(hash);
+
+	for(int b = 0; b < hash->bucketCount; b++) {
+		int start = hash->bucketStart[b];
+		int end = hash->bucketStart[b+1];
+
+		for(int i = start; i < end; i++) {
+			SpatialHashEntry* e1 = &hash->sorted[i];
+
+			for(int j = i+1; j < end; j++) {
+				SpatialHashEntry* e2 = &hash->sorted[j];
+
+				//Different cells that hashed to the same bucket.
+				if ((e1->x != e2->x) || (e1->y != e2->y) || (e1->z != e2->z))
+					continue;
+
+				if (manBroadphase.bothResting(broadphase, e1->collider, e2->collider))
+					continue;
+
+				if (!isOwningCell(hash, e1, e1->collider, e2->collider))
+					continue;
+
+				if (manBroadphase.overlaps(&bounds[e1->collider], &bounds[e2->collider]))
+					appendPair(pairs, e1->collider, e2->collider);
+			}
+		}
+	}
+
+	//Oversized colliders skip the grid and are tested against everything.
+	for(int i = 0; i < hash->oversizedCount; i++) {
+		int big = hash->oversized[i];
+
+		for(int j = 0; j < count; j++) {
+			if (j == big)
+				continue;
+
+			//Pairs of oversized colliders are only reported by the earlier one in the list.
+			bool otherOversized = false;
+			for(int k = 0; k < i; k++) {
+				if (hash->oversized[k] == j) {
+					otherOversized = true;
+					break;
+				}
+			}
+
+			if (otherOversized || manBroadphase.bothResting(broadphase, big, j))
+				continue;
+
+			if (manBroadphase.overlaps(&bounds[big], &bounds[j]))
+				appendPair(pairs, big, j);
+		}
+	}
+}
+
+const SpatialHashManager manSpatialHash = {new, delete};
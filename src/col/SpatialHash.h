@@ -0,0 +1,85 @@
+#ifndef COH_SPATIALHASH_H
+#define COH_SPATIALHASH_H
+
+#include "col/Broadphase.h"
+
+/**
+ *	Colliders that would be inserted into more cells than this are
+ *	kept out of the grid and tested against everything instead.
+ */
+#define SPATIAL_HASH_MAX_CELLS 64
+
+/**
+ *	A single (cell, collider) insertion into the hash.
+ */
+typedef struct SpatialHashEntry_s {
+	int x, y, z;
+	int collider;
+} SpatialHashEntry;
+
+/**
+ *	Uniform grid broadphase. Every transformed broadphase sphere is inserted
+ *	into each cell its bounding box touches and only colliders sharing a cell are
+ *	tested against each other.
+ *
+ *	The grid is rebuilt every tick, but all storage is kept between ticks
+ *	so the steady state does not allocate.
+ */
+typedef struct SpatialHash_s {
+	/**
+	 *	Broadphase instance to use.
+	 */
+	Broadphase broadphase;
+
+	/**
+	 *	The size of a cell. If zero or less, the cell size is picked each tick
+	 *	from the mean sphere diameter.
+	 */
+	scalar cellSize;
+
+	/** The cell size used for the last build. **/
+	scalar activeCellSize;
+
+	/** Insertions in the order they were made. **/
+	SpatialHashEntry* entries;
+	/** Insertions grouped by bucket. **/
+	SpatialHashEntry* sorted;
+	int entryCount;
+	int entryCapacity;
+
+	/** Offset of each bucket into sorted, bucketCount+1 long. **/
+	int* bucketStart;
+	int bucketCount;
+
+	/** The lowest cell each collider touches, used to report a pair once. **/
+	int* minCells;
+	int colliderCapacity;
+
+	/** Colliders too large to insert into the grid. **/
+	int* oversized;
+	int oversizedCount;
+} SpatialHash;
+
+/**
+ *	Manager for spatial hash broadphases.
+ */
+typedef struct SpatialHashManager_s {
+	/**
+	 *	Creates a new spatial hash broadphase.
+	 *
+	 *	@param	cellSize	scalar, the width of a grid cell, or 0 to size cells automatically.
+	 *	@return				pointer to SpatialHash, the new spatial hash.
+	 */
+	SpatialHash*(* new)(scalar cellSize);
+
+	/**
+	 *	Frees all memory associated with the spatial hash, not including the hash itself.
+	 *
+	 *	@param	hash	pointer to SpatialHash to delete.
+	 */
+	void(* delete)(SpatialHash* hash);
+} SpatialHashManager;
+
+extern const SpatialHashManager manSpatialHash;
+
+#endif
@@ -0,0 +1,198 @@
+#include "SweepAndPrune.h"
+
+#include <stdlib.h>
+
+static void findPairs(void* const self, ColliderSphere* bounds, int count, DynamicArray* pairs);
+static void deleteBroadphase(void* const self);
+
+static SweepAndPrune* new() {
+	SweepAndPrune* sap = malloc(sizeof(SweepAndPrune));
+
+	for(int a = 0; a < 3; a++)
+		sap->axes[a] = NULL;
+
+	sap->colliderCount = 0;
+	sap->capacity = 0;
+
+	sap->active = NULL;
+	sap->activeIndex = NULL;
+	sap->activeCount = 0;
+
+	sap->lastSwapCount = 0;
+	sap->lastSweepAxis = 0;
+
+	sap->broadphase.self = sap;
+	sap->broadphase.jobSystem = NULL;
+	sap->broadphase.resting = NULL;
+	sap->broadphase.findPairs = findPairs;
+	sap->broadphase.delete = deleteBroadphase;
+
+	return sap;
+}
+
+static void delete(SweepAndPrune* sap) {
+	for(int a = 0; a < 3; a++) {
+		free(sap->axes[a]);
+		sap->axes[a] = NULL;
+	}
+
+	free(sap->active);
+	free(sap->activeIndex);
+	sap->active = NULL;
+	sap->activeIndex = NULL;
+
+	sap->colliderCount = 0;
+	sap->capacity = 0;
+}
+
+static void deleteBroadphase(void* const self) {
+	Broadphase* broadphase = (Broadphase*)self;
+	delete((SweepAndPrune*)broadphase->self);
+}
+
+static scalar axisValue(const Vec3* v, int axis) {
+	return axis == 0 ? v->x : (axis == 1 ? v->y : v->z);
+}
+
+static scalar endpointValue(ColliderSphere* bounds, int id, int axis) {
+	ColliderSphere* s = &bounds[id >> 1];
+	scalar c = axisValue(&s->center, axis);
+	return (id & 1) ? c + s->radius : c - s->radius;
+}
+
+/*
+ * Appends endpoints for colliders added since the last tick.
+ * The insertion sort will move them into place.
+ */
+static void growTo(SweepAndPrune* sap, int count) {
+	if (count > sap->capacity) {
+		int capacity = sap->capacity == 0 ? 16 : sap->capacity;
+		while(capacity < count)
+			capacity *= 2;
+
+		for(int a = 0; a < 3; a++)
+			sap->axes[a] = realloc(sap->axes[a], sizeof(SAPEndpoint)*2*capacity);
+
+		sap->active = realloc(sap->active, sizeof(int)*capacity);
+		sap->activeIndex = realloc(sap->activeIndex, sizeof(int)*capacity);
+		sap->capacity = capacity;
+	}
+
+	for(int a = 0; a < 3; a++) {
+		for(int i = sap->colliderCount; i < count; i++) {
+			sap->axes[a][i*2].id = i*2;
+			sap->axes[a][i*2+1].id = i*2+1;
+		}
+	}
+
+	sap->colliderCount = count;
+}
+
+static int updateAndSort(SAPEndpoint* axis, int endpointCount, ColliderSphere* bounds, int a) {
+	int swaps = 0;
+
+	for(int i = 0; i < endpointCount; i++)
+		axis[i].value = endpointValue(bounds, axis[i].id, a);
+
+	for(int i = 1; i < endpointCount; i++) {
+		SAPEndpoint key = axis[i];
+		int j = i-1;
+
+		//Ties put minimums first so touching extents are still swept as overlapping.
+		while(j >= 0 && ((axis[j].value > key.value) || ((axis[j].value == key.value) && (axis[j].id & 1) && !(key.id & 1)))) {
+			axis[j+1] = axis[j];
+			j--;
+			swaps++;
+		}
+
+		axis[j+1] = key;
+	}
+
+	return swaps;
+}
+
+/*
+ * Picks the axis with the largest spread of sphere centers, as it will have
+ * the fewest overlapping extents to sweep through.
+ */
+static int pickSweepAxis(ColliderSphere* bounds, int count) {
+	scalar sum[3] = {0, 0, 0};
+	scalar sumSq[3] = {0, 0, 0};
+
+	for(int i = 0; i < count; i++) {
+		for(int a = 0; a < 3; a++) {
+			scalar v = axisValue(&bounds[i].center, a);
+			sum[a] += v;
+			sumSq[a] += v*v;
+		}
+	}
+
+	int best = 0;
+	scalar bestVariance = -1;
+	for(int a = 0; a < 3; a++) {
+		scalar mean = count > 0 ? sum[a]/count : 0;
+		scalar variance = count > 0 ? sumSq[a]/count - mean*mean : 0;
+
+		if (variance > bestVariance) {
+			bestVariance = variance;
+			best = a;
+		}
+	}
+
+	return best;
+}
+
+static void sweep(SweepAndPrune* sap, SAPEndpoint* axis, ColliderSphere* bounds, DynamicArray* pairs) {
+	sap->activeCount = 0;
+
+	for(int i = 0; i < sap->colliderCount*2; i++) {
+		int collider = axis[i].id >> 1;
+
+		if (axis[i].id & 1) {
+			//Swap-remove the collider from the active list.
+			int index = sap->activeIndex[collider];
+			int last = sap->active[--sap->activeCount];
+			sap->active[index] = last;
+			sap->activeIndex[last] = index;
+		} else {
+			for(int j = 0; j < sap->activeCount; j++) {
+				int other = sap->active[j];
+
+				if (manBroadphase.bothResting(&sap->broadphase, collider, other))
+					continue;
+
+				if (manBroadphase.overlaps(&bounds[collider], &bounds[other])) {
+					BroadphasePair pair;
+					pair.collider1 = collider < other ? collider : other;
+					pair.collider2 = collider < other ? other : collider;
+					manDynamicArray.append(pairs, &pair);
+				}
+			}
+
+			sap->activeIndex[collider] = sap->activeCount;
+			sap->active[sap->activeCount++] = collider;
+		}
+	}
+}
+
+static void findPairs(void* const self, ColliderSphere* bounds, int count, DynamicArray* pairs) {
+	Broadphase* broadphase = (Broadphase*)self;
+	SweepAndPrune* sap = (SweepAndPrune*)broadphase->self;
+
+	manDynamicArray.clear(pairs);
+
+	//Colliders are never removed from a resolver, but start again if it happens.
+	if (count < sap->colliderCount)
+		sap->colliderCount = 0;
+
+	growTo(sap, count);
+
+	sap->lastSwapCount = 0;
+	for(int a = 0; a < 3; a++)
+		sap->lastSwapCount += updateAndSort(sap->axes[a], count*2, bounds, a);
+
+	sap->lastSweepAxis = pickSweepAxis(bounds, count);
+	sweep(sap, sap->axes[sap->lastSweepAxis], bounds, pairs);
+}
+
+const SweepAndPruneManager manSweepAndPrune = {new, delete};
@@ -0,0 +1,68 @@
+#ifndef COH_SWEEPANDPRUNE_H
+#define COH_SWEEPANDPRUNE_H
+
+#include "col/Broadphase.h"
+
+/**
+ *	One end of a collider's extent along an axis.
+ *	id is collider*2 for the minimum end and collider*2+1 for the maximum end.
+ */
+typedef struct SAPEndpoint_s {
+	scalar value;
+	int id;
+} SAPEndpoint;
+
+/**
+ *	Incremental sweep and prune broadphase.
+ *
+ *	Keeps an array of endpoints sorted along each axis between ticks. Since objects
+ *	only move a little each tick the arrays are nearly sorted already, so they
+ *	are re-sorted with an insertion sort, which is close to linear in that case.
+ *	Pairs are then found by sweeping the axis the colliders are most spread out along.
+ */
+typedef struct SweepAndPrune_s {
+	/**
+	 *	Broadphase instance to use.
+	 */
+	Broadphase broadphase;
+
+	/** Sorted endpoints for the x, y and z axes, each 2*colliderCount long. **/
+	SAPEndpoint* axes[3];
+	/** The number of colliders currently in the endpoint arrays. **/
+	int colliderCount;
+	int capacity;
+
+	/** Colliders whose extents are open during the sweep. **/
+	int* active;
+	/** Where each collider is in active, used for constant time removal. **/
+	int* activeIndex;
+	int activeCount;
+
+	/** Total number of swaps made by the insertion sorts in the last tick. **/
+	int lastSwapCount;
+	/** The axis swept in the last tick. **/
+	int lastSweepAxis;
+} SweepAndPrune;
+
+/**
+ *	Manager for sweep and prune broadphases.
+ */
+typedef struct SweepAndPruneManager_s {
+	/**
+	 *	Creates a new sweep and prune broadphase.
+	 *
+	 *	@return	pointer to SweepAndPrune, the new broadphase.
+	 */
+	SweepAndPrune*(* new)();
+
+	/**
+	 *	Frees all memory associated with the broadphase, not including the broadphase itself.
+	 *
+	 *	@param	sap	pointer to SweepAndPrune to delete.
+	 */
+	void(* delete)(SweepAndPrune* sap);
+} SweepAndPruneManager;
+
+extern const SweepAndPruneManager manSweepAndPrune;
+
+#endif
@@ -2,6 +2,9 @@
 
 #include <stdlib.h>
 
+#include "util/Clock.h"
+#include "util/Profiler.h"
+
 /*
  * Helper funcs
  */
@@ -25,14 +28,18 @@ static void doOnInitMisc(GameLoop* gameloop) {
 		gameloop->onInitMisc(gameloop);
 }
 
-static void doOnRender(GameLoop* gameloop) {
+static void doOnRender(GameLoop* gameloop, float alpha) {
+	PROFILE_BEGIN("onRender");
 	if (gameloop->onRender != NULL)
-		gameloop->onRender(gameloop, gameloop->targetFrameTime);
+		gameloop->onRender(gameloop, alpha);
+	PROFILE_END();
 }
 
 static void doOnUpdate(GameLoop* gameloop) {
+	PROFILE_BEGIN("onUpdate");
 	if (gameloop->onUpdate!=NULL)
 		gameloop->onUpdate(gameloop, gameloop->targetTickTime);
+	PROFILE_END();
 }
 
 static void doOnClose(GameLoop* gameloop) {
@@ -45,6 +52,66 @@ static void doOnDestroy(GameLoop* gameloop) {
 		gameloop->onDestroy(gameloop);
 }
 
+static double getMilliseconds(GameLoop* gameloop) {
+	if (gameloop->headless)
+		return gameloop->headlessTime;
+
+	return manWin.getMilliseconds();
+}
+
+static void countTick(GameLoop* gameloop) {
+	gameloop->tickCount++;
+	double currentTime = getMilliseconds(gameloop);
+	if (currentTime-gameloop->tickStartTime >= 1000) {
+		gameloop->tps = (double)gameloop->tickCount/((currentTime-gameloop->tickStartTime)/1000.0);
+		gameloop->tickStartTime = currentTime;
+		gameloop->tickCount = 0;
+	}
+}
+
+static void countFrame(GameLoop* gameloop) {
+	gameloop->frameCount++;
+	double currentTime = getMilliseconds(gameloop);
+	if (currentTime-gameloop->frameStartTime >= 1000) {
+		gameloop->fps = (double)gameloop->frameCount/((currentTime-gameloop->frameStartTime)/1000.0);
+		gameloop->frameStartTime = currentTime;
+		gameloop->frameCount = 0;
+	}
+}
+
+static void finishProfile() {
+#ifdef COH_PROFILE
+	manProfiler.printStats();
+	manProfiler.writeChromeTrace(PROFILER_TRACE_FILE);
+#endif
+}
+
+static int compareDoubles(const void* a, const void* b) {
+	double da = *(const double*)a;
+	double db = *(const double*)b;
+	return (da > db) - (da < db);
+}
+
+static double percentile(const double* sorted, int count, double fraction) {
+	return sorted[(int)(fraction*(count-1) + 0.5)];
+}
+
+static void calculateTickStats(double* tickTimes, int ticks, TickStats* stats) {
+	qsort(tickTimes, ticks, sizeof(double), compareDoubles);
+
+	double total = 0;
+	for(int i = 0; i < ticks; i++)
+		total += tickTimes[i];
+
+	stats->ticks = ticks;
+	stats->totalTime = total;
+	stats->mean = ticks > 0 ? total/ticks : 0;
+	stats->p50 = ticks > 0 ? percentile(tickTimes, ticks, 0.50) : 0;
+	stats->p95 = ticks > 0 ? percentile(tickTimes, ticks, 0.95) : 0;
+	stats->p99 = ticks > 0 ? percentile(tickTimes, ticks, 0.99) : 0;
+	stats->max = ticks > 0 ? tickTimes[ticks-1] : 0;
+}
+
 /*
  * Manager Functions
  */
@@ -53,26 +120,33 @@ static GameLoop* new(NewCallback* onNew, InitWindowCallback* onInitWindow, InitO
 
 	gameloop->onNew = onNew;
 	gameloop->onInitWindow = onInitWindow;
-	gameloop->onInitOpenGL = onInitMisc;
-	gameloop->onInitMisc = onInitOpenGL;
+	gameloop->onInitOpenGL = onInitOpenGL;
+	gameloop->onInitMisc = onInitMisc;
 	gameloop->onUpdate = onUpdate;
 	gameloop->onRender = onRender;
 	gameloop->onClose = onClose;
 	gameloop->onDestroy = onDestroy;
 
-	gameloop->primaryWindow = manWin.new();
+	//Created by enterGameLoop, so a loop that only runs headless never touches GLFW.
+	gameloop->primaryWindow = NULL;
 
 	gameloop->timeAccumulator = 0;
+	gameloop->lastFrameTime = 0;
 	gameloop->targetFrameTime = targetFrameTime;
 	gameloop->targetTickTime = targetTickTime;
+	gameloop->maxCatchUpTime = 0.25;
 
 	gameloop->extraData = NULL;
 
-	gameloop->frameStartTime = manWin.getMilliseconds();
+	gameloop->headless = false;
+	gameloop->headlessTime = 0;
+
+	//Started again from the loop's clock when the loop is entered or run headless.
+	gameloop->frameStartTime = 0;
 	gameloop->frameCount = 0;
 	gameloop->fps = 0;
 
-	gameloop->tickStartTime = manWin.getMilliseconds();
+	gameloop->tickStartTime = 0;
 	gameloop->tickCount = 0;
 	gameloop->tps = 0;
 
@@ -82,6 +156,9 @@ static GameLoop* new(NewCallback* onNew, InitWindowCallback* onInitWindow, InitO
 }
 
 static void enterGameLoop(GameLoop* gameloop) {
+	if (gameloop->primaryWindow == NULL)
+		gameloop->primaryWindow = manWin.new();
+
 	doOnInitWindow(gameloop);
 
 	if (!manWin.isOpen(gameloop->primaryWindow))
@@ -92,45 +169,88 @@ static void enterGameLoop(GameLoop* gameloop) {
 
 
 	manWin.update(gameloop->primaryWindow);
+	gameloop->timeAccumulator = 0;
+	gameloop->lastFrameTime = getMilliseconds(gameloop);
+	gameloop->frameStartTime = gameloop->lastFrameTime;
+	gameloop->frameCount = 0;
+	gameloop->tickStartTime = gameloop->lastFrameTime;
+	gameloop->tickCount = 0;
 	while(manWin.isOpen(gameloop->primaryWindow)) {
-		doOnRender(gameloop);
+		PROFILE_FRAME_BEGIN();
+		double currentTime = getMilliseconds(gameloop);
+		double frameTime = (currentTime - gameloop->lastFrameTime)/1000.0;
+		gameloop->lastFrameTime = currentTime;
 
-		gameloop->timeAccumulator += gameloop->targetFrameTime;
+		if (frameTime > gameloop->maxCatchUpTime)
+			frameTime = gameloop->maxCatchUpTime;
+		gameloop->timeAccumulator += frameTime;
 
 		while(gameloop->timeAccumulator >= gameloop->targetTickTime) {
 			gameloop->timeAccumulator -= gameloop->targetTickTime;
 
 			doOnUpdate(gameloop);
-
-			gameloop->tickCount++;
-			double currentTime = manWin.getMilliseconds();
-			if (currentTime-gameloop->tickStartTime >= 1000) {
-				gameloop->tps = (double)gameloop->tickCount*((currentTime-gameloop->tickStartTime)/1000.0);
-				gameloop->tickStartTime = currentTime;
-				gameloop->tickCount = 0;
-			}
+			countTick(gameloop);
 		}
+
+		doOnRender(gameloop, gameloop->timeAccumulator/gameloop->targetTickTime);
+
+		PROFILE_BEGIN("windowUpdate");
 		manWin.update(gameloop->primaryWindow);
+		PROFILE_END();
 
+		PROFILE_BEGIN("swapBuffers");
 		manWin.swapBuffers(gameloop->primaryWindow);
+		PROFILE_END();
 
-		gameloop->frameCount++;
-		double currentTime = manWin.getMilliseconds();
-		if (currentTime-gameloop->frameStartTime >= 1000) {
-			gameloop->fps = (double)gameloop->frameCount*((currentTime-gameloop->frameStartTime)/1000.0);
-			gameloop->frameStartTime = currentTime;
-			gameloop->frameCount = 0;
-		}
+		countFrame(gameloop);
+		PROFILE_FRAME_END();
+	}
+
+	finishProfile();
+	doOnClose(gameloop);
+}
+
+static void runHeadless(GameLoop* gameloop, int ticks, TickStats* stats) {
+	gameloop->headless = true;
+	gameloop->headlessTime = 0;
+	gameloop->timeAccumulator = 0;
+	gameloop->frameStartTime = getMilliseconds(gameloop);
+	gameloop->tickStartTime = getMilliseconds(gameloop);
+	gameloop->tickCount = 0;
+	gameloop->tps = 0;
+
+	doOnInitMisc(gameloop);
+
+	//Each tick is timed against the real clock, the fake one only drives the simulation.
+	double* tickTimes = malloc(sizeof(double)*(ticks > 0 ? ticks : 1));
+	for(int i = 0; i < ticks; i++) {
+		PROFILE_FRAME_BEGIN();
+		double start = manClock.getMilliseconds();
+		doOnUpdate(gameloop);
+		tickTimes[i] = manClock.getMilliseconds() - start;
+
+		gameloop->headlessTime += gameloop->targetTickTime*1000.0;
+		countTick(gameloop);
+		PROFILE_FRAME_END();
+	}
+
+	if (stats != NULL) {
+		calculateTickStats(tickTimes, ticks, stats);
+		stats->simulatedTime = gameloop->headlessTime;
 	}
+	free(tickTimes);
 
+	finishProfile();
 	doOnClose(gameloop);
+	gameloop->headless = false;
 }
 
 static void delete(GameLoop* gameloop) {
 	doOnDestroy(gameloop);
 
-	manWin.delete(gameloop->primaryWindow);
+	if (gameloop->primaryWindow != NULL)
+		manWin.delete(gameloop->primaryWindow);
 	free(gameloop);
 }
 
-const GameLoopManager manGameLoop = {new, enterGameLoop, delete};
+const GameLoopManager manGameLoop = {new, enterGameLoop, runHeadless, getMilliseconds, delete};
@@ -21,8 +21,12 @@ typedef void InitMiscCallback(GameLoop* self);
 /** Called everytime the world state should be updated **/
 typedef void UpdateCallback(GameLoop* self, float tickDelta);
 
-/** Called everytime the world should be rendered. **/
-typedef void RenderCallback(GameLoop* self, float frameDelta);
+/**
+ * Called everytime the world should be rendered.
+ * alpha is how far real time is between the last tick and the next, from 0 to 1,
+ * for interpolating between the previous and current state.
+ */
+typedef void RenderCallback(GameLoop* self, float alpha);
 
 /** Called when the main window of a gameloop is closed. **/
 typedef void CloseCallback(GameLoop* self);
@@ -30,6 +34,20 @@ typedef void CloseCallback(GameLoop* self);
 /** Called when the gameloop is being destroyed, being freed. **/
 typedef void DestroyCallback(GameLoop* self);
 
+/** Wall clock statistics for the ticks run by manGameLoop.runHeadless, times are in ms. **/
+typedef struct TickStats_s {
+	int ticks;
+	/** The time the fake clock advanced by. **/
+	double simulatedTime;
+	/** The real time spent in onUpdate. **/
+	double totalTime;
+	double mean;
+	double p50;
+	double p95;
+	double p99;
+	double max;
+} TickStats;
+
 /** Struct containing all the information for a given gameloop **/
 typedef struct GameLoop_s {
 
@@ -42,18 +60,29 @@ typedef struct GameLoop_s {
 	CloseCallback* onClose;
 	DestroyCallback* onDestroy;
 
-	/** The primary window of the gameloop. Safe to swap to any non-null window.**/
+	/**
+	 * The primary window of the gameloop, created by enterGameLoop unless one was set before it.
+	 * NULL until then, and always NULL for a loop only run headless. Safe to swap to any non-null window.
+	 **/
 	Window* primaryWindow;
 
-	/** The internal accumulator used for calculating when to update the world. Not recommended to alter.**/
+	/** The internal accumulator of real time in s not yet simulated. Not recommended to alter.**/
 	double timeAccumulator;
+	/** The time in ms the last frame started at. Not recommended to alter.**/
+	double lastFrameTime;
 
-	/** The target time in ms a frame should take to render. May be changed at runtime. **/
+	/** The target time in s a frame should take to render. Frames are paced by the buffer swap, not this. May be changed at runtime. **/
 	double targetFrameTime;
 
-	/** The target time in ms a tick should take to update. May be changed at runtime. **/
+	/** The time in s each tick simulates, ticks run as often as real time requires. May be changed at runtime. **/
 	double targetTickTime;
 
+	/**
+	 * The most real time in s a single frame can add to the accumulator. If ticks fall behind,
+	 * time past this is dropped so the simulation slows down instead of spiralling. May be changed at runtime.
+	 */
+	double maxCatchUpTime;
+
 	/** FPS **/
 	double frameStartTime;
 	int frameCount;
@@ -64,6 +93,11 @@ typedef struct GameLoop_s {
 	int tickCount;
 	double tps;
 
+	/** Whether the loop is running without a window, in which case time comes from headlessTime. **/
+	bool headless;
+	/** The fake clock in ms used when headless, advanced by targetTickTime every tick. **/
+	double headlessTime;
+
 	/** An anchor point for a loop's extra data. Must be manually freed if used.**/
 	void* extraData;
 } GameLoop;
@@ -72,7 +106,7 @@ typedef struct GameLoop_s {
 typedef struct GameLoopManager_s {
 
 	/**
-	 * Creates a new gameloop.
+	 * Creates a new gameloop. No window is created, and GLFW isn't touched, until enterGameLoop.
 	 *
 	 * @param onNew The function to call when the gameloop is created.
 	 * @param onInit The function to call when the gameloop is being started.
@@ -80,8 +114,8 @@ typedef struct GameLoopManager_s {
 	 * @param onRender The function to call when the gameloop is rendering.
 	 * @param onClose The function to call when the gameloop is closing.
 	 * @param onDestroy The function to call when the gameloop is being destroyed.
-	 * @param targetFrameTime The ideal time it takes to render 1 frame (1/60ms for a 60hz target)
-	 * @param targetTickTime The ideal time it takes to update 1 tick (1/120ms for a 120hz target)
+	 * @param targetFrameTime The ideal time in s it takes to render 1 frame (1/60.0 for a 60hz target)
+	 * @param targetTickTime The time in s each tick simulates (1/120.0 for a 120hz target)
 	 *
 	 * @return The newly constructed gameloop.
 	 */
@@ -94,6 +128,28 @@ typedef struct GameLoopManager_s {
 	 */
 	void(* enterGameLoop)(GameLoop* gameloop);
 
+	/**
+	 * Runs the given game loop for a fixed number of ticks without opening a window.
+	 * Only onInitMisc, onUpdate and onClose are called, and primaryWindow is left NULL,
+	 * so neither GLFW nor an OpenGL context is needed.
+	 * Time comes from a fake clock that advances by targetTickTime every tick, so runs are
+	 * repeatable no matter how long each tick really takes.
+	 *
+	 * @param gameloop The gameloop to run.
+	 * @param ticks The number of ticks to run.
+	 * @param stats Filled with the real time each tick took, may be NULL.
+	 */
+	void(* runHeadless)(GameLoop* gameloop, int ticks, TickStats* stats);
+
+	/**
+	 * Gets the current time of the given loop's clock, the fake clock when running headless.
+	 *
+	 * @param gameloop The gameloop to get the time of.
+	 *
+	 * @return The time in ms.
+	 */
+	double(* getMilliseconds)(GameLoop* gameloop);
+
 	/**
 	 * Destroys the given game loop, freeing it from memory.
 	 *
@@ -2,6 +2,10 @@
 
 #include "render/Renderer.h"
 
+#include <math.h>
+
+#define GAME_OBJECT_TWO_PI 6.28318530717958647692
+
 static GameObject* new(char* name, void* parent, bool hasPhysics, bool hasRender, FuncOnUpdate* onUpdateCallback, FuncOnCollide* onCollideCallback, FuncOnRender* onRenderCallback, ParticleForceRegistry* pfRegistry,  Window* window) {
 	GameObject* gameObject = malloc(sizeof(GameObject));
 	gameObject->name = name;
@@ -14,6 +18,11 @@ static GameObject* new(char* name, void* parent, bool hasPhysics, bool hasRender
 	gameObject->acceleration = manVec3.create(NULL, 0,0,0);
 	gameObject->force = manVec3.create(NULL, 0,0,0);
 
+	gameObject->previousPosition = gameObject->position;
+	gameObject->previousRotation = gameObject->rotation;
+	gameObject->renderPosition = gameObject->position;
+	gameObject->renderRotation = gameObject->rotation;
+
 	if (hasPhysics) {
 		gameObject->particle = manParticle.new(&gameObject->position, &gameObject->velocity, &gameObject->acceleration, &gameObject->force);
 		gameObject->physCollider = manPhysCollider.new(&gameObject->position, &gameObject->rotation, &gameObject->scale, &gameObject->velocity, &gameObject->particle->inverseMass);
@@ -21,9 +30,11 @@ static GameObject* new(char* name, void* parent, bool hasPhysics, bool hasRender
 		gameObject->physCollider = NULL;
 		gameObject->particle = NULL;
 	}
+	gameObject->particleHandle = PARTICLE_HANDLE_NONE;
+	gameObject->colliderIndex = -1;
 
 	if (hasRender) {
-		gameObject->render = manRenderObj.new(&gameObject->position, &gameObject->rotation, &gameObject->scale);
+		gameObject->render = manRenderObj.new(&gameObject->renderPosition, &gameObject->renderRotation, &gameObject->scale);
 	} else {
 		gameObject->render = NULL;
 	}
@@ -49,15 +60,42 @@ static void collide(GameObject* gameObject, GameObject* other) {
 		gameObject->onCollideCallback(gameObject, other);
 }
 
-static void render(GameObject* gameObject, float frameDelta, Shader* shader, MatrixManager* matMan) {
+static Vec3 interpolate(Vec3* previous, Vec3* current, float alpha) {
+	Vec3 delta = manVec3.sub(current, previous);
+	delta = manVec3.postMulScalar(&delta, alpha);
+	return manVec3.sum(previous, &delta);
+}
+
+/*
+ * Interpolates each angle the short way round, so an angle set from -pi to just under pi turns a little
+ * rather than nearly a whole turn back.
+ */
+static Vec3 interpolateAngles(Vec3* previous, Vec3* current, float alpha) {
+	Vec3 delta = manVec3.sub(current, previous);
+	delta.x = remainder(delta.x, GAME_OBJECT_TWO_PI);
+	delta.y = remainder(delta.y, GAME_OBJECT_TWO_PI);
+	delta.z = remainder(delta.z, GAME_OBJECT_TWO_PI);
+	delta = manVec3.postMulScalar(&delta, alpha);
+	return manVec3.sum(previous, &delta);
+}
+
+static void render(GameObject* gameObject, float alpha, Shader* shader, MatrixManager* matMan) {
+	gameObject->renderPosition = interpolate(&gameObject->previousPosition, &gameObject->position, alpha);
+	gameObject->renderRotation = interpolateAngles(&gameObject->previousRotation, &gameObject->rotation, alpha);
+
 	if (gameObject->onRenderCallback != NULL)
-		gameObject->onRenderCallback(gameObject, frameDelta, shader, matMan);
+		gameObject->onRenderCallback(gameObject, alpha, shader, matMan);
 
 	if (gameObject->render!=NULL) {
 		manRenderer.renderModel(gameObject->render, shader, matMan);
 	}
 }
 
+static void storePreviousState(GameObject* gameObject) {
+	gameObject->previousPosition = gameObject->position;
+	gameObject->previousRotation = gameObject->rotation;
+}
+
 //Internals
 static void setPhysicsCollider(GameObject* gameObject, PhysicsCollider* collider) {
 	if (gameObject->physCollider!=NULL) {
@@ -194,12 +232,13 @@ static void addForceVec(GameObject* gameObject, Vec3* force) {
 	addForceXYZ(gameObject, force->x, force->y, force->z);
 }
 
-static void addForceGenerator(GameObject* gameObject, ParticleForceGenerator* forceGenerator) {
+static ParticleForceHandle addForceGenerator(GameObject* gameObject, ParticleForceGenerator* forceGenerator) {
 	if (gameObject->particle!=NULL)
-		manForceRegistry.add(gameObject->pfRegistry, gameObject->particle, forceGenerator);
+		return manForceRegistry.add(gameObject->pfRegistry, gameObject->particle, forceGenerator);
+	return NULL;
 }
 
 static void delete(GameObject* gameObject) {
 }
 
-const GameObjectManager manGameObj = {new, update, collide, render, setPhysicsCollider, setModel, setPositionXYZ, addPositionXYZ, setPositionVec, addPositionVec, setScaleXYZ, addScaleXYZ, setScaleVec, addScaleVec, setRotationXYZ, addRotationXYZ, setRotationVec, addRotationVec, setVelocityXYZ, addVelocityXYZ, setVelocityVec, addVelocityVec, setAccelerationXYZ, addAccelerationXYZ, setAccelerationVec, addAccelerationVec, setForceXYZ, addForceXYZ, setForceVec, addForceVec, addForceGenerator, delete};
+const GameObjectManager manGameObj = {new, update, collide, render, storePreviousState, setPhysicsCollider, setModel, setPositionXYZ, addPositionXYZ, setPositionVec, addPositionVec, setScaleXYZ, addScaleXYZ, setScaleVec, addScaleVec, setRotationXYZ, addRotationXYZ, setRotationVec, addRotationVec, setVelocityXYZ, addVelocityXYZ, setVelocityVec, addVelocityVec, setAccelerationXYZ, addAccelerationXYZ, setAccelerationVec, addAccelerationVec, setForceXYZ, addForceXYZ, setForceVec, addForceVec, addForceGenerator, delete};
@@ -8,6 +8,7 @@
 #include "render/RenderObject.h"
 #include "render/MatrixManager.h"
 #include "physics/Particle.h"
+#include "physics/ParticleSystem.h"
 #include "physics/ParticleForceRegistry.h"
 #include "physics/ParticleForceGenerator.h"
 #include "glfw/Display.h"
@@ -18,8 +19,8 @@ typedef struct GameObject_s GameObject;
 typedef void FuncOnUpdate(GameObject* self, float tickDelta);
 /** The function callback for collisions **/
 typedef void FuncOnCollide(GameObject* self, GameObject* other);
-/** The function callback for rendering **/
-typedef void FuncOnRender(GameObject* self, float frameDelta, Shader* shader, MatrixManager* matMan);
+/** The function callback for rendering, alpha is how far between the previous and current tick to draw. **/
+typedef void FuncOnRender(GameObject* self, float alpha, Shader* shader, MatrixManager* matMan);
 
 typedef struct GameObject_s {
 	/** The name of the object, used for identification **/
@@ -34,6 +35,16 @@ typedef struct GameObject_s {
 	/** The size fo the object **/
 	Vec3 scale;
 
+	/** The position and orientation at the start of the last tick. **/
+	Vec3 previousPosition;
+	Vec3 previousRotation;
+	/**
+	 * The position and orientation interpolated for rendering, what the renderObject draws at. Each angle
+	 * is interpolated the shortest way round, so it can differ from rotation by whole turns.
+	 **/
+	Vec3 renderPosition;
+	Vec3 renderRotation;
+
 	/** The speed in m/s the object is moving at. **/
 	Vec3 velocity;
 	/** The speed in m/s/s the object is accelerating at. **/
@@ -43,8 +54,12 @@ typedef struct GameObject_s {
 
 	/** The collider of the object **/
 	PhysicsCollider* physCollider;
+	/** The index of the collider in the registry's CollisionResolver, set when the object is registered. -1 if it has none. **/
+	int colliderIndex;
 	/** The physics particle of the object **/
 	Particle* particle;
+	/** The handle of the particle in the registry's ParticleSystem, set when the object is registered. **/
+	ParticleHandle particleHandle;
 	/** The renderObject of the object **/
 	RenderObject* render;
 
@@ -68,7 +83,9 @@ typedef struct GameObjectManager_s {
 	//Functions
 	void(* update)(GameObject* gameObject, float tickDelta);
 	void(* collide)(GameObject* gameObject, GameObject* other);
-	void(* render)(GameObject* gameObject, float frameDelta, Shader* shader, MatrixManager* matMan);
+	void(* render)(GameObject* gameObject, float alpha, Shader* shader, MatrixManager* matMan);
+	/** Remembers the current position and orientation as the state rendering interpolates from. **/
+	void(* storePreviousState)(GameObject* gameObject);
 
 	//Internals
 	void(* setPhysicsCollider)(GameObject* gameObject, PhysicsCollider* collider);
@@ -106,7 +123,7 @@ typedef struct GameObjectManager_s {
 	void(* setForceVec)(GameObject* gameObject, Vec3* force);
 	void(* addForceVec)(GameObject* gameObject, Vec3* force);
 
-	void(* addForceGenerator)(GameObject* gameObject, ParticleForceGenerator* forceGenerator);
+	ParticleForceHandle(* addForceGenerator)(GameObject* gameObject, ParticleForceGenerator* forceGenerator);
 
 	void(* delete)(GameObject* gameObject);
 } GameObjectManager;
@@ -2,6 +2,11 @@
 
 #include "col/CollisionResolver.h"
 #include "col/CollisionDetection.h"
+#include "util/Profiler.h"
+#include "util/MemUtil.h"
+
+#include <stdint.h>
+#include <string.h>
 
 GameObjectRegist* new(MatrixManager* matMan) {
 	GameObjectRegist* regist = malloc(sizeof(GameObjectRegist));
@@ -9,7 +14,16 @@ GameObjectRegist* new(MatrixManager* matMan) {
 	regist->matMan = matMan;
 	regist->gameObjects = manDynamicArray.new(1, sizeof(GameObject*));
 	regist->pfRegistry = manForceRegistry.new();
+	regist->particleSystem = manParticleSystem.new(16);
 	regist->collisionResolver = manColResolver.new();
+	regist->jobSystem = NULL;
+	regist->objectForces = manDynamicArray.new(1, sizeof(Vec3));
+	regist->tickDelta = 0;
+	regist->particleIndex.particles = NULL;
+	regist->particleIndex.objects = NULL;
+	regist->particleIndex.mask = 0;
+	regist->particleIndex.count = 0;
+	regist->forceGeneratorIds = manDynamicArray.new(2, sizeof(ForceGeneratorId));
 
 	return regist;
 }
@@ -17,7 +31,10 @@ GameObjectRegist* new(MatrixManager* matMan) {
 void add(GameObjectRegist* regist, GameObject* gameObject) {
 	gameObject->pfRegistry = regist->pfRegistry;
 	manDynamicArray.append(regist->gameObjects, &gameObject);
-	manColResolver.addCollider(regist->collisionResolver, gameObject->physCollider);
+	manGameObj.storePreviousState(gameObject);
+	if (gameObject->particle != NULL)
+		gameObject->particleHandle = manParticleSystem.add(regist->particleSystem);
+	gameObject->colliderIndex = manColResolver.addCollider(regist->collisionResolver, gameObject->physCollider);
 }
 
 void setShader(GameObjectRegist* regist, Shader* shader) {
@@ -28,50 +45,588 @@ void setMatrixManager(GameObjectRegist* regist, MatrixManager* matMan) {
 	regist->matMan = matMan;
 }
 
+void setJobSystem(GameObjectRegist* regist, JobSystem* jobs) {
+	regist->jobSystem = jobs;
+	manParticleSystem.setJobSystem(regist->particleSystem, jobs);
+	manColResolver.setJobSystem(regist->collisionResolver, jobs);
+}
+
+void setForceGeneratorId(GameObjectRegist* regist, ParticleForceGenerator* generator, int id) {
+	//Any id the generator had, and any generator that had the id, are forgotten.
+	ForceGeneratorId* ids = (ForceGeneratorId*)regist->forceGeneratorIds->contents;
+	for(int i = 0; i < regist->forceGeneratorIds->size; i++) {
+		if (ids[i].generator == generator || ids[i].id == id)
+			ids[i--] = ids[--regist->forceGeneratorIds->size];
+	}
+
+	ForceGeneratorId entry = {generator, id};
+	manDynamicArray.append(regist->forceGeneratorIds, &entry);
+}
+
 GameObject* getGameObject(GameObjectRegist* regist, int id) {
 	return *((GameObject**) manDynamicArray.get(regist->gameObjects, id));
 }
 
+/** How many objects ahead walks over every object start fetching an object, its particle is fetched half as far ahead. **/
+#define OBJECT_PREFETCH_DISTANCE 16
+
+/*
+ * The objects and their particles are each allocated on their own, so walking them in order
+ * waits on memory at every step. Fetching ahead, first the object then what it points to, hides that.
+ */
+static void prefetchObject(GameObject** gameObjects, int i, int count) {
+	if (i + OBJECT_PREFETCH_DISTANCE < count) {
+		GameObject* ahead = gameObjects[i + OBJECT_PREFETCH_DISTANCE];
+		MEM_PREFETCH(&ahead->position);
+		MEM_PREFETCH(&ahead->velocity);
+		MEM_PREFETCH(&ahead->particleHandle);
+	}
+	if (i + OBJECT_PREFETCH_DISTANCE/2 < count) {
+		GameObject* ahead = gameObjects[i + OBJECT_PREFETCH_DISTANCE/2];
+		if (ahead->particle != NULL) {
+			MEM_PREFETCH(&ahead->particle->damping);
+			MEM_PREFETCH(&ahead->particle->inverseMass);
+		}
+	}
+}
+
+/*
+ * Finds the forces on every particle at the integrator's current sample point,
+ * by copying it out to the objects and running the force generators on them again.
+ */
+static void evaluateForces(ParticleSystem* system, void* data) {
+	GameObjectRegist* regist = (GameObjectRegist*)data;
+
+	for(unsigned int i = 0; i < regist->gameObjects->size; i++) {
+		GameObject* gameObject = getGameObject(regist, i);
+		if (gameObject->particle!=NULL && gameObject->particleHandle!=PARTICLE_HANDLE_NONE) {
+			manParticleSystem.storeParticle(system, gameObject->particleHandle, gameObject->particle);
+			*gameObject->particle->forceAccum = *(Vec3*)manDynamicArray.get(regist->objectForces, i);
+		}
+	}
+
+	manForceRegistry.updateForces(regist->pfRegistry, regist->tickDelta);
+
+	for(unsigned int i = 0; i < regist->gameObjects->size; i++) {
+		GameObject* gameObject = getGameObject(regist, i);
+		if (gameObject->particle!=NULL && gameObject->particleHandle!=PARTICLE_HANDLE_NONE)
+			manParticleSystem.addForce(system, gameObject->particleHandle, gameObject->particle->forceAccum);
+	}
+}
+
+void setIntegrator(GameObjectRegist* regist, ParticleIntegrator integrator) {
+	manParticleSystem.setIntegrator(regist->particleSystem, integrator);
+
+	bool multiStage = (integrator == PARTICLE_INTEGRATOR_VELOCITY_VERLET) || (integrator == PARTICLE_INTEGRATOR_RK4);
+	manParticleSystem.setForceFunc(regist->particleSystem, multiStage ? evaluateForces : NULL, regist);
+}
+
+void setSleepEnabled(GameObjectRegist* regist, bool enabled) {
+	manColResolver.setSleepEnabled(regist->collisionResolver, enabled);
+}
+
+/*
+ * Wakes sleeping objects that have any force on them or have been set moving, then takes sleeping objects out of the
+ * ParticleSystem and puts woken ones back in, so only awake objects are integrated.
+ */
+static void updateSleeping(GameObjectRegist* regist) {
+	CollisionResolver* resolver = regist->collisionResolver;
+	scalar sleepVelocitySquared = COLLISION_RESOLVER_SLEEP_VELOCITY*COLLISION_RESOLVER_SLEEP_VELOCITY;
+
+	for(unsigned int i = 0; i < regist->gameObjects->size; i++) {
+		GameObject* gameObject = getGameObject(regist, i);
+		if (gameObject->particle==NULL || gameObject->colliderIndex < 0)
+			continue;
+
+		//Any force keeps the object, and its island, awake, however weak. Waking resets its still time, so
+		//an object a generator keeps pushing never sleeps and never has its force or velocity dropped.
+		Vec3* force = gameObject->particle->forceAccum;
+		bool pushed = (force->x != 0) || (force->y != 0) || (force->z != 0);
+		bool moving = manVec3.dot(gameObject->particle->velocity, gameObject->particle->velocity) > sleepVelocitySquared;
+		if (pushed || (moving && gameObject->physCollider->sleeping))
+			manColResolver.wake(resolver, gameObject->colliderIndex);
+	}
+
+	for(unsigned int i = 0; i < regist->gameObjects->size; i++) {
+		GameObject* gameObject = getGameObject(regist, i);
+		if (gameObject->particle==NULL || gameObject->colliderIndex < 0)
+			continue;
+
+		if (gameObject->physCollider->sleeping) {
+			if (gameObject->particleHandle!=PARTICLE_HANDLE_NONE) {
+				manParticleSystem.remove(regist->particleSystem, gameObject->particleHandle);
+				gameObject->particleHandle = PARTICLE_HANDLE_NONE;
+			}
+		} else if (gameObject->particleHandle==PARTICLE_HANDLE_NONE) {
+			gameObject->particleHandle = manParticleSystem.add(regist->particleSystem);
+		}
+	}
+}
+
 void update(GameObjectRegist* regist, float tickDelta) {
+	regist->tickDelta = tickDelta;
 
 	//Call update functions
+	PROFILE_BEGIN("objectUpdate");
 	for(unsigned int i = 0; i <regist->gameObjects->size; i++) {
 		GameObject* gameObject = getGameObject(regist, i);
+		manGameObj.storePreviousState(gameObject);
 		manGameObj.update(gameObject, tickDelta);
 	}
+	PROFILE_END();
+
+	if (regist->particleSystem->forceFunc != NULL) {
+		manDynamicArray.clear(regist->objectForces);
+		for(unsigned int i = 0; i < regist->gameObjects->size; i++) {
+			GameObject* gameObject = getGameObject(regist, i);
+			Vec3 force = gameObject->particle!=NULL ? *gameObject->particle->forceAccum : manVec3.create(NULL, 0, 0, 0);
+			manDynamicArray.append(regist->objectForces, &force);
+		}
+	}
 
+	PROFILE_BEGIN("forceRegistry");
 	manForceRegistry.updateForces(regist->pfRegistry, tickDelta);
+	PROFILE_END();
 
-	//Integrate particles
-	for(unsigned int i = 0; i < regist->gameObjects->size; i++) {
-		GameObject* gameObject = getGameObject(regist, i);
-		if (gameObject->particle!=NULL)
-			manParticle.integrate(gameObject->particle, tickDelta);
+	if (regist->collisionResolver->sleepEnabled) {
+		PROFILE_BEGIN("sleep");
+		updateSleeping(regist);
+		PROFILE_END();
+	}
+
+	//Integrate particles, objects own their state so copy it in and back out around the batch.
+	//Both copies walk every object, so they fetch ahead as snapshots do.
+	PROFILE_BEGIN("integrate");
+	GameObject** gameObjects = (GameObject**)regist->gameObjects->contents;
+	int objectCount = regist->gameObjects->size;
+	for(int i = 0; i < objectCount; i++) {
+		GameObject* gameObject = gameObjects[i];
+		prefetchObject(gameObjects, i, objectCount);
+		if (gameObject->particle!=NULL && gameObject->particleHandle!=PARTICLE_HANDLE_NONE)
+			manParticleSystem.loadParticle(regist->particleSystem, gameObject->particleHandle, gameObject->particle);
+	}
+
+	manParticleSystem.integrateAll(regist->particleSystem, tickDelta);
+
+	for(int i = 0; i < objectCount; i++) {
+		GameObject* gameObject = gameObjects[i];
+		prefetchObject(gameObjects, i, objectCount);
+		if (gameObject->particle!=NULL && gameObject->particleHandle!=PARTICLE_HANDLE_NONE)
+			manParticleSystem.storeParticle(regist->particleSystem, gameObject->particleHandle, gameObject->particle);
 	}
+	PROFILE_END();
 
+	PROFILE_BEGIN("collisionReset");
 	manColResolver.reset(regist->collisionResolver);
+	PROFILE_END();
 
-	int i = 0;
-	bool flag = true;
-	while(flag && i < 1) {
-		manColResolver.prepare(regist->collisionResolver);
-		flag = manColResolver.check(regist->collisionResolver);
+	PROFILE_BEGIN("collisionPrepare");
+	manColResolver.prepare(regist->collisionResolver);
+	PROFILE_END();
 
-		if (flag)
-			manColResolver.resolve(regist->collisionResolver);
+	PROFILE_BEGIN("collisionCheck");
+	bool colliding = manColResolver.check(regist->collisionResolver);
+	PROFILE_END();
 
-		i++;
+	//The solver iterates over every contact itself, so one check a tick is enough.
+	if (colliding) {
+		PROFILE_BEGIN("collisionResolve");
+		manColResolver.resolve(regist->collisionResolver);
+		PROFILE_END();
 	}
+
+	PROFILE_BEGIN("collisionSleep");
+	manColResolver.updateSleep(regist->collisionResolver, tickDelta);
+	PROFILE_END();
 }
 
-void render(GameObjectRegist* regist, float frameDelta) {
+void render(GameObjectRegist* regist, float alpha) {
 	manMatMan.setMode(regist->matMan, MATRIX_MODE_MODEL);
 	for(int i = 0; i < regist->gameObjects->size; i++) {
 		GameObject* gameObject = getGameObject(regist, i);
-		manGameObj.render(gameObject, frameDelta, regist->currentShader, regist->matMan);
+		manGameObj.render(gameObject, alpha, regist->currentShader, regist->matMan);
 	}
 }
 
+static unsigned long long hashBytes(unsigned long long hash, const void* data, int size) {
+	const unsigned char* bytes = (const unsigned char*)data;
+	for(int b = 0; b < size; b++) {
+		hash ^= bytes[b];
+		hash *= 1099511628211ull;
+	}
+	return hash;
+}
+
+static unsigned long long hashState(GameObjectRegist* regist) {
+	unsigned long long hash = 14695981039346656037ull;
+	for(unsigned int i = 0; i < regist->gameObjects->size; i++) {
+		GameObject* gameObject = getGameObject(regist, i);
+		if (gameObject->particle == NULL)
+			continue;
+
+		hash = hashBytes(hash, gameObject->particle->position, sizeof(Vec3));
+		hash = hashBytes(hash, gameObject->particle->velocity, sizeof(Vec3));
+	}
+	return hash;
+}
+
+/*
+ * An object's part of a snapshot. Particle state the object doesn't hold is stored with it.
+ */
+typedef struct ObjectSnapshot_s {
+	Vec3 position;
+	Vec3 rotation;
+	Vec3 scale;
+	Vec3 previousPosition;
+	Vec3 previousRotation;
+	Vec3 velocity;
+	Vec3 acceleration;
+	Vec3 force;
+	scalar damping;
+	scalar inverseMass;
+	/** Whether the particle was in the ParticleSystem, which only holds awake objects. **/
+	bool integrated;
+} ObjectSnapshot;
+
+/*
+ * The header is followed by an ObjectSnapshot per object, then colliderSize bytes of collision resolver
+ * snapshot, then forceSize bytes of force registrations. Those are the group count, then for each group
+ * its generator's id, its count and the index of each particle's object.
+ */
+typedef struct SnapshotHeader_s {
+	char magic[4];
+	int version;
+	/** WORLD_SNAPSHOT_BYTE_ORDER as the machine that wrote it stores it. **/
+	unsigned int byteOrder;
+	/** sizeof(scalar) where it was written. **/
+	int scalarSize;
+	int objectCount;
+	int colliderSize;
+	int forceSize;
+} SnapshotHeader;
+
+#define WORLD_SNAPSHOT_BYTE_ORDER 0x01020304u
+static unsigned int hashParticle(const ParticleIndex* index, const Particle* particle) {
+	unsigned long long key = (unsigned long long)(uintptr_t)particle;
+	return (unsigned int)((key*11400714819323198485ull) >> 32) & index->mask;
+}
+
+/*
+ * Puts the particles of objects added since the last snapshot in the index,
+ * making the table bigger first if that would leave it over half full.
+ */
+static void updateParticleIndex(GameObjectRegist* regist) {
+	ParticleIndex* index = &regist->particleIndex;
+	if (index->count == regist->gameObjects->size)
+		return;
+
+	if (index->particles == NULL || regist->gameObjects->size*2 > index->mask + 1) {
+		unsigned int size = 16;
+		while(size < regist->gameObjects->size*2)
+			size *= 2;
+		free(index->particles);
+		free(index->objects);
+		index->mask = size - 1;
+		index->particles = calloc(size, sizeof(Particle*));
+		index->objects = malloc(size*sizeof(int));
+		index->count = 0;
+	}
+
+	GameObject** gameObjects = (GameObject**)regist->gameObjects->contents;
+	for(; index->count < regist->gameObjects->size; index->count++) {
+		Particle* particle = gameObjects[index->count]->particle;
+		if (particle == NULL)
+			continue;
+
+		unsigned int slot = hashParticle(index, particle);
+		while(index->particles[slot] != NULL)
+			slot = (slot + 1) & index->mask;
+		index->particles[slot] = particle;
+		index->objects[slot] = index->count;
+	}
+}
+
+static int findParticle(const ParticleIndex* index, const Particle* particle) {
+	for(unsigned int slot = hashParticle(index, particle); index->particles[slot] != NULL; slot = (slot + 1) & index->mask) {
+		if (index->particles[slot] == particle)
+			return index->objects[slot];
+	}
+	return -1;
+}
+
+/*
+ * The id given to a generator, or -1 if it has none.
+ */
+static int findGeneratorId(GameObjectRegist* regist, ParticleForceGenerator* generator) {
+	ForceGeneratorId* ids = (ForceGeneratorId*)regist->forceGeneratorIds->contents;
+	for(int i = 0; i < regist->forceGeneratorIds->size; i++) {
+		if (ids[i].generator == generator)
+			return ids[i].id;
+	}
+	return -1;
+}
+
+static ParticleForceGenerator* findGenerator(GameObjectRegist* regist, int id) {
+	ForceGeneratorId* ids = (ForceGeneratorId*)regist->forceGeneratorIds->contents;
+	for(int i = 0; i < regist->forceGeneratorIds->size; i++) {
+		if (ids[i].id == id)
+			return ids[i].generator;
+	}
+	return NULL;
+}
+
+static ParticleForceGroup* getForceGroup(ParticleForceRegistry* registry, int group) {
+	return (ParticleForceGroup*)manDynamicArray.get(registry->groups, group);
+}
+
+/*
+ * Emptied groups waiting to be reused are left out of snapshots.
+ */
+static int countForceGroups(ParticleForceRegistry* registry) {
+	int count = 0;
+	for(int g = 0; g < registry->groups->size; g++)
+		count += getForceGroup(registry, g)->forceGenerator != NULL;
+	return count;
+}
+
+static int getForceSnapshotSize(ParticleForceRegistry* registry) {
+	return sizeof(int) + countForceGroups(registry)*2*sizeof(int) + manForceRegistry.getCount(registry)*sizeof(int);
+}
+
+static void snapshotForces(GameObjectRegist* regist, char* data) {
+	ParticleForceRegistry* registry = regist->pfRegistry;
+	updateParticleIndex(regist);
+
+	int groupCount = countForceGroups(registry);
+	memcpy(data, &groupCount, sizeof(int));
+	data += sizeof(int);
+	for(int g = 0; g < registry->groups->size; g++) {
+		ParticleForceGroup* group = getForceGroup(registry, g);
+		if (group->forceGenerator == NULL)
+			continue;
+
+		//Generators without an id are stored as -1 and can't be restored.
+		int id = findGeneratorId(regist, group->forceGenerator);
+		memcpy(data, &id, sizeof(int));
+		memcpy(data + sizeof(int), &group->count, sizeof(int));
+		data += 2*sizeof(int);
+
+		//Particles not owned by an object are stored as -1 and can't be restored.
+		int* objects = (int*)data;
+		for(int i = 0; i < group->count; i++)
+			objects[i] = findParticle(&regist->particleIndex, group->particles[i]);
+		data += group->count*sizeof(int);
+	}
+}
+
+void snapshot(GameObjectRegist* regist, WorldSnapshot* snapshot) {
+	manForceRegistry.applyPending(regist->pfRegistry);
+
+	SnapshotHeader header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, WORLD_SNAPSHOT_MAGIC, 4);
+	header.version = WORLD_SNAPSHOT_VERSION;
+	header.byteOrder = WORLD_SNAPSHOT_BYTE_ORDER;
+	header.scalarSize = sizeof(scalar);
+	header.objectCount = regist->gameObjects->size;
+	header.forceSize = getForceSnapshotSize(regist->pfRegistry);
+
+	//The resolver only gives the most it could write, the header is filled in once it has.
+	int capacity = sizeof(header) + header.objectCount*sizeof(ObjectSnapshot) + manColResolver.getSnapshotSize(regist->collisionResolver) + header.forceSize;
+	if (snapshot->capacity < capacity) {
+		snapshot->capacity = capacity;
+		snapshot->data = realloc(snapshot->data, snapshot->capacity);
+	}
+
+	ObjectSnapshot* objects = (ObjectSnapshot*)(snapshot->data + sizeof(header));
+	GameObject** gameObjects = (GameObject**)regist->gameObjects->contents;
+	for(int i = 0; i < header.objectCount; i++) {
+		GameObject* gameObject = gameObjects[i];
+		ObjectSnapshot* object = &objects[i];
+		prefetchObject(gameObjects, i, header.objectCount);
+
+		memset(object, 0, sizeof(ObjectSnapshot));
+		object->position = gameObject->position;
+		object->rotation = gameObject->rotation;
+		object->scale = gameObject->scale;
+		object->previousPosition = gameObject->previousPosition;
+		object->previousRotation = gameObject->previousRotation;
+		object->velocity = gameObject->velocity;
+		object->acceleration = gameObject->acceleration;
+		object->force = gameObject->force;
+		object->damping = gameObject->particle != NULL ? gameObject->particle->damping : 0;
+		object->inverseMass = gameObject->particle != NULL ? gameObject->particle->inverseMass : 0;
+		object->integrated = gameObject->particleHandle != PARTICLE_HANDLE_NONE;
+	}
+
+	char* colliders = (char*)&objects[header.objectCount];
+	header.colliderSize = manColResolver.snapshot(regist->collisionResolver, colliders);
+	snapshotForces(regist, colliders + header.colliderSize);
+
+	memcpy(snapshot->data, &header, sizeof(header));
+	snapshot->size = sizeof(header) + header.objectCount*sizeof(ObjectSnapshot) + header.colliderSize + header.forceSize;
+}
+
+/*
+ * Checks the force registrations in a snapshot can be restored, finding the generator given each of its
+ * generator ids in the world. Returns whether the world's registrations are already the snapshot's, or -1
+ * if they can't be restored.
+ */
+static int matchForces(GameObjectRegist* regist, const char* data, int size, ParticleForceGenerator** generators) {
+	ParticleForceRegistry* registry = regist->pfRegistry;
+	GameObject** gameObjects = (GameObject**)regist->gameObjects->contents;
+	const char* end = data + size;
+	int groupCount;
+	if (size < sizeof(int))
+		return -1;
+	memcpy(&groupCount, data, sizeof(int));
+	data += sizeof(int);
+	if (groupCount < 0 || groupCount > (end - data)/(2*sizeof(int)))
+		return -1;
+
+	const int** groupObjects = malloc((groupCount + 1)*sizeof(int*));
+	int* counts = malloc((groupCount + 1)*sizeof(int));
+	int result = 1;
+
+	for(int g = 0; g < groupCount && result >= 0; g++) {
+		int id;
+		if (end - data < 2*sizeof(int)) {
+			result = -1;
+			break;
+		}
+		memcpy(&id, data, sizeof(int));
+		memcpy(&counts[g], data + sizeof(int), sizeof(int));
+		data += 2*sizeof(int);
+		groupObjects[g] = (const int*)data;
+		if (counts[g] < 0 || (end - data)/(long)sizeof(int) < counts[g]) {
+			result = -1;
+			break;
+		}
+		data += counts[g]*sizeof(int);
+
+		//Each group's generator must have an id here, and no two groups the same one.
+		generators[g] = id >= 0 ? findGenerator(regist, id) : NULL;
+		if (generators[g] == NULL)
+			result = -1;
+		for(int h = 0; h < g && result >= 0; h++) {
+			if (generators[h] == generators[g])
+				result = -1;
+		}
+
+		for(int i = 0; i < counts[g]; i++) {
+			int object = groupObjects[g][i];
+			if (object >= (int)regist->gameObjects->size || (object >= 0 && gameObjects[object]->particle == NULL))
+				result = -1;
+		}
+	}
+	if (data != end)
+		result = -1;
+
+	//Already restored if the groups hold the same particles, in the same order.
+	if (result > 0 && groupCount != countForceGroups(registry))
+		result = 0;
+	for(int g = 0, d = 0; g < groupCount && result > 0; g++, d++) {
+		while(getForceGroup(registry, d)->forceGenerator == NULL)
+			d++;
+		ParticleForceGroup* group = getForceGroup(registry, d);
+		if (group->forceGenerator != generators[g] || group->count != counts[g]) {
+			result = 0;
+			break;
+		}
+		for(int i = 0; i < counts[g] && result > 0; i++) {
+			int object = groupObjects[g][i];
+			if (object < 0 || gameObjects[object]->particle != group->particles[i])
+				result = 0;
+		}
+	}
+
+	free(groupObjects);
+	free(counts);
+	return result;
+}
+
+static void restoreForces(GameObjectRegist* regist, const char* data, ParticleForceGenerator** generators) {
+	ParticleForceRegistry* registry = regist->pfRegistry;
+	manForceRegistry.clear(registry);
+
+	int groupCount;
+	memcpy(&groupCount, data, sizeof(int));
+	data += sizeof(int);
+	for(int g = 0; g < groupCount; g++) {
+		int count;
+		memcpy(&count, data + sizeof(int), sizeof(int));
+		data += 2*sizeof(int);
+
+		const int* objects = (const int*)data;
+		for(int i = 0; i < count; i++) {
+			if (objects[i] >= 0)
+				manForceRegistry.add(registry, getGameObject(regist, objects[i])->particle, generators[g]);
+		}
+		data += count*sizeof(int);
+	}
+
+	manForceRegistry.applyPending(registry);
+}
+
+bool restore(GameObjectRegist* regist, const WorldSnapshot* snapshot) {
+	SnapshotHeader header;
+	if (snapshot->size < sizeof(header))
+		return false;
+	memcpy(&header, snapshot->data, sizeof(header));
+	if (memcmp(header.magic, WORLD_SNAPSHOT_MAGIC, 4) != 0 || header.version != WORLD_SNAPSHOT_VERSION ||
+	    header.byteOrder != WORLD_SNAPSHOT_BYTE_ORDER || header.scalarSize != sizeof(scalar) ||
+	    header.objectCount != regist->gameObjects->size || header.colliderSize < 0 || header.forceSize < 0 ||
+	    snapshot->size != sizeof(header) + header.objectCount*sizeof(ObjectSnapshot) + (long)header.colliderSize + header.forceSize)
+		return false;
+
+	const ObjectSnapshot* objects = (const ObjectSnapshot*)(snapshot->data + sizeof(header));
+	const char* colliders = (const char*)&objects[header.objectCount];
+	const char* forces = colliders + header.colliderSize;
+
+	manForceRegistry.applyPending(regist->pfRegistry);
+	ParticleForceGenerator** generators = malloc((header.forceSize/(2*sizeof(int)) + 1)*sizeof(ParticleForceGenerator*));
+	int forcesMatch = matchForces(regist, forces, header.forceSize, generators);
+	if (forcesMatch < 0 || !manColResolver.restore(regist->collisionResolver, colliders, header.colliderSize)) {
+		free(generators);
+		return false;
+	}
+
+	if (!forcesMatch)
+		restoreForces(regist, forces, generators);
+	free(generators);
+
+	GameObject** gameObjects = (GameObject**)regist->gameObjects->contents;
+	for(int i = 0; i < header.objectCount; i++) {
+		GameObject* gameObject = gameObjects[i];
+		const ObjectSnapshot* object = &objects[i];
+		prefetchObject(gameObjects, i, header.objectCount);
+
+		gameObject->position = object->position;
+		gameObject->rotation = object->rotation;
+		gameObject->scale = object->scale;
+		gameObject->previousPosition = object->previousPosition;
+		gameObject->previousRotation = object->previousRotation;
+		gameObject->velocity = object->velocity;
+		gameObject->acceleration = object->acceleration;
+		gameObject->force = object->force;
+		if (gameObject->particle == NULL)
+			continue;
+
+		gameObject->particle->damping = object->damping;
+		gameObject->particle->inverseMass = object->inverseMass;
+
+		//Only awake objects are in the ParticleSystem.
+		if (!object->integrated && gameObject->particleHandle != PARTICLE_HANDLE_NONE) {
+			manParticleSystem.remove(regist->particleSystem, gameObject->particleHandle);
+			gameObject->particleHandle = PARTICLE_HANDLE_NONE;
+		} else if (object->integrated && gameObject->particleHandle == PARTICLE_HANDLE_NONE) {
+			gameObject->particleHandle = manParticleSystem.add(regist->particleSystem);
+		}
+	}
+
+	return true;
+}
+
 void delete(GameObjectRegist* regist) {
 	for(int i = 0; i < regist->gameObjects->size; i++) {
 		manGameObj.delete((GameObject*)manDynamicArray.get(regist->gameObjects, i));
@@ -87,6 +642,18 @@ void delete(GameObjectRegist* regist) {
 
 	manForceRegistry.delete(regist->pfRegistry);
 	free(regist->pfRegistry);
+
+	manParticleSystem.delete(regist->particleSystem);
+	free(regist->particleSystem);
+
+	manDynamicArray.delete(regist->objectForces);
+	free(regist->objectForces);
+
+	free(regist->particleIndex.particles);
+	free(regist->particleIndex.objects);
+
+	manDynamicArray.delete(regist->forceGeneratorIds);
+	free(regist->forceGeneratorIds);
 }
 
-const GameObjectRegistManager manGameObjRegist = {new, add, setShader, setMatrixManager, getGameObject, update, render, delete};
+const GameObjectRegistManager manGameObjRegist = {new, add, setShader, setMatrixManager, setJobSystem, setIntegrator, setSleepEnabled, setForceGeneratorId, getGameObject, update, render, hashState, snapshot, restore, delete};
@@ -6,6 +6,26 @@
 #include "render/MatrixManager.h"
 #include "col/CollisionResolver.h"
 
+/**
+ * Maps particles to the index of the object that owns them, in an open addressed table.
+ */
+typedef struct ParticleIndex_s {
+	Particle** particles;
+	int* objects;
+	/** One less than the table's size, a power of two.**/
+	unsigned int mask;
+	/** How many of the registry's objects have been put in the table.**/
+	unsigned int count;
+} ParticleIndex;
+
+/**
+ * The id a force generator is known by in snapshots.
+ */
+typedef struct ForceGeneratorId_s {
+	ParticleForceGenerator* generator;
+	int id;
+} ForceGeneratorId;
+
 typedef struct GameObjectRegist_s {
 	/** The Shader to use when rendering.**/
 	Shader* currentShader;
@@ -13,12 +33,38 @@ typedef struct GameObjectRegist_s {
 	MatrixManager* matMan;
 	/** The ParticleForceRegist to register forces in.**/
 	ParticleForceRegistry* pfRegistry;
+	/** Integrates the particles of all registered objects in bulk.**/
+	ParticleSystem* particleSystem;
 	/** The list of objects that make up the world.**/
 	DynamicArray* gameObjects;
 
 	CollisionResolver* collisionResolver;
+	/** The job system physics is spread over, or NULL to run on the calling thread. Not owned.**/
+	JobSystem* jobSystem;
+	/** Forces each object put on its particle in its update, kept for integrators that find forces more than once a tick.**/
+	DynamicArray* objectForces;
+	/** The time the current tick simulates, in seconds.**/
+	float tickDelta;
+	/** Finds the object each force registration's particle belongs to when snapshotting, brought up to date as objects are added.**/
+	ParticleIndex particleIndex;
+	/** The ids given to force generators with setForceGeneratorId, as ForceGeneratorIds.**/
+	DynamicArray* forceGeneratorIds;
 } GameObjectRegist;
 
+/** First bytes of a world snapshot. **/
+#define WORLD_SNAPSHOT_MAGIC "COHW"
+#define WORLD_SNAPSHOT_VERSION 2
+
+/**
+ * The state of a world at the end of a tick in one block of memory, written by snapshot and read back by restore.
+ */
+typedef struct WorldSnapshot_s {
+	/** The snapshot, size bytes long. Only grows, so a snapshot taken again every tick stops allocating. Freed by the owner.**/
+	char* data;
+	int size;
+	int capacity;
+} WorldSnapshot;
+
 typedef struct GameObjectRegistManager_s {
 	/**
 	 * Creates a new GameObjectRegist.
@@ -28,7 +74,8 @@ typedef struct GameObjectRegistManager_s {
 	GameObjectRegist*(* new)(MatrixManager* matMan);
 
 	/**
-	 * Adds the given gameobject to "the world"
+	 * Adds the given gameobject to "the world". Objects are never taken out again, so force registrations on an
+	 * object's particle last until the registry is deleted unless removed with the handles addForceGenerator returned.
 	 * @param regist The GameObjectRegist to register with.
 	 * @param gameObject The GameOBject to register.
 	 */
@@ -48,6 +95,42 @@ typedef struct GameObjectRegistManager_s {
 	 */
 	void(* setMatrixManager)(GameObjectRegist* regist, MatrixManager* matMan);
 
+	/**
+	 * Changes what job system particle integration and collision detection are spread over.
+	 * The simulation gives the same results whatever the number of threads.
+	 * @param regist The GameObjectRegist to alter.
+	 * @param jobs The JobSystem to use from now on, or NULL to run on the calling thread.
+	 */
+	void(* setJobSystem)(GameObjectRegist* regist, JobSystem* jobs);
+
+	/**
+	 * Changes how particles are integrated. Verlet and RK4 run the force generators again within the tick,
+	 * with the forces objects add in their updates held for the whole tick.
+	 * @param regist The GameObjectRegist to alter.
+	 * @param integrator The ParticleIntegrator to use from now on.
+	 */
+	void(* setIntegrator)(GameObjectRegist* regist, ParticleIntegrator integrator);
+
+	/**
+	 * Enables or disables sleeping. Objects whose contact island has been still for COLLISION_RESOLVER_SLEEP_TIME
+	 * stop being integrated and collision checked against each other, until something touches them, moves them,
+	 * or puts a force on them. An object with any force on it, such as one a force generator is pulling,
+	 * is kept awake along with its island, so even a weak constant force is never dropped.
+	 * @param regist The GameObjectRegist to alter.
+	 * @param enabled Whether objects can sleep from now on.
+	 */
+	void(* setSleepEnabled)(GameObjectRegist* regist, bool enabled);
+
+	/**
+	 * Gives a force generator the id its registrations are snapshotted under, so a restore finds the generator
+	 * with the same id in the world it restores into. Give a world's generators the same ids each time it is built.
+	 * Replaces any id the generator had, and takes the id from any generator that had it.
+	 * @param regist The GameObjectRegist to alter.
+	 * @param generator The generator to name, not owned.
+	 * @param id The id to give it, 0 or more.
+	 */
+	void(* setForceGeneratorId)(GameObjectRegist* regist, ParticleForceGenerator* generator, int id);
+
 	/**
 	 * Gets the gameobject at the given ID.
 	 * @param regist The registry to get the object from.
@@ -59,17 +142,47 @@ typedef struct GameObjectRegistManager_s {
 	/**
 	 * Updates and performs relevent physics operations to all registered objects.
 	 * @param regist The registry to update.
-	 * @param tickDelta The change in time between the last frame and now, in miliseconds.
+	 * @param tickDelta The time the tick simulates, in seconds.
 	 */
 	void(* update)(GameObjectRegist* regist, float tickDelta);
 
 	/**
-	 * Renders all registered objects.
+	 * Renders all registered objects, interpolated between their previous and current tick.
 	 * @param regist The registry to render.
-	 * @param tickDelta The change in time between the last frame and now, in miliseconds.
+	 * @param alpha How far between the previous and current tick to draw, from 0 to 1.
+	 */
+	void(* render)(GameObjectRegist* regist, float alpha);
+
+	/**
+	 * Hashes the position and velocity of every object's particle, in registration order. Hashed after each update,
+	 * two runs given the same inputs match tick for tick when built with COH_DETERMINISTIC (scons deterministic=1).
+	 * @param regist The registry to hash.
+	 * @return A 64 bit FNV-1a hash of the particles' bits.
 	 */
-	void(* render)(GameObjectRegist* regist, float frameDelta);
+	unsigned long long(* hashState)(GameObjectRegist* regist);
 
+	/**
+	 * Writes the state of the world into a snapshot: every object's transform, motion and particle state, every
+	 * force registration, and the collision resolver's state between ticks, including sleep and the contact cache.
+	 * Meshes, models and whatever objects keep in their own callbacks are left out, they aren't changed by ticking.
+	 * Take it between updates. Pending force registration changes are applied first.
+	 * @param regist The registry to snapshot.
+	 * @param snapshot The snapshot to write over, start it zeroed. Its memory is reused where it is big enough.
+	 */
+	void(* snapshot)(GameObjectRegist* regist, WorldSnapshot* snapshot);
+
+	/**
+	 * Puts the world back as it was when the snapshot was taken, so updating from there gives the same ticks
+	 * again. The world must hold the same objects in the same order, either the one snapshotted or one built
+	 * the same way, nothing is loaded or created. Force generators are matched to the world's by the ids given
+	 * with setForceGeneratorId, so every generator with registrations in the snapshot needs an id in both worlds.
+	 * If the force registrations differ from the snapshot's, they are all replaced and any handles to them are no longer valid.
+	 * @param regist The registry to restore.
+	 * @param snapshot A snapshot written by snapshot.
+	 * @return false, changing nothing, if the snapshot isn't one, was written by a machine with another byte order or scalar size,
+	 * or was taken of a world with different objects or with generators this world has no id for.
+	 */
+	bool(* restore)(GameObjectRegist* regist, const WorldSnapshot* snapshot);
 
 	/**
 	 * Destroys the given registry..
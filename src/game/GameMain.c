@@ -4,11 +4,15 @@
 #include "game/objs/Asteroid.h"
 #include "game/objs/GravityWell.h"
 #include "engine/GameObjectRegistry.h"
+#include "col/SpatialHash.h"
 #include "render/Camera.h"
 #include "render/Renderer.h"
 #include "render/Skybox.h"
 #include "util/OGLUtil.h"
 #include "util/ObjLoader.h"
+#include "util/JobSystem.h"
+
+#include <stdio.h>
 
 typedef enum stateType_s {GAME_STATE, QUIT_STATE, LIGHTING_STATE} stateType;
 
@@ -29,6 +33,8 @@ typedef struct GameData_s {
 
 	//World
 	GameObjectRegist* gameObjRegist;
+	JobSystem* jobSystem;
+	SpatialHash* broadphase;
 
 	//Game
 	stateType gameState;
@@ -63,7 +69,9 @@ static void onInitMisc(GameLoop* self);
 static void onClose(GameLoop* self);
 static void onDestroy(GameLoop* self);
 static void onUpdate(GameLoop* self, float tickDelta);
-static void onRender(GameLoop* self, float frameDelta);
+static void onRender(GameLoop* self, float alpha);
+static void onInitHeadless(GameLoop* self);
+static void onUpdateHeadless(GameLoop* self, float tickDelta);
 
 void runGame() {
 	GameLoop* gameloop = manGameLoop.new(onCreate, onInitWindow, onInitOpenGL, onInitMisc, onUpdate, onRender, onClose, onDestroy, 1/120.0, 1/60.0);
@@ -71,8 +79,27 @@ void runGame() {
 	manGameLoop.delete(gameloop);
 }
 
+void runGameHeadless(int ticks, int threads) {
+	GameLoop* gameloop = manGameLoop.new(onCreate, NULL, NULL, onInitHeadless, onUpdateHeadless, NULL, onClose, onDestroy, 1/120.0, 1/60.0);
+	GameData* data = gameloop->extraData;
+	data->jobSystem = manJobSystem.new(threads);
+
+	TickStats stats;
+	manGameLoop.runHeadless(gameloop, ticks, &stats);
+
+	printf("[Headless] %d threads, %d objects, %d ticks, %.3f ms simulated, %.3f ms total\n", data->jobSystem->threadCount, data->gameObjRegist->gameObjects->size, stats.ticks, stats.simulatedTime, stats.totalTime);
+	printf("[Headless] tick ms mean %.3f, p50 %.3f, p95 %.3f, p99 %.3f, max %.3f\n", stats.mean, stats.p50, stats.p95, stats.p99, stats.max);
+	printf("[Headless] state hash %016llx\n", manGameObjRegist.hashState(data->gameObjRegist));
+
+	manGameLoop.delete(gameloop);
+}
+
 static void onCreate(GameLoop* self) {
 	self->extraData = malloc(sizeof(GameData));
+
+	GameData* data = (GameData*)self->extraData;
+	data->jobSystem = NULL;
+	data->broadphase = NULL;
 }
 
 /* *********** *
@@ -157,19 +184,18 @@ static void initCamera(GameLoop* self) {
 
 	data->gameObjRegist = manGameObjRegist.new(data->matMan);
 	manGameObjRegist.setShader(data->gameObjRegist, data->globalShader);
+	data->jobSystem = manJobSystem.new(0);
+	manGameObjRegist.setJobSystem(data->gameObjRegist, data->jobSystem);
+	manGameObjRegist.setSleepEnabled(data->gameObjRegist, true);
 	manGameObjRegist.add(data->gameObjRegist, cameraController);
+
+	data->broadphase = manSpatialHash.new(0);
+	manColResolver.setBroadphase(data->gameObjRegist->collisionResolver, &data->broadphase->broadphase);
 }
 
-static void onInitMisc(GameLoop* self) {
+static void initAsteroids(GameLoop* self) {
 	GameData* data = (GameData*)self->extraData;
 
-	initMatMan(self);
-	initGlobalShader(self);
-	initEndScreen(self);
-	initSkybox(self);
-	initCamera(self);
-
-	prepareAsteroids(data->globalShader);
 	int dir = 4;
 	for(int i = 0; i < dir; i++) {
 		for(int j = 0; j < dir; j++) {
@@ -180,6 +206,19 @@ static void onInitMisc(GameLoop* self) {
 			}
 		}
 	}
+}
+
+static void onInitMisc(GameLoop* self) {
+	GameData* data = (GameData*)self->extraData;
+
+	initMatMan(self);
+	initGlobalShader(self);
+	initEndScreen(self);
+	initSkybox(self);
+	initCamera(self);
+
+	prepareAsteroids(data->globalShader);
+	initAsteroids(self);
 
 	data->gameState = GAME_STATE;
 	data->lClickStillDown = false;
@@ -221,6 +260,31 @@ static void onInitMisc(GameLoop* self) {
 
 }
 
+/*
+ * The same asteroid field with a gravity well and an anti-gravity well at fixed
+ * positions, built without touching OpenGL.
+ */
+static void onInitHeadless(GameLoop* self) {
+	GameData* data = (GameData*)self->extraData;
+
+	data->gameObjRegist = manGameObjRegist.new(NULL);
+	manGameObjRegist.setJobSystem(data->gameObjRegist, data->jobSystem);
+	manGameObjRegist.setSleepEnabled(data->gameObjRegist, true);
+	data->broadphase = manSpatialHash.new(0);
+	manColResolver.setBroadphase(data->gameObjRegist->collisionResolver, &data->broadphase->broadphase);
+
+	prepareAsteroids(NULL);
+	initAsteroids(self);
+
+	prepareGrav(NULL);
+	data->massLowest = 1061858316100.0f;
+	data->gravityWellMass = data->massLowest + 1.0f;
+	manGameObjRegist.add(data->gameObjRegist, newGrav(data->gameObjRegist, self->primaryWindow, data->gravityWellMass, manVec3.create(NULL, 0, 0, 0), manVec3.create(NULL, 0, 0, 0), manVec3.create(NULL, 10, 10, 10)));
+	manGameObjRegist.add(data->gameObjRegist, newGrav(data->gameObjRegist, self->primaryWindow, -data->gravityWellMass, manVec3.create(NULL, 200, 0, 0), manVec3.create(NULL, 0, 0, 0), manVec3.create(NULL, 10, 10, 10)));
+
+	data->gameState = GAME_STATE;
+}
+
 /* ************ *
  *  Close Start *
  * ************ */
@@ -229,6 +293,16 @@ static void onClose(GameLoop* self) {
 }
 
 static void onDestroy(GameLoop* self) {
+	GameData* data = (GameData*)self->extraData;
+
+	if (data->jobSystem != NULL) {
+		manJobSystem.delete(data->jobSystem);
+		free(data->jobSystem);
+	}
+	if (data->broadphase != NULL) {
+		manSpatialHash.delete(data->broadphase);
+		free(data->broadphase);
+	}
 	free(self->extraData);
 }
 
@@ -299,6 +373,12 @@ static void onUpdate(GameLoop* self, float tickDelta) {
 	data->gravityWellBar->scale->x = 50 * (data->gravityWellMass / (data->massHighest - data->massLowest));
 }
 
+static void onUpdateHeadless(GameLoop* self, float tickDelta) {
+	GameData* data = self->extraData;
+
+	manGameObjRegist.update(data->gameObjRegist, tickDelta);
+}
+
 static void renderSkybox(MatrixManager* matMan, Shader* skyboxShader, Skybox* skybox) {
 	manShader.bind(skyboxShader);
 		manShader.bindUniformMat4(skyboxShader, "projectionMatrix", manMatMan.peekStack(matMan, MATRIX_MODE_PROJECTION));
@@ -308,7 +388,7 @@ static void renderSkybox(MatrixManager* matMan, Shader* skyboxShader, Skybox* sk
 	manShader.unbind();
 }
 
-static void onRender(GameLoop* self, float frameDelta) {
+static void onRender(GameLoop* self, float alpha) {
 	GameData* data = self->extraData;
 	glViewport(0, 0, manWin.getFramebufferWidth(self->primaryWindow), manWin.getFramebufferHeight(self->primaryWindow));
 	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
@@ -319,7 +399,7 @@ static void onRender(GameLoop* self, float frameDelta) {
 			manMatMan.setMode(data->matMan, MATRIX_MODE_MODEL);
 			renderSkybox(data->matMan, data->skyboxShader, data->skybox);
 
-			manGameObjRegist.render(data->gameObjRegist, frameDelta);
+			manGameObjRegist.render(data->gameObjRegist, alpha);
 
 			glClear(GL_DEPTH_BUFFER_BIT);
 			manMatMan.setMode(data->matMan, MATRIX_MODE_VIEW);
@@ -5,4 +5,11 @@
 
 void runGame();
 
+/**
+ * Runs the asteroid and gravity well scene without a window for the given number of ticks,
+ * printing tick time statistics and a hash of the final state.
+ * threads is the number of threads to simulate with, 0 for one per hardware thread.
+ */
+void runGameHeadless(int ticks, int threads);
+
 #endif
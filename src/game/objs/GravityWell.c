@@ -8,9 +8,14 @@ static PhysicsCollider* col;
 
 #include "util/ObjLoader.h"
 #include "util/TextureUtil.h"
-#include "physics/AnchoredGravityForceGenerator.h"
 
 void prepareGrav(Shader* shader) {
+	col = objLoader.loadCollisionMesh("./data/models/grav.col.obj", NULL, NULL, NULL, NULL);
+
+	//Headless, only the collision mesh is needed.
+	if (shader == NULL)
+		return;
+
 	int vPos = manShader.getAttribLocation(shader, "vPos");
 	int vNorm = manShader.getAttribLocation(shader, "vNorm");
 	int vTex = manShader.getAttribLocation(shader, "vTex");
@@ -19,7 +24,6 @@ void prepareGrav(Shader* shader) {
 	Texture* tex2 = textureUtil.createTextureFromFile("./data/texture/antigrav.bmp", GL_LINEAR, GL_LINEAR);
 	ro1 = manRenderObj.new(NULL, NULL, NULL);
 	ro2 = manRenderObj.new(NULL, NULL, NULL);
-	col = objLoader.loadCollisionMesh("./data/models/grav.col.obj", NULL, NULL, NULL, NULL);
 
 	manRenderObj.setModel(ro1, vao);
 	manRenderObj.addTexture(ro1, tex1);
@@ -29,12 +33,13 @@ void prepareGrav(Shader* shader) {
 }
 
 GameObject* newGrav(GameObjectRegist* regist, Window* window, scalar mass, Vec3 pos, Vec3 rot, Vec3 scl) {
-	GameObject* grav = manGameObj.new("Grav", NULL, true, true, NULL, NULL, NULL, NULL, window);
+	GameObject* grav = manGameObj.new("Grav", NULL, true, ro1 != NULL, NULL, NULL, NULL, NULL, window);
 
 	manGameObj.setPositionVec(grav, &pos);
 	manGameObj.setRotationVec(grav, &rot);
 	manGameObj.setScaleVec(grav, &scl);
 
+	//Without render objects the models are left empty, see setModel.
 	if (mass>0)
 		manGameObj.setModel(grav, ro1);
 	else
@@ -45,14 +50,33 @@ GameObject* newGrav(GameObjectRegist* regist, Window* window, scalar mass, Vec3
 	grav->particle->damping = 0;
 	manParticle.setMass(grav->particle, mass);
 
-	AnchoredGravityForceGenerator* fg = manAnchoredGravityForceGenerator.new(grav->particle);
+	GravityWell* well = malloc(sizeof(GravityWell));
+	well->generator = manAnchoredGravityForceGenerator.new(grav->particle);
+	well->handles = manDynamicArray.new(regist->gameObjects->size + 1, sizeof(ParticleForceHandle));
+	grav->parent = well;
 
 	for(int i = 0; i<regist->gameObjects->size; i++) {
 		GameObject* obj = manGameObjRegist.getGameObject(regist, i);
-		manGameObj.addForceGenerator(obj, &fg->forceGenerator);
+		ParticleForceHandle handle = manGameObj.addForceGenerator(obj, &well->generator->forceGenerator);
+		if (handle != NULL)
+			manDynamicArray.append(well->handles, &handle);
 	}
 
 	grav->physCollider->immovable = true;
 
 	return grav;
 }
+
+void deleteGrav(GameObjectRegist* regist, GameObject* grav) {
+	GravityWell* well = (GravityWell*)grav->parent;
+
+	for(int i = 0; i<well->handles->size; i++)
+		manForceRegistry.remove(regist->pfRegistry, *(ParticleForceHandle*)manDynamicArray.get(well->handles, i));
+
+	manDynamicArray.delete(well->handles);
+	free(well->handles);
+	manAnchoredGravityForceGenerator.delete(well->generator);
+	free(well->generator);
+	free(well);
+	grav->parent = NULL;
+}
@@ -2,9 +2,32 @@
 #define GAME_OBJS_GRAVITYWELL_H_
 
 #include "engine/GameObjectRegistry.h"
+#include "physics/AnchoredGravityForceGenerator.h"
 #include "glfw/Display.h"
 
+/**
+ * What a gravity well keeps in its GameObject's parent, so its registrations can be removed with it.
+ */
+typedef struct GravityWell_s {
+	/** Pulls the registered objects toward the well's particle. **/
+	AnchoredGravityForceGenerator* generator;
+	/** The ParticleForceHandle of each registration the well made. **/
+	DynamicArray* handles;
+} GravityWell;
+
 void prepareGrav(Shader* shader);
+
+/**
+ * Creates a gravity well pulling on every object already in regist. Objects added afterwards aren't pulled by it.
+ * The well itself isn't added to regist.
+ */
 GameObject* newGrav(GameObjectRegist* regist, Window* window, scalar mass, Vec3 pos, Vec3 rot, Vec3 scl);
 
+/**
+ * Removes every registration the well made from regist's force registry, from the next update, and frees the well's
+ * generator and GravityWell. The GameObject is left as it is, a GameObjectRegist has no way to take an object out.
+ * The handles are no longer valid once a restore has replaced the registrations, so don't call this after one.
+ */
+void deleteGrav(GameObjectRegist* regist, GameObject* grav);
+
 #endif
@@ -1,8 +1,11 @@
 #include "lib/ogl.h"
 #include "lib/glfw3.h"
 #include "game/GameMain.h"
+#include "util/ObjLoader.h"
 
+#include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <time.h>
 
 static void setupLibraries(int argc, char **argv) {
@@ -10,6 +13,25 @@ static void setupLibraries(int argc, char **argv) {
 }
 
 int main(int argc, char **argv) {
+    //"--headless [ticks] [threads]" runs the game scene without a window or GL, for benchmarking on servers.
+    if (argc > 1 && strcmp(argv[1], "--headless") == 0) {
+        runGameHeadless(argc > 2 ? atoi(argv[2]) : 10000, argc > 3 ? atoi(argv[3]) : 0);
+        return 0;
+    }
+
+    //"--cook-collision file.col.obj..." writes each collision mesh's .colbin next to it, which loadCollisionMesh then loads.
+    //"--cook-mesh file.obj..." does the same for the .meshbin genVAOFromFile loads.
+    if (argc > 1 && (strcmp(argv[1], "--cook-collision") == 0 || strcmp(argv[1], "--cook-mesh") == 0)) {
+        bool collision = strcmp(argv[1], "--cook-collision") == 0;
+        int failed = 0;
+        for(int i = 2; i < argc; i++) {
+            bool cooked = collision ? objLoader.cookCollisionMesh(argv[i], NULL) : objLoader.cookMesh(argv[i], NULL);
+            printf("[Cooker] %s: %s\n", argv[i], cooked ? "cooked" : "FAILED");
+            failed += !cooked;
+        }
+        return failed > 0;
+    }
+
     srand((unsigned)time(NULL));
     setupLibraries(argc, argv);
 
@@ -17,6 +39,27 @@ int main(int argc, char **argv) {
     //runPhysicsGLFWTest();
     //runGameLoopTest();
     //runGravity();
+    //runBroadphaseBenchmark();
+    //runCollisionAllocTest();
+    //runParticleBenchmark();
+    //runMathSimdTest();
+    //runMathBenchmark();
+    //runProfilerTest();
+    //runJobSystemBenchmark();
+    //runForceRegistryTest();
+    //runNBodyTest();
+    //runIntegratorBenchmark();
+    //runSleepTest();
+    //runContinuousCollisionTest();
+    //runNarrowphaseBenchmark();
+    //runSupportMappingTest();
+    //runContactManifoldTest();
+    //runSolverTest();
+    //runReplayTest();
+    //runSnapshotBenchmark();
+    //runCollisionMeshCookTest();
+    //runMeshCookTest();
+    //runAABBTreeTest();
     runGame();
 
     glfwTerminate();
@@ -1,4 +1,5 @@
 #include "Mat4.h"
+#include "Simd.h"
 
 #include <math.h>
 
@@ -90,10 +91,10 @@ static Mat4 sum(const Mat4 *const mat1, const Mat4 *const mat2) {
 }
 
 static Mat4 sub(const Mat4 *const mat1, const Mat4 *const mat2) {
-    Vec4 v0 = manVec4.sum(&(mat1->data[0]), &(mat2->data[0]));
-    Vec4 v1 = manVec4.sum(&(mat1->data[1]), &(mat2->data[1]));
-    Vec4 v2 = manVec4.sum(&(mat1->data[2]), &(mat2->data[2]));
-    Vec4 v3 = manVec4.sum(&(mat1->data[3]), &(mat2->data[3]));
+    Vec4 v0 = manVec4.sub(&(mat1->data[0]), &(mat2->data[0]));
+    Vec4 v1 = manVec4.sub(&(mat1->data[1]), &(mat2->data[1]));
+    Vec4 v2 = manVec4.sub(&(mat1->data[2]), &(mat2->data[2]));
+    Vec4 v3 = manVec4.sub(&(mat1->data[3]), &(mat2->data[3]));
 
     return (
         manMat4.createFromVec4(
@@ -334,8 +335,8 @@ static Mat4 affRotate(const Mat4 *const matrix, const scalar angle, const Vec3 *
 	Mat4 dest = *matrix;
 
 	//Pre-calculations to streamline matrix transformation.
-	scalar aCos = (scalar) cos(angle);
-	scalar aSin = (scalar) sin(angle);
+	scalar aCos = (scalar) scalar_cos(angle);
+	scalar aSin = (scalar) scalar_sin(angle);
 	scalar invC = 1.0f - aCos;
 
 	scalar xx = axis->x*axis->x*invC;
@@ -380,4 +381,300 @@ static Mat4 affRotate(const Mat4 *const matrix, const scalar angle, const Vec3 *
 	return dest;
 }
 
-const Mat4Manager manMat4 = {create, createLeading, createFromVec4, createFromMat4, sum, sub, postMulScalar, preMulScalar, mul, postMulVec4, preMulVec4, inverse, getMat4Data, affScale, affTranslate, affRotate};
+/*
+ * matrix * (x, y, z, w) for each Vec3. The matrix is copied into locals so it can stay in
+ * registers, and the terms are summed in the same order as postMulVec4.
+ */
+static void transformVec3s(const Mat4 *const matrix, const char* in, int inStride, char* out, int outStride, int count, scalar w) {
+    const scalar m00 = matrix->data[0].x, m01 = matrix->data[0].y, m02 = matrix->data[0].z;
+    const scalar m10 = matrix->data[1].x, m11 = matrix->data[1].y, m12 = matrix->data[1].z;
+    const scalar m20 = matrix->data[2].x, m21 = matrix->data[2].y, m22 = matrix->data[2].z;
+    const scalar m30 = matrix->data[3].x*w, m31 = matrix->data[3].y*w, m32 = matrix->data[3].z*w;
+
+    for(int i = 0; i < count; i++) {
+        const Vec3 *const src = (const Vec3*)(in + (long)i*inStride);
+        Vec3 *const dest = (Vec3*)(out + (long)i*outStride);
+        scalar x = src->x, y = src->y, z = src->z;
+
+        dest->x = m00*x + m10*y + m20*z + m30;
+        dest->y = m01*x + m11*y + m21*z + m31;
+        dest->z = m02*x + m12*y + m22*z + m32;
+    }
+}
+
+static void transformPoints(const Mat4 *const matrix, const Vec3 *const in, Vec3 *const out, int count) {
+    transformVec3s(matrix, (const char*)in, sizeof(Vec3), (char*)out, sizeof(Vec3), count, 1);
+}
+
+static void transformDirections(const Mat4 *const matrix, const Vec3 *const in, Vec3 *const out, int count) {
+    transformVec3s(matrix, (const char*)in, sizeof(Vec3), (char*)out, sizeof(Vec3), count, 0);
+}
+
+static void transformPointsStrided(const Mat4 *const matrix, const void *const in, int inStride, void *const out, int outStride, int count) {
+    transformVec3s(matrix, in, inStride, out, outStride, count, 1);
+}
+
+static void transformDirectionsStrided(const Mat4 *const matrix, const void *const in, int inStride, void *const out, int outStride, int count) {
+    transformVec3s(matrix, in, inStride, out, outStride, count, 0);
+}
+
+#ifdef COH_SIMD_SSE
+static void loadColumns(const Mat4 *const matrix, __m128 *const cols) {
+    cols[0] = _mm_loadu_ps(&matrix->data[0].x);
+    cols[1] = _mm_loadu_ps(&matrix->data[1].x);
+    cols[2] = _mm_loadu_ps(&matrix->data[2].x);
+    cols[3] = _mm_loadu_ps(&matrix->data[3].x);
+}
+
+static Mat4 storeColumns(__m128 col0, __m128 col1, __m128 col2, __m128 col3) {
+    Mat4 result;
+
+    _mm_storeu_ps(&result.data[0].x, col0);
+    _mm_storeu_ps(&result.data[1].x, col1);
+    _mm_storeu_ps(&result.data[2].x, col2);
+    _mm_storeu_ps(&result.data[3].x, col3);
+
+    return result;
+}
+
+/*
+ * cols * v, summed in the same order as the row-column dot products of the scalar version.
+ */
+static __m128 mulColumns(const __m128 *const cols, __m128 v) {
+    __m128 result = _mm_mul_ps(cols[0], COH_SIMD_SHUFFLE(v, 0, 0, 0, 0));
+    result = _mm_add_ps(result, _mm_mul_ps(cols[1], COH_SIMD_SHUFFLE(v, 1, 1, 1, 1)));
+    result = _mm_add_ps(result, _mm_mul_ps(cols[2], COH_SIMD_SHUFFLE(v, 2, 2, 2, 2)));
+    return _mm_add_ps(result, _mm_mul_ps(cols[3], COH_SIMD_SHUFFLE(v, 3, 3, 3, 3)));
+}
+
+static Mat4 sumSimd(const Mat4 *const mat1, const Mat4 *const mat2) {
+    __m128 a[4], b[4];
+    loadColumns(mat1, a);
+    loadColumns(mat2, b);
+
+    return storeColumns(_mm_add_ps(a[0], b[0]), _mm_add_ps(a[1], b[1]), _mm_add_ps(a[2], b[2]), _mm_add_ps(a[3], b[3]));
+}
+
+static Mat4 subSimd(const Mat4 *const mat1, const Mat4 *const mat2) {
+    __m128 a[4], b[4];
+    loadColumns(mat1, a);
+    loadColumns(mat2, b);
+
+    return storeColumns(_mm_sub_ps(a[0], b[0]), _mm_sub_ps(a[1], b[1]), _mm_sub_ps(a[2], b[2]), _mm_sub_ps(a[3], b[3]));
+}
+
+static Mat4 postMulScalarSimd(const Mat4 *const matrix, scalar factor) {
+    __m128 cols[4];
+    __m128 f = _mm_set1_ps(factor);
+    loadColumns(matrix, cols);
+
+    return storeColumns(_mm_mul_ps(cols[0], f), _mm_mul_ps(cols[1], f), _mm_mul_ps(cols[2], f), _mm_mul_ps(cols[3], f));
+}
+
+static Mat4 preMulScalarSimd(scalar factor, const Mat4 *const matrix) {
+    return postMulScalarSimd(matrix, factor);
+}
+
+static Mat4 mulSimd(const Mat4 *const mat1, const Mat4 *const mat2) {
+    __m128 a[4];
+    loadColumns(mat1, a);
+
+    return storeColumns(
+        mulColumns(a, _mm_loadu_ps(&mat2->data[0].x)),
+        mulColumns(a, _mm_loadu_ps(&mat2->data[1].x)),
+        mulColumns(a, _mm_loadu_ps(&mat2->data[2].x)),
+        mulColumns(a, _mm_loadu_ps(&mat2->data[3].x))
+    );
+}
+
+static Vec4 postMulVec4Simd(const Mat4 *const matrix, const Vec4 *const col) {
+    __m128 cols[4];
+    loadColumns(matrix, cols);
+
+    Vec4 result;
+    _mm_storeu_ps(&result.x, mulColumns(cols, _mm_loadu_ps(&col->x)));
+    return result;
+}
+
+static Vec4 preMulVec4Simd(const Vec4 *const row, const Mat4 *const matrix) {
+    //Each result is the row dotted with a column, so transpose and sum the other way.
+    __m128 rows[4];
+    loadColumns(matrix, rows);
+    _MM_TRANSPOSE4_PS(rows[0], rows[1], rows[2], rows[3]);
+
+    Vec4 result;
+    _mm_storeu_ps(&result.x, mulColumns(rows, _mm_loadu_ps(&row->x)));
+    return result;
+}
+
+/*
+ * (a*sa - b*sb) + c*sc for each lane, which is the shape of every co-factor.
+ */
+static __m128 cofactors(__m128 a, __m128 sa, __m128 b, __m128 sb, __m128 c, __m128 sc) {
+    return _mm_add_ps(_mm_sub_ps(_mm_mul_ps(a, sa), _mm_mul_ps(b, sb)), _mm_mul_ps(c, sc));
+}
+
+/*
+ * a_i*b_j - a_j*b_i for the column pairs (2,3), (1,3), (1,2), (0,3) and (0,2), (0,1).
+ */
+static void subFactors(__m128 a, __m128 b, float *const out) {
+    __m128 first = _mm_sub_ps(
+        _mm_mul_ps(COH_SIMD_SHUFFLE(a, 2, 1, 1, 0), COH_SIMD_SHUFFLE(b, 3, 3, 2, 3)),
+        _mm_mul_ps(COH_SIMD_SHUFFLE(a, 3, 3, 2, 3), COH_SIMD_SHUFFLE(b, 2, 1, 1, 0))
+    );
+    __m128 second = _mm_sub_ps(
+        _mm_mul_ps(COH_SIMD_SHUFFLE(a, 0, 0, 0, 0), COH_SIMD_SHUFFLE(b, 2, 1, 2, 1)),
+        _mm_mul_ps(COH_SIMD_SHUFFLE(a, 2, 1, 2, 1), COH_SIMD_SHUFFLE(b, 0, 0, 0, 0))
+    );
+
+    _mm_storeu_ps(out, first);
+    float tmp[4];
+    _mm_storeu_ps(tmp, second);
+    out[4] = tmp[0];
+    out[5] = tmp[1];
+}
+
+static Mat4 inverseSimd(const Mat4 *const matrix) {
+    //Same Laplace expansion as the scalar version, with rows of the matrix in registers.
+    __m128 rows[4];
+    loadColumns(matrix, rows);
+    _MM_TRANSPOSE4_PS(rows[0], rows[1], rows[2], rows[3]);
+
+    //zw: sub00, sub01, sub02, sub03, sub04, sub05
+    //yw: sub12, sub13, sub14, sub07, sub15, sub08 (sub06 is the same as sub14)
+    //yz: sub16, sub17, sub18, sub19, sub11, sub10
+    float zw[6], yw[6], yz[6];
+    subFactors(rows[2], rows[3], zw);
+    subFactors(rows[1], rows[3], yw);
+    subFactors(rows[1], rows[2], yz);
+
+    const Vec4 *const m = matrix->data;
+    __m128 ay = _mm_setr_ps(m[1].y, m[0].y, m[0].y, m[0].y);
+    __m128 by = _mm_setr_ps(m[2].y, m[2].y, m[1].y, m[1].y);
+    __m128 cy = _mm_setr_ps(m[3].y, m[3].y, m[3].y, m[2].y);
+    __m128 ax = _mm_setr_ps(m[1].x, m[0].x, m[0].x, m[0].x);
+    __m128 bx = _mm_setr_ps(m[2].x, m[2].x, m[1].x, m[1].x);
+    __m128 cx = _mm_setr_ps(m[3].x, m[3].x, m[3].x, m[2].x);
+
+    __m128 sa = _mm_setr_ps(zw[0], zw[0], zw[1], zw[2]);
+    __m128 sb = _mm_setr_ps(zw[1], zw[3], zw[3], zw[4]);
+    __m128 sc = _mm_setr_ps(zw[2], zw[4], zw[5], zw[5]);
+    __m128 cof0 = simdNegate(cofactors(ay, sa, by, sb, cy, sc), 0, 1, 0, 1);
+    __m128 cof1 = simdNegate(cofactors(ax, sa, bx, sb, cx, sc), 1, 0, 1, 0);
+
+    sa = _mm_setr_ps(yw[0], yw[0], yw[1], yw[2]);
+    sb = _mm_setr_ps(yw[1], yw[3], yw[3], yw[4]);
+    sc = _mm_setr_ps(yw[2], yw[4], yw[5], yw[5]);
+    __m128 cof2 = simdNegate(cofactors(ax, sa, bx, sb, cx, sc), 0, 1, 0, 1);
+
+    sa = _mm_setr_ps(yz[0], yz[0], yz[1], yz[2]);
+    sb = _mm_setr_ps(yz[1], yz[3], yz[3], yz[4]);
+    sc = _mm_setr_ps(yz[2], yz[4], yz[5], yz[5]);
+    __m128 cof3 = simdNegate(cofactors(ax, sa, bx, sb, cx, sc), 1, 0, 1, 0);
+
+    float det = simdSumInOrder(_mm_mul_ps(rows[0], cof0));
+    __m128 invDet = _mm_set1_ps(1/det);
+
+    return storeColumns(_mm_mul_ps(cof0, invDet), _mm_mul_ps(cof1, invDet), _mm_mul_ps(cof2, invDet), _mm_mul_ps(cof3, invDet));
+}
+
+static Mat4 affScaleSimd(const Mat4 *const matrix, const Vec3 *const scale) {
+    __m128 cols[4];
+    loadColumns(matrix, cols);
+
+    return storeColumns(
+        _mm_mul_ps(cols[0], _mm_set1_ps(scale->x)),
+        _mm_mul_ps(cols[1], _mm_set1_ps(scale->y)),
+        _mm_mul_ps(cols[2], _mm_set1_ps(scale->z)),
+        cols[3]
+    );
+}
+
+static Mat4 affTranslateSimd(const Mat4 *const matrix, const Vec3 *const translation) {
+    __m128 cols[4];
+    loadColumns(matrix, cols);
+
+    __m128 offset = _mm_mul_ps(cols[0], _mm_set1_ps(translation->x));
+    offset = _mm_add_ps(offset, _mm_mul_ps(cols[1], _mm_set1_ps(translation->y)));
+    offset = _mm_add_ps(offset, _mm_mul_ps(cols[2], _mm_set1_ps(translation->z)));
+
+    return storeColumns(cols[0], cols[1], cols[2], _mm_add_ps(cols[3], offset));
+}
+
+static __m128 rotateColumn(const __m128 *const cols, scalar m0, scalar m1, scalar m2) {
+    __m128 result = _mm_mul_ps(cols[0], _mm_set1_ps(m0));
+    result = _mm_add_ps(result, _mm_mul_ps(cols[1], _mm_set1_ps(m1)));
+    return _mm_add_ps(result, _mm_mul_ps(cols[2], _mm_set1_ps(m2)));
+}
+
+static Mat4 affRotateSimd(const Mat4 *const matrix, const scalar angle, const Vec3 *const axis) {
+    __m128 cols[4];
+    loadColumns(matrix, cols);
+
+    scalar aCos = (scalar) scalar_cos(angle);
+    scalar aSin = (scalar) scalar_sin(angle);
+    scalar invC = 1.0f - aCos;
+
+    scalar xx = axis->x*axis->x*invC;
+    scalar yy = axis->y*axis->y*invC;
+    scalar zz = axis->z*axis->z*invC;
+
+    scalar xy = axis->x*axis->y*invC;
+    scalar yz = axis->y*axis->z*invC;
+    scalar xz = axis->x*axis->z*invC;
+
+    scalar xsin = axis->x*aSin;
+    scalar ysin = axis->y*aSin;
+    scalar zsin = axis->z*aSin;
+
+    return storeColumns(
+        rotateColumn(cols, xx + aCos, xy + zsin, xz - ysin),
+        rotateColumn(cols, xy - zsin, yy + aCos, yz + xsin),
+        rotateColumn(cols, xz + ysin, yz - xsin, zz + aCos),
+        cols[3]
+    );
+}
+
+static void transformVec3sSimd(const Mat4 *const matrix, const char* in, int inStride, char* out, int outStride, int count, scalar w) {
+    __m128 cols[4];
+    loadColumns(matrix, cols);
+    //The last column is always multiplied by the same w, so do it once.
+    __m128 last = _mm_mul_ps(cols[3], _mm_set1_ps(w));
+
+    for(int i = 0; i < count; i++) {
+        const Vec3 *const src = (const Vec3*)(in + (long)i*inStride);
+        Vec3 *const dest = (Vec3*)(out + (long)i*outStride);
+
+        __m128 result = _mm_mul_ps(cols[0], _mm_set1_ps(src->x));
+        result = _mm_add_ps(result, _mm_mul_ps(cols[1], _mm_set1_ps(src->y)));
+        result = _mm_add_ps(result, _mm_mul_ps(cols[2], _mm_set1_ps(src->z)));
+        result = _mm_add_ps(result, last);
+
+        //Write only x, y and z so the last element can't overrun the array.
+        _mm_storel_pi((__m64*)&dest->x, result);
+        _mm_store_ss(&dest->z, _mm_movehl_ps(result, result));
+    }
+}
+
+static void transformPointsSimd(const Mat4 *const matrix, const Vec3 *const in, Vec3 *const out, int count) {
+    transformVec3sSimd(matrix, (const char*)in, sizeof(Vec3), (char*)out, sizeof(Vec3), count, 1);
+}
+
+static void transformDirectionsSimd(const Mat4 *const matrix, const Vec3 *const in, Vec3 *const out, int count) {
+    transformVec3sSimd(matrix, (const char*)in, sizeof(Vec3), (char*)out, sizeof(Vec3), count, 0);
+}
+
+static void transformPointsStridedSimd(const Mat4 *const matrix, const void *const in, int inStride, void *const out, int outStride, int count) {
+    transformVec3sSimd(matrix, in, inStride, out, outStride, count, 1);
+}
+
+static void transformDirectionsStridedSimd(const Mat4 *const matrix, const void *const in, int inStride, void *const out, int outStride, int count) {
+    transformVec3sSimd(matrix, in, inStride, out, outStride, count, 0);
+}
+
+const Mat4Manager manMat4 = {create, createLeading, createFromVec4, createFromMat4, sumSimd, subSimd, postMulScalarSimd, preMulScalarSimd, mulSimd, postMulVec4Simd, preMulVec4Simd, inverseSimd, getMat4Data, affScaleSimd, affTranslateSimd, affRotateSimd, transformPointsSimd, transformDirectionsSimd, transformPointsStridedSimd, transformDirectionsStridedSimd};
+#else
+const Mat4Manager manMat4 = {create, createLeading, createFromVec4, createFromMat4, sum, sub, postMulScalar, preMulScalar, mul, postMulVec4, preMulVec4, inverse, getMat4Data, affScale, affTranslate, affRotate, transformPoints, transformDirections, transformPointsStrided, transformDirectionsStrided};
+#endif
+
+const Mat4Manager manMat4Scalar = {create, createLeading, createFromVec4, createFromMat4, sum, sub, postMulScalar, preMulScalar, mul, postMulVec4, preMulVec4, inverse, getMat4Data, affScale, affTranslate, affRotate, transformPoints, transformDirections, transformPointsStrided, transformDirectionsStrided};
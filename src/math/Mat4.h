@@ -198,6 +198,54 @@ typedef struct Mat4Manager_s {
      */
     Mat4(* affRotate)(const Mat4 *const matrix, const scalar angle, const Vec3 *const axis);
 
+    /**
+     *  Transforms an array of points (w = 1) by the given matrix. Gives the same
+     *  results as calling postMulVec4 on each point, but the matrix is only loaded once.
+     *  in and out may be the same array.
+     *
+     *  @param  matrix  const pointer to const Mat4, matrix to transform by.
+     *  @param  in      const pointer to const Vec3, points to transform.
+     *  @param  out     const pointer to Vec3, array to write the transformed points to.
+     *  @param  count   int, number of points.
+     */
+    void(* transformPoints)(const Mat4 *const matrix, const Vec3 *const in, Vec3 *const out, int count);
+
+    /**
+     *  Transforms an array of directions (w = 0) by the given matrix, so translation is ignored.
+     *  in and out may be the same array.
+     *
+     *  @param  matrix  const pointer to const Mat4, matrix to transform by.
+     *  @param  in      const pointer to const Vec3, directions to transform.
+     *  @param  out     const pointer to Vec3, array to write the transformed directions to.
+     *  @param  count   int, number of directions.
+     */
+    void(* transformDirections)(const Mat4 *const matrix, const Vec3 *const in, Vec3 *const out, int count);
+
+    /**
+     *  Transforms points stored inside larger structures, eg. vertex positions in an
+     *  interleaved vertex buffer. Each Vec3 is read from in + i*inStride and written to out + i*outStride.
+     *
+     *  @param  matrix      const pointer to const Mat4, matrix to transform by.
+     *  @param  in          const pointer to const void, the first point to transform.
+     *  @param  inStride    int, bytes between the start of each input point.
+     *  @param  out         const pointer to void, where to write the first transformed point.
+     *  @param  outStride   int, bytes between the start of each output point.
+     *  @param  count       int, number of points.
+     */
+    void(* transformPointsStrided)(const Mat4 *const matrix, const void *const in, int inStride, void *const out, int outStride, int count);
+
+    /**
+     *  Transforms directions stored inside larger structures, see transformPointsStrided.
+     *
+     *  @param  matrix      const pointer to const Mat4, matrix to transform by.
+     *  @param  in          const pointer to const void, the first direction to transform.
+     *  @param  inStride    int, bytes between the start of each input direction.
+     *  @param  out         const pointer to void, where to write the first transformed direction.
+     *  @param  outStride   int, bytes between the start of each output direction.
+     *  @param  count       int, number of directions.
+     */
+    void(* transformDirectionsStrided)(const Mat4 *const matrix, const void *const in, int inStride, void *const out, int outStride, int count);
+
 } Mat4Manager;
 
 // Mat4 createMat4(        scalar el00, scalar el10, scalar el20, scalar el30, 
@@ -217,4 +265,10 @@ typedef struct Mat4Manager_s {
 // Mat4 inverseMat4(const Mat4 *const matrix);
 
 extern const Mat4Manager manMat4;
+
+/**
+ *  The scalar implementation, which manMat4 is the same as when SIMD is disabled (see "Simd.h").
+ *  Used as the reference when testing the SIMD backend.
+ */
+extern const Mat4Manager manMat4Scalar;
 #endif
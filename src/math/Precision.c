@@ -0,0 +1,145 @@
+#include "Precision.h"
+
+#define PRECISION_LN2 0.6931471805599453094
+#define PRECISION_LOG2E 1.4426950408889634074
+#define PRECISION_SQRT1_2 0.7071067811865475244
+#define PRECISION_PI 3.1415926535897932385
+#define PRECISION_PI_2 1.5707963267948966192
+#define PRECISION_2_PI 0.6366197723675813431
+//pi/2 split so PRECISION_PI_2_HIGH*k is exact for the k a scalar angle reduces by.
+#define PRECISION_PI_2_HIGH 1.5707963267341256142
+#define PRECISION_PI_2_LOW 6.0771005065061922e-11
+
+/*
+ * Natural logarithm of a positive x. frexp splits off the exponent exactly, the mantissa
+ * is brought within [sqrt(1/2), sqrt(2)) and its logarithm is 2*atanh((m-1)/(m+1)).
+ */
+static double portableLog(double x) {
+    int exponent;
+    double mantissa = frexp(x, &exponent);
+    if (mantissa < PRECISION_SQRT1_2) {
+        mantissa *= 2;
+        exponent--;
+    }
+
+    double s = (mantissa - 1)/(mantissa + 1);
+    double s2 = s*s;
+    double term = s;
+    double sum = 0;
+    for(int i = 1; i <= 25; i += 2) {
+        sum += term/i;
+        term *= s2;
+    }
+
+    return 2*sum + exponent*PRECISION_LN2;
+}
+
+/*
+ * e^x, as 2^k*e^r with |r| <= ln(2)/2. ldexp applies 2^k exactly.
+ */
+static double portableExp(double x) {
+    double k = floor(x*PRECISION_LOG2E + 0.5);
+    double r = x - k*PRECISION_LN2;
+
+    double term = 1;
+    double sum = 1;
+    for(int i = 1; i <= 16; i++) {
+        term *= r/i;
+        sum += term;
+    }
+
+    return ldexp(sum, (int)k);
+}
+
+/*
+ * sin and cos of r within [-pi/4, pi/4], from their Taylor series.
+ */
+static double portableSinReduced(double r) {
+    double r2 = r*r;
+    double term = r;
+    double sum = r;
+    for(int i = 2; i <= 20; i += 2) {
+        term *= -r2/(i*(i + 1));
+        sum += term;
+    }
+    return sum;
+}
+
+static double portableCosReduced(double r) {
+    double r2 = r*r;
+    double term = 1;
+    double sum = 1;
+    for(int i = 1; i <= 19; i += 2) {
+        term *= -r2/(i*(i + 1));
+        sum += term;
+    }
+    return sum;
+}
+
+/*
+ * Brings x to r within [-pi/4, pi/4] of k*pi/2, returning k mod 4.
+ */
+static int portableReduce(double x, double* r) {
+    double k = floor(x*PRECISION_2_PI + 0.5);
+    *r = (x - k*PRECISION_PI_2_HIGH) - k*PRECISION_PI_2_LOW;
+    return (int)(k - 4*floor(k/4));
+}
+
+/*
+ * atan of x, halving the angle with atan(x) = 2*atan(x/(1 + sqrt(1 + x*x))) until |x| <= tan(pi/8).
+ */
+static double portableAtan(double x) {
+    if (fabs(x) > 1)
+        return (x > 0 ? PRECISION_PI_2 : -PRECISION_PI_2) - portableAtan(1/x);
+
+    double x2 = x*x;
+    double halved = x/(1 + sqrt(1 + x2));
+    x2 = halved*halved;
+
+    double term = halved;
+    double sum = 0;
+    for(int i = 1; i <= 31; i += 2) {
+        sum += term/i;
+        term *= -x2;
+    }
+    return 2*sum;
+}
+
+scalar scalar_portableSin(scalar angle) {
+    double r;
+    switch(portableReduce(angle, &r)) {
+        case 0: return (scalar)portableSinReduced(r);
+        case 1: return (scalar)portableCosReduced(r);
+        case 2: return (scalar)-portableSinReduced(r);
+        default: return (scalar)-portableCosReduced(r);
+    }
+}
+
+scalar scalar_portableCos(scalar angle) {
+    double r;
+    switch(portableReduce(angle, &r)) {
+        case 0: return (scalar)portableCosReduced(r);
+        case 1: return (scalar)-portableSinReduced(r);
+        case 2: return (scalar)-portableCosReduced(r);
+        default: return (scalar)portableSinReduced(r);
+    }
+}
+
+scalar scalar_portableAtan2(scalar y, scalar x) {
+    if (x == 0)
+        return y == 0 ? 0 : (y > 0 ? PRECISION_PI_2 : -PRECISION_PI_2);
+
+    double angle = portableAtan((double)y/x);
+    if (x < 0)
+        angle += signbit(y) ? -PRECISION_PI : PRECISION_PI;
+    return (scalar)angle;
+}
+
+scalar scalar_portablePow(scalar base, scalar exponent) {
+    if (exponent == 0 || base == 1)
+        return 1;
+    if (base <= 0)
+        return base == 0 ? 0 : NAN;
+
+    return (scalar)portableExp(exponent*portableLog(base));
+}
@@ -7,10 +7,56 @@
 #define SCALAR_MAX_VAL FLT_MAX
 #define SCALAR_MIN_VAL -FLT_MAX
 #define scalar_abs 		fabsf
+
+/**
+ *  Raises base to exponent. Built with COH_DETERMINISTIC (scons deterministic=1) this is
+ *  scalar_portablePow, which only uses basic arithmetic, so it gives the same bits with any
+ *  C library. Otherwise it is the C library's pow, whose last bit varies between libraries.
+ */
+#ifdef COH_DETERMINISTIC
+#define scalar_pow 		scalar_portablePow
+#else
+#define scalar_pow 		pow
+#endif
+
+/**
+ *  Trigonometry, which the C library computes differently on each platform. Built with
+ *  COH_DETERMINISTIC these are the portable versions below, otherwise the C library's.
+ */
+#ifdef COH_DETERMINISTIC
+#define scalar_sin 		scalar_portableSin
+#define scalar_cos 		scalar_portableCos
+#define scalar_atan2 	scalar_portableAtan2
+#else
+#define scalar_sin 		sin
+#define scalar_cos 		cos
+#define scalar_atan2 	atan2
+#endif
 /**
  *  Used in math classes, allows us to easily change the precision
  *  of our physics calculations.
  */
 typedef float scalar;
 
+/**
+ *  pow for a positive base, from a series for the logarithm and one for the exponential.
+ *  Only exact IEEE operations are used, so it is reproducible on any platform as long as
+ *  the compiler keeps to strict floating point. Accurate to about a double ulp, well within
+ *  a scalar's precision.
+ */
+scalar scalar_portablePow(scalar base, scalar exponent);
+
+/**
+ *  sin and cos of an angle in radians, from series on the angle brought within pi/4 of a
+ *  multiple of pi/2. Like scalar_portablePow only exact IEEE operations are used. Accurate to
+ *  a few double ulps for angles up to about 1e6 radians, past which the reduction loses bits.
+ */
+scalar scalar_portableSin(scalar angle);
+scalar scalar_portableCos(scalar angle);
+
+/**
+ *  atan2 from a series on the ratio brought within tan(pi/8), built the same way.
+ */
+scalar scalar_portableAtan2(scalar y, scalar x);
+
 #endif
@@ -1,4 +1,5 @@
 #include "Quat.h"
+#include "Simd.h"
 
 #include <math.h>
 
@@ -97,8 +98,8 @@ static Mat4 castMat4(const Quat *const quat) {
 static void offsetAxis(Quat *const quat, const Vec3 *const axis, float angleRad) {
     Vec3 axisN = manVec3.normalize(axis);
 
-    axisN = manVec3.postMulScalar(&axisN, sinf(angleRad / 2.0f));
-    scalar scalar = cosf(angleRad / 2.0f);
+    axisN = manVec3.postMulScalar(&axisN, scalar_sin(angleRad / 2.0f));
+    scalar scalar = scalar_cos(angleRad / 2.0f);
 
     Quat offset = manQuat.createFromAxisScalar(NULL, &axisN, scalar);
     
@@ -115,8 +116,8 @@ static void offsetAxisXYZ(Quat *const quat, scalar x, scalar y, scalar z, float
     Vec3 axis = manVec3.create(NULL, x, y, z);
     Vec3 axisN = manVec3.normalize(&axis);
 
-    axisN = manVec3.postMulScalar(&axisN, sinf(angleRad / 2.0f));
-    scalar scalar = cosf(angleRad / 2.0f);
+    axisN = manVec3.postMulScalar(&axisN, scalar_sin(angleRad / 2.0f));
+    scalar scalar = scalar_cos(angleRad / 2.0f);
 
     Quat offset = manQuat.createFromAxisScalar(NULL, &axisN, scalar);
     
@@ -127,4 +128,67 @@ static scalar magnitude(const Quat *const self) {
     return ( sqrt(pow(self->x, 2) + pow(self->y, 2) + pow(self->z, 2) + pow(self->w, 2)) );
 }
 
+#ifdef COH_SIMD_SSE
+static Quat mulSimd(const Quat *const q1, const Quat *const q2) {
+    __m128 a = _mm_loadu_ps(&q1->x);
+    __m128 b = _mm_loadu_ps(&q2->x);
+
+    //Each lane is (t1 + t2 + t3) - t4, except w which subtracts every term.
+    __m128 t1 = _mm_mul_ps(COH_SIMD_SHUFFLE(a, 3, 3, 3, 3), b);
+    __m128 t2 = _mm_mul_ps(COH_SIMD_SHUFFLE(a, 0, 1, 2, 0), COH_SIMD_SHUFFLE(b, 3, 3, 3, 0));
+    __m128 t3 = _mm_mul_ps(COH_SIMD_SHUFFLE(a, 1, 2, 0, 1), COH_SIMD_SHUFFLE(b, 2, 0, 1, 1));
+    __m128 t4 = _mm_mul_ps(COH_SIMD_SHUFFLE(a, 2, 0, 1, 2), COH_SIMD_SHUFFLE(b, 1, 2, 0, 2));
+
+    __m128 result = _mm_add_ps(t1, simdNegate(t2, 0, 0, 0, 1));
+    result = _mm_add_ps(result, simdNegate(t3, 0, 0, 0, 1));
+    result = _mm_sub_ps(result, t4);
+
+    Quat quat;
+    _mm_storeu_ps(&quat.x, result);
+    return quat;
+}
+
+static scalar dotSimd(const Quat *const q1, const Quat *const q2) {
+    return simdSumInOrder(_mm_mul_ps(_mm_loadu_ps(&q1->x), _mm_loadu_ps(&q2->x)));
+}
+
+/*
+ * (a + b) + c per lane with the flagged lanes of b and c subtracted instead.
+ * Lanes with nothing to add are given -0, as x + -0 is exactly x.
+ */
+static __m128 castColumn(__m128 a, __m128 b, __m128 c, int bx, int by, int bz, int cx, int cy, int cz) {
+    __m128 result = _mm_add_ps(a, simdNegate(b, bx, by, bz, 0));
+    return _mm_add_ps(result, simdNegate(c, cx, cy, cz, 0));
+}
+
+static Mat4 castMat4Simd(const Quat *const quat) {
+    __m128 q = _mm_loadu_ps(&quat->x);
+    __m128 two = _mm_mul_ps(_mm_set1_ps(2), q);
+
+    //(2x)x, (2y)y, (2z)z, (2w)x and (2x)y, (2x)z, (2y)z, (2w)y and (2w)z
+    float sq[4], mixed[4], wz[4];
+    _mm_storeu_ps(sq, _mm_mul_ps(two, COH_SIMD_SHUFFLE(q, 0, 1, 2, 0)));
+    _mm_storeu_ps(mixed, _mm_mul_ps(COH_SIMD_SHUFFLE(two, 0, 0, 1, 3), COH_SIMD_SHUFFLE(q, 1, 2, 2, 1)));
+    _mm_storeu_ps(wz, _mm_mul_ps(two, COH_SIMD_SHUFFLE(q, 0, 0, 0, 2)));
+    float xx = sq[0], yy = sq[1], zz = sq[2], wx = sq[3];
+    float xy = mixed[0], xz = mixed[1], yz = mixed[2], wy = mixed[3];
+    float wzz = wz[3];
+
+    __m128 col0 = castColumn(_mm_setr_ps(1, xy, xz, 0), _mm_setr_ps(yy, -0.0f, -0.0f, -0.0f), _mm_setr_ps(zz, wzz, wy, -0.0f), 1, 0, 0, 1, 0, 1);
+    __m128 col1 = castColumn(_mm_setr_ps(xy, 1, yz, 0), _mm_setr_ps(-0.0f, xx, -0.0f, -0.0f), _mm_setr_ps(wzz, zz, wx, -0.0f), 0, 1, 0, 1, 1, 0);
+    __m128 col2 = castColumn(_mm_setr_ps(xz, yz, 1, 0), _mm_setr_ps(-0.0f, -0.0f, xx, -0.0f), _mm_setr_ps(wy, wx, yy, -0.0f), 0, 0, 1, 0, 1, 1);
+
+    Mat4 result;
+    _mm_storeu_ps(&result.data[0].x, col0);
+    _mm_storeu_ps(&result.data[1].x, col1);
+    _mm_storeu_ps(&result.data[2].x, col2);
+    _mm_storeu_ps(&result.data[3].x, _mm_setr_ps(0.0f, 0.0f, 0.0f, 1.0f));
+    return result;
+}
+
+const QuatManager manQuat = {create, createFromAxisScalar, invert, mulSimd, normalize, dotSimd, castMat4Simd, offsetAxis, offsetAxisXYZ, magnitude};
+#else
 const QuatManager manQuat = {create, createFromAxisScalar, invert, mul, normalize, dot, castMat4, offsetAxis, offsetAxisXYZ, magnitude};
+#endif
+
+const QuatManager manQuatScalar = {create, createFromAxisScalar, invert, mul, normalize, dot, castMat4, offsetAxis, offsetAxisXYZ, magnitude};
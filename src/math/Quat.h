@@ -135,4 +135,10 @@ typedef struct QuatManager_s {
 
 extern const QuatManager manQuat;
 
+/**
+ *  The scalar implementation, which manQuat is the same as when SIMD is disabled (see "Simd.h").
+ *  Used as the reference when testing the SIMD backend.
+ */
+extern const QuatManager manQuatScalar;
+
 #endif
@@ -0,0 +1,73 @@
+#ifndef MATH_SIMD_H
+#define MATH_SIMD_H
+
+/**
+ *  Selects the SIMD backend used by the math managers.
+ *
+ *  Define COH_SIMD to use SSE where the target supports it (always the case on x86-64).
+ *  Otherwise, or on other targets, the scalar implementations are used.
+ *
+ *  The SIMD versions do the same float operations in the same order as the
+ *  scalar ones, only several lanes at a time, so results are bit-for-bit identical
+ *  (as long as the compiler is not allowed to contract into fused multiply-adds).
+ */
+#if defined(COH_SIMD) && (defined(__SSE2__) || defined(_M_X64))
+#define COH_SIMD_SSE 1
+#endif
+
+#ifdef COH_SIMD_SSE
+
+#include <emmintrin.h>
+
+#include "Vec3.h"
+
+/** Shuffle lanes of a, taking lane x, y, z and w of the result from the given lanes. **/
+#define COH_SIMD_SHUFFLE(a, x, y, z, w) _mm_shuffle_ps((a), (a), _MM_SHUFFLE((w), (z), (y), (x)))
+
+/**
+ *  Loads a Vec3 into the low three lanes of a register, the last lane is 0.
+ */
+static inline __m128 simdLoadVec3(const Vec3 *const vec) {
+    return _mm_set_ps(0.0f, vec->z, vec->y, vec->x);
+}
+
+/**
+ *  Stores the low three lanes of a register as a Vec3.
+ */
+static inline Vec3 simdStoreVec3(__m128 v) {
+    float out[4];
+    _mm_storeu_ps(out, v);
+
+    Vec3 result = {out[0], out[1], out[2]};
+    return result;
+}
+
+/**
+ *  Flips the sign of the lanes whose flag is set. Exact, so a + simdNegate(b) is the same as a - b.
+ */
+static inline __m128 simdNegate(__m128 v, int x, int y, int z, int w) {
+    __m128 mask = _mm_set_ps(w ? -0.0f : 0.0f, z ? -0.0f : 0.0f, y ? -0.0f : 0.0f, x ? -0.0f : 0.0f);
+    return _mm_xor_ps(v, mask);
+}
+
+/**
+ *  Sums the low three lanes in the order x + y + z, the same as the scalar Vec3 dot product.
+ */
+static inline float simdSumInOrder3(__m128 v) {
+    float out[4];
+    _mm_storeu_ps(out, v);
+    return out[0] + out[1] + out[2];
+}
+
+/**
+ *  Sums the lanes in the order x + y + z + w, the same as the scalar Vec4 dot product.
+ */
+static inline float simdSumInOrder(__m128 v) {
+    float out[4];
+    _mm_storeu_ps(out, v);
+    return out[0] + out[1] + out[2] + out[3];
+}
+
+#endif
+
+#endif
@@ -1,4 +1,5 @@
 #include "Vec3.h"
+#include "Simd.h"
 
 #include <math.h>
 #include <assert.h>
@@ -128,4 +129,44 @@ static scalar magnitude(const Vec3 *const vec) {
     return (sqrt(pow(vec->x, 2) + pow(vec->y, 2) + pow(vec->z, 2)));
 }
 
+#ifdef COH_SIMD_SSE
+static Vec3 sumSimd(const Vec3 *const v1, const Vec3 *const v2) {
+    return simdStoreVec3(_mm_add_ps(simdLoadVec3(v1), simdLoadVec3(v2)));
+}
+
+static Vec3 subSimd(const Vec3 *const v1, const Vec3 *const v2) {
+    return simdStoreVec3(_mm_sub_ps(simdLoadVec3(v1), simdLoadVec3(v2)));
+}
+
+static Vec3 postMulScalarSimd(const Vec3 *const vec, scalar factor) {
+    return simdStoreVec3(_mm_mul_ps(_mm_set1_ps(factor), simdLoadVec3(vec)));
+}
+
+static Vec3 preMulScalarSimd(scalar factor, const Vec3 *const vec) {
+    return postMulScalarSimd(vec, factor);
+}
+
+static Vec3 invertSimd(const Vec3 *const vec) {
+    return simdStoreVec3(simdNegate(simdLoadVec3(vec), 1, 1, 1, 1));
+}
+
+static scalar dotSimd(const Vec3 *const v1, const Vec3 *const v2) {
+    return simdSumInOrder3(_mm_mul_ps(simdLoadVec3(v1), simdLoadVec3(v2)));
+}
+
+static Vec3 crossSimd(const Vec3 *const v1, const Vec3 *const v2) {
+    __m128 a = simdLoadVec3(v1);
+    __m128 b = simdLoadVec3(v2);
+
+    //(y1*z2, z1*x2, x1*y2) - (z1*y2, x1*z2, y1*x2)
+    __m128 left = _mm_mul_ps(COH_SIMD_SHUFFLE(a, 1, 2, 0, 3), COH_SIMD_SHUFFLE(b, 2, 0, 1, 3));
+    __m128 right = _mm_mul_ps(COH_SIMD_SHUFFLE(a, 2, 0, 1, 3), COH_SIMD_SHUFFLE(b, 1, 2, 0, 3));
+    return simdStoreVec3(_mm_sub_ps(left, right));
+}
+
+const Vec3Manager manVec3 = {create, createFromVec3, sumSimd, subSimd, postMulScalarSimd, preMulScalarSimd, invertSimd, dotSimd, crossSimd, normalize, magnitude};
+#else
 const Vec3Manager manVec3 = {create, createFromVec3, sum, sub, postMulScalar, preMulScalar, invert, dot, cross, normalize, magnitude};
+#endif
+
+const Vec3Manager manVec3Scalar = {create, createFromVec3, sum, sub, postMulScalar, preMulScalar, invert, dot, cross, normalize, magnitude};
@@ -142,4 +142,10 @@ typedef struct Vec3Manager_s {
 
 extern const Vec3Manager manVec3;
 
+/**
+ *  The scalar implementation, which manVec3 is the same as when SIMD is disabled (see "Simd.h").
+ *  Used as the reference when testing the SIMD backend.
+ */
+extern const Vec3Manager manVec3Scalar;
+
 #endif
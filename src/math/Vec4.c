@@ -1,4 +1,5 @@
 #include "Vec4.h"
+#include "Simd.h"
 
 #include <math.h>
 
@@ -134,4 +135,42 @@ static scalar magnitude(const Vec4 *const vec) {
     return (sqrt(pow(vec->x, 2) + pow(vec->y, 2) + pow(vec->z, 2) + pow(vec->w, 2)));
 }
 
+#ifdef COH_SIMD_SSE
+static Vec4 sumSimd(const Vec4 *const v1, const Vec4 *const v2) {
+    Vec4 result;
+    _mm_storeu_ps(&result.x, _mm_add_ps(_mm_loadu_ps(&v1->x), _mm_loadu_ps(&v2->x)));
+    return result;
+}
+
+static Vec4 subSimd(const Vec4 *const v1, const Vec4 *const v2) {
+    Vec4 result;
+    _mm_storeu_ps(&result.x, _mm_sub_ps(_mm_loadu_ps(&v1->x), _mm_loadu_ps(&v2->x)));
+    return result;
+}
+
+static Vec4 postMulScalarSimd(const Vec4 *const vec, scalar factor) {
+    Vec4 result;
+    _mm_storeu_ps(&result.x, _mm_mul_ps(_mm_loadu_ps(&vec->x), _mm_set1_ps(factor)));
+    return result;
+}
+
+static Vec4 preMulScalarSimd(scalar factor, const Vec4 *const vec) {
+    return postMulScalarSimd(vec, factor);
+}
+
+static Vec4 invertSimd(const Vec4 *const vec) {
+    Vec4 result;
+    _mm_storeu_ps(&result.x, simdNegate(_mm_loadu_ps(&vec->x), 1, 1, 1, 1));
+    return result;
+}
+
+static scalar dotSimd(const Vec4 *const v1, const Vec4 *const v2) {
+    return simdSumInOrder(_mm_mul_ps(_mm_loadu_ps(&v1->x), _mm_loadu_ps(&v2->x)));
+}
+
+const Vec4Manager manVec4 = {create, createFromVec3, createFromVec4, sumSimd, subSimd, postMulScalarSimd, preMulScalarSimd, invertSimd, dotSimd, normalize, magnitude};
+#else
 const Vec4Manager manVec4 = {create, createFromVec3, createFromVec4, sum, sub, postMulScalar, preMulScalar, invert, dot, normalize, magnitude};
+#endif
+
+const Vec4Manager manVec4Scalar = {create, createFromVec3, createFromVec4, sum, sub, postMulScalar, preMulScalar, invert, dot, normalize, magnitude};
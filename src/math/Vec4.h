@@ -144,4 +144,10 @@ typedef struct Vec4Manager_s {
 
 extern const Vec4Manager manVec4;
 
+/**
+ *  The scalar implementation, which manVec4 is the same as when SIMD is disabled (see "Simd.h").
+ *  Used as the reference when testing the SIMD backend.
+ */
+extern const Vec4Manager manVec4Scalar;
+
 #endif
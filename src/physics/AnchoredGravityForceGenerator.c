@@ -1,10 +1,15 @@
 #include <stdio.h>
+#include <math.h>
 
 #include "AnchoredGravityForceGenerator.h"
+#include "util/MemUtil.h"
 
 static const scalar GRAVITATIONAL_CONSTANT = 6.67384e-11; //6.67384 * 10^-11
+/* How many particles ahead the batch starts fetching a particle's position and force. */
+#define ANCHORED_GRAVITY_PREFETCH_DISTANCE 8
 
 static void updateForce(void *const self, Particle *const particle, scalar frameTime);
+static void updateForceBatch(void *const self, Particle *const *const particles, int count, scalar frameTime);
 
 static AnchoredGravityForceGenerator* new(Particle *gravityAnchor) {
 	AnchoredGravityForceGenerator *fg = malloc(sizeof(AnchoredGravityForceGenerator));
@@ -14,6 +19,7 @@ static AnchoredGravityForceGenerator* new(Particle *gravityAnchor) {
 	ParticleForceGenerator *tempForceGen = manParticleForceGenerator.new(fg, updateForce);
 	
 	fg->forceGenerator = *tempForceGen;
+	fg->forceGenerator.updateForceBatch = updateForceBatch;
 	
 	manParticleForceGenerator.delete(tempForceGen);
 
@@ -40,4 +46,39 @@ static void updateForce(void *const self, Particle *const particle, scalar frame
 	}
 }
 
+/*
+ * Same as updateForce, giving the same forces to the bit, but the anchor's position and mass are only
+ * looked up once and the vector and mass calls are done inline. Each particle's position and force are
+ * fetched a few particles ahead, as the particles are each allocated on their own.
+ */
+static void updateForceBatch(void *const self, Particle *const *const particles, int count, scalar frameTime) {
+	ParticleForceGenerator *pfg = (ParticleForceGenerator *) self;
+	AnchoredGravityForceGenerator *fg = (AnchoredGravityForceGenerator *) pfg->self;
+
+	Vec3 anchor = *fg->gravityAnchor->position;
+	scalar anchorMass = manParticle.getMass(fg->gravityAnchor);
+
+	for(int i = 0; i < count; i++) {
+		if (i + 2*ANCHORED_GRAVITY_PREFETCH_DISTANCE < count)
+			MEM_PREFETCH(particles[i + 2*ANCHORED_GRAVITY_PREFETCH_DISTANCE]);
+		if (i + ANCHORED_GRAVITY_PREFETCH_DISTANCE < count) {
+			MEM_PREFETCH(particles[i + ANCHORED_GRAVITY_PREFETCH_DISTANCE]->position);
+			MEM_PREFETCH(particles[i + ANCHORED_GRAVITY_PREFETCH_DISTANCE]->forceAccum);
+		}
+
+		Particle *particle = particles[i];
+		Vec3 diff = {particle->position->x - anchor.x, particle->position->y - anchor.y, particle->position->z - anchor.z};
+		//As manVec3.magnitude works it out, squares summed as doubles.
+		scalar mag = sqrt((double)diff.x*diff.x + (double)diff.y*diff.y + (double)diff.z*diff.z);
+		if (mag != 0) {
+			scalar mass = particle->inverseMass != 0 ? 1/particle->inverseMass : SCALAR_MAX_VAL;
+			scalar grav = -(GRAVITATIONAL_CONSTANT*((anchorMass*mass)/(mag*mag)));
+
+			particle->forceAccum->x += grav*(diff.x/mag);
+			particle->forceAccum->y += grav*(diff.y/mag);
+			particle->forceAccum->z += grav*(diff.z/mag);
+		}
+	}
+}
+
 const AnchoredGravityForceGeneratorManager manAnchoredGravityForceGenerator = {new, delete};
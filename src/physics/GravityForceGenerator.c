@@ -3,6 +3,7 @@
 #include "GravityForceGenerator.h"
 
 static void updateForce(void *const self, Particle *const particle, scalar frameTime);
+static void updateForceBatch(void *const self, Particle *const *const particles, int count, scalar frameTime);
 
 static GravityForceGenerator *new(const Vec3 *const gravityAccel) {
 	GravityForceGenerator *fg = malloc(sizeof(GravityForceGenerator));
@@ -12,6 +13,7 @@ static GravityForceGenerator *new(const Vec3 *const gravityAccel) {
 	ParticleForceGenerator *tempForceGen = manParticleForceGenerator.new(fg, updateForce);
 	
 	fg->forceGenerator = *tempForceGen;
+	fg->forceGenerator.updateForceBatch = updateForceBatch;
 	
 	manParticleForceGenerator.delete(tempForceGen);
 
@@ -31,4 +33,14 @@ static void updateForce(void *const self, Particle *const particle, scalar frame
 	manParticle.addForce(particle, &forceToAdd);
 }
 
+static void updateForceBatch(void *const self, Particle *const *const particles, int count, scalar frameTime) {
+	ParticleForceGenerator *pfg = (ParticleForceGenerator *) self;
+	GravityForceGenerator *fg = (GravityForceGenerator *) pfg->self;
+
+	for(int i = 0; i < count; i++) {
+		Vec3 forceToAdd = manVec3.postMulScalar(&(fg->gravity), manParticle.getMass(particles[i]));
+		manParticle.addForce(particles[i], &forceToAdd);
+	}
+}
+
 const GravityForceGeneratorManager manGravityForceGenerator = {new, delete};
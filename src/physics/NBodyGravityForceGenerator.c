@@ -0,0 +1,293 @@
+#include <math.h>
+#include <stdlib.h>
+
+#include "NBodyGravityForceGenerator.h"
+
+static const scalar GRAVITATIONAL_CONSTANT = 6.67384e-11; //6.67384 * 10^-11
+
+static void updateForce(void *const self, Particle *const particle, scalar frameTime);
+static void updateForceBatch(void *const self, Particle *const *const particles, int count, scalar frameTime);
+
+static NBodyGravityForceGenerator *new(scalar theta) {
+	NBodyGravityForceGenerator *fg = malloc(sizeof(NBodyGravityForceGenerator));
+
+	fg->theta = theta;
+	fg->softening = NBODY_DEFAULT_SOFTENING;
+	fg->jobSystem = NULL;
+
+	fg->nodes = NULL;
+	fg->nodeCount = 0;
+	fg->nodeCapacity = 0;
+
+	fg->positions = NULL;
+	fg->masses = NULL;
+	fg->forces = NULL;
+	fg->bodyNext = NULL;
+	fg->bodyCapacity = 0;
+
+	ParticleForceGenerator *tempForceGen = manParticleForceGenerator.new(fg, updateForce);
+
+	fg->forceGenerator = *tempForceGen;
+	fg->forceGenerator.updateForceBatch = updateForceBatch;
+
+	manParticleForceGenerator.delete(tempForceGen);
+
+	return fg;
+}
+
+static void setTheta(NBodyGravityForceGenerator *nBody, scalar theta) {
+	nBody->theta = theta;
+}
+
+static void setJobSystem(NBodyGravityForceGenerator *nBody, JobSystem *jobs) {
+	nBody->jobSystem = jobs;
+}
+
+static void delete(NBodyGravityForceGenerator *nBody) {
+	free(nBody->nodes);
+	free(nBody->positions);
+	free(nBody->masses);
+	free(nBody->forces);
+	free(nBody->bodyNext);
+}
+
+/*
+ * A single particle has nothing to be attracted to, the forces are all found in updateForceBatch.
+ */
+static void updateForce(void *const self, Particle *const particle, scalar frameTime) {
+}
+
+static void reserveBodies(NBodyGravityForceGenerator *fg, int count) {
+	if (count <= fg->bodyCapacity)
+		return;
+
+	fg->bodyCapacity = count;
+	fg->positions = realloc(fg->positions, sizeof(Vec3)*count);
+	fg->masses = realloc(fg->masses, sizeof(scalar)*count);
+	fg->forces = realloc(fg->forces, sizeof(Vec3)*count);
+	fg->bodyNext = realloc(fg->bodyNext, sizeof(int)*count);
+}
+
+static int newNode(NBodyGravityForceGenerator *fg, scalar x, scalar y, scalar z, scalar halfSize) {
+	if (fg->nodeCount == fg->nodeCapacity) {
+		fg->nodeCapacity = fg->nodeCapacity == 0 ? 64 : fg->nodeCapacity*2;
+		fg->nodes = realloc(fg->nodes, sizeof(NBodyNode)*fg->nodeCapacity);
+	}
+
+	NBodyNode *node = &fg->nodes[fg->nodeCount];
+	node->center.x = x;
+	node->center.y = y;
+	node->center.z = z;
+	node->halfSize = halfSize;
+	node->mass = 0;
+	node->firstChild = -1;
+	node->firstBody = -1;
+
+	return fg->nodeCount++;
+}
+
+/*
+ * Splits a leaf into 8 children. Children are added after their parent, so
+ * every child's index is greater than its parent's.
+ */
+static void split(NBodyGravityForceGenerator *fg, int node) {
+	Vec3 center = fg->nodes[node].center;
+	scalar quarter = fg->nodes[node].halfSize/2;
+
+	int firstChild = fg->nodeCount;
+	for(int octant = 0; octant < 8; octant++) {
+		newNode(fg, center.x + ((octant & 1) ? quarter : -quarter),
+		            center.y + ((octant & 2) ? quarter : -quarter),
+		            center.z + ((octant & 4) ? quarter : -quarter), quarter);
+	}
+
+	fg->nodes[node].firstChild = firstChild;
+}
+
+static int childFor(NBodyGravityForceGenerator *fg, int node, const Vec3 *position) {
+	NBodyNode *parent = &fg->nodes[node];
+	int octant = (position->x >= parent->center.x ? 1 : 0) |
+	             (position->y >= parent->center.y ? 2 : 0) |
+	             (position->z >= parent->center.z ? 4 : 0);
+	return parent->firstChild + octant;
+}
+
+static void insert(NBodyGravityForceGenerator *fg, int body) {
+	int node = 0;
+
+	for(int depth = 0; ; depth++) {
+		if (fg->nodes[node].firstChild >= 0) {
+			node = childFor(fg, node, &fg->positions[body]);
+			continue;
+		}
+
+		if (fg->nodes[node].firstBody < 0 || depth >= NBODY_MAX_DEPTH) {
+			fg->bodyNext[body] = fg->nodes[node].firstBody;
+			fg->nodes[node].firstBody = body;
+			return;
+		}
+
+		//An occupied leaf above the depth limit holds exactly one body, move it down a level.
+		int occupant = fg->nodes[node].firstBody;
+		fg->nodes[node].firstBody = -1;
+		split(fg, node);
+
+		int child = childFor(fg, node, &fg->positions[occupant]);
+		fg->nodes[child].firstBody = occupant;
+		fg->bodyNext[occupant] = -1;
+
+		node = childFor(fg, node, &fg->positions[body]);
+	}
+}
+
+/*
+ * Finds each node's mass and centre of mass, children first.
+ */
+static void summarise(NBodyGravityForceGenerator *fg) {
+	for(int n = fg->nodeCount-1; n >= 0; n--) {
+		NBodyNode *node = &fg->nodes[n];
+		scalar mass = 0;
+		scalar x = 0, y = 0, z = 0;
+
+		if (node->firstChild >= 0) {
+			for(int c = node->firstChild; c < node->firstChild + 8; c++) {
+				NBodyNode *child = &fg->nodes[c];
+				mass += child->mass;
+				x += child->centerOfMass.x*child->mass;
+				y += child->centerOfMass.y*child->mass;
+				z += child->centerOfMass.z*child->mass;
+			}
+		} else {
+			for(int b = node->firstBody; b >= 0; b = fg->bodyNext[b]) {
+				mass += fg->masses[b];
+				x += fg->positions[b].x*fg->masses[b];
+				y += fg->positions[b].y*fg->masses[b];
+				z += fg->positions[b].z*fg->masses[b];
+			}
+		}
+
+		node->mass = mass;
+		if (mass > 0) {
+			node->centerOfMass.x = x/mass;
+			node->centerOfMass.y = y/mass;
+			node->centerOfMass.z = z/mass;
+		} else {
+			node->centerOfMass = node->center;
+		}
+	}
+}
+
+static void build(NBodyGravityForceGenerator *fg, Particle *const *const particles, int count) {
+	reserveBodies(fg, count);
+
+	Vec3 min = {SCALAR_MAX_VAL, SCALAR_MAX_VAL, SCALAR_MAX_VAL};
+	Vec3 max = {-SCALAR_MAX_VAL, -SCALAR_MAX_VAL, -SCALAR_MAX_VAL};
+
+	for(int i = 0; i < count; i++) {
+		fg->positions[i] = *particles[i]->position;
+		fg->masses[i] = manParticle.hasFiniteMass(particles[i]) ? manParticle.getMass(particles[i]) : 0;
+
+		min.x = fminf(min.x, fg->positions[i].x);
+		min.y = fminf(min.y, fg->positions[i].y);
+		min.z = fminf(min.z, fg->positions[i].z);
+		max.x = fmaxf(max.x, fg->positions[i].x);
+		max.y = fmaxf(max.y, fg->positions[i].y);
+		max.z = fmaxf(max.z, fg->positions[i].z);
+	}
+
+	//The root is a cube a little larger than the bounds, so every body is strictly inside.
+	scalar halfSize = fmaxf(max.x - min.x, fmaxf(max.y - min.y, max.z - min.z))/2;
+	halfSize = halfSize*1.001 + 1e-3;
+
+	fg->nodeCount = 0;
+	newNode(fg, (min.x + max.x)/2, (min.y + max.y)/2, (min.z + max.z)/2, halfSize);
+
+	for(int i = 0; i < count; i++) {
+		if (fg->masses[i] > 0)
+			insert(fg, i);
+	}
+
+	summarise(fg);
+}
+
+/*
+ * Walks the tree for each body in the range, opening nodes that are too close to treat as a point.
+ */
+static void traverseRange(void *data, int start, int end, int threadIndex) {
+	NBodyGravityForceGenerator *fg = (NBodyGravityForceGenerator *)data;
+	scalar thetaSquared = fg->theta*fg->theta;
+	scalar softeningSquared = fg->softening*fg->softening;
+	int stack[8*(NBODY_MAX_DEPTH+1)];
+
+	for(int i = start; i < end; i++) {
+		Vec3 position = fg->positions[i];
+		scalar ax = 0, ay = 0, az = 0;
+
+		if (fg->masses[i] > 0) {
+			int top = 0;
+			stack[top++] = 0;
+
+			while(top > 0) {
+				NBodyNode *node = &fg->nodes[stack[--top]];
+				if (node->mass == 0)
+					continue;
+
+				if (node->firstChild < 0) {
+					for(int b = node->firstBody; b >= 0; b = fg->bodyNext[b]) {
+						if (b == i)
+							continue;
+
+						scalar dx = fg->positions[b].x - position.x;
+						scalar dy = fg->positions[b].y - position.y;
+						scalar dz = fg->positions[b].z - position.z;
+						scalar distanceSquared = dx*dx + dy*dy + dz*dz + softeningSquared;
+						scalar strength = fg->masses[b]/(distanceSquared*sqrtf(distanceSquared));
+						ax += dx*strength;
+						ay += dy*strength;
+						az += dz*strength;
+					}
+					continue;
+				}
+
+				scalar dx = node->centerOfMass.x - position.x;
+				scalar dy = node->centerOfMass.y - position.y;
+				scalar dz = node->centerOfMass.z - position.z;
+				scalar distanceSquared = dx*dx + dy*dy + dz*dz;
+				scalar size = node->halfSize*2;
+
+				if (size*size < thetaSquared*distanceSquared) {
+					distanceSquared += softeningSquared;
+					scalar strength = node->mass/(distanceSquared*sqrtf(distanceSquared));
+					ax += dx*strength;
+					ay += dy*strength;
+					az += dz*strength;
+				} else {
+					for(int c = node->firstChild; c < node->firstChild + 8; c++)
+						stack[top++] = c;
+				}
+			}
+		}
+
+		scalar scale = GRAVITATIONAL_CONSTANT*fg->masses[i];
+		fg->forces[i].x = ax*scale;
+		fg->forces[i].y = ay*scale;
+		fg->forces[i].z = az*scale;
+	}
+}
+
+static void updateForceBatch(void *const self, Particle *const *const particles, int count, scalar frameTime) {
+	ParticleForceGenerator *pfg = (ParticleForceGenerator *) self;
+	NBodyGravityForceGenerator *fg = (NBodyGravityForceGenerator *) pfg->self;
+
+	if (count < 2)
+		return;
+
+	build(fg, particles, count);
+	manJobSystem.parallelFor(fg->jobSystem, count, NBODY_CHUNK_SIZE, traverseRange, fg);
+
+	//Applied on one thread, as a particle could be registered more than once.
+	for(int i = 0; i < count; i++)
+		manParticle.addForce(particles[i], &fg->forces[i]);
+}
+
+const NBodyGravityForceGeneratorManager manNBodyGravityForceGenerator = {new, setTheta, setJobSystem, delete};
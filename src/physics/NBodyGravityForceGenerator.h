@@ -0,0 +1,113 @@
+#ifndef COH_NBODYGRAVITYFORCEGENERATOR_H
+#define COH_NBODYGRAVITYFORCEGENERATOR_H
+
+#include "ParticleForceGenerator.h"
+#include "util/JobSystem.h"
+
+/** Opening angle used unless another is set, a common balance of speed and accuracy. **/
+#define NBODY_DEFAULT_THETA 0.5
+/** Distance added in quadrature to every separation, so close bodies don't get huge forces. **/
+#define NBODY_DEFAULT_SOFTENING 0.1
+/** Depth past which bodies share a leaf instead of splitting further, so coincident bodies can't recurse forever. **/
+#define NBODY_MAX_DEPTH 32
+/** Number of bodies each job finds the forces on when traversing in parallel. **/
+#define NBODY_CHUNK_SIZE 256
+
+/**
+ *	A cube of space in the octree. Internal nodes have 8 children, stored together
+ * 	from firstChild, leaves have a chain of bodies instead.
+ */
+typedef struct NBodyNode_s {
+	Vec3 center;
+	scalar halfSize;
+
+	/** Total mass and centre of mass of every body in the node. **/
+	scalar mass;
+	Vec3 centerOfMass;
+
+	/** Index of the first of the 8 children, or -1 for a leaf. **/
+	int firstChild;
+	/** First body of a leaf, chained through bodyNext, or -1 if the leaf is empty. **/
+	int firstBody;
+} NBodyNode;
+
+/**
+ *	Force generator where every registered particle attracts every other,
+ * 	approximated with a Barnes-Hut octree.
+ *
+ * 	Each update builds an octree over the particles, then for each particle walks
+ * 	it from the root, treating any node that looks smaller than the opening angle
+ * 	theta from the particle as a single body at its centre of mass. That makes an
+ * 	update O(n log n) instead of O(n^2). A theta of 0 opens every node and gives
+ * 	the exact sum.
+ *
+ * 	Only updateForceBatch does the work, so the generator must be run by a registry
+ * 	with all its particles registered to it. Particles of infinite mass neither
+ * 	attract nor are attracted.
+ */
+typedef struct NBodyGravityForceGenerator_s {
+	/**
+	 *	Force Generator instance to use.
+	 */
+	ParticleForceGenerator forceGenerator;
+
+	/** Opening angle, larger is faster and less accurate. **/
+	scalar theta;
+	/** Softening length, see NBODY_DEFAULT_SOFTENING. **/
+	scalar softening;
+	/** Job system the traversal is split across, or NULL to run on the calling thread. Not owned. **/
+	JobSystem* jobSystem;
+
+	/** The octree, rebuilt every update. The root is node 0. **/
+	NBodyNode* nodes;
+	int nodeCount;
+	int nodeCapacity;
+
+	/** Copies of each body's position and mass, and the force found on it. **/
+	Vec3* positions;
+	scalar* masses;
+	Vec3* forces;
+	/** Next body in the same leaf, or -1. **/
+	int* bodyNext;
+	int bodyCapacity;
+} NBodyGravityForceGenerator;
+
+/**
+ *	Manager for NBodyGravityForceGenerators.
+ */
+typedef struct NBodyGravityForceGeneratorManager_s {
+	/**
+	 *	Instantiate a new NBodyGravityForceGenerator.
+	 *
+	 * 	@param 	theta 	scalar, the opening angle, NBODY_DEFAULT_THETA is a good start.
+	 * 	@return 		pointer to NBodyGravityForceGenerator, new NBodyGravityForceGenerator.
+	 */
+	NBodyGravityForceGenerator *(*new)(scalar theta);
+
+	/**
+	 *	Change the opening angle.
+	 *
+	 * 	@param 	nBody 	pointer to NBodyGravityForceGenerator to alter.
+	 * 	@param 	theta 	scalar, the opening angle, 0 for exact forces.
+	 */
+	void (*setTheta)(NBodyGravityForceGenerator *nBody, scalar theta);
+
+	/**
+	 *	Change what job system the traversal is split across. Forces are the same whatever the thread count.
+	 *
+	 * 	@param 	nBody 	pointer to NBodyGravityForceGenerator to alter.
+	 * 	@param 	jobs 	pointer to JobSystem to use, or NULL to run on the calling thread.
+	 */
+	void (*setJobSystem)(NBodyGravityForceGenerator *nBody, JobSystem *jobs);
+
+	/**
+	 *	Free all memory associated with a given NBodyGravityForceGenerator, not including the generator itself.
+	 *
+	 *	@param 	nBody 	pointer to NBodyGravityForceGenerator to delete.
+	 */
+	void (*delete)(NBodyGravityForceGenerator *nBody);
+} NBodyGravityForceGeneratorManager;
+
+extern const NBodyGravityForceGeneratorManager manNBodyGravityForceGenerator;
+
+#endif
@@ -87,7 +87,7 @@ static void integrate(Particle *const particle, scalar frameTime) {
 	*particle->velocity = manVec3.sum(particle->velocity, &velocityModifer);
 
 	// Apply drag
-	*particle->velocity = manVec3.postMulScalar(particle->velocity, pow(particle->damping, frameTime));
+	*particle->velocity = manVec3.postMulScalar(particle->velocity, scalar_pow(particle->damping, frameTime));
 
 	// Clear forces
 	manParticle.clearForceAccumulator(particle);
@@ -5,6 +5,7 @@ static ParticleForceGenerator *new(void *const self, void (*updateForce)(void *c
 
 	fg->self = self;
 	fg->updateForce = updateForce;
+	fg->updateForceBatch = NULL;
 
 	return fg;
 }
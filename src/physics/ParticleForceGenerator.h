@@ -24,6 +24,18 @@ typedef struct ParticleForceGenerator_s {
 	 * 	@param 	frameTime 	scalar, duration of previous frame.
 	 */
 	void (*updateForce)(void *const self, Particle *const particle, scalar frameTime);
+
+	/**
+	 *	Optional pointer to function to update the force of many particles at once,
+	 * 	so work shared between particles is only done once. NULL to call updateForce
+	 * 	for each particle instead.
+	 *
+	 * 	@param 	self 		const pointer to void, pointer to ParticleForceGenerator.
+	 * 	@param 	particles 	const pointer to const pointer to Particle, particles to update force of.
+	 * 	@param 	count 		int, number of particles.
+	 * 	@param 	frameTime 	scalar, duration of previous frame.
+	 */
+	void (*updateForceBatch)(void *const self, Particle *const *const particles, int count, scalar frameTime);
 } ParticleForceGenerator;
 
 /**
@@ -3,33 +3,243 @@
 static ParticleForceRegistry *new() {
 	ParticleForceRegistry *registry = malloc(sizeof(ParticleForceRegistry));
 
-	registry->forceRegistrations = manDynamicArray.new(10, sizeof(ParticleForceRegistration));
+	registry->groups = manDynamicArray.new(4, sizeof(ParticleForceGroup));
+	atomic_init(&registry->pendingAdds, NULL);
+	atomic_init(&registry->pendingRemoves, NULL);
 
 	return (registry);
 }
 
-static void delete(ParticleForceRegistry *registry) {
-	manDynamicArray.delete(registry->forceRegistrations);
+static ParticleForceGroup *getGroup(ParticleForceRegistry *const registry, int group) {
+	return (ParticleForceGroup *) manDynamicArray.get(registry->groups, group);
+}
+
+/*
+ * Finds the group of the given generator, or a group to start for it,
+ * reusing an emptied group before making a new one. Deterministic builds
+ * always start new groups at the end, so groups stay in the order their
+ * generators were added.
+ */
+static int findGroup(ParticleForceRegistry *const registry, ParticleForceGenerator *const forceGenerator) {
+	int empty = -1;
+
+	for(int i = 0; i < registry->groups->size; i++) {
+		ParticleForceGroup *group = getGroup(registry, i);
+		if (group->forceGenerator == forceGenerator)
+			return i;
+#ifndef COH_DETERMINISTIC
+		if (group->forceGenerator == NULL && empty < 0)
+			empty = i;
+#endif
+	}
+
+	if (empty < 0) {
+		ParticleForceGroup group;
+		group.forceGenerator = NULL;
+		group.particles = NULL;
+		group.registrations = NULL;
+		group.count = 0;
+		group.capacity = 0;
+		manDynamicArray.append(registry->groups, &group);
+		empty = registry->groups->size-1;
+	}
+
+	getGroup(registry, empty)->forceGenerator = forceGenerator;
+	return empty;
+}
+
+static void insert(ParticleForceRegistry *const registry, ParticleForceRegistration *registration) {
+	registration->group = findGroup(registry, registration->forceGenerator);
+	ParticleForceGroup *group = getGroup(registry, registration->group);
+
+	if (group->count == group->capacity) {
+		group->capacity = group->capacity == 0 ? 16 : group->capacity*2;
+		group->particles = realloc(group->particles, sizeof(Particle *)*group->capacity);
+		group->registrations = realloc(group->registrations, sizeof(ParticleForceRegistration *)*group->capacity);
+	}
+
+	registration->index = group->count++;
+	group->particles[registration->index] = registration->particle;
+	group->registrations[registration->index] = registration;
+}
+
+/*
+ * Removes a registration by moving the group's last one into its place. Deterministic
+ * builds shift the rest of the group down instead, so particles are always updated in
+ * the order they were added, however many were removed before them.
+ */
+static void extract(ParticleForceRegistry *const registry, ParticleForceRegistration *registration) {
+	ParticleForceGroup *group = getGroup(registry, registration->group);
+	int last = --group->count;
+
+#ifdef COH_DETERMINISTIC
+	for(int i = registration->index; i < last; i++) {
+		group->particles[i] = group->particles[i+1];
+		group->registrations[i] = group->registrations[i+1];
+		group->registrations[i]->index = i;
+	}
+#else
+	if (registration->index != last) {
+		group->particles[registration->index] = group->particles[last];
+		group->registrations[registration->index] = group->registrations[last];
+		group->registrations[registration->index]->index = registration->index;
+	}
+#endif
+
+	if (group->count == 0)
+		group->forceGenerator = NULL;
+}
+
+/*
+ * Takes a whole pending stack, returning it oldest first.
+ */
+static ParticleForceRegistration *takeAdds(ParticleForceRegistry *const registry) {
+	ParticleForceRegistration *stack = atomic_exchange_explicit(&registry->pendingAdds, NULL, memory_order_acquire);
+	ParticleForceRegistration *reversed = NULL;
+
+	while(stack != NULL) {
+		ParticleForceRegistration *next = stack->nextAdd;
+		stack->nextAdd = reversed;
+		reversed = stack;
+		stack = next;
+	}
+
+	return reversed;
+}
+
+static ParticleForceRegistration *takeRemoves(ParticleForceRegistry *const registry) {
+	ParticleForceRegistration *stack = atomic_exchange_explicit(&registry->pendingRemoves, NULL, memory_order_acquire);
+	ParticleForceRegistration *reversed = NULL;
+
+	while(stack != NULL) {
+		ParticleForceRegistration *next = stack->nextRemove;
+		stack->nextRemove = reversed;
+		reversed = stack;
+		stack = next;
+	}
+
+	return reversed;
+}
+
+#ifdef COH_DETERMINISTIC
+/*
+ * Drops emptied groups, keeping the rest in order, since deterministic builds never reuse them.
+ */
+static void compactGroups(ParticleForceRegistry *const registry) {
+	int kept = 0;
+
+	for(int i = 0; i < registry->groups->size; i++) {
+		ParticleForceGroup *group = getGroup(registry, i);
+		if (group->forceGenerator == NULL) {
+			free(group->particles);
+			free(group->registrations);
+			continue;
+		}
+
+		if (kept != i) {
+			*getGroup(registry, kept) = *group;
+			for(int j = 0; j < group->count; j++)
+				group->registrations[j]->group = kept;
+		}
+		kept++;
+	}
+
+	registry->groups->size = kept;
+}
+#endif
+
+/*
+ * Applies the pending adds before the removes, so a registration added and
+ * removed in the same tick is simply dropped.
+ */
+static void applyPending(ParticleForceRegistry *const registry) {
+	for(ParticleForceRegistration *registration = takeAdds(registry); registration != NULL; registration = registration->nextAdd)
+		insert(registry, registration);
+
+	ParticleForceRegistration *registration = takeRemoves(registry);
+#ifdef COH_DETERMINISTIC
+	bool removed = registration != NULL;
+#endif
+	while(registration != NULL) {
+		ParticleForceRegistration *next = registration->nextRemove;
+		extract(registry, registration);
+		free(registration);
+		registration = next;
+	}
+
+#ifdef COH_DETERMINISTIC
+	if (removed)
+		compactGroups(registry);
+#endif
+}
+
+static void clear(ParticleForceRegistry *const registry) {
+	applyPending(registry);
+
+	for(int i = 0; i < registry->groups->size; i++) {
+		ParticleForceGroup *group = getGroup(registry, i);
+		for(int j = 0; j < group->count; j++)
+			free(group->registrations[j]);
+		free(group->particles);
+		free(group->registrations);
+	}
+
+	registry->groups->size = 0;
 }
 
-static void add(ParticleForceRegistry *const registry, Particle *const particle, ParticleForceGenerator *const forceGenerator) {
-	ParticleForceRegistration registration;
-	registration.particle = particle;
-	registration.forceGenerator = forceGenerator;
+static void delete(ParticleForceRegistry *registry) {
+	clear(registry);
 
-	manDynamicArray.append(registry->forceRegistrations, &registration);
+	manDynamicArray.delete(registry->groups);
+	free(registry->groups);
 }
 
-static void remove(ParticleForceRegistry *const registry, Particle *const particle, const ParticleForceGenerator *const forceGenerator) {
+static ParticleForceHandle add(ParticleForceRegistry *const registry, Particle *const particle, ParticleForceGenerator *const forceGenerator) {
+	ParticleForceRegistration *registration = malloc(sizeof(ParticleForceRegistration));
+	registration->particle = particle;
+	registration->forceGenerator = forceGenerator;
+	registration->group = -1;
+	registration->index = -1;
+	registration->nextRemove = NULL;
+
+	registration->nextAdd = atomic_load_explicit(&registry->pendingAdds, memory_order_relaxed);
+	while(!atomic_compare_exchange_weak_explicit(&registry->pendingAdds, &registration->nextAdd, registration, memory_order_release, memory_order_relaxed));
+
+	return registration;
+}
 
+static void remove(ParticleForceRegistry *const registry, ParticleForceHandle handle) {
+	handle->nextRemove = atomic_load_explicit(&registry->pendingRemoves, memory_order_relaxed);
+	while(!atomic_compare_exchange_weak_explicit(&registry->pendingRemoves, &handle->nextRemove, handle, memory_order_release, memory_order_relaxed));
 }
 
-static void updateForces(const ParticleForceRegistry *const registry, scalar frameTime) {
-	// Call update force for each registration
-	for(int i = 0; i < registry->forceRegistrations->size; ++i) {
-		ParticleForceRegistration *registration = (ParticleForceRegistration *) manDynamicArray.get(registry->forceRegistrations, i);
-		registration->forceGenerator->updateForce(registration->forceGenerator, registration->particle, frameTime);
+static void updateForces(ParticleForceRegistry *const registry, scalar frameTime) {
+	applyPending(registry);
+
+	// Call update force once per generator for all of its particles
+	for(int i = 0; i < registry->groups->size; i++) {
+		ParticleForceGroup *group = getGroup(registry, i);
+		ParticleForceGenerator *forceGenerator = group->forceGenerator;
+
+		if (forceGenerator == NULL)
+			continue;
+
+		if (forceGenerator->updateForceBatch != NULL) {
+			forceGenerator->updateForceBatch(forceGenerator, group->particles, group->count, frameTime);
+		} else {
+			for(int j = 0; j < group->count; j++)
+				forceGenerator->updateForce(forceGenerator, group->particles[j], frameTime);
+		}
 	}
 }
 
-const ParticleForceRegistryManager manForceRegistry = {new, delete, add, remove, updateForces};
+static int getCount(const ParticleForceRegistry *const registry) {
+	int count = 0;
+
+	for(int i = 0; i < registry->groups->size; i++)
+		count += ((ParticleForceGroup *) manDynamicArray.get(registry->groups, i))->count;
+
+	return count;
+}
+
+const ParticleForceRegistryManager manForceRegistry = {new, delete, add, remove, updateForces, applyPending, clear, getCount};
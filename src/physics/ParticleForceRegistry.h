@@ -5,6 +5,8 @@
 #ifndef PARTICLE_FORCE_REGISTRY_H
 #define PARTICLE_FORCE_REGISTRY_H
 
+#include <stdatomic.h>
+
 #include "util/DynamicArray.h"
 #include "Particle.h"
 #include "ParticleForceGenerator.h"
@@ -22,13 +24,69 @@ typedef struct ParticleForceRegistration_s {
 	 *	Force generator to use to update particle.
 	 */
 	ParticleForceGenerator *forceGenerator;
+
+	/**
+	 *	Group the registration is in and its index in that group, -1 until the add is applied.
+	 */
+	int group;
+	int index;
+
+	/**
+	 *	Links in the registry's pending add and remove stacks.
+	 */
+	struct ParticleForceRegistration_s *nextAdd;
+	struct ParticleForceRegistration_s *nextRemove;
 } ParticleForceRegistration;
 
 /**
- *	A registry containing an array of ParticleForceRegistrations.
+ *	Handle to a registration, returned by add and passed to remove.
+ */
+typedef ParticleForceRegistration *ParticleForceHandle;
+
+/**
+ *	Every particle registered with one force generator, kept contiguous
+ * 	so the generator can be run over all of them in one call.
+ */
+typedef struct ParticleForceGroup_s {
+	/**
+	 *	Force generator of the group, NULL while the group is empty and free for reuse.
+	 */
+	ParticleForceGenerator *forceGenerator;
+
+	/**
+	 *	The group's particles and the registration of each, count long.
+	 */
+	Particle **particles;
+	ParticleForceRegistration **registrations;
+	int count;
+	int capacity;
+} ParticleForceGroup;
+
+/**
+ *	A registry of connections between particles and force generators, grouped by generator.
+ *
+ * 	add and remove may be called from any thread, including while updateForces is running.
+ * 	They only push onto lock-free stacks, which updateForces applies before it runs the
+ * 	generators, so changes take effect from the next update.
+ *
+ * 	Built with COH_DETERMINISTIC, generators run in the order they were added and each
+ * 	over its particles in the order they were added, whatever was removed in between,
+ * 	so forces sum in the same order on every run. Removing is linear in the size of
+ * 	the group then. Adds and removes made from more than one thread between updates
+ * 	are applied in whatever order they landed, so make them from one thread to keep
+ * 	the order fixed.
  */
 typedef struct ParticleForceRegistry_s {
-	DynamicArray 	*forceRegistrations;
+	/**
+	 *	The groups, as ParticleForceGroup. Only touched by the thread calling updateForces.
+	 */
+	DynamicArray 	*groups;
+
+	/**
+	 *	Registrations waiting to be added and removed.
+	 */
+	_Atomic(ParticleForceRegistration *) pendingAdds;
+	_Atomic(ParticleForceRegistration *) pendingRemoves;
 } ParticleForceRegistry;
 
 /** 
@@ -43,7 +101,8 @@ typedef struct ParticleForceRegistryManager_s {
 	ParticleForceRegistry *(*new)();
 
 	/**
-	 *	Free all memory associated with the given ParticleForceRegistry.
+	 *	Free all memory associated with the given ParticleForceRegistry, not including the registry itself.
+	 * 	Handles to its registrations are no longer valid afterwards.
 	 *
 	 * 	@param 	registry 	pointer to ParticleForceRegistry.
 	 */
@@ -51,28 +110,57 @@ typedef struct ParticleForceRegistryManager_s {
 
 	/**
 	 *	Register a connection between the given particle and the given force generator.
+	 * 	Takes effect from the next updateForces.
 	 *
 	 * 	@param 	registry 		const pointer to ParticleForceRegistry, the registry to register particle and force function on.
 	 * 	@param 	particle 		const pointer to Particle, the particle to update.
 	 * 	@param 	forceGenerator 	const pointer to const ParticleForceGenerator, the force generator to use to update the particle.
+	 * 	@returns 				ParticleForceHandle, handle to remove the registration with.
 	 */
-	void (*add)(ParticleForceRegistry *const registry, Particle *const particle, ParticleForceGenerator *const forceGenerator);
+	ParticleForceHandle (*add)(ParticleForceRegistry *const registry, Particle *const particle, ParticleForceGenerator *const forceGenerator);
 
 	/**
-	 *	Remove the registration of a connection between the given particle and the given force generator.
-	 * 	Has no effect if no registration that matches exists.
-	 * 	Does not remove particle or force generator or ParticleForceRegistration. Only removes their existence in the registry.
+	 *	Remove a registration in constant time, or linear in its group with COH_DETERMINISTIC. Takes effect from the next updateForces.
+	 * 	Does not remove particle or force generator. Only removes their existence in the registry.
+	 * 	Each handle must be removed at most once, and is no longer valid after the next updateForces.
+	 *
+	 * 	@param 	registry 	const pointer to ParticleForceRegistry, the registry the handle came from.
+	 * 	@param 	handle 		ParticleForceHandle, the registration to remove.
 	 */
-	void (*remove)(ParticleForceRegistry *const registry, Particle *const particle, const ParticleForceGenerator *const forceGenerator);
+	void (*remove)(ParticleForceRegistry *const registry, ParticleForceHandle handle);
 
 	/**
-	 *	Update all the force generators in the registry and applies them to their
-	 * 	respective particle.
+	 *	Apply pending adds and removes, then update all the force generators in the registry
+	 * 	and apply them to their respective particles, one generator at a time.
 	 *
-	 * 	@param 	registry 	const pointer to const ParticleForceRegistry, registry to update forces from.
+	 * 	@param 	registry 	const pointer to ParticleForceRegistry, registry to update forces from.
 	 * 	@param 	frametime 	scalar, the duration of the previous frame.
 	 */
-	void (*updateForces)(const ParticleForceRegistry *const registry, scalar frameTime);
+	void (*updateForces)(ParticleForceRegistry *const registry, scalar frameTime);
+
+	/**
+	 *	Apply pending adds and removes now instead of at the next updateForces, so the groups
+	 * 	hold every registration made so far. Call from the thread that calls updateForces.
+	 *
+	 * 	@param 	registry 	const pointer to ParticleForceRegistry, registry to apply changes to.
+	 */
+	void (*applyPending)(ParticleForceRegistry *const registry);
+
+	/**
+	 *	Remove every registration, including pending ones, straight away. Handles to them are
+	 * 	no longer valid afterwards. Call from the thread that calls updateForces.
+	 *
+	 * 	@param 	registry 	const pointer to ParticleForceRegistry, registry to empty.
+	 */
+	void (*clear)(ParticleForceRegistry *const registry);
+
+	/**
+	 *	Get the number of registrations, not counting pending adds and removes.
+	 *
+	 * 	@param 	registry 	const pointer to const ParticleForceRegistry.
+	 * 	@returns 			int, number of registrations.
+	 */
+	int (*getCount)(const ParticleForceRegistry *const registry);
 } ParticleForceRegistryManager;
 
 extern const ParticleForceRegistryManager manForceRegistry;
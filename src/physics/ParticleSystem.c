@@ -0,0 +1,514 @@
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+
+#include "ParticleSystem.h"
+
+#define PARTICLE_SYSTEM_ARRAY_COUNT 27
+
+/*
+ * Every per-particle array, in one place so growing and freeing can't miss one.
+ */
+static scalar** getArrays(ParticleSystem* system, scalar** arrays) {
+	arrays[0] = system->positionX;
+	arrays[1] = system->positionY;
+	arrays[2] = system->positionZ;
+	arrays[3] = system->velocityX;
+	arrays[4] = system->velocityY;
+	arrays[5] = system->velocityZ;
+	arrays[6] = system->accelerationX;
+	arrays[7] = system->accelerationY;
+	arrays[8] = system->accelerationZ;
+	arrays[9] = system->forceX;
+	arrays[10] = system->forceY;
+	arrays[11] = system->forceZ;
+	arrays[12] = system->inverseMass;
+	arrays[13] = system->damping;
+	arrays[14] = system->dampingFactor;
+	arrays[15] = system->startPositionX;
+	arrays[16] = system->startPositionY;
+	arrays[17] = system->startPositionZ;
+	arrays[18] = system->startVelocityX;
+	arrays[19] = system->startVelocityY;
+	arrays[20] = system->startVelocityZ;
+	arrays[21] = system->deltaPositionX;
+	arrays[22] = system->deltaPositionY;
+	arrays[23] = system->deltaPositionZ;
+	arrays[24] = system->deltaVelocityX;
+	arrays[25] = system->deltaVelocityY;
+	arrays[26] = system->deltaVelocityZ;
+	return arrays;
+}
+
+static void setArrays(ParticleSystem* system, scalar** arrays) {
+	system->positionX = arrays[0];
+	system->positionY = arrays[1];
+	system->positionZ = arrays[2];
+	system->velocityX = arrays[3];
+	system->velocityY = arrays[4];
+	system->velocityZ = arrays[5];
+	system->accelerationX = arrays[6];
+	system->accelerationY = arrays[7];
+	system->accelerationZ = arrays[8];
+	system->forceX = arrays[9];
+	system->forceY = arrays[10];
+	system->forceZ = arrays[11];
+	system->inverseMass = arrays[12];
+	system->damping = arrays[13];
+	system->dampingFactor = arrays[14];
+	system->startPositionX = arrays[15];
+	system->startPositionY = arrays[16];
+	system->startPositionZ = arrays[17];
+	system->startVelocityX = arrays[18];
+	system->startVelocityY = arrays[19];
+	system->startVelocityZ = arrays[20];
+	system->deltaPositionX = arrays[21];
+	system->deltaPositionY = arrays[22];
+	system->deltaPositionZ = arrays[23];
+	system->deltaVelocityX = arrays[24];
+	system->deltaVelocityY = arrays[25];
+	system->deltaVelocityZ = arrays[26];
+}
+
+static void reserve(ParticleSystem* system, int capacity) {
+	if (capacity <= system->capacity)
+		return;
+
+	scalar* arrays[PARTICLE_SYSTEM_ARRAY_COUNT];
+	getArrays(system, arrays);
+	for(int i = 0; i < PARTICLE_SYSTEM_ARRAY_COUNT; i++)
+		arrays[i] = realloc(arrays[i], sizeof(scalar)*capacity);
+	setArrays(system, arrays);
+
+	system->indexToHandle = realloc(system->indexToHandle, sizeof(ParticleHandle)*capacity);
+	system->capacity = capacity;
+}
+
+static ParticleSystem* new(int capacity) {
+	ParticleSystem* system = malloc(sizeof(ParticleSystem));
+
+	scalar* arrays[PARTICLE_SYSTEM_ARRAY_COUNT] = {NULL};
+	setArrays(system, arrays);
+
+	system->count = 0;
+	system->capacity = 0;
+	system->dampingTimeStep = 0;
+
+	system->indexToHandle = NULL;
+	system->handleToIndex = NULL;
+	system->handleNext = NULL;
+	system->handleCapacity = 0;
+	system->freeHandle = PARTICLE_HANDLE_NONE;
+	system->jobSystem = NULL;
+	system->integrator = PARTICLE_INTEGRATOR_EULER;
+	system->forceFunc = NULL;
+	system->forceData = NULL;
+
+	reserve(system, capacity > 0 ? capacity : 16);
+
+	return system;
+}
+
+static void delete(ParticleSystem* system) {
+	scalar* arrays[PARTICLE_SYSTEM_ARRAY_COUNT];
+	getArrays(system, arrays);
+	for(int i = 0; i < PARTICLE_SYSTEM_ARRAY_COUNT; i++)
+		free(arrays[i]);
+
+	free(system->indexToHandle);
+	free(system->handleToIndex);
+	free(system->handleNext);
+
+	system->count = 0;
+	system->capacity = 0;
+	system->handleCapacity = 0;
+}
+
+static ParticleHandle allocHandle(ParticleSystem* system) {
+	if (system->freeHandle == PARTICLE_HANDLE_NONE) {
+		int oldCapacity = system->handleCapacity;
+		int capacity = oldCapacity == 0 ? 16 : oldCapacity*2;
+
+		system->handleToIndex = realloc(system->handleToIndex, sizeof(int)*capacity);
+		system->handleNext = realloc(system->handleNext, sizeof(int)*capacity);
+
+		for(int i = oldCapacity; i < capacity; i++) {
+			system->handleToIndex[i] = -1;
+			system->handleNext[i] = i+1 < capacity ? i+1 : PARTICLE_HANDLE_NONE;
+		}
+
+		system->freeHandle = oldCapacity;
+		system->handleCapacity = capacity;
+	}
+
+	ParticleHandle handle = system->freeHandle;
+	system->freeHandle = system->handleNext[handle];
+	return handle;
+}
+
+static scalar dampingFactor(ParticleSystem* system, scalar damping) {
+	return system->dampingTimeStep > 0 ? scalar_pow(damping, system->dampingTimeStep) : 1;
+}
+
+static ParticleHandle add(ParticleSystem* system) {
+	if (system->count == system->capacity)
+		reserve(system, system->capacity*2);
+
+	ParticleHandle handle = allocHandle(system);
+	int i = system->count++;
+
+	system->handleToIndex[handle] = i;
+	system->indexToHandle[i] = handle;
+
+	system->positionX[i] = system->positionY[i] = system->positionZ[i] = 0;
+	system->velocityX[i] = system->velocityY[i] = system->velocityZ[i] = 0;
+	system->accelerationX[i] = system->accelerationY[i] = system->accelerationZ[i] = 0;
+	system->forceX[i] = system->forceY[i] = system->forceZ[i] = 0;
+	system->inverseMass[i] = 1.0f;
+	system->damping[i] = 0.8f;
+	system->dampingFactor[i] = dampingFactor(system, system->damping[i]);
+
+	return handle;
+}
+
+static int getIndex(ParticleSystem* system, ParticleHandle handle) {
+	if (handle < 0 || handle >= system->handleCapacity)
+		return -1;
+	return system->handleToIndex[handle];
+}
+
+static void remove(ParticleSystem* system, ParticleHandle handle) {
+	int i = getIndex(system, handle);
+	if (i < 0)
+		return;
+
+	//Move the last particle into the hole to keep the arrays dense.
+	int last = --system->count;
+	if (i != last) {
+		scalar* arrays[PARTICLE_SYSTEM_ARRAY_COUNT];
+		getArrays(system, arrays);
+		for(int a = 0; a < PARTICLE_SYSTEM_ARRAY_COUNT; a++)
+			arrays[a][i] = arrays[a][last];
+
+		ParticleHandle moved = system->indexToHandle[last];
+		system->indexToHandle[i] = moved;
+		system->handleToIndex[moved] = i;
+	}
+
+	system->handleToIndex[handle] = -1;
+	system->handleNext[handle] = system->freeHandle;
+	system->freeHandle = handle;
+}
+
+static void setPosition(ParticleSystem* system, ParticleHandle handle, const Vec3* const position) {
+	int i = getIndex(system, handle);
+	system->positionX[i] = position->x;
+	system->positionY[i] = position->y;
+	system->positionZ[i] = position->z;
+}
+
+static Vec3 getPosition(ParticleSystem* system, ParticleHandle handle) {
+	int i = getIndex(system, handle);
+	return manVec3.create(NULL, system->positionX[i], system->positionY[i], system->positionZ[i]);
+}
+
+static void setVelocity(ParticleSystem* system, ParticleHandle handle, const Vec3* const velocity) {
+	int i = getIndex(system, handle);
+	system->velocityX[i] = velocity->x;
+	system->velocityY[i] = velocity->y;
+	system->velocityZ[i] = velocity->z;
+}
+
+static Vec3 getVelocity(ParticleSystem* system, ParticleHandle handle) {
+	int i = getIndex(system, handle);
+	return manVec3.create(NULL, system->velocityX[i], system->velocityY[i], system->velocityZ[i]);
+}
+
+static void setAcceleration(ParticleSystem* system, ParticleHandle handle, const Vec3* const acceleration) {
+	int i = getIndex(system, handle);
+	system->accelerationX[i] = acceleration->x;
+	system->accelerationY[i] = acceleration->y;
+	system->accelerationZ[i] = acceleration->z;
+}
+
+static void addForce(ParticleSystem* system, ParticleHandle handle, const Vec3* const force) {
+	int i = getIndex(system, handle);
+	system->forceX[i] += force->x;
+	system->forceY[i] += force->y;
+	system->forceZ[i] += force->z;
+}
+
+static void setInverseMass(ParticleSystem* system, ParticleHandle handle, scalar invMass) {
+	system->inverseMass[getIndex(system, handle)] = invMass;
+}
+
+static void setDamping(ParticleSystem* system, ParticleHandle handle, scalar damping) {
+	int i = getIndex(system, handle);
+	if (system->damping[i] != damping) {
+		system->damping[i] = damping;
+		system->dampingFactor[i] = dampingFactor(system, damping);
+	}
+}
+
+static void loadParticle(ParticleSystem* system, ParticleHandle handle, const Particle* const particle) {
+	int i = getIndex(system, handle);
+	const Vec3* position = particle->position;
+	const Vec3* velocity = particle->velocity;
+	const Vec3* acceleration = particle->acceleration;
+	const Vec3* force = particle->forceAccum;
+
+	system->positionX[i] = position->x;
+	system->positionY[i] = position->y;
+	system->positionZ[i] = position->z;
+	system->velocityX[i] = velocity->x;
+	system->velocityY[i] = velocity->y;
+	system->velocityZ[i] = velocity->z;
+	system->accelerationX[i] = acceleration->x;
+	system->accelerationY[i] = acceleration->y;
+	system->accelerationZ[i] = acceleration->z;
+	system->forceX[i] = force->x;
+	system->forceY[i] = force->y;
+	system->forceZ[i] = force->z;
+	system->inverseMass[i] = particle->inverseMass;
+
+	if (system->damping[i] != particle->damping) {
+		system->damping[i] = particle->damping;
+		system->dampingFactor[i] = dampingFactor(system, particle->damping);
+	}
+}
+
+static void storeParticle(ParticleSystem* system, ParticleHandle handle, Particle* const particle) {
+	int i = getIndex(system, handle);
+
+	*particle->position = manVec3.create(NULL, system->positionX[i], system->positionY[i], system->positionZ[i]);
+	*particle->velocity = manVec3.create(NULL, system->velocityX[i], system->velocityY[i], system->velocityZ[i]);
+	*particle->forceAccum = manVec3.create(NULL, system->forceX[i], system->forceY[i], system->forceZ[i]);
+}
+
+/*
+ * Recomputes damping^frameTime for every particle. Neighbouring particles
+ * usually share a damping, so the last result is reused where possible.
+ */
+static void updateDampingFactors(ParticleSystem* system, scalar frameTime) {
+	system->dampingTimeStep = frameTime;
+
+	scalar lastDamping = -1;
+	scalar lastFactor = 1;
+	for(int i = 0; i < system->count; i++) {
+		if (system->damping[i] != lastDamping) {
+			lastDamping = system->damping[i];
+			lastFactor = scalar_pow(lastDamping, frameTime);
+		}
+		system->dampingFactor[i] = lastFactor;
+	}
+}
+
+/*
+ * One component of the integration. Kept separate so each loop only touches
+ * five arrays and has no aliasing, which lets it vectorise.
+ */
+static void integrateAxis(int count, scalar frameTime,
+                          scalar* restrict position, scalar* restrict velocity,
+                          const scalar* restrict acceleration, scalar* restrict force,
+                          const scalar* restrict inverseMass, const scalar* restrict damping) {
+	for(int i = 0; i < count; i++) {
+		position[i] += velocity[i]*frameTime;
+		velocity[i] = (velocity[i] + (acceleration[i] + force[i]*inverseMass[i])*frameTime)*damping[i];
+		force[i] = 0;
+	}
+}
+
+/*
+ * Velocity from the new acceleration, then position from the new velocity.
+ */
+static void semiImplicitAxis(int count, scalar frameTime,
+                             scalar* restrict position, scalar* restrict velocity,
+                             const scalar* restrict acceleration, scalar* restrict force,
+                             const scalar* restrict inverseMass, const scalar* restrict damping) {
+	for(int i = 0; i < count; i++) {
+		velocity[i] = (velocity[i] + (acceleration[i] + force[i]*inverseMass[i])*frameTime)*damping[i];
+		position[i] += velocity[i]*frameTime;
+		force[i] = 0;
+	}
+}
+
+/*
+ * The first half kick and the drift of velocity Verlet, leaving the half step velocity
+ * for the forces to be found at the new positions.
+ */
+static void verletDriftAxis(int count, scalar frameTime, bool clearForce,
+                            scalar* restrict position, scalar* restrict velocity,
+                            const scalar* restrict acceleration, scalar* restrict force,
+                            const scalar* restrict inverseMass) {
+	for(int i = 0; i < count; i++) {
+		velocity[i] += (acceleration[i] + force[i]*inverseMass[i])*frameTime*0.5f;
+		position[i] += velocity[i]*frameTime;
+		if (clearForce)
+			force[i] = 0;
+	}
+}
+
+static void verletKickAxis(int count, scalar frameTime,
+                           scalar* restrict velocity, const scalar* restrict acceleration,
+                           scalar* restrict force, const scalar* restrict inverseMass,
+                           const scalar* restrict damping) {
+	for(int i = 0; i < count; i++) {
+		velocity[i] = (velocity[i] + (acceleration[i] + force[i]*inverseMass[i])*frameTime*0.5f)*damping[i];
+		force[i] = 0;
+	}
+}
+
+/*
+ * One of the four RK4 stages. The current position and velocity are the stage's
+ * sample point, whose derivative is added to the weighted sum before moving to the
+ * next sample point, or to the end of the step after the last stage.
+ */
+static void rk4Axis(int count, scalar frameTime, int stage, bool clearForce,
+                    scalar* restrict position, scalar* restrict velocity,
+                    const scalar* restrict acceleration, scalar* restrict force,
+                    const scalar* restrict inverseMass, const scalar* restrict damping,
+                    scalar* restrict startPosition, scalar* restrict startVelocity,
+                    scalar* restrict deltaPosition, scalar* restrict deltaVelocity) {
+	scalar weight = (stage == 0 || stage == 3) ? 1 : 2;
+	scalar next = stage < 2 ? frameTime*0.5f : frameTime;
+
+	for(int i = 0; i < count; i++) {
+		scalar positionRate = velocity[i];
+		scalar velocityRate = acceleration[i] + force[i]*inverseMass[i];
+
+		if (stage == 0) {
+			startPosition[i] = position[i];
+			startVelocity[i] = velocity[i];
+			deltaPosition[i] = 0;
+			deltaVelocity[i] = 0;
+		}
+
+		deltaPosition[i] += positionRate*weight;
+		deltaVelocity[i] += velocityRate*weight;
+
+		if (stage < 3) {
+			position[i] = startPosition[i] + positionRate*next;
+			velocity[i] = startVelocity[i] + velocityRate*next;
+			if (clearForce)
+				force[i] = 0;
+		} else {
+			position[i] = startPosition[i] + deltaPosition[i]*frameTime/6;
+			velocity[i] = (startVelocity[i] + deltaVelocity[i]*frameTime/6)*damping[i];
+			force[i] = 0;
+		}
+	}
+}
+
+typedef enum IntegrateStage_e {
+	INTEGRATE_STAGE_EULER,
+	INTEGRATE_STAGE_SEMI_IMPLICIT_EULER,
+	INTEGRATE_STAGE_VERLET_DRIFT,
+	INTEGRATE_STAGE_VERLET_KICK,
+	INTEGRATE_STAGE_RK4
+} IntegrateStage;
+
+typedef struct IntegrateJob_s {
+	ParticleSystem* system;
+	scalar frameTime;
+	IntegrateStage stage;
+	/** Which RK4 stage, 0 to 3. **/
+	int rk4Stage;
+	/** Whether forces are cleared for the force function to refill. **/
+	bool clearForce;
+} IntegrateJob;
+
+static void integrateRange(void* data, int start, int end, int threadIndex) {
+	IntegrateJob* job = (IntegrateJob*)data;
+	ParticleSystem* s = job->system;
+	scalar h = job->frameTime;
+	int n = end - start;
+
+	switch(job->stage) {
+		case INTEGRATE_STAGE_EULER:
+			integrateAxis(n, h, s->positionX+start, s->velocityX+start, s->accelerationX+start, s->forceX+start, s->inverseMass+start, s->dampingFactor+start);
+			integrateAxis(n, h, s->positionY+start, s->velocityY+start, s->accelerationY+start, s->forceY+start, s->inverseMass+start, s->dampingFactor+start);
+			integrateAxis(n, h, s->positionZ+start, s->velocityZ+start, s->accelerationZ+start, s->forceZ+start, s->inverseMass+start, s->dampingFactor+start);
+			break;
+
+		case INTEGRATE_STAGE_SEMI_IMPLICIT_EULER:
+			semiImplicitAxis(n, h, s->positionX+start, s->velocityX+start, s->accelerationX+start, s->forceX+start, s->inverseMass+start, s->dampingFactor+start);
+			semiImplicitAxis(n, h, s->positionY+start, s->velocityY+start, s->accelerationY+start, s->forceY+start, s->inverseMass+start, s->dampingFactor+start);
+			semiImplicitAxis(n, h, s->positionZ+start, s->velocityZ+start, s->accelerationZ+start, s->forceZ+start, s->inverseMass+start, s->dampingFactor+start);
+			break;
+
+		case INTEGRATE_STAGE_VERLET_DRIFT:
+			verletDriftAxis(n, h, job->clearForce, s->positionX+start, s->velocityX+start, s->accelerationX+start, s->forceX+start, s->inverseMass+start);
+			verletDriftAxis(n, h, job->clearForce, s->positionY+start, s->velocityY+start, s->accelerationY+start, s->forceY+start, s->inverseMass+start);
+			verletDriftAxis(n, h, job->clearForce, s->positionZ+start, s->velocityZ+start, s->accelerationZ+start, s->forceZ+start, s->inverseMass+start);
+			break;
+
+		case INTEGRATE_STAGE_VERLET_KICK:
+			verletKickAxis(n, h, s->velocityX+start, s->accelerationX+start, s->forceX+start, s->inverseMass+start, s->dampingFactor+start);
+			verletKickAxis(n, h, s->velocityY+start, s->accelerationY+start, s->forceY+start, s->inverseMass+start, s->dampingFactor+start);
+			verletKickAxis(n, h, s->velocityZ+start, s->accelerationZ+start, s->forceZ+start, s->inverseMass+start, s->dampingFactor+start);
+			break;
+
+		case INTEGRATE_STAGE_RK4:
+			rk4Axis(n, h, job->rk4Stage, job->clearForce, s->positionX+start, s->velocityX+start, s->accelerationX+start, s->forceX+start, s->inverseMass+start, s->dampingFactor+start,
+			        s->startPositionX+start, s->startVelocityX+start, s->deltaPositionX+start, s->deltaVelocityX+start);
+			rk4Axis(n, h, job->rk4Stage, job->clearForce, s->positionY+start, s->velocityY+start, s->accelerationY+start, s->forceY+start, s->inverseMass+start, s->dampingFactor+start,
+			        s->startPositionY+start, s->startVelocityY+start, s->deltaPositionY+start, s->deltaVelocityY+start);
+			rk4Axis(n, h, job->rk4Stage, job->clearForce, s->positionZ+start, s->velocityZ+start, s->accelerationZ+start, s->forceZ+start, s->inverseMass+start, s->dampingFactor+start,
+			        s->startPositionZ+start, s->startVelocityZ+start, s->deltaPositionZ+start, s->deltaVelocityZ+start);
+			break;
+	}
+}
+
+static void runStage(ParticleSystem* system, IntegrateJob* job, IntegrateStage stage) {
+	job->stage = stage;
+	manJobSystem.parallelFor(system->jobSystem, system->count, PARTICLE_SYSTEM_CHUNK_SIZE, integrateRange, job);
+}
+
+static void integrateAll(ParticleSystem* system, scalar frameTime) {
+	assert(frameTime > 0.0);
+
+	if (frameTime != system->dampingTimeStep)
+		updateDampingFactors(system, frameTime);
+
+	IntegrateJob job = {system, frameTime, INTEGRATE_STAGE_EULER, 0, system->forceFunc != NULL};
+
+	switch(system->integrator) {
+		case PARTICLE_INTEGRATOR_EULER:
+			runStage(system, &job, INTEGRATE_STAGE_EULER);
+			break;
+
+		case PARTICLE_INTEGRATOR_SEMI_IMPLICIT_EULER:
+			runStage(system, &job, INTEGRATE_STAGE_SEMI_IMPLICIT_EULER);
+			break;
+
+		case PARTICLE_INTEGRATOR_VELOCITY_VERLET:
+			runStage(system, &job, INTEGRATE_STAGE_VERLET_DRIFT);
+			if (system->forceFunc != NULL)
+				system->forceFunc(system, system->forceData);
+			runStage(system, &job, INTEGRATE_STAGE_VERLET_KICK);
+			break;
+
+		case PARTICLE_INTEGRATOR_RK4:
+			for(job.rk4Stage = 0; job.rk4Stage < 4; job.rk4Stage++) {
+				runStage(system, &job, INTEGRATE_STAGE_RK4);
+				if (job.rk4Stage < 3 && system->forceFunc != NULL)
+					system->forceFunc(system, system->forceData);
+			}
+			break;
+	}
+}
+
+static void setJobSystem(ParticleSystem* system, JobSystem* jobs) {
+	system->jobSystem = jobs;
+}
+
+static void setIntegrator(ParticleSystem* system, ParticleIntegrator integrator) {
+	system->integrator = integrator;
+}
+
+static void setForceFunc(ParticleSystem* system, ParticleForceFunc* func, void* data) {
+	system->forceFunc = func;
+	system->forceData = data;
+}
+
+const ParticleSystemManager manParticleSystem = {new, add, remove, getIndex, setPosition, getPosition, setVelocity, getVelocity, setAcceleration, addForce, setInverseMass, setDamping, loadParticle, storeParticle, integrateAll, setJobSystem, setIntegrator, setForceFunc, delete};
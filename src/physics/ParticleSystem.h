@@ -0,0 +1,296 @@
+#ifndef PARTICLESYSTEM_H
+#define PARTICLESYSTEM_H
+
+#include <stdbool.h>
+
+#include "math/Vec3.h"
+#include "physics/Particle.h"
+#include "util/JobSystem.h"
+
+#define PARTICLE_HANDLE_NONE -1
+
+/** Number of particles integrated by each job when integrating in parallel. **/
+#define PARTICLE_SYSTEM_CHUNK_SIZE 16384
+
+/**
+ *	Ways integrateAll can step the particles.
+ */
+typedef enum ParticleIntegrator_e {
+	/** Position from the old velocity, then velocity, the same step as manParticle.integrate. First order, and gains energy. **/
+	PARTICLE_INTEGRATOR_EULER,
+	/** Velocity first, then position from the new velocity. Symplectic, so energy stays bounded, for the same cost as Euler. **/
+	PARTICLE_INTEGRATOR_SEMI_IMPLICIT_EULER,
+	/** Kick-drift-kick velocity Verlet. Symplectic and second order, evaluates the forces once more each step. **/
+	PARTICLE_INTEGRATOR_VELOCITY_VERLET,
+	/** Classic fourth order Runge-Kutta. Most accurate per step but not symplectic, evaluates the forces three more times each step. **/
+	PARTICLE_INTEGRATOR_RK4
+} ParticleIntegrator;
+
+struct ParticleSystem_s;
+
+/**
+ *	Adds the force on every particle at its current position and velocity to the
+ * 	system's force arrays, which are zero when it is called. Integrators that look
+ * 	at more than one state per step call it so forces can change within the step.
+ *
+ * 	@param 	system 	pointer to ParticleSystem being integrated.
+ * 	@param 	data 	pointer to void, the data given to setForceFunc.
+ */
+typedef void ParticleForceFunc(struct ParticleSystem_s* system, void* data);
+
+/**
+ *	Identifies a particle in a ParticleSystem. Handles stay valid until the
+ * 	particle is removed, even though removing other particles moves data around.
+ */
+typedef int ParticleHandle;
+
+/**
+ *	Stores many particles as a structure of arrays.
+ *
+ * 	Each component of each quantity is kept in its own contiguous array, so
+ * 	integrating every particle is a single pass over flat arrays of scalars
+ * 	that the compiler can vectorise. Particles are kept densely packed,
+ * 	with removal swapping the last particle into the hole.
+ */
+typedef struct ParticleSystem_s {
+	/** Number of particles in the system. **/
+	int count;
+	/** Number of particles the arrays have room for. **/
+	int capacity;
+
+	scalar* positionX;
+	scalar* positionY;
+	scalar* positionZ;
+
+	scalar* velocityX;
+	scalar* velocityY;
+	scalar* velocityZ;
+
+	scalar* accelerationX;
+	scalar* accelerationY;
+	scalar* accelerationZ;
+
+	/** Resultant force for the next step, cleared by integrateAll. **/
+	scalar* forceX;
+	scalar* forceY;
+	scalar* forceZ;
+
+	scalar* inverseMass;
+	scalar* damping;
+
+	/**
+	 *	damping^frameTime for each particle, for the frame time in dampingTimeStep.
+	 * 	Cached so pow is only called when the time step or a damping changes.
+	 */
+	scalar* dampingFactor;
+	scalar dampingTimeStep;
+
+	/** Scratch for integrators with more than one stage, the state at the start of the step and the weighted sum of derivatives. **/
+	scalar* startPositionX;
+	scalar* startPositionY;
+	scalar* startPositionZ;
+	scalar* startVelocityX;
+	scalar* startVelocityY;
+	scalar* startVelocityZ;
+	scalar* deltaPositionX;
+	scalar* deltaPositionY;
+	scalar* deltaPositionZ;
+	scalar* deltaVelocityX;
+	scalar* deltaVelocityY;
+	scalar* deltaVelocityZ;
+
+	/** How integrateAll steps the particles, PARTICLE_INTEGRATOR_EULER by default. **/
+	ParticleIntegrator integrator;
+	/** Finds the forces within a step, or NULL to hold the forces from the start of the step. **/
+	ParticleForceFunc* forceFunc;
+	void* forceData;
+
+	/** The handle of the particle at each index. **/
+	ParticleHandle* indexToHandle;
+	/** The index of each handle, or -1 for free handles. Free handles are chained through handleNext. **/
+	int* handleToIndex;
+	int* handleNext;
+	int handleCapacity;
+	int freeHandle;
+
+	/** Job system integrateAll splits the particles across, or NULL to integrate on the calling thread. Not owned. **/
+	JobSystem* jobSystem;
+} ParticleSystem;
+
+/**
+ *	Manager for particle systems.
+ */
+typedef struct ParticleSystemManager_s {
+	/**
+	 *	Creates a new, empty particle system.
+	 *
+	 * 	@param 	capacity 	int, number of particles to reserve room for.
+	 * 	@return 			pointer to ParticleSystem, the new system.
+	 */
+	ParticleSystem*(* new)(int capacity);
+
+	/**
+	 *	Adds a particle to the system. It has the same defaults as manParticle.new.
+	 *
+	 * 	@param 	system 	pointer to ParticleSystem to add to.
+	 * 	@return 		ParticleHandle, the handle of the new particle.
+	 */
+	ParticleHandle(* add)(ParticleSystem* system);
+
+	/**
+	 *	Removes a particle from the system. The handle may be reused afterwards.
+	 *
+	 * 	@param 	system 	pointer to ParticleSystem to remove from.
+	 * 	@param 	handle 	ParticleHandle, particle to remove.
+	 */
+	void(* remove)(ParticleSystem* system, ParticleHandle handle);
+
+	/**
+	 *	Gets where the particle's data currently is in the arrays.
+	 *
+	 * 	@param 	system 	pointer to ParticleSystem the particle is in.
+	 * 	@param 	handle 	ParticleHandle, particle to find.
+	 * 	@return 		int, index into the arrays, or -1 if the handle is not in use.
+	 */
+	int(* getIndex)(ParticleSystem* system, ParticleHandle handle);
+
+	/**
+	 *	Sets the position of a particle.
+	 *
+	 * 	@param 	system 		pointer to ParticleSystem the particle is in.
+	 * 	@param 	handle 		ParticleHandle, particle to change.
+	 * 	@param 	position 	const pointer to const Vec3, position to set.
+	 */
+	void(* setPosition)(ParticleSystem* system, ParticleHandle handle, const Vec3* const position);
+
+	/**
+	 *	Gets the position of a particle.
+	 *
+	 * 	@param 	system 	pointer to ParticleSystem the particle is in.
+	 * 	@param 	handle 	ParticleHandle, particle to read.
+	 * 	@return 		Vec3, position of the particle.
+	 */
+	Vec3(* getPosition)(ParticleSystem* system, ParticleHandle handle);
+
+	/**
+	 *	Sets the velocity of a particle.
+	 *
+	 * 	@param 	system 		pointer to ParticleSystem the particle is in.
+	 * 	@param 	handle 		ParticleHandle, particle to change.
+	 * 	@param 	velocity 	const pointer to const Vec3, velocity to set.
+	 */
+	void(* setVelocity)(ParticleSystem* system, ParticleHandle handle, const Vec3* const velocity);
+
+	/**
+	 *	Gets the velocity of a particle.
+	 *
+	 * 	@param 	system 	pointer to ParticleSystem the particle is in.
+	 * 	@param 	handle 	ParticleHandle, particle to read.
+	 * 	@return 		Vec3, velocity of the particle.
+	 */
+	Vec3(* getVelocity)(ParticleSystem* system, ParticleHandle handle);
+
+	/**
+	 *	Sets the constant acceleration of a particle.
+	 *
+	 * 	@param 	system 			pointer to ParticleSystem the particle is in.
+	 * 	@param 	handle 			ParticleHandle, particle to change.
+	 * 	@param 	acceleration 	const pointer to const Vec3, acceleration to set.
+	 */
+	void(* setAcceleration)(ParticleSystem* system, ParticleHandle handle, const Vec3* const acceleration);
+
+	/**
+	 *	Adds a force to be applied at the next step.
+	 *
+	 * 	@param 	system 	pointer to ParticleSystem the particle is in.
+	 * 	@param 	handle 	ParticleHandle, particle to push.
+	 * 	@param 	force 	const pointer to const Vec3, force to add.
+	 */
+	void(* addForce)(ParticleSystem* system, ParticleHandle handle, const Vec3* const force);
+
+	/**
+	 *	Sets the inverse mass of a particle, 0 for infinite mass.
+	 *
+	 * 	@param 	system 		pointer to ParticleSystem the particle is in.
+	 * 	@param 	handle 		ParticleHandle, particle to change.
+	 * 	@param 	invMass 	scalar, inverse mass to set.
+	 */
+	void(* setInverseMass)(ParticleSystem* system, ParticleHandle handle, scalar invMass);
+
+	/**
+	 *	Sets the damping of a particle.
+	 *
+	 * 	@param 	system 		pointer to ParticleSystem the particle is in.
+	 * 	@param 	handle 		ParticleHandle, particle to change.
+	 * 	@param 	damping 	scalar, damping to set.
+	 */
+	void(* setDamping)(ParticleSystem* system, ParticleHandle handle, scalar damping);
+
+	/**
+	 *	Copies the state of a Particle into the system, so objects that still
+	 * 	use Particle (eg. GameObject) can be integrated in bulk.
+	 *
+	 * 	@param 	system 		pointer to ParticleSystem to copy into.
+	 * 	@param 	handle 		ParticleHandle, particle to overwrite.
+	 * 	@param 	particle 	const pointer to const Particle, particle to copy.
+	 */
+	void(* loadParticle)(ParticleSystem* system, ParticleHandle handle, const Particle* const particle);
+
+	/**
+	 *	Copies position, velocity and force back out of the system into a Particle.
+	 *
+	 * 	@param 	system 		pointer to ParticleSystem to copy from.
+	 * 	@param 	handle 		ParticleHandle, particle to copy.
+	 * 	@param 	particle 	const pointer to Particle, particle to overwrite.
+	 */
+	void(* storeParticle)(ParticleSystem* system, ParticleHandle handle, Particle* const particle);
+
+	/**
+	 *	Integrates every particle in the system with its integrator, then clears the forces.
+	 * 	The forces in the system are used as the forces at the start of the step.
+	 *
+	 * 	@pre 				frameTime must be greater than 0.
+	 *
+	 * 	@param 	system 		pointer to ParticleSystem to update.
+	 * 	@param 	frameTime 	scalar, how long the previous frame took to update.
+	 */
+	void(* integrateAll)(ParticleSystem* system, scalar frameTime);
+
+	/**
+	 *	Sets the job system integrateAll spreads its work over. Particles are
+	 * 	independent, so the results are the same with any number of threads.
+	 *
+	 * 	@param 	system 	pointer to ParticleSystem to change.
+	 * 	@param 	jobs 	pointer to JobSystem to use, or NULL to integrate on the calling thread.
+	 */
+	void(* setJobSystem)(ParticleSystem* system, JobSystem* jobs);
+
+	/**
+	 *	Sets how integrateAll steps the particles.
+	 *
+	 * 	@param 	system 		pointer to ParticleSystem to change.
+	 * 	@param 	integrator 	ParticleIntegrator, the integrator to use.
+	 */
+	void(* setIntegrator)(ParticleSystem* system, ParticleIntegrator integrator);
+
+	/**
+	 *	Sets what finds the forces within a step, for the Verlet and RK4 integrators.
+	 * 	Without one the forces at the start of the step are held for the whole step.
+	 *
+	 * 	@param 	system 	pointer to ParticleSystem to change.
+	 * 	@param 	func 	pointer to ParticleForceFunc, or NULL.
+	 * 	@param 	data 	pointer to void, passed to func.
+	 */
+	void(* setForceFunc)(ParticleSystem* system, ParticleForceFunc* func, void* data);
+
+	/**
+	 *	Frees all memory associated with the system, not including the system itself.
+	 *
+	 * 	@param 	system 	pointer to ParticleSystem to delete.
+	 */
+	void(* delete)(ParticleSystem* system);
+} ParticleSystemManager;
+
+extern const ParticleSystemManager manParticleSystem;
+
+#endif
@@ -0,0 +1,232 @@
+#include "Tests.h"
+
+#include "col/AABBTree.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+/*
+ * Checks the AABB tree answers region and ray queries with the same leaves as testing every
+ * fat box does, on random boxes and again after half of them are removed and reinserted
+ * elsewhere. Also checks the tree stays balanced, for the random boxes and for boxes inserted
+ * in order along a line, which would leave an unbalanced tree a list.
+ */
+
+static const int boxCount = 1000;
+static const int queryCount = 500;
+static const scalar margin = 0.1;
+static const scalar worldSize = 100;
+
+static scalar randomRange(scalar low, scalar high) {
+	return low + ((scalar)rand()/(scalar)RAND_MAX)*(high - low);
+}
+
+static AABB randomBox() {
+	AABB box;
+	box.min = manVec3.create(NULL, randomRange(0, worldSize), randomRange(0, worldSize), randomRange(0, worldSize));
+	box.max = manVec3.create(NULL, box.min.x + randomRange(0.1, 4), box.min.y + randomRange(0.1, 4), box.min.z + randomRange(0.1, 4));
+	return box;
+}
+
+static AABB fatBox(const AABB* box) {
+	AABB fat;
+	fat.min = manVec3.create(NULL, box->min.x - margin, box->min.y - margin, box->min.z - margin);
+	fat.max = manVec3.create(NULL, box->max.x + margin, box->max.y + margin, box->max.z + margin);
+	return fat;
+}
+
+static bool boxesOverlap(const AABB* a, const AABB* b) {
+	return (a->min.x <= b->max.x) && (a->max.x >= b->min.x) &&
+	       (a->min.y <= b->max.y) && (a->max.y >= b->min.y) &&
+	       (a->min.z <= b->max.z) && (a->max.z >= b->min.z);
+}
+
+/*
+ * Slab test of the segment from origin to origin + maxFraction*direction.
+ */
+static bool rayHitsBox(const AABB* box, const Vec3* origin, const Vec3* direction, scalar maxFraction) {
+	const scalar o[3] = {origin->x, origin->y, origin->z};
+	const scalar d[3] = {direction->x, direction->y, direction->z};
+	const scalar lo[3] = {box->min.x, box->min.y, box->min.z};
+	const scalar hi[3] = {box->max.x, box->max.y, box->max.z};
+	scalar tMin = 0;
+	scalar tMax = maxFraction;
+
+	for(int a = 0; a < 3; a++) {
+		if (fabs(d[a]) < 1e-12) {
+			if ((o[a] < lo[a]) || (o[a] > hi[a]))
+				return false;
+			continue;
+		}
+
+		scalar t1 = (lo[a] - o[a])*(1/d[a]);
+		scalar t2 = (hi[a] - o[a])*(1/d[a]);
+		tMin = fmax(tMin, fmin(t1, t2));
+		tMax = fmin(tMax, fmax(t1, t2));
+		if (tMin > tMax)
+			return false;
+	}
+
+	return true;
+}
+
+/*
+ * Checks results holds each ID in expected exactly once and nothing else.
+ */
+static bool sameIDs(DynamicArray* results, const bool* expected, int count, bool* seen) {
+	int expectedCount = 0;
+	for(int i = 0; i < count; i++) {
+		seen[i] = false;
+		expectedCount += expected[i];
+	}
+
+	if ((int)results->size != expectedCount)
+		return false;
+
+	for(int i = 0; i < (int)results->size; i++) {
+		int id = *(int*)manDynamicArray.get(results, i);
+		if (id < 0 || id >= count || !expected[id] || seen[id])
+			return false;
+		seen[id] = true;
+	}
+
+	return true;
+}
+
+/*
+ * Runs random region and ray queries on the tree and on every box still inserted, returning
+ * how many gave different leaves.
+ */
+static int countMismatches(AABBTree* tree, const AABB* boxes, const bool* inserted, DynamicArray* results) {
+	bool* expected = malloc(sizeof(bool)*boxCount);
+	bool* seen = malloc(sizeof(bool)*boxCount);
+	int mismatches = 0;
+
+	for(int q = 0; q < queryCount; q++) {
+		AABB region = randomBox();
+		region.max = manVec3.create(NULL, region.max.x + 10, region.max.y + 10, region.max.z + 10);
+		for(int i = 0; i < boxCount; i++) {
+			AABB fat = fatBox(&boxes[i]);
+			expected[i] = inserted[i] && boxesOverlap(&fat, &region);
+		}
+		manAABBTree.queryRegion(tree, &region, results);
+		mismatches += !sameIDs(results, expected, boxCount, seen);
+
+		Vec3 origin = manVec3.create(NULL, randomRange(0, worldSize), randomRange(0, worldSize), randomRange(0, worldSize));
+		Vec3 direction = manVec3.create(NULL, randomRange(-1, 1), randomRange(-1, 1), randomRange(-1, 1));
+		//Every few rays run along an axis, to cover the parallel slabs.
+		if (q%8 == 0)
+			direction = manVec3.create(NULL, 0, 0, 1);
+		scalar maxFraction = randomRange(1, 60);
+		for(int i = 0; i < boxCount; i++) {
+			AABB fat = fatBox(&boxes[i]);
+			expected[i] = inserted[i] && rayHitsBox(&fat, &origin, &direction, maxFraction);
+		}
+		manAABBTree.queryRay(tree, &origin, &direction, maxFraction, results);
+		mismatches += !sameIDs(results, expected, boxCount, seen);
+	}
+
+	free(expected);
+	free(seen);
+	return mismatches;
+}
+
+/*
+ * Checks every internal node's height, balance and box against its children, and that the
+ * height is within what a tree balanced that way can reach for its leaf count.
+ */
+static bool isBalanced(AABBTree* tree, int leafCount) {
+	int leaves = 0;
+	for(int i = 0; i < tree->nodeCapacity; i++) {
+		AABBTreeNode* node = &tree->nodes[i];
+		if (node->height < 0)
+			continue;
+		if (node->left == AABB_TREE_NULL_NODE) {
+			leaves++;
+			continue;
+		}
+
+		AABBTreeNode* left = &tree->nodes[node->left];
+		AABBTreeNode* right = &tree->nodes[node->right];
+		int taller = left->height > right->height ? left->height : right->height;
+		bool contains = (node->box.min.x <= left->box.min.x) && (node->box.min.x <= right->box.min.x) &&
+		                (node->box.max.x >= left->box.max.x) && (node->box.max.x >= right->box.max.x) &&
+		                (node->box.min.y <= left->box.min.y) && (node->box.min.y <= right->box.min.y) &&
+		                (node->box.max.y >= left->box.max.y) && (node->box.max.y >= right->box.max.y) &&
+		                (node->box.min.z <= left->box.min.z) && (node->box.min.z <= right->box.min.z) &&
+		                (node->box.max.z >= left->box.max.z) && (node->box.max.z >= right->box.max.z);
+		if (node->height != taller + 1 || abs(left->height - right->height) > 1 || !contains ||
+		    left->parent != i || right->parent != i)
+			return false;
+	}
+
+	//The tallest tree whose nodes' children differ in height by at most one.
+	int maxHeight = (int)(1.44*log2(leafCount + 2));
+	return (leaves == leafCount) && (manAABBTree.getHeight(tree) <= maxHeight);
+}
+
+void runAABBTreeTest() {
+	srand(11);
+	DynamicArray* results = manDynamicArray.new(64, sizeof(int));
+	AABB* boxes = malloc(sizeof(AABB)*boxCount);
+	int* proxies = malloc(sizeof(int)*boxCount);
+	bool* inserted = malloc(sizeof(bool)*boxCount);
+
+	AABBTree* tree = manAABBTree.new(margin);
+	for(int i = 0; i < boxCount; i++) {
+		boxes[i] = randomBox();
+		proxies[i] = manAABBTree.insert(tree, &boxes[i], i);
+		inserted[i] = true;
+	}
+	int randomMismatches = countMismatches(tree, boxes, inserted, results);
+	bool randomBalanced = isBalanced(tree, boxCount);
+	int randomHeight = manAABBTree.getHeight(tree);
+
+	//Remove every other box, query without them, then put them back somewhere new.
+	for(int i = 0; i < boxCount; i += 2) {
+		manAABBTree.remove(tree, proxies[i]);
+		inserted[i] = false;
+	}
+	int removedMismatches = countMismatches(tree, boxes, inserted, results);
+	bool removedBalanced = isBalanced(tree, boxCount/2);
+
+	for(int i = 0; i < boxCount; i += 2) {
+		boxes[i] = randomBox();
+		proxies[i] = manAABBTree.insert(tree, &boxes[i], i);
+		inserted[i] = true;
+	}
+	int reinsertedMismatches = countMismatches(tree, boxes, inserted, results);
+	bool reinsertedBalanced = isBalanced(tree, boxCount);
+	manAABBTree.delete(tree);
+	free(tree);
+
+	//Inserted in order along a line.
+	tree = manAABBTree.new(margin);
+	for(int i = 0; i < boxCount; i++) {
+		boxes[i].min = manVec3.create(NULL, i*2, 0, 0);
+		boxes[i].max = manVec3.create(NULL, i*2 + 1, 1, 1);
+		proxies[i] = manAABBTree.insert(tree, &boxes[i], i);
+	}
+	int lineMismatches = countMismatches(tree, boxes, inserted, results);
+	bool lineBalanced = isBalanced(tree, boxCount);
+	int lineHeight = manAABBTree.getHeight(tree);
+	manAABBTree.delete(tree);
+	free(tree);
+
+	printf("[AABB Tree Test] %d boxes, %d region and %d ray queries per step\n", boxCount, queryCount, queryCount);
+	printf("[AABB Tree Test] random:     %d mismatches, height %d, %s\n", randomMismatches, randomHeight, randomBalanced ? "balanced" : "UNBALANCED");
+	printf("[AABB Tree Test] removed:    %d mismatches, %s\n", removedMismatches, removedBalanced ? "balanced" : "UNBALANCED");
+	printf("[AABB Tree Test] reinserted: %d mismatches, %s\n", reinsertedMismatches, reinsertedBalanced ? "balanced" : "UNBALANCED");
+	printf("[AABB Tree Test] in a line:  %d mismatches, height %d, %s\n", lineMismatches, lineHeight, lineBalanced ? "balanced" : "UNBALANCED");
+
+	bool passed = (randomMismatches + removedMismatches + reinsertedMismatches + lineMismatches == 0) &&
+	              randomBalanced && removedBalanced && reinsertedBalanced && lineBalanced;
+	printf("[AABB Tree Test] %s\n", passed ? "passed" : "FAILED");
+
+	manDynamicArray.delete(results);
+	free(results);
+	free(boxes);
+	free(proxies);
+	free(inserted);
+}
@@ -0,0 +1,91 @@
+#include "Tests.h"
+
+#include "col/CollisionResolver.h"
+#include "col/SpatialHash.h"
+#include "col/SweepAndPrune.h"
+#include "col/AABBTree.h"
+#include "glfw/Display.h"
+
+#include <stdio.h>
+#include <math.h>
+
+/*
+ * Compares the brute-force broadphase with the spatial hash, sweep and prune and AABB tree.
+ * Colliders are unit cubes scattered through a volume that grows with the
+ * collider count, so the density (and so the real pair count) stays about the same.
+ */
+
+static const int colliderCounts[] = {100, 1000, 10000};
+static const int tickCount = 10;
+
+static scalar randomRange(scalar range) {
+	return ((scalar)rand()/(scalar)RAND_MAX)*range - range/2;
+}
+
+static PhysicsCollider* newCube(scalar range) {
+	PhysicsCollider* col = manPhysCollider.new(NULL, NULL, NULL, NULL, NULL);
+
+	manVec3.create(col->position, randomRange(range), randomRange(range), randomRange(range));
+	attachTestCube(col, sqrt(3));
+
+	return col;
+}
+
+static double timeTicks(CollisionResolver* resolver, int* pairCount) {
+	double start = manWin.getMilliseconds();
+
+	for(int i = 0; i < tickCount; i++) {
+		manColResolver.reset(resolver);
+		manColResolver.prepare(resolver);
+		manColResolver.check(resolver);
+	}
+
+	*pairCount = resolver->pairs->size;
+	return (manWin.getMilliseconds() - start)/tickCount;
+}
+
+void runBroadphaseBenchmark() {
+	printf("[Broadphase Benchmark] %8s %12s %10s %12s %10s %12s %10s %12s %10s %8s\n", "count", "brute pairs", "brute ms", "hash pairs", "hash ms", "sap pairs", "sap ms", "tree pairs", "tree ms", "records");
+
+	for(int c = 0; c < sizeof(colliderCounts)/sizeof(colliderCounts[0]); c++) {
+		int count = colliderCounts[c];
+		scalar range = 4*cbrt(count);
+
+		srand(1);
+		CollisionResolver* resolver = manColResolver.new();
+		for(int i = 0; i < count; i++)
+			manColResolver.addCollider(resolver, newCube(range));
+
+		int brutePairs, hashPairs, sapPairs, treePairs;
+		double bruteTime = timeTicks(resolver, &brutePairs);
+		int bruteRecords = resolver->collisionRecords->size;
+
+		SpatialHash* hash = manSpatialHash.new(0);
+		manColResolver.setBroadphase(resolver, &hash->broadphase);
+		double hashTime = timeTicks(resolver, &hashPairs);
+		int hashRecords = resolver->collisionRecords->size;
+
+		SweepAndPrune* sap = manSweepAndPrune.new();
+		manColResolver.setBroadphase(resolver, &sap->broadphase);
+		double sapTime = timeTicks(resolver, &sapPairs);
+		int sapRecords = resolver->collisionRecords->size;
+
+		AABBTree* tree = manAABBTree.new(0.1);
+		manColResolver.setBroadphase(resolver, &tree->broadphase);
+		double treeTime = timeTicks(resolver, &treePairs);
+		int treeRecords = resolver->collisionRecords->size;
+
+		bool match = (bruteRecords == hashRecords) && (bruteRecords == sapRecords) && (bruteRecords == treeRecords);
+		printf("[Broadphase Benchmark] %8d %12d %10.3f %12d %10.3f %12d %10.3f %12d %10.3f %8s\n", count, brutePairs, bruteTime, hashPairs, hashTime, sapPairs, sapTime, treePairs, treeTime, match ? "match" : "MISMATCH");
+
+		manColResolver.setBroadphase(resolver, NULL);
+		manSpatialHash.delete(hash);
+		free(hash);
+		manSweepAndPrune.delete(sap);
+		free(sap);
+		manAABBTree.delete(tree);
+		free(tree);
+		manColResolver.delete(resolver);
+		free(resolver);
+	}
+}
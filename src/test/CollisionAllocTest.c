@@ -0,0 +1,95 @@
+#include "Tests.h"
+
+#include "col/CollisionResolver.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+/*
+ * Checks that the collision resolver does not allocate once it has warmed up.
+ * Allocations are counted by replacing malloc and friends, which relies on the
+ * glibc internals, so the counting is only built with "scons alloctest=1".
+ */
+
+#ifdef COH_ALLOC_TEST
+extern void* __libc_malloc(size_t size);
+extern void* __libc_calloc(size_t count, size_t size);
+extern void* __libc_realloc(void* ptr, size_t size);
+extern void __libc_free(void* ptr);
+
+static int allocCount = 0;
+
+void* malloc(size_t size) {
+	allocCount++;
+	return __libc_malloc(size);
+}
+
+void* calloc(size_t count, size_t size) {
+	allocCount++;
+	return __libc_calloc(count, size);
+}
+
+void* realloc(void* ptr, size_t size) {
+	allocCount++;
+	return __libc_realloc(ptr, size);
+}
+
+void free(void* ptr) {
+	if (ptr != NULL)
+		allocCount++;
+	__libc_free(ptr);
+}
+
+static const int colliderCount = 200;
+static const int warmupTicks = 5;
+static const int testTicks = 100;
+
+static void tick(CollisionResolver* resolver) {
+	manColResolver.reset(resolver);
+	manColResolver.prepare(resolver);
+	manColResolver.check(resolver);
+	manColResolver.resolve(resolver);
+}
+
+void runCollisionAllocTest() {
+	srand(1);
+	CollisionResolver* resolver = manColResolver.new();
+	PhysicsCollider** colliders = malloc(sizeof(PhysicsCollider*)*colliderCount);
+
+	for(int i = 0; i < colliderCount; i++) {
+		PhysicsCollider* col = manPhysCollider.new(NULL, NULL, NULL, NULL, NULL);
+		manVec3.create(col->position, (rand()%40) - 20, (rand()%40) - 20, (rand()%40) - 20);
+		attachTestCube(col, 1.8);
+
+		colliders[i] = col;
+		manColResolver.addCollider(resolver, col);
+	}
+
+	//Let the record and pair arrays grow to their working size.
+	for(int i = 0; i < warmupTicks; i++)
+		tick(resolver);
+
+	int before = allocCount;
+	for(int i = 0; i < testTicks; i++) {
+		//Nudge everything so every collider has to be transformed again.
+		for(int c = 0; c < colliderCount; c++)
+			colliders[c]->position->x += (i & 1) ? 0.001 : -0.001;
+
+		tick(resolver);
+	}
+	int allocs = allocCount - before;
+
+	printf("[Collision Alloc Test] %d allocations in %d ticks, %s\n", allocs, testTicks, allocs == 0 ? "passed" : "FAILED");
+
+	manColResolver.delete(resolver);
+	free(resolver);
+	free(colliders);
+}
+
+#else
+
+void runCollisionAllocTest() {
+	printf("[Collision Alloc Test] Allocation counting not built, rebuild with alloctest=1\n");
+}
+
+#endif
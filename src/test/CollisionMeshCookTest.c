@@ -0,0 +1,178 @@
+#include "Tests.h"
+
+#include "util/ObjLoader.h"
+#include "util/Clock.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * Cooks the game's collision hulls to .colbin files and checks loading them gives the same
+ * mesh, bounding sphere and hull adjacency as loading the obj does, then times both ways of
+ * loading. Each load is followed by a pass over the vertices, so the mapped pages are read in
+ * as the collision resolver would read them. The loads after the first share its mapping, and
+ * a hull cooked over the file gets a new one. Also checks a cut short file, and one with an
+ * adjacency index past the vertices, are refused, and that loadCollisionMesh picks up a mesh
+ * cooked to its default name, replacing any meteor.colbin.
+ */
+
+static const int objRepeats = 10;
+static const int binaryRepeats = 100;
+static const char* hullFiles[] = {"./data/models/meteor.col.obj", "./data/models/grav.col.obj", "./data/models/Spaceship.col.obj", "./data/models/Boxy.col.obj"};
+static const char* hullNames[] = {"meteor", "grav", "Spaceship", "Boxy"};
+static const int hullCount = 4;
+static const char* cookedFile = "./collisionMeshCookTest.colbin";
+static const char* truncatedFile = "./collisionMeshCookTest.short.colbin";
+static const char* badIndexFile = "./collisionMeshCookTest.badindex.colbin";
+
+static bool sameInts(const int* a, const int* b, int count) {
+	if (a == NULL || b == NULL)
+		return a == b;
+	return memcmp(a, b, sizeof(int)*count) == 0;
+}
+
+static bool meshesMatch(PhysicsCollider* a, PhysicsCollider* b) {
+	SATMesh* meshA = &a->nPhase.satMesh;
+	SATMesh* meshB = &b->nPhase.satMesh;
+	if (meshA->vCount != meshB->vCount || meshA->nCount != meshB->nCount)
+		return false;
+
+	bool adjacencyMatches = sameInts(meshA->adjacencyStart, meshB->adjacencyStart, meshA->vCount + 1);
+	if (adjacencyMatches && meshA->adjacencyStart != NULL)
+		adjacencyMatches = sameInts(meshA->adjacency, meshB->adjacency, meshA->adjacencyStart[meshA->vCount]);
+
+	return adjacencyMatches &&
+	       memcmp(meshA->verts, meshB->verts, sizeof(Vec3)*meshA->vCount) == 0 &&
+	       memcmp(meshA->norms, meshB->norms, sizeof(Vec3)*meshA->nCount) == 0 &&
+	       sameInts(a->nPhase.minPointForAxis, b->nPhase.minPointForAxis, meshA->nCount) &&
+	       sameInts(a->nPhase.maxPointForAxis, b->nPhase.maxPointForAxis, meshA->nCount) &&
+	       memcmp(&a->bPhase.center, &b->bPhase.center, sizeof(Vec3)) == 0 && a->bPhase.radius == b->bPhase.radius;
+}
+
+static scalar touchVerts(PhysicsCollider* collider) {
+	scalar sum = 0;
+	for(int i = 0; i < collider->nPhase.satMesh.vCount; i++)
+		sum += collider->nPhase.satMesh.verts[i].x;
+	return sum;
+}
+
+/*
+ * Frees a collider made with no transform given. A loaded mesh is left alone, it points into its file's mapping.
+ */
+static void deleteCollider(PhysicsCollider* collider, bool ownsMesh) {
+	if (ownsMesh)
+		manColMesh.deleteSimpleMesh(&collider->nPhase);
+	free(collider->position);
+	free(collider->rotation);
+	free(collider->scale);
+	free(collider->velocity);
+	free(collider->inverseMass);
+	free(collider);
+}
+
+/*
+ * Writes a file to another, all but the last byte of it if truncate is set, otherwise with its
+ * last int, the end of the adjacency of a mesh that has it, pointing past the vertices.
+ */
+static bool writeDamaged(const char* from, const char* to, bool truncate) {
+	FILE* in = fopen(from, "rb");
+	if (in == NULL)
+		return false;
+
+	char buffer[1 << 16];
+	size_t size = fread(buffer, 1, sizeof(buffer), in);
+	fclose(in);
+
+	FILE* out = fopen(to, "wb");
+	if (out == NULL || size < sizeof(int))
+		return false;
+	if (truncate) {
+		size--;
+	} else {
+		int badIndex = 1 << 30;
+		memcpy(buffer + size - sizeof(int), &badIndex, sizeof(int));
+	}
+	bool written = fwrite(buffer, 1, size, out) == size;
+	return (fclose(out) == 0) && written;
+}
+
+void runCollisionMeshCookTest() {
+	bool passed = true;
+	scalar touched = 0;
+	double objTotal = 0;
+	double binaryTotal = 0;
+	bool shared = true;
+	const Vec3* lastVerts = NULL;
+
+	printf("[Collision Mesh Cook Test] %-10s %6s %6s %10s %12s %12s %9s\n", "hull", "verts", "norms", "matched", "obj us", "colbin us", "speedup");
+	for(int h = 0; h < hullCount; h++) {
+		bool cooked = objLoader.cookCollisionMesh(hullFiles[h], cookedFile);
+		PhysicsCollider* fromObj = objLoader.loadCollisionMesh(hullFiles[h], NULL, NULL, NULL, NULL);
+		PhysicsCollider* fromBinary = cooked ? objLoader.loadCollisionMeshBinary(cookedFile, NULL, NULL, NULL, NULL) : NULL;
+		bool matched = fromBinary != NULL && meshesMatch(fromObj, fromBinary);
+		passed = passed && matched;
+
+		//Each hull is cooked over the last one's file, so it must not get the last one's mapping.
+		if (fromBinary != NULL) {
+			shared = shared && fromBinary->nPhase.satMesh.verts != lastVerts;
+			lastVerts = fromBinary->nPhase.satMesh.verts;
+		}
+
+		double start = manClock.getMilliseconds();
+		for(int r = 0; r < objRepeats; r++) {
+			PhysicsCollider* collider = objLoader.loadCollisionMesh(hullFiles[h], NULL, NULL, NULL, NULL);
+			touched += touchVerts(collider);
+			deleteCollider(collider, true);
+		}
+		double objTime = (manClock.getMilliseconds() - start)/objRepeats;
+
+		start = manClock.getMilliseconds();
+		for(int r = 0; r < binaryRepeats && fromBinary != NULL; r++) {
+			PhysicsCollider* collider = objLoader.loadCollisionMeshBinary(cookedFile, NULL, NULL, NULL, NULL);
+			shared = shared && collider->nPhase.satMesh.verts == lastVerts;
+			touched += touchVerts(collider);
+			deleteCollider(collider, false);
+		}
+		double binaryTime = (manClock.getMilliseconds() - start)/binaryRepeats;
+
+		objTotal += objTime;
+		binaryTotal += binaryTime;
+		printf("[Collision Mesh Cook Test] %-10s %6d %6d %10s %12.1f %12.1f %8.0fx\n", hullNames[h],
+		       fromObj->nPhase.satMesh.vCount, fromObj->nPhase.satMesh.nCount, matched ? "yes" : "NO",
+		       objTime*1000, binaryTime*1000, objTime/binaryTime);
+
+		deleteCollider(fromObj, true);
+		if (fromBinary != NULL)
+			deleteCollider(fromBinary, false);
+	}
+
+	bool refused = writeDamaged(cookedFile, truncatedFile, true) && objLoader.loadCollisionMeshBinary(truncatedFile, NULL, NULL, NULL, NULL) == NULL;
+	remove(truncatedFile);
+	remove(cookedFile);
+
+	//Meteor has adjacency, so its last int is an adjacency index.
+	bool badIndexRefused = objLoader.cookCollisionMesh(hullFiles[0], cookedFile) && writeDamaged(cookedFile, badIndexFile, false) &&
+	                       objLoader.loadCollisionMeshBinary(badIndexFile, NULL, NULL, NULL, NULL) == NULL;
+	remove(badIndexFile);
+	remove(cookedFile);
+
+	//Grav's mesh cooked to meteor's default name is what loading meteor's obj gives.
+	char defaultName[COOKED_MAX_PATH];
+	snprintf(defaultName, sizeof(defaultName), "./data/models/%s.colbin", hullNames[0]);
+	bool pickedUp = false;
+	if (objLoader.cookCollisionMesh(hullFiles[1], defaultName)) {
+		PhysicsCollider* fromDefault = objLoader.loadCollisionMesh(hullFiles[0], NULL, NULL, NULL, NULL);
+		PhysicsCollider* fromObj = objLoader.loadCollisionMesh(hullFiles[1], NULL, NULL, NULL, NULL);
+		pickedUp = meshesMatch(fromDefault, fromObj);
+		deleteCollider(fromDefault, !pickedUp);
+		deleteCollider(fromObj, true);
+	}
+	remove(defaultName);
+
+	passed = passed && shared && refused && badIndexRefused && pickedUp;
+	printf("[Collision Mesh Cook Test] all hulls: obj %.1f us, colbin %.1f us (%.0fx); mapping %s, truncated file %s, bad index %s, default name %s (%g)\n",
+	       objTotal*1000, binaryTotal*1000, objTotal/binaryTotal, shared ? "shared" : "NOT SHARED", refused ? "refused" : "LOADED",
+	       badIndexRefused ? "refused" : "LOADED", pickedUp ? "used" : "NOT USED", touched);
+	printf("[Collision Mesh Cook Test] %s\n", passed ? "passed" : "FAILED");
+}
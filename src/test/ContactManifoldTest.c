@@ -0,0 +1,203 @@
+#include "Tests.h"
+
+#include "col/CollisionResolver.h"
+#include "col/SpatialHash.h"
+#include "util/Clock.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+/*
+ * Checks a cube resting face down, edge down and corner down on a larger cube gets four,
+ * two and one contact points at the right depth, whichever way the axis it is given points.
+ * Then checks a resolver's pair cache carries manifolds along with colliders moving together
+ * without rerunning the narrowphase, carries impulses on when they move apart a little, and
+ * times a field of touching pairs drifting together against the same field jostling.
+ */
+
+static const scalar tolerance = 1e-3;
+static const int fieldPairs = 1000;
+static const int timedTicks = 60;
+
+/*
+ * The shared test cube, copied with its adjacency built.
+ */
+static ColliderSimpleMesh newCubeMesh() {
+	ColliderSimpleMesh* source = newTestCubeMesh();
+	ColliderSimpleMesh mesh = manColMesh.copyMesh(source);
+	manColMesh.buildAdjacency(&mesh);
+	free(source);
+	return mesh;
+}
+
+static ColliderSimpleMesh placeCube(ColliderSimpleMesh* cube, Vec3 position, Vec3 rotation, scalar halfSize) {
+	ColliderSimpleMesh placed;
+	placed.satMesh.verts = malloc(sizeof(Vec3)*cube->satMesh.vCount);
+	placed.satMesh.norms = malloc(sizeof(Vec3)*cube->satMesh.nCount);
+	Vec3 scale = manVec3.create(NULL, halfSize, halfSize, halfSize);
+	Mat4 transform = manColMesh.makeTransformationMatrix(&position, &rotation, &scale);
+	manColMesh.transformSimpleMeshInto(&placed, cube, &transform);
+	return placed;
+}
+
+/*
+ * Rests a cube of half size 0.5 on top of a cube of half size 1 at the origin, sunk 0.1 into it.
+ */
+static bool testShape(ColliderSimpleMesh* cube, const char* name, Vec3 rotation, int expectedCount) {
+	ColliderSimpleMesh base = placeCube(cube, manVec3.create(NULL, 0, 0, 0), manVec3.create(NULL, 0, 0, 0), 1);
+	ColliderSimpleMesh top = placeCube(cube, manVec3.create(NULL, 0.2, 0, 0.1), rotation, 0.5);
+
+	scalar lowest = top.satMesh.verts[0].y;
+	for(int i = 1; i < top.satMesh.vCount; i++)
+		lowest = fminf(lowest, top.satMesh.verts[i].y);
+	Vec3 sink = manVec3.create(NULL, 0, 0.9 - lowest, 0);
+	for(int i = 0; i < top.satMesh.vCount; i++)
+		top.satMesh.verts[i] = manVec3.sum(&top.satMesh.verts[i], &sink);
+
+	bool passed = true;
+	Vec3 axes[2] = {{0, 1, 0}, {0, -1, 0}};
+	ContactManifold manifold;
+	for(int a = 0; a < 2; a++) {
+		int vertex1 = 0, vertex2 = 0;
+		manContactManifold.generate(&manifold, &base.satMesh, &top.satMesh, &axes[a], &vertex1, &vertex2);
+
+		passed = passed && manifold.count == expectedCount && manifold.normal.y == -1 && fabs(manifold.depth - 0.1) < tolerance;
+		for(int i = 0; i < manifold.count; i++)
+			passed = passed && fabs(manifold.points[i].depth - 0.1) < tolerance && fabs(manifold.points[i].position.y - 0.95) < tolerance;
+	}
+
+	printf("[Contact Manifold Test] %-7s %d points, normal (%.0f, %.0f, %.0f), depth %.3f: %s\n", name, manifold.count,
+	       manifold.normal.x, manifold.normal.y, manifold.normal.z, manifold.depth, passed ? "ok" : "WRONG");
+
+	free(base.satMesh.verts);
+	free(base.satMesh.norms);
+	free(top.satMesh.verts);
+	free(top.satMesh.norms);
+	return passed;
+}
+
+static PhysicsCollider* newCollider(CollisionResolver* resolver, ColliderSimpleMesh* cube, scalar x, scalar y) {
+	PhysicsCollider* col = manPhysCollider.new(NULL, NULL, NULL, NULL, NULL);
+	manVec3.create(col->position, x, y, 0);
+	manPhysCollider.setBroadphase(col, NULL, sqrt(3));
+	manPhysCollider.attachNarrowphaseSimpleMesh(col, cube);
+	manColResolver.addCollider(resolver, col);
+	return col;
+}
+
+static void tick(CollisionResolver* resolver) {
+	manColResolver.reset(resolver);
+	manColResolver.prepare(resolver);
+	manColResolver.check(resolver);
+}
+
+static ContactPair* firstContact(CollisionResolver* resolver) {
+	return (ContactPair*)manDynamicArray.get(resolver->contactPairs, 0);
+}
+
+/*
+ * Two cubes, one sunk into the top of the other. Collisions are found but never resolved,
+ * so only the moves below change the pair.
+ */
+static bool testCache(ColliderSimpleMesh* cube) {
+	CollisionResolver* resolver = manColResolver.new();
+	PhysicsCollider* lower = newCollider(resolver, cube, 0, 0);
+	PhysicsCollider* upper = newCollider(resolver, cube, 0.5, 1.75);
+
+	tick(resolver);
+	bool found = resolver->collisionRecords->size == 1 && firstContact(resolver)->manifold.count == 4 && !firstContact(resolver)->reused;
+	scalar startX = firstContact(resolver)->manifold.points[0].position.x;
+
+	//Moving both the same way keeps the result, and the manifold follows them.
+	bool reused = true;
+	for(int t = 1; t <= 10; t++) {
+		lower->position->x += 0.5;
+		upper->position->x += 0.5;
+		tick(resolver);
+		reused = reused && firstContact(resolver)->reused && resolver->collisionRecords->size == 1;
+	}
+	bool followed = fabs(firstContact(resolver)->manifold.points[0].position.x - (startX + 5)) < tolerance;
+
+	//Moving one a little gets a new manifold, which starts from the impulses of the last.
+	for(int i = 0; i < firstContact(resolver)->manifold.count; i++)
+		firstContact(resolver)->manifold.points[i].normalImpulse = 1;
+	upper->position->x += 0.01;
+	tick(resolver);
+	bool warm = !firstContact(resolver)->reused && firstContact(resolver)->manifold.count == 4;
+	for(int i = 0; i < firstContact(resolver)->manifold.count; i++)
+		warm = warm && firstContact(resolver)->manifold.points[i].normalImpulse == 1;
+
+	//Turning it moves every corner of the overlap, so it starts over.
+	upper->rotation->y += 30;
+	tick(resolver);
+	bool cold = !firstContact(resolver)->reused;
+	for(int i = 0; i < firstContact(resolver)->manifold.count; i++)
+		cold = cold && firstContact(resolver)->manifold.points[i].normalImpulse == 0;
+
+	printf("[Contact Manifold Test] cache: found %s, reused moving together %s, followed %s, warm started %s, cold after turning %s\n",
+	       found ? "yes" : "NO", reused ? "yes" : "NO", followed ? "yes" : "NO", warm ? "yes" : "NO", cold ? "yes" : "NO");
+
+	manColResolver.delete(resolver);
+	free(resolver);
+
+	return found && reused && followed && warm && cold;
+}
+
+/*
+ * Times ticks of a field of touching pairs, either all drifting the same way or each jostled a little.
+ */
+static double timeField(ColliderSimpleMesh* cube, bool jostle, int* reused) {
+	CollisionResolver* resolver = manColResolver.new();
+	SpatialHash* broadphase = manSpatialHash.new(0);
+	manColResolver.setBroadphase(resolver, &broadphase->broadphase);
+	PhysicsCollider** colliders = malloc(sizeof(PhysicsCollider*)*fieldPairs*2);
+	for(int i = 0; i < fieldPairs; i++) {
+		colliders[i*2] = newCollider(resolver, cube, (i%32)*8, (i/32)*8);
+		colliders[i*2+1] = newCollider(resolver, cube, (i%32)*8 + 0.5, (i/32)*8 + 1.75);
+	}
+	tick(resolver);
+
+	double start = manClock.getMilliseconds();
+	*reused = 0;
+	for(int t = 0; t < timedTicks; t++) {
+		for(int i = 0; i < fieldPairs*2; i++)
+			colliders[i]->position->x += 0.25;
+		if (jostle) {
+			for(int i = 0; i < fieldPairs; i++)
+				colliders[i*2+1]->position->z = ((t+1)%2)*0.01;
+		}
+		tick(resolver);
+
+		for(int p = 0; p < resolver->contactPairs->size; p++)
+			*reused += ((ContactPair*)manDynamicArray.get(resolver->contactPairs, p))->reused;
+	}
+	double time = (manClock.getMilliseconds() - start)/timedTicks;
+
+	manColResolver.delete(resolver);
+	free(resolver);
+	manSpatialHash.delete(broadphase);
+	free(broadphase);
+	free(colliders);
+
+	return time;
+}
+
+void runContactManifoldTest() {
+	ColliderSimpleMesh cube = newCubeMesh();
+
+	bool passed = testShape(&cube, "face", manVec3.create(NULL, 0, 0, 0), 4);
+	passed = testShape(&cube, "edge", manVec3.create(NULL, 0, 0, 45), 2) && passed;
+	passed = testShape(&cube, "corner", manVec3.create(NULL, 45, 0, 35.26439), 1) && passed;
+	passed = testCache(&cube) && passed;
+
+	int driftReused, jostleReused;
+	double driftTime = timeField(&cube, false, &driftReused);
+	double jostleTime = timeField(&cube, true, &jostleReused);
+	passed = passed && driftReused == fieldPairs*timedTicks && jostleReused == 0;
+	printf("[Contact Manifold Test] %d touching pairs: drifting together %.3f ms a tick (%d reused), jostled %.3f ms (%d reused), %.2fx\n",
+	       fieldPairs, driftTime, driftReused, jostleTime, jostleReused, jostleTime/driftTime);
+
+	manColMesh.deleteSimpleMesh(&cube);
+	printf("[Contact Manifold Test] %s\n", passed ? "passed" : "FAILED");
+}
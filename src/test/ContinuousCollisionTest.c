@@ -0,0 +1,124 @@
+#include "Tests.h"
+
+#include "col/CollisionResolver.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+/*
+ * Fires a fast cube at a thin immovable wall at a few tick rates, with and without
+ * continuous collision, and reports which runs pass through the wall. Also checks
+ * the cube is moved back to where it first touched the wall, and that two fast
+ * cubes flying at each other collide instead of swapping places.
+ */
+
+static const scalar bulletSpeed = 600;
+static const scalar wallHalfWidth = 0.05;
+static const int tickRates[] = {60, 120, 240, 480};
+static const int tickRateCount = 4;
+
+static PhysicsCollider* newCube(CollisionResolver* resolver, scalar x, scalar velocity, bool continuous) {
+	PhysicsCollider* col = manPhysCollider.new(NULL, NULL, NULL, NULL, NULL);
+	manVec3.create(col->position, x, 0, 0);
+	manVec3.create(col->velocity, velocity, 0, 0);
+	col->continuous = continuous;
+	attachTestCube(col, sqrt(3));
+
+	manColResolver.addCollider(resolver, col);
+	return col;
+}
+
+static void tick(CollisionResolver* resolver, PhysicsCollider** colliders, int count, scalar tickDelta) {
+	for(int i = 0; i < count; i++) {
+		if (!colliders[i]->immovable) {
+			Vec3 move = manVec3.preMulScalar(tickDelta, colliders[i]->velocity);
+			*colliders[i]->position = manVec3.sum(colliders[i]->position, &move);
+		}
+	}
+
+	manColResolver.reset(resolver);
+	manColResolver.prepare(resolver);
+	if (manColResolver.check(resolver))
+		manColResolver.resolve(resolver);
+}
+
+/*
+ * Runs the bullet at the wall for a quarter of a second.
+ * @return Whether the bullet ended up on the far side of the wall.
+ * @param impactX Set to where the bullet was after the first tick it hit the wall, or NAN if it never did.
+ */
+static bool fireAtWall(int tickRate, bool continuous, scalar* impactX) {
+	CollisionResolver* resolver = manColResolver.new();
+	PhysicsCollider* colliders[2];
+
+	colliders[0] = newCube(resolver, 0, 0, false);
+	colliders[0]->immovable = true;
+	*colliders[0]->inverseMass = 0.0001;
+	manVec3.create(colliders[0]->scale, wallHalfWidth, 10, 10);
+
+	//Start where the bullet steps over the wall at every rate up to 240Hz, rather than landing in it by luck.
+	colliders[1] = newCube(resolver, -23.75, bulletSpeed, continuous);
+
+	*impactX = NAN;
+	scalar tickDelta = 1.0/tickRate;
+	for(int t = 0; t < tickRate/4; t++) {
+		tick(resolver, colliders, 2, tickDelta);
+		if (isnan(*impactX) && resolver->collisionRecords->size > 0)
+			*impactX = colliders[1]->position->x;
+	}
+
+	bool passed = colliders[1]->position->x > 0;
+
+	manColResolver.delete(resolver);
+	free(resolver);
+
+	return passed;
+}
+
+/*
+ * Two bullets flying at each other, each covering more than its own width every tick.
+ */
+static bool headOn(bool continuous) {
+	CollisionResolver* resolver = manColResolver.new();
+	PhysicsCollider* colliders[2];
+
+	colliders[0] = newCube(resolver, -15, bulletSpeed, continuous);
+	colliders[1] = newCube(resolver, 15, -bulletSpeed, continuous);
+
+	for(int t = 0; t < 15; t++)
+		tick(resolver, colliders, 2, 1.0/60);
+
+	bool swapped = colliders[0]->position->x > colliders[1]->position->x;
+
+	manColResolver.delete(resolver);
+	free(resolver);
+
+	return swapped;
+}
+
+void runContinuousCollisionTest() {
+	bool passed = true;
+
+	printf("[Continuous Collision Test] %d u/s cube at a %.2f thick wall\n", (int)bulletSpeed, wallHalfWidth*2);
+	printf("[Continuous Collision Test] %8s %18s %18s %16s\n", "tick Hz", "static tunnels", "swept tunnels", "impact x");
+
+	for(int r = 0; r < tickRateCount; r++) {
+		scalar staticImpact, sweptImpact;
+		bool staticTunnels = fireAtWall(tickRates[r], false, &staticImpact);
+		bool sweptTunnels = fireAtWall(tickRates[r], true, &sweptImpact);
+
+		//The cube's face touches the wall's face one half width short of the wall's centre.
+		scalar expectedImpact = -(1 + wallHalfWidth);
+		passed = passed && !sweptTunnels && fabs(sweptImpact - expectedImpact) < 1e-3;
+
+		printf("[Continuous Collision Test] %8d %18s %18s %16.4f\n", tickRates[r], staticTunnels ? "yes" : "no", sweptTunnels ? "YES" : "no", sweptImpact);
+	}
+
+	bool staticSwapped = headOn(false);
+	bool sweptSwapped = headOn(true);
+	passed = passed && !sweptSwapped;
+	printf("[Continuous Collision Test] head on at 60Hz: static pass through each other %s, swept %s\n", staticSwapped ? "yes" : "no", sweptSwapped ? "YES" : "no");
+
+	printf("[Continuous Collision Test] %s\n", passed ? "passed" : "FAILED");
+}
@@ -22,7 +22,7 @@ static void onInitWindow(GameLoop* self);
 static void onInitOpenGL(GameLoop* self);
 static void onInitMisc(GameLoop* self);
 static void onUpdate(GameLoop* self, float tickDelta);
-static void onRender(GameLoop* self, float frameDelta);
+static void onRender(GameLoop* self, float alpha);
 static void onClose(GameLoop* self);
 static void onDestroy(GameLoop* self);
 
@@ -127,7 +127,7 @@ static void onUpdate(GameLoop* self, float tickDelta) {
 	}
 }
 
-static void onRender(GameLoop* self, float frameDelta) {
+static void onRender(GameLoop* self, float alpha) {
 	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
 	manMatMan.setMode(manMat, MATRIX_MODE_VIEW);
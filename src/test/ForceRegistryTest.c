@@ -0,0 +1,161 @@
+#include "Tests.h"
+
+#include "physics/ParticleForceRegistry.h"
+#include "physics/AnchoredGravityForceGenerator.h"
+#include "util/JobSystem.h"
+#include "util/Clock.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+/*
+ * Registers particles with a few gravity wells from every thread of a job system,
+ * checks the batched update gives the same forces as calling each generator per
+ * particle, then removes half the registrations by handle, again from every thread.
+ * Also times the batched update against one call per registration, the batch has to be at
+ * least minSpeedup times faster.
+ */
+
+static const int particleCount = 50000;
+static const int wellCount = 4;
+static const int updateCount = 20;
+static const double minSpeedup = 1.3;
+
+typedef struct ForceRegistryTestData_s {
+	ParticleForceRegistry* registry;
+	Particle** particles;
+	AnchoredGravityForceGenerator** wells;
+	ParticleForceHandle* handles;
+} ForceRegistryTestData;
+
+static scalar randomRange(scalar range) {
+	return ((scalar)rand()/(scalar)RAND_MAX)*range - range/2;
+}
+
+static void addRange(void* data, int start, int end, int threadIndex) {
+	ForceRegistryTestData* test = (ForceRegistryTestData*)data;
+
+	for(int i = start; i < end; i++) {
+		for(int w = 0; w < wellCount; w++)
+			test->handles[i*wellCount + w] = manForceRegistry.add(test->registry, test->particles[i], &test->wells[w]->forceGenerator);
+	}
+}
+
+static void removeRange(void* data, int start, int end, int threadIndex) {
+	ForceRegistryTestData* test = (ForceRegistryTestData*)data;
+
+	for(int i = start; i < end; i++) {
+		if (i%2 == 0) {
+			for(int w = 0; w < wellCount; w++)
+				manForceRegistry.remove(test->registry, test->handles[i*wellCount + w]);
+		}
+	}
+}
+
+static void clearForces(ForceRegistryTestData* test) {
+	for(int i = 0; i < particleCount; i++)
+		manParticle.clearForceAccumulator(test->particles[i]);
+}
+
+/*
+ * Checks every particle's force against calling each well's updateForce on it directly.
+ */
+static bool checkForces(ForceRegistryTestData* test, bool removedEven) {
+	bool matches = true;
+
+	for(int i = 0; i < particleCount && matches; i++) {
+		Particle* particle = test->particles[i];
+		Vec3 force = *particle->forceAccum;
+
+		manParticle.clearForceAccumulator(particle);
+		if (!removedEven || i%2 != 0) {
+			for(int w = 0; w < wellCount; w++)
+				test->wells[w]->forceGenerator.updateForce(&test->wells[w]->forceGenerator, particle, 1/120.0);
+		}
+
+		matches = (force.x == particle->forceAccum->x) && (force.y == particle->forceAccum->y) && (force.z == particle->forceAccum->z);
+	}
+
+	return matches;
+}
+
+static double timeUpdates(ForceRegistryTestData* test) {
+	double total = 0;
+	for(int i = 0; i < updateCount; i++) {
+		clearForces(test);
+		double start = manClock.getMilliseconds();
+		manForceRegistry.updateForces(test->registry, 1/120.0);
+		total += manClock.getMilliseconds() - start;
+	}
+	return total/updateCount;
+}
+
+void runForceRegistryTest() {
+	ForceRegistryTestData test;
+	test.registry = manForceRegistry.new();
+	test.particles = malloc(sizeof(Particle*)*particleCount);
+	test.wells = malloc(sizeof(AnchoredGravityForceGenerator*)*wellCount);
+	test.handles = malloc(sizeof(ParticleForceHandle)*particleCount*wellCount);
+
+	srand(1);
+	for(int i = 0; i < particleCount; i++) {
+		test.particles[i] = manParticle.new(NULL, NULL, NULL, NULL);
+		manVec3.create(test.particles[i]->position, randomRange(1000), randomRange(1000), randomRange(1000));
+		manParticle.setMass(test.particles[i], 1 + randomRange(1));
+	}
+
+	Particle** anchors = malloc(sizeof(Particle*)*wellCount);
+	for(int w = 0; w < wellCount; w++) {
+		anchors[w] = manParticle.new(NULL, NULL, NULL, NULL);
+		manVec3.create(anchors[w]->position, randomRange(1000), randomRange(1000), randomRange(1000));
+		manParticle.setMass(anchors[w], 1e12);
+		test.wells[w] = manAnchoredGravityForceGenerator.new(anchors[w]);
+	}
+
+	JobSystem* jobs = manJobSystem.new(0);
+
+	manJobSystem.parallelFor(jobs, particleCount, 256, addRange, &test);
+	clearForces(&test);
+	manForceRegistry.updateForces(test.registry, 1/120.0);
+	bool added = manForceRegistry.getCount(test.registry) == particleCount*wellCount;
+	bool addedForces = checkForces(&test, false);
+
+	double batchedTime = timeUpdates(&test);
+	for(int w = 0; w < wellCount; w++)
+		test.wells[w]->forceGenerator.updateForceBatch = NULL;
+	double singleTime = timeUpdates(&test);
+
+	manJobSystem.parallelFor(jobs, particleCount, 256, removeRange, &test);
+	clearForces(&test);
+	manForceRegistry.updateForces(test.registry, 1/120.0);
+	bool removed = manForceRegistry.getCount(test.registry) == (particleCount/2)*wellCount;
+	bool removedForces = checkForces(&test, true);
+
+	bool faster = singleTime >= minSpeedup*batchedTime;
+	bool passed = added && addedForces && removed && removedForces && faster;
+	printf("[Force Registry Test] %d threads, %d registrations, batched %.3f ms, per registration %.3f ms (%.2fx, %s %.1fx), %s\n",
+	       manJobSystem.getThreadCount(jobs), particleCount*wellCount, batchedTime, singleTime, singleTime/batchedTime,
+	       faster ? "at least" : "UNDER", minSpeedup, passed ? "passed" : "FAILED");
+
+	manJobSystem.delete(jobs);
+	free(jobs);
+
+	manForceRegistry.delete(test.registry);
+	free(test.registry);
+
+	for(int w = 0; w < wellCount; w++) {
+		manAnchoredGravityForceGenerator.delete(test.wells[w]);
+		free(test.wells[w]);
+		manParticle.delete(anchors[w]);
+		free(anchors[w]);
+	}
+	for(int i = 0; i < particleCount; i++) {
+		manParticle.delete(test.particles[i]);
+		free(test.particles[i]);
+	}
+
+	free(anchors);
+	free(test.particles);
+	free(test.wells);
+	free(test.handles);
+}
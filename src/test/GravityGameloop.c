@@ -22,7 +22,7 @@ static void onInitWindow(GameLoop* self);
 static void onInitOpenGL(GameLoop* self);
 static void onInitMisc(GameLoop* self);
 static void onUpdate(GameLoop* self, float tickDelta);
-static void onRender(GameLoop* self, float frameDelta);
+static void onRender(GameLoop* self, float alpha);
 static void onClose(GameLoop* self);
 static void onDestroy(GameLoop* self);
 
@@ -293,7 +293,7 @@ static void setupCamera(MatrixManager* mats, Vec3* camPos, Vec3* camRot) {
 	manMatMan.translate(mats, *camPos);
 }
 
-static void render(float frameDelta, Window* window, Vec3* camPos, Vec3* camRot, Skybox* skybox, Shader* skyboxShader, Shader* villageShader, RenderObject* villageModel, GameObjectRegist* gameObjRegist) {
+static void render(float alpha, Window* window, Vec3* camPos, Vec3* camRot, Skybox* skybox, Shader* skyboxShader, Shader* villageShader, RenderObject* villageModel, GameObjectRegist* gameObjRegist) {
 	glViewport(0, 0, manWin.getFramebufferWidth(window), manWin.getFramebufferHeight(window));
 	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
@@ -308,13 +308,13 @@ static void render(float frameDelta, Window* window, Vec3* camPos, Vec3* camRot,
 		manRenderer.renderModel(villageModel, villageShader, matMan);
 
 		manMatMan.setMode(matMan, MATRIX_MODE_MODEL);
-		manGameObjRegist.render(gameObjRegist, frameDelta);
+		manGameObjRegist.render(gameObjRegist, alpha);
 
 	manMatMan.setMode(matMan, MATRIX_MODE_VIEW);
 	manMatMan.pop(matMan);
 }
 
-static void onRender(GameLoop* self, float frameDelta) {
+static void onRender(GameLoop* self, float alpha) {
 	NewtonsCradleData* data = (NewtonsCradleData*)self->extraData;
-	render(frameDelta, self->primaryWindow, data->camPos, data->camRot, data->skybox, data->skyboxShader, data->villageShader, data->villageModel, data->gameObjRegist);
+	render(alpha, self->primaryWindow, data->camPos, data->camRot, data->skybox, data->skyboxShader, data->villageShader, data->villageModel, data->gameObjRegist);
 }
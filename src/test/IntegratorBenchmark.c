@@ -0,0 +1,198 @@
+#include "Tests.h"
+
+#include "physics/ParticleSystem.h"
+#include "physics/ParticleForceRegistry.h"
+#include "physics/SpringForceGenerator.h"
+#include "physics/AnchoredGravityForceGenerator.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+/*
+ * Runs a stiff spring and a circular orbit with each ParticleSystem integrator,
+ * and reports the energy drift at the game's 120Hz tick and the largest time
+ * step that keeps the energy within 10% of where it started.
+ */
+
+typedef enum IntegratorScene_e {
+	SCENE_SPRING,
+	SCENE_ORBIT
+} IntegratorScene;
+
+typedef struct IntegratorSceneData_s {
+	IntegratorScene scene;
+	ParticleSystem* system;
+	ParticleForceRegistry* registry;
+	ParticleHandle handle;
+	Particle* body;
+	Particle* anchor;
+	SpringForceGenerator* spring;
+	AnchoredGravityForceGenerator* gravity;
+	scalar frameTime;
+} IntegratorSceneData;
+
+static const char* integratorNames[] = {"euler", "semi-implicit", "verlet", "rk4"};
+static const char* sceneNames[] = {"spring", "orbit"};
+
+static const scalar springConstant = 400;
+static const scalar springTime = 10;
+static const scalar orbitRadius = 100;
+static const scalar orbitGM = 1e4;
+static const scalar gravitationalConstant = 6.67384e-11;
+static const scalar maxStableError = 0.1;
+static const double pi = 3.14159265358979323846;
+
+/*
+ * Period of one oscillation or orbit, so both scenes run for a few of them.
+ */
+static scalar getPeriod(IntegratorScene scene) {
+	if (scene == SCENE_SPRING)
+		return 2*pi/sqrt(springConstant);
+	return 2*pi*orbitRadius/sqrt(orbitGM/orbitRadius);
+}
+
+static void evaluateForces(ParticleSystem* system, void* data) {
+	IntegratorSceneData* scene = (IntegratorSceneData*)data;
+
+	manParticleSystem.storeParticle(system, scene->handle, scene->body);
+	manParticle.clearForceAccumulator(scene->body);
+	manForceRegistry.updateForces(scene->registry, scene->frameTime);
+	manParticleSystem.addForce(system, scene->handle, scene->body->forceAccum);
+}
+
+static void newScene(IntegratorSceneData* scene, IntegratorScene kind, ParticleIntegrator integrator, scalar frameTime) {
+	scene->scene = kind;
+	scene->frameTime = frameTime;
+	scene->system = manParticleSystem.new(1);
+	scene->registry = manForceRegistry.new();
+	scene->handle = manParticleSystem.add(scene->system);
+	manParticleSystem.setIntegrator(scene->system, integrator);
+	manParticleSystem.setForceFunc(scene->system, evaluateForces, scene);
+
+	scene->body = manParticle.new(NULL, NULL, NULL, NULL);
+	scene->body->damping = 1;
+	manParticle.setMass(scene->body, 1);
+
+	scene->anchor = manParticle.new(NULL, NULL, NULL, NULL);
+	scene->spring = NULL;
+	scene->gravity = NULL;
+
+	if (kind == SCENE_SPRING) {
+		scene->anchor->inverseMass = 0;
+		manVec3.create(scene->body->position, 1, 0, 0);
+		manVec3.create(scene->body->velocity, 0, 5, 2);
+		scene->spring = manSpringForceGenerator.new(scene->anchor, springConstant, 0);
+		manForceRegistry.add(scene->registry, scene->body, &scene->spring->forceGenerator);
+	} else {
+		manParticle.setMass(scene->anchor, orbitGM/gravitationalConstant);
+		manVec3.create(scene->body->position, orbitRadius, 0, 0);
+		manVec3.create(scene->body->velocity, 0, sqrt(orbitGM/orbitRadius), 0);
+		scene->gravity = manAnchoredGravityForceGenerator.new(scene->anchor);
+		manForceRegistry.add(scene->registry, scene->body, &scene->gravity->forceGenerator);
+	}
+}
+
+static void deleteScene(IntegratorSceneData* scene) {
+	manParticleSystem.delete(scene->system);
+	free(scene->system);
+	manForceRegistry.delete(scene->registry);
+	free(scene->registry);
+
+	if (scene->spring != NULL)
+		manSpringForceGenerator.delete(scene->spring);
+	if (scene->gravity != NULL) {
+		manAnchoredGravityForceGenerator.delete(scene->gravity);
+		free(scene->gravity);
+	}
+
+	manParticle.delete(scene->body);
+	free(scene->body);
+	manParticle.delete(scene->anchor);
+	free(scene->anchor);
+}
+
+static double getEnergy(IntegratorSceneData* scene) {
+	Vec3* position = scene->body->position;
+	Vec3* velocity = scene->body->velocity;
+	double kinetic = 0.5*manVec3.dot(velocity, velocity);
+	double radiusSquared = manVec3.dot(position, position);
+
+	if (scene->scene == SCENE_SPRING)
+		return kinetic + 0.5*springConstant*radiusSquared;
+	return kinetic - orbitGM/sqrt(radiusSquared);
+}
+
+/*
+ * One tick, the same way the game object registry does it.
+ */
+static void step(IntegratorSceneData* scene) {
+	manParticle.clearForceAccumulator(scene->body);
+	manForceRegistry.updateForces(scene->registry, scene->frameTime);
+	manParticleSystem.loadParticle(scene->system, scene->handle, scene->body);
+	manParticleSystem.integrateAll(scene->system, scene->frameTime);
+	manParticleSystem.storeParticle(scene->system, scene->handle, scene->body);
+}
+
+/*
+ * Runs the scene for the given time and returns the largest relative energy error seen.
+ */
+static double runScene(IntegratorScene kind, ParticleIntegrator integrator, scalar frameTime, scalar time) {
+	IntegratorSceneData scene;
+	newScene(&scene, kind, integrator, frameTime);
+
+	double startEnergy = getEnergy(&scene);
+	double maxError = 0;
+	int steps = (int)ceil(time/frameTime);
+
+	for(int i = 0; i < steps && maxError <= maxStableError; i++) {
+		step(&scene);
+		double error = fabs((getEnergy(&scene) - startEnergy)/startEnergy);
+		if (!(error == error))
+			error = INFINITY;
+		if (error > maxError)
+			maxError = error;
+	}
+
+	deleteScene(&scene);
+	return maxError;
+}
+
+/*
+ * Grows the time step until the energy error goes past maxStableError.
+ */
+static scalar findLargestStableStep(IntegratorScene kind, ParticleIntegrator integrator) {
+	scalar period = getPeriod(kind);
+	scalar stable = 0;
+
+	for(scalar frameTime = period/10000; frameTime < period; frameTime *= 1.1) {
+		if (runScene(kind, integrator, frameTime, period*3) > maxStableError)
+			break;
+		stable = frameTime;
+	}
+
+	return stable;
+}
+
+void runIntegratorBenchmark() {
+	printf("[Integrator Benchmark] %-8s %-14s %16s %16s %12s\n", "scene", "integrator", "drift at 120Hz", "stable step ms", "min tick Hz");
+
+	for(int s = SCENE_SPRING; s <= SCENE_ORBIT; s++) {
+		scalar time = s == SCENE_SPRING ? springTime : getPeriod(s)*10;
+
+		for(int i = PARTICLE_INTEGRATOR_EULER; i <= PARTICLE_INTEGRATOR_RK4; i++) {
+			double drift = runScene(s, i, 1/120.0, time);
+			scalar stable = findLargestStableStep(s, i);
+
+			//runScene stops once the error passes maxStableError, so larger drifts aren't meaningful.
+			char driftText[32];
+			if (drift > maxStableError)
+				snprintf(driftText, sizeof(driftText), "unstable");
+			else
+				snprintf(driftText, sizeof(driftText), "%.3e", drift);
+
+			printf("[Integrator Benchmark] %-8s %-14s %16s %16.3f %12.1f\n", sceneNames[s], integratorNames[i],
+			       driftText, stable*1000, stable > 0 ? 1/stable : INFINITY);
+		}
+	}
+}
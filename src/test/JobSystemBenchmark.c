@@ -0,0 +1,148 @@
+#include "Tests.h"
+
+#include "col/CollisionResolver.h"
+#include "physics/ParticleSystem.h"
+#include "util/JobSystem.h"
+#include "util/Clock.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+/*
+ * Times particle integration, the brute-force collision broadphase and the narrowphase
+ * of a dense cluster at 1, 2, 4... threads up to the hardware thread count, and checks
+ * every thread count gives exactly the same particles, pairs and records as one thread.
+ */
+
+static const int particleCount = 4000000;
+static const int particleSteps = 20;
+static const int colliderCount = 4000;
+static const int clusterCount = 1000;
+static const int collisionTicks = 5;
+
+static scalar randomRange(scalar range) {
+	return ((scalar)rand()/(scalar)RAND_MAX)*range - range/2;
+}
+
+static ParticleSystem* newParticles() {
+	ParticleSystem* system = manParticleSystem.new(particleCount);
+
+	srand(1);
+	for(int i = 0; i < particleCount; i++) {
+		ParticleHandle handle = manParticleSystem.add(system);
+		Vec3 position = manVec3.create(NULL, randomRange(100), randomRange(100), randomRange(100));
+		Vec3 velocity = manVec3.create(NULL, randomRange(10), randomRange(10), randomRange(10));
+		manParticleSystem.setPosition(system, handle, &position);
+		manParticleSystem.setVelocity(system, handle, &velocity);
+		manParticleSystem.setDamping(system, handle, 0.99);
+	}
+
+	return system;
+}
+
+static CollisionResolver* newColliders(int count, scalar range) {
+	CollisionResolver* resolver = manColResolver.new();
+
+	srand(1);
+	for(int i = 0; i < count; i++) {
+		PhysicsCollider* col = manPhysCollider.new(NULL, NULL, NULL, NULL, NULL);
+		manVec3.create(col->position, randomRange(range), randomRange(range), randomRange(range));
+		attachTestCube(col, sqrt(3));
+
+		manColResolver.addCollider(resolver, col);
+	}
+
+	return resolver;
+}
+
+static double timeParticles(ParticleSystem* system, JobSystem* jobs) {
+	manParticleSystem.setJobSystem(system, jobs);
+
+	double start = manClock.getMilliseconds();
+	for(int i = 0; i < particleSteps; i++)
+		manParticleSystem.integrateAll(system, 1/120.0);
+	return (manClock.getMilliseconds() - start)/particleSteps;
+}
+
+static double timeCollision(CollisionResolver* resolver, JobSystem* jobs) {
+	manColResolver.setJobSystem(resolver, jobs);
+
+	double start = manClock.getMilliseconds();
+	for(int i = 0; i < collisionTicks; i++) {
+		manColResolver.reset(resolver);
+		manColResolver.prepare(resolver);
+		manColResolver.check(resolver);
+	}
+	return (manClock.getMilliseconds() - start)/collisionTicks;
+}
+
+static bool sameContents(DynamicArray* array, void* expected, int expectedCount) {
+	return (array->size == expectedCount) && memcmp(array->contents, expected, array->elementSize*expectedCount) == 0;
+}
+
+static void* copyContents(DynamicArray* array) {
+	void* copy = malloc(array->elementSize*(array->size > 0 ? array->size : 1));
+	memcpy(copy, array->contents, array->elementSize*array->size);
+	return copy;
+}
+
+void runJobSystemBenchmark() {
+	int hardwareThreads = manJobSystem.getHardwareThreadCount();
+
+	ParticleSystem* reference = newParticles();
+	CollisionResolver* resolver = newColliders(colliderCount, 4*cbrt(colliderCount));
+	CollisionResolver* cluster = newColliders(clusterCount, 1.5*cbrt(clusterCount));
+
+	double baseParticleTime = timeParticles(reference, NULL);
+	//The first ticks fill the resolvers' caches, so leave them out.
+	timeCollision(resolver, NULL);
+	timeCollision(cluster, NULL);
+	double baseCollisionTime = timeCollision(resolver, NULL);
+	double baseClusterTime = timeCollision(cluster, NULL);
+
+	int referencePairs = resolver->pairs->size;
+	void* pairs = copyContents(resolver->pairs);
+	int referenceRecords = cluster->collisionRecords->size;
+	void* records = copyContents(cluster->collisionRecords);
+
+	printf("[Job System Benchmark] %d hardware threads, %d particles, %d colliders (%d pairs), cluster of %d (%d pairs, %d records)\n", hardwareThreads, particleCount, colliderCount, referencePairs, clusterCount, cluster->pairs->size, referenceRecords);
+	printf("[Job System Benchmark] %8s %14s %8s %14s %8s %14s %8s %s\n", "threads", "integrate ms", "speedup", "broadphase ms", "speedup", "cluster ms", "speedup", "matches");
+
+	for(int threads = 1; ; threads *= 2) {
+		if (threads > hardwareThreads)
+			threads = hardwareThreads;
+
+		JobSystem* jobs = manJobSystem.new(threads);
+
+		ParticleSystem* particles = newParticles();
+		double particleTime = timeParticles(particles, jobs);
+		double collisionTime = timeCollision(resolver, jobs);
+		double clusterTime = timeCollision(cluster, jobs);
+
+		bool matches = sameContents(resolver->pairs, pairs, referencePairs) &&
+		               sameContents(cluster->collisionRecords, records, referenceRecords) &&
+		               memcmp(particles->positionX, reference->positionX, sizeof(scalar)*particleCount) == 0 &&
+		               memcmp(particles->velocityY, reference->velocityY, sizeof(scalar)*particleCount) == 0;
+
+		printf("[Job System Benchmark] %8d %14.3f %7.2fx %14.3f %7.2fx %14.3f %7.2fx %s\n", threads, particleTime, baseParticleTime/particleTime, collisionTime, baseCollisionTime/collisionTime, clusterTime, baseClusterTime/clusterTime, matches ? "yes" : "NO");
+
+		manParticleSystem.delete(particles);
+		free(particles);
+		manJobSystem.delete(jobs);
+		free(jobs);
+
+		if (threads == hardwareThreads)
+			break;
+	}
+
+	free(pairs);
+	free(records);
+	manColResolver.delete(cluster);
+	free(cluster);
+	manParticleSystem.delete(reference);
+	free(reference);
+	manColResolver.delete(resolver);
+	free(resolver);
+}
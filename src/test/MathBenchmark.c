@@ -0,0 +1,121 @@
+#include "Tests.h"
+
+#include "math/Mat4.h"
+#include "math/Quat.h"
+#include "glfw/Display.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+/*
+ * Times the scalar math implementations against the selected backend for the
+ * operations that dominate transforming colliders and building render matrices.
+ */
+
+static const int matrixCount = 1024;
+static const int pointCount = 1000000;
+static const int repeats = 200;
+
+static scalar randomScalar() {
+	return ((scalar)rand()/(scalar)RAND_MAX)*2 - 1;
+}
+
+/*
+ * Accumulates results so the compiler can't drop the work being timed.
+ */
+static volatile scalar sink;
+
+static void printResult(const char* name, double scalarTime, double backendTime) {
+	printf("[Math Benchmark] %-20s scalar %9.3f ms, backend %9.3f ms, %5.2fx\n", name, scalarTime, backendTime, scalarTime/backendTime);
+}
+
+static double timeMul(const Mat4Manager* man, Mat4* matrices) {
+	double start = manWin.getMilliseconds();
+	for(int r = 0; r < repeats; r++) {
+		Mat4 acc = matrices[0];
+		for(int i = 1; i < matrixCount; i++)
+			acc = man->mul(&matrices[i], &acc);
+		sink += acc.data[0].x;
+	}
+	return manWin.getMilliseconds() - start;
+}
+
+static double timeInverse(const Mat4Manager* man, Mat4* matrices) {
+	double start = manWin.getMilliseconds();
+	for(int r = 0; r < repeats; r++) {
+		for(int i = 0; i < matrixCount; i++) {
+			Mat4 inv = man->inverse(&matrices[i]);
+			sink += inv.data[3].w;
+		}
+	}
+	return manWin.getMilliseconds() - start;
+}
+
+static double timeTransform(const Mat4Manager* man, Mat4* matrix, Vec4* points, Vec4* out) {
+	double start = manWin.getMilliseconds();
+	for(int i = 0; i < pointCount; i++)
+		out[i] = man->postMulVec4(matrix, &points[i]);
+	sink += out[pointCount-1].x;
+	return manWin.getMilliseconds() - start;
+}
+
+static double timeTransformBatch(const Mat4Manager* man, Mat4* matrix, Vec3* points, Vec3* out) {
+	double start = manWin.getMilliseconds();
+	man->transformPoints(matrix, points, out, pointCount);
+	sink += out[pointCount-1].x;
+	return manWin.getMilliseconds() - start;
+}
+
+static double timeCastMat4(const QuatManager* man, Quat* quats) {
+	double start = manWin.getMilliseconds();
+	for(int r = 0; r < repeats; r++) {
+		for(int i = 0; i < matrixCount; i++) {
+			Mat4 mat = man->castMat4(&quats[i]);
+			sink += mat.data[1].y;
+		}
+	}
+	return manWin.getMilliseconds() - start;
+}
+
+void runMathBenchmark() {
+	Mat4* matrices = malloc(sizeof(Mat4)*matrixCount);
+	Quat* quats = malloc(sizeof(Quat)*matrixCount);
+	Vec4* points = malloc(sizeof(Vec4)*pointCount);
+	Vec4* out = malloc(sizeof(Vec4)*pointCount);
+	Vec3* points3 = malloc(sizeof(Vec3)*pointCount);
+	Vec3* out3 = malloc(sizeof(Vec3)*pointCount);
+
+	srand(1);
+	for(int i = 0; i < matrixCount; i++) {
+		Vec3 pos = manVec3.create(NULL, randomScalar(), randomScalar(), randomScalar());
+		Vec3 axis = manVec3.create(NULL, randomScalar(), randomScalar(), randomScalar());
+		axis = manVec3.normalize(&axis);
+
+		matrices[i] = manMat4.createLeading(NULL, 1);
+		matrices[i] = manMat4.affTranslate(&matrices[i], &pos);
+		matrices[i] = manMat4.affRotate(&matrices[i], randomScalar(), &axis);
+
+		quats[i] = manQuat.create(NULL, randomScalar(), randomScalar(), randomScalar(), randomScalar());
+		quats[i] = manQuat.normalize(&quats[i]);
+	}
+
+	for(int i = 0; i < pointCount; i++) {
+		points[i] = manVec4.create(NULL, randomScalar()*100, randomScalar()*100, randomScalar()*100, 1);
+		points3[i] = manVec3.create(NULL, points[i].x, points[i].y, points[i].z);
+		out3[i] = points3[i];
+	}
+
+	printf("[Math Benchmark] %d matrices x %d repeats, %d points\n", matrixCount, repeats, pointCount);
+	printResult("mul", timeMul(&manMat4Scalar, matrices), timeMul(&manMat4, matrices));
+	printResult("inverse", timeInverse(&manMat4Scalar, matrices), timeInverse(&manMat4, matrices));
+	printResult("transform points", timeTransform(&manMat4Scalar, &matrices[0], points, out), timeTransform(&manMat4, &matrices[0], points, out));
+	printResult("transformPoints", timeTransformBatch(&manMat4Scalar, &matrices[0], points3, out3), timeTransformBatch(&manMat4, &matrices[0], points3, out3));
+	printResult("quat castMat4", timeCastMat4(&manQuatScalar, quats), timeCastMat4(&manQuat, quats));
+
+	free(matrices);
+	free(quats);
+	free(points);
+	free(out);
+	free(points3);
+	free(out3);
+}
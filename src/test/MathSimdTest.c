@@ -0,0 +1,166 @@
+#include "Tests.h"
+
+#include "math/Vec3.h"
+#include "math/Vec4.h"
+#include "math/Mat4.h"
+#include "math/Quat.h"
+#include "math/Simd.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * Checks the math managers give bit-for-bit the same results as the scalar
+ * reference implementations, over random inputs plus zeros of both signs.
+ */
+
+static const int iterations = 100000;
+
+static int failures = 0;
+
+static scalar randomScalar() {
+	switch(rand()%16) {
+		case 0: return 0.0f;
+		case 1: return -0.0f;
+		case 2: return 1.0f;
+		default: return ((scalar)rand()/(scalar)RAND_MAX)*200 - 100;
+	}
+}
+
+static Vec3 randomVec3() {
+	return manVec3Scalar.create(NULL, randomScalar(), randomScalar(), randomScalar());
+}
+
+static Vec4 randomVec4() {
+	return manVec4Scalar.create(NULL, randomScalar(), randomScalar(), randomScalar(), randomScalar());
+}
+
+static Mat4 randomMat4() {
+	Vec4 v0 = randomVec4(), v1 = randomVec4(), v2 = randomVec4(), v3 = randomVec4();
+	return manMat4Scalar.createFromVec4(NULL, &v0, &v1, &v2, &v3);
+}
+
+static Quat randomQuat() {
+	return manQuatScalar.create(NULL, randomScalar(), randomScalar(), randomScalar(), randomScalar());
+}
+
+static void expect(const char* name, const void* expected, const void* actual, size_t size) {
+	if (memcmp(expected, actual, size) != 0) {
+		if (failures < 10)
+			printf("[Math SIMD Test] %s differs from the scalar version\n", name);
+		failures++;
+	}
+}
+
+#define EXPECT_SAME(type, name, expected, actual) do { \
+	type expectedValue = (expected); \
+	type actualValue = (actual); \
+	expect((name), &expectedValue, &actualValue, sizeof(type)); \
+} while(0)
+
+static void testVec3() {
+	Vec3 a = randomVec3(), b = randomVec3();
+	scalar f = randomScalar();
+
+	EXPECT_SAME(Vec3, "Vec3 sum", manVec3Scalar.sum(&a, &b), manVec3.sum(&a, &b));
+	EXPECT_SAME(Vec3, "Vec3 sub", manVec3Scalar.sub(&a, &b), manVec3.sub(&a, &b));
+	EXPECT_SAME(Vec3, "Vec3 postMulScalar", manVec3Scalar.postMulScalar(&a, f), manVec3.postMulScalar(&a, f));
+	EXPECT_SAME(Vec3, "Vec3 preMulScalar", manVec3Scalar.preMulScalar(f, &a), manVec3.preMulScalar(f, &a));
+	EXPECT_SAME(Vec3, "Vec3 invert", manVec3Scalar.invert(&a), manVec3.invert(&a));
+	EXPECT_SAME(scalar, "Vec3 dot", manVec3Scalar.dot(&a, &b), manVec3.dot(&a, &b));
+	EXPECT_SAME(Vec3, "Vec3 cross", manVec3Scalar.cross(&a, &b), manVec3.cross(&a, &b));
+}
+
+static void testVec4() {
+	Vec4 a = randomVec4(), b = randomVec4();
+	scalar f = randomScalar();
+
+	EXPECT_SAME(Vec4, "Vec4 sum", manVec4Scalar.sum(&a, &b), manVec4.sum(&a, &b));
+	EXPECT_SAME(Vec4, "Vec4 sub", manVec4Scalar.sub(&a, &b), manVec4.sub(&a, &b));
+	EXPECT_SAME(Vec4, "Vec4 postMulScalar", manVec4Scalar.postMulScalar(&a, f), manVec4.postMulScalar(&a, f));
+	EXPECT_SAME(Vec4, "Vec4 preMulScalar", manVec4Scalar.preMulScalar(f, &a), manVec4.preMulScalar(f, &a));
+	EXPECT_SAME(Vec4, "Vec4 invert", manVec4Scalar.invert(&a), manVec4.invert(&a));
+	EXPECT_SAME(scalar, "Vec4 dot", manVec4Scalar.dot(&a, &b), manVec4.dot(&a, &b));
+}
+
+static void testMat4() {
+	Mat4 a = randomMat4(), b = randomMat4();
+	Vec4 v = randomVec4();
+	Vec3 v3 = randomVec3();
+	Vec3 axis = manVec3Scalar.normalize(&v3);
+	scalar f = randomScalar();
+
+	EXPECT_SAME(Mat4, "Mat4 sum", manMat4Scalar.sum(&a, &b), manMat4.sum(&a, &b));
+	EXPECT_SAME(Mat4, "Mat4 sub", manMat4Scalar.sub(&a, &b), manMat4.sub(&a, &b));
+	EXPECT_SAME(Mat4, "Mat4 postMulScalar", manMat4Scalar.postMulScalar(&a, f), manMat4.postMulScalar(&a, f));
+	EXPECT_SAME(Mat4, "Mat4 preMulScalar", manMat4Scalar.preMulScalar(f, &a), manMat4.preMulScalar(f, &a));
+	EXPECT_SAME(Mat4, "Mat4 mul", manMat4Scalar.mul(&a, &b), manMat4.mul(&a, &b));
+	EXPECT_SAME(Vec4, "Mat4 postMulVec4", manMat4Scalar.postMulVec4(&a, &v), manMat4.postMulVec4(&a, &v));
+	EXPECT_SAME(Vec4, "Mat4 preMulVec4", manMat4Scalar.preMulVec4(&v, &a), manMat4.preMulVec4(&v, &a));
+	EXPECT_SAME(Mat4, "Mat4 inverse", manMat4Scalar.inverse(&a), manMat4.inverse(&a));
+	EXPECT_SAME(Mat4, "Mat4 affScale", manMat4Scalar.affScale(&a, &v3), manMat4.affScale(&a, &v3));
+	EXPECT_SAME(Mat4, "Mat4 affTranslate", manMat4Scalar.affTranslate(&a, &v3), manMat4.affTranslate(&a, &v3));
+	EXPECT_SAME(Mat4, "Mat4 affRotate", manMat4Scalar.affRotate(&a, f, &axis), manMat4.affRotate(&a, f, &axis));
+}
+
+/*
+ * The batch transforms must match postMulVec4 with w = 1 for points and w = 0 for directions.
+ */
+static void testTransforms() {
+	Mat4 m = randomMat4();
+	Vec3 in[4] = {randomVec3(), randomVec3(), randomVec3(), randomVec3()};
+	Vec3 points[4], directions[4];
+	//Interleaved like a vertex buffer, a position followed by a normal.
+	Vec3 strided[8];
+
+	manMat4.transformPoints(&m, in, points, 4);
+	manMat4.transformDirections(&m, in, directions, 4);
+
+	for(int i = 0; i < 4; i++) {
+		Vec4 point = manVec4Scalar.createFromVec3(NULL, &in[i], 1);
+		Vec4 direction = manVec4Scalar.createFromVec3(NULL, &in[i], 0);
+		point = manMat4Scalar.postMulVec4(&m, &point);
+		direction = manMat4Scalar.postMulVec4(&m, &direction);
+
+		EXPECT_SAME(Vec3, "Mat4 transformPoints", manVec3Scalar.create(NULL, point.x, point.y, point.z), points[i]);
+		EXPECT_SAME(Vec3, "Mat4 transformDirections", manVec3Scalar.create(NULL, direction.x, direction.y, direction.z), directions[i]);
+	}
+
+	manMat4.transformPointsStrided(&m, in, sizeof(Vec3), &strided[0], sizeof(Vec3)*2, 4);
+	manMat4.transformDirectionsStrided(&m, in, sizeof(Vec3), &strided[1], sizeof(Vec3)*2, 4);
+
+	for(int i = 0; i < 4; i++) {
+		EXPECT_SAME(Vec3, "Mat4 transformPointsStrided", points[i], strided[i*2]);
+		EXPECT_SAME(Vec3, "Mat4 transformDirectionsStrided", directions[i], strided[i*2+1]);
+	}
+}
+
+static void testQuat() {
+	Quat a = randomQuat(), b = randomQuat();
+
+	EXPECT_SAME(Quat, "Quat mul", manQuatScalar.mul(&a, &b), manQuat.mul(&a, &b));
+	EXPECT_SAME(scalar, "Quat dot", manQuatScalar.dot(&a, &b), manQuat.dot(&a, &b));
+	EXPECT_SAME(Mat4, "Quat castMat4", manQuatScalar.castMat4(&a), manQuat.castMat4(&a));
+}
+
+void runMathSimdTest() {
+#ifdef COH_SIMD_SSE
+	const char* backend = "SSE";
+#else
+	const char* backend = "scalar";
+#endif
+
+	srand(1);
+	failures = 0;
+
+	for(int i = 0; i < iterations; i++) {
+		testVec3();
+		testVec4();
+		testMat4();
+		testTransforms();
+		testQuat();
+	}
+
+	printf("[Math SIMD Test] %s backend, %d iterations, %d mismatches, %s\n", backend, iterations, failures, failures == 0 ? "passed" : "FAILED");
+}
@@ -0,0 +1,120 @@
+#include "Tests.h"
+
+#include "util/ObjLoader.h"
+#include "util/Clock.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * Cooks the game's slowest loading models to .meshbin files and checks loading them gives the same
+ * vertices as loading the obj does, then times both. Nothing is put on the GPU: the upload is a stub
+ * that copies the vertices into a buffer of its own, as the driver would. Also checks a cut short
+ * file is refused, and that loadMesh picks up a mesh cooked to its default name, replacing any
+ * town.meshbin.
+ */
+
+static const int objRepeats = 3;
+static const int binaryRepeats = 30;
+static const char* modelFiles[] = {"./data/models/town.obj", "./data/models/Spaceship.obj"};
+static const char* modelNames[] = {"town", "Spaceship"};
+static const int modelCount = 2;
+static const char* cookedFile = "./meshCookTest.meshbin";
+static const char* truncatedFile = "./meshCookTest.short.meshbin";
+
+/*
+ * Stands in for the GPU, keeping a copy of the last vertices uploaded.
+ */
+typedef struct StubUpload_s {
+	GLVertex* vertices;
+	int vertexCount;
+	int uploads;
+} StubUpload;
+
+static void stubUpload(void* data, const GLVertex* vertices, int vertexCount) {
+	StubUpload* upload = (StubUpload*)data;
+	upload->vertices = realloc(upload->vertices, sizeof(GLVertex)*vertexCount);
+	memcpy(upload->vertices, vertices, sizeof(GLVertex)*vertexCount);
+	upload->vertexCount = vertexCount;
+	upload->uploads++;
+}
+
+static bool sameUpload(StubUpload* a, StubUpload* b) {
+	return a->vertexCount == b->vertexCount && memcmp(a->vertices, b->vertices, sizeof(GLVertex)*a->vertexCount) == 0;
+}
+
+/*
+ * Writes all but the last byte of a file to another.
+ */
+static bool writeTruncated(const char* from, const char* to) {
+	FILE* in = fopen(from, "rb");
+	if (in == NULL)
+		return false;
+
+	fseek(in, 0, SEEK_END);
+	long size = ftell(in);
+	fseek(in, 0, SEEK_SET);
+	char* buffer = malloc(size > 0 ? size : 1);
+	bool read = size > 0 && fread(buffer, 1, size, in) == (size_t)size;
+	fclose(in);
+
+	FILE* out = read ? fopen(to, "wb") : NULL;
+	bool written = out != NULL && fwrite(buffer, 1, size - 1, out) == (size_t)(size - 1);
+	written = out != NULL && (fclose(out) == 0) && written;
+	free(buffer);
+	return written;
+}
+
+void runMeshCookTest() {
+	bool passed = true;
+	double objTotal = 0;
+	double binaryTotal = 0;
+	StubUpload fromObj = {NULL, 0, 0};
+	StubUpload fromBinary = {NULL, 0, 0};
+
+	printf("[Mesh Cook Test] %-10s %9s %10s %12s %12s %9s\n", "model", "vertices", "matched", "obj ms", "meshbin ms", "speedup");
+	for(int m = 0; m < modelCount; m++) {
+		bool cooked = objLoader.cookMesh(modelFiles[m], cookedFile);
+
+		double start = manClock.getMilliseconds();
+		for(int r = 0; r < objRepeats; r++)
+			objLoader.loadMesh(modelFiles[m], stubUpload, &fromObj);
+		double objTime = (manClock.getMilliseconds() - start)/objRepeats;
+
+		start = manClock.getMilliseconds();
+		bool loaded = cooked;
+		for(int r = 0; r < binaryRepeats && loaded; r++)
+			loaded = objLoader.loadMeshBinary(cookedFile, stubUpload, &fromBinary);
+		double binaryTime = (manClock.getMilliseconds() - start)/binaryRepeats;
+
+		bool matched = loaded && sameUpload(&fromObj, &fromBinary);
+		passed = passed && matched;
+		objTotal += objTime;
+		binaryTotal += binaryTime;
+		printf("[Mesh Cook Test] %-10s %9d %10s %12.3f %12.3f %8.0fx\n", modelNames[m], fromObj.vertexCount, matched ? "yes" : "NO",
+		       objTime, binaryTime, objTime/binaryTime);
+	}
+
+	int uploads = fromBinary.uploads;
+	bool refused = writeTruncated(cookedFile, truncatedFile) && !objLoader.loadMeshBinary(truncatedFile, stubUpload, &fromBinary) && fromBinary.uploads == uploads;
+	remove(truncatedFile);
+	remove(cookedFile);
+
+	//The cube cooked to the town's default name is what loading the town gives.
+	char defaultName[COOKED_MAX_PATH];
+	snprintf(defaultName, sizeof(defaultName), "./data/models/%s.meshbin", modelNames[0]);
+	bool pickedUp = objLoader.cookMesh("./data/models/cube.obj", defaultName) &&
+	                objLoader.loadMesh(modelFiles[0], stubUpload, &fromBinary) &&
+	                objLoader.loadMesh("./data/models/cube.obj", stubUpload, &fromObj) &&
+	                sameUpload(&fromObj, &fromBinary);
+	remove(defaultName);
+
+	passed = passed && refused && pickedUp;
+	printf("[Mesh Cook Test] both models: obj %.3f ms, meshbin %.3f ms (%.0fx); truncated file %s, default name %s\n",
+	       objTotal, binaryTotal, objTotal/binaryTotal, refused ? "refused" : "LOADED", pickedUp ? "used" : "NOT USED");
+	printf("[Mesh Cook Test] %s\n", passed ? "passed" : "FAILED");
+
+	free(fromObj.vertices);
+	free(fromBinary.vertices);
+}
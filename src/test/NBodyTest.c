@@ -0,0 +1,146 @@
+#include "Tests.h"
+
+#include "physics/NBodyGravityForceGenerator.h"
+#include "physics/ParticleForceRegistry.h"
+#include "util/JobSystem.h"
+#include "util/Clock.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+/*
+ * Finds the gravity between a cloud of bodies with the Barnes-Hut generator and
+ * compares it to the exact pairwise sum: theta 0 should match it, theta 0.5 should
+ * be close and much faster. Also checks the job system gives the same forces as
+ * one thread.
+ */
+
+static const int bodyCount = 4000;
+static const int updateCount = 10;
+static const double gravitationalConstant = 6.67384e-11;
+
+static scalar randomRange(scalar range) {
+	return ((scalar)rand()/(scalar)RAND_MAX)*range - range/2;
+}
+
+/*
+ * The exact forces, in double precision.
+ */
+static double bruteForce(Particle** bodies, Vec3* forces, scalar softening) {
+	double start = manClock.getMilliseconds();
+
+	for(int i = 0; i < bodyCount; i++) {
+		double fx = 0, fy = 0, fz = 0;
+		for(int j = 0; j < bodyCount; j++) {
+			if (i == j)
+				continue;
+
+			double dx = bodies[j]->position->x - bodies[i]->position->x;
+			double dy = bodies[j]->position->y - bodies[i]->position->y;
+			double dz = bodies[j]->position->z - bodies[i]->position->z;
+			double distanceSquared = dx*dx + dy*dy + dz*dz + softening*softening;
+			double strength = manParticle.getMass(bodies[j])/(distanceSquared*sqrt(distanceSquared));
+			fx += dx*strength;
+			fy += dy*strength;
+			fz += dz*strength;
+		}
+
+		double scale = gravitationalConstant*manParticle.getMass(bodies[i]);
+		manVec3.create(&forces[i], fx*scale, fy*scale, fz*scale);
+	}
+
+	return manClock.getMilliseconds() - start;
+}
+
+static double timeTree(ParticleForceRegistry* registry, Particle** bodies, Vec3* forces) {
+	double start = manClock.getMilliseconds();
+
+	for(int u = 0; u < updateCount; u++) {
+		for(int i = 0; i < bodyCount; i++)
+			manParticle.clearForceAccumulator(bodies[i]);
+		manForceRegistry.updateForces(registry, 1/120.0);
+	}
+
+	double time = (manClock.getMilliseconds() - start)/updateCount;
+
+	for(int i = 0; i < bodyCount; i++)
+		forces[i] = *bodies[i]->forceAccum;
+
+	return time;
+}
+
+/*
+ * Error relative to the typical force, as bodies where the pulls nearly cancel
+ * have tiny forces that any approximation gets proportionally wrong.
+ */
+static double rmsRelativeError(Vec3* forces, Vec3* exact) {
+	double errorSum = 0, forceSum = 0;
+
+	for(int i = 0; i < bodyCount; i++) {
+		Vec3 diff = manVec3.sub(&forces[i], &exact[i]);
+		errorSum += manVec3.dot(&diff, &diff);
+		forceSum += manVec3.dot(&exact[i], &exact[i]);
+	}
+
+	return sqrt(errorSum/forceSum);
+}
+
+void runNBodyTest() {
+	Particle** bodies = malloc(sizeof(Particle*)*bodyCount);
+	Vec3* exact = malloc(sizeof(Vec3)*bodyCount);
+	Vec3* forces = malloc(sizeof(Vec3)*bodyCount);
+	Vec3* threadedForces = malloc(sizeof(Vec3)*bodyCount);
+
+	NBodyGravityForceGenerator* nBody = manNBodyGravityForceGenerator.new(0);
+	ParticleForceRegistry* registry = manForceRegistry.new();
+
+	srand(1);
+	for(int i = 0; i < bodyCount; i++) {
+		bodies[i] = manParticle.new(NULL, NULL, NULL, NULL);
+		manVec3.create(bodies[i]->position, randomRange(1000), randomRange(1000), randomRange(1000));
+		manParticle.setMass(bodies[i], 1e10*(1 + randomRange(1)));
+		manForceRegistry.add(registry, bodies[i], &nBody->forceGenerator);
+	}
+
+	double bruteTime = bruteForce(bodies, exact, nBody->softening);
+
+	double exactTime = timeTree(registry, bodies, forces);
+	double exactError = rmsRelativeError(forces, exact);
+
+	manNBodyGravityForceGenerator.setTheta(nBody, NBODY_DEFAULT_THETA);
+	double treeTime = timeTree(registry, bodies, forces);
+	double treeError = rmsRelativeError(forces, exact);
+
+	JobSystem* jobs = manJobSystem.new(0);
+	manNBodyGravityForceGenerator.setJobSystem(nBody, jobs);
+	double threadedTime = timeTree(registry, bodies, threadedForces);
+	bool matches = memcmp(forces, threadedForces, sizeof(Vec3)*bodyCount) == 0;
+
+	bool passed = (exactError < 1e-4) && (treeError < 0.01) && matches;
+
+	printf("[N-Body Test] %d bodies, %d nodes\n", bodyCount, nBody->nodeCount);
+	printf("[N-Body Test] exact sum     %10.3f ms\n", bruteTime);
+	printf("[N-Body Test] theta 0       %10.3f ms, rms error %.2e\n", exactTime, exactError);
+	printf("[N-Body Test] theta %.2f    %10.3f ms, rms error %.2e, %.2fx faster than exact\n", NBODY_DEFAULT_THETA, treeTime, treeError, bruteTime/treeTime);
+	printf("[N-Body Test] %d threads    %10.3f ms, matches one thread %s\n", manJobSystem.getThreadCount(jobs), threadedTime, matches ? "yes" : "NO");
+	printf("[N-Body Test] %s\n", passed ? "passed" : "FAILED");
+
+	manJobSystem.delete(jobs);
+	free(jobs);
+
+	manForceRegistry.delete(registry);
+	free(registry);
+	manNBodyGravityForceGenerator.delete(nBody);
+	free(nBody);
+
+	for(int i = 0; i < bodyCount; i++) {
+		manParticle.delete(bodies[i]);
+		free(bodies[i]);
+	}
+	free(bodies);
+	free(exact);
+	free(forces);
+	free(threadedForces);
+}
@@ -0,0 +1,134 @@
+#include "Tests.h"
+
+#include "col/CollisionDetection.h"
+#include "col/GJK.h"
+#include "util/ObjLoader.h"
+#include "util/Clock.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+/*
+ * Places pairs of the game's collision hulls at random, overlapping bounding spheres and
+ * random orientations, and times the SAT narrowphase against GJK/EPA on the same placements.
+ * Checks GJK never finds a collision where SAT found a separating face, and that EPA's depth
+ * is never more than SAT's, as SAT only tries face normals. SAT only is how often an edge-edge
+ * axis separates meshes SAT reports as colliding.
+ */
+
+static const int placementCount = 1000;
+static const char* hullFiles[] = {"./data/models/meteor.col.obj", "./data/models/grav.col.obj", "./data/models/Spaceship.col.obj"};
+static const char* hullNames[] = {"meteor", "grav", "Spaceship"};
+static const int hullCount = 3;
+static const scalar depthTolerance = 1e-3;
+
+static scalar randomRange(scalar range) {
+	return ((scalar)rand()/(scalar)RAND_MAX)*range - range/2;
+}
+
+static ColliderSimpleMesh newMeshBuffer(ColliderSimpleMesh* src) {
+	ColliderSimpleMesh mesh;
+	mesh.satMesh.verts = malloc(sizeof(Vec3)*src->satMesh.vCount);
+	mesh.satMesh.norms = malloc(sizeof(Vec3)*src->satMesh.nCount);
+	return mesh;
+}
+
+static void placeMesh(ColliderSimpleMesh* dest, PhysicsCollider* hull, scalar range) {
+	Vec3 position = manVec3.create(NULL, randomRange(range), randomRange(range), randomRange(range));
+	Vec3 rotation = manVec3.create(NULL, randomRange(360), randomRange(360), randomRange(360));
+	Vec3 scale = manVec3.create(NULL, 1, 1, 1);
+
+	Mat4 transform = manColMesh.makeTransformationMatrix(&position, &rotation, &scale);
+	manColMesh.transformSimpleMeshInto(dest, &hull->nPhase, &transform);
+}
+
+static void runPair(PhysicsCollider* hull1, PhysicsCollider* hull2, const char* name1, const char* name2, bool* passed) {
+	ColliderSimpleMesh* meshes1 = malloc(sizeof(ColliderSimpleMesh)*placementCount);
+	ColliderSimpleMesh* meshes2 = malloc(sizeof(ColliderSimpleMesh)*placementCount);
+	CollisionResult* satResults = malloc(sizeof(CollisionResult)*placementCount);
+	CollisionResult* gjkResults = malloc(sizeof(CollisionResult)*placementCount);
+
+	//Spread the centres over where the bounding spheres can overlap, so there are separated placements to test too.
+	scalar range = 2*(hull1->bPhase.radius + hull2->bPhase.radius);
+	for(int i = 0; i < placementCount; i++) {
+		meshes1[i] = newMeshBuffer(&hull1->nPhase);
+		meshes2[i] = newMeshBuffer(&hull2->nPhase);
+		placeMesh(&meshes1[i], hull1, 0);
+		placeMesh(&meshes2[i], hull2, range);
+	}
+
+	double start = manClock.getMilliseconds();
+	for(int i = 0; i < placementCount; i++)
+		satResults[i] = manColDetection.checkStaticNarrowphase(&meshes1[i], &meshes2[i]);
+	double satTime = manClock.getMilliseconds() - start;
+
+	start = manClock.getMilliseconds();
+	for(int i = 0; i < placementCount; i++)
+		gjkResults[i] = manColDetection.checkGJKNarrowphase(&meshes1[i], &meshes2[i]);
+	double gjkTime = manClock.getMilliseconds() - start;
+
+	int colliding = 0, satOnly = 0, gjkOnly = 0, deeper = 0;
+	for(int i = 0; i < placementCount; i++) {
+		colliding += gjkResults[i].isColliding;
+
+		if (satResults[i].isColliding && !gjkResults[i].isColliding)
+			satOnly++;
+		if (gjkResults[i].isColliding && !satResults[i].isColliding)
+			gjkOnly++;
+		if (satResults[i].isColliding && gjkResults[i].isColliding && gjkResults[i].distance > fabs(satResults[i].distance) + depthTolerance)
+			deeper++;
+	}
+
+	//Count the support calls on their own, so the timing above isn't affected.
+	long supportCalls = 0;
+	for(int i = 0; i < placementCount; i++) {
+		GJKSimplex simplex;
+		simplex.vertex1 = 0;
+		simplex.vertex2 = 0;
+		Vec3 normal;
+		scalar depth;
+		if (gjk.intersect(&meshes1[i].satMesh, &meshes2[i].satMesh, &simplex))
+			gjk.penetration(&meshes1[i].satMesh, &meshes2[i].satMesh, &simplex, &normal, &depth);
+		supportCalls += simplex.supportCalls;
+	}
+
+	*passed = *passed && (gjkOnly == 0) && (deeper == 0);
+
+	char pairName[32];
+	snprintf(pairName, sizeof(pairName), "%s/%s", name1, name2);
+	printf("[Narrowphase Benchmark] %-20s %4d/%-4d %10.2f %10.2f %8.2fx %10.1f %9d %8d %8d %8d\n", pairName,
+	       hull1->nPhase.satMesh.nCount, hull2->nPhase.satMesh.nCount,
+	       satTime*1000/placementCount, gjkTime*1000/placementCount, satTime/gjkTime,
+	       (double)supportCalls/placementCount, colliding, satOnly, gjkOnly, deeper);
+
+	for(int i = 0; i < placementCount; i++) {
+		free(meshes1[i].satMesh.verts);
+		free(meshes1[i].satMesh.norms);
+		free(meshes2[i].satMesh.verts);
+		free(meshes2[i].satMesh.norms);
+	}
+	free(meshes1);
+	free(meshes2);
+	free(satResults);
+	free(gjkResults);
+}
+
+void runNarrowphaseBenchmark() {
+	PhysicsCollider* hulls[3];
+	for(int h = 0; h < hullCount; h++)
+		hulls[h] = objLoader.loadCollisionMesh(hullFiles[h], NULL, NULL, NULL, NULL);
+
+	srand(1);
+	bool passed = true;
+
+	printf("[Narrowphase Benchmark] %d placements per pair\n", placementCount);
+	printf("[Narrowphase Benchmark] %-20s %9s %10s %10s %9s %10s %9s %8s %8s %8s\n", "pair", "normals", "SAT us", "GJK us", "speedup", "supports", "colliding", "SAT only", "GJK only", "deeper");
+
+	for(int h1 = 0; h1 < hullCount; h1++) {
+		for(int h2 = h1; h2 < hullCount; h2++)
+			runPair(hulls[h1], hulls[h2], hullNames[h1], hullNames[h2], &passed);
+	}
+
+	printf("[Narrowphase Benchmark] %s\n", passed ? "passed" : "FAILED");
+}
@@ -0,0 +1,157 @@
+#include "Tests.h"
+
+#include "physics/Particle.h"
+#include "physics/ParticleSystem.h"
+#include "util/Clock.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+/*
+ * Compares integrating particles one at a time through manParticle.integrate
+ * with integrating the same particles in a ParticleSystem, and checks both give
+ * the same positions. Then times what the GameObjectRegistry does each tick for
+ * game sized numbers of objects, copying each object's particle in with loadParticle
+ * and back out with storeParticle around integrateAll, against integrating each
+ * object's particle where it is.
+ */
+
+static const int particleCount = 1000000;
+static const int tickCount = 10;
+static const scalar tickTime = 1.0f/60.0f;
+static const int copyCounts[] = {500, 2000, 10000, 100000};
+static const int copyCountCount = 4;
+/** Particle ticks timed for each object count. **/
+static const int copyWork = 2000000;
+
+/*
+ * A particle's state allocated in one block, as a GameObject holds it.
+ */
+typedef struct ObjectState_s {
+	Vec3 position;
+	Vec3 velocity;
+	Vec3 acceleration;
+	Vec3 force;
+	Particle* particle;
+	ParticleHandle handle;
+} ObjectState;
+
+static scalar randomRange(scalar range) {
+	return ((scalar)rand()/(scalar)RAND_MAX)*range - range/2;
+}
+
+/*
+ * Times count objects integrated where they are and copied through a ParticleSystem, in ms per tick.
+ */
+static void timeCopy(int count, double* inPlaceTime, double* copiedTime) {
+	ObjectState** objects = malloc(sizeof(ObjectState*)*count);
+	ParticleSystem* system = manParticleSystem.new(count);
+	for(int i = 0; i < count; i++) {
+		ObjectState* object = malloc(sizeof(ObjectState));
+		object->position = manVec3.create(NULL, randomRange(100), randomRange(100), randomRange(100));
+		object->velocity = manVec3.create(NULL, randomRange(10), randomRange(10), randomRange(10));
+		object->acceleration = manVec3.create(NULL, 0, -9.8, 0);
+		object->force = manVec3.create(NULL, 0, 0, 0);
+		object->particle = manParticle.new(&object->position, &object->velocity, &object->acceleration, &object->force);
+		object->handle = manParticleSystem.add(system);
+		objects[i] = object;
+	}
+
+	int ticks = copyWork/count;
+	double start = manClock.getMilliseconds();
+	for(int t = 0; t < ticks; t++)
+		for(int i = 0; i < count; i++)
+			manParticle.integrate(objects[i]->particle, tickTime);
+	*inPlaceTime = (manClock.getMilliseconds() - start)/ticks;
+
+	start = manClock.getMilliseconds();
+	for(int t = 0; t < ticks; t++) {
+		for(int i = 0; i < count; i++)
+			manParticleSystem.loadParticle(system, objects[i]->handle, objects[i]->particle);
+		manParticleSystem.integrateAll(system, tickTime);
+		for(int i = 0; i < count; i++)
+			manParticleSystem.storeParticle(system, objects[i]->handle, objects[i]->particle);
+	}
+	*copiedTime = (manClock.getMilliseconds() - start)/ticks;
+
+	for(int i = 0; i < count; i++) {
+		manParticle.delete(objects[i]->particle);
+		free(objects[i]->particle);
+		free(objects[i]);
+	}
+	free(objects);
+	manParticleSystem.delete(system);
+	free(system);
+}
+
+void runParticleBenchmark() {
+	Particle** particles = malloc(sizeof(Particle*)*particleCount);
+	ParticleSystem* system = manParticleSystem.new(particleCount);
+	Vec3 force = manVec3.create(NULL, 0, 0, 1);
+
+	srand(1);
+	for(int i = 0; i < particleCount; i++) {
+		particles[i] = manParticle.new(NULL, NULL, NULL, NULL);
+		manParticle.setPositionXYZ(particles[i], randomRange(100), randomRange(100), randomRange(100));
+		manParticle.setVelocityXYZ(particles[i], randomRange(10), randomRange(10), randomRange(10));
+		manParticle.setAccelerationXYZ(particles[i], 0, -9.8, 0);
+		manParticle.setInverseMass(particles[i], 1.0f/(1 + (i%4)));
+
+		ParticleHandle handle = manParticleSystem.add(system);
+		manParticleSystem.loadParticle(system, handle, particles[i]);
+	}
+
+	double start = manClock.getMilliseconds();
+	for(int t = 0; t < tickCount; t++) {
+		for(int i = 0; i < particleCount; i++) {
+			manParticle.addForce(particles[i], &force);
+			manParticle.integrate(particles[i], tickTime);
+		}
+	}
+	double particleTime = (manClock.getMilliseconds() - start)/tickCount;
+
+	start = manClock.getMilliseconds();
+	for(int t = 0; t < tickCount; t++) {
+		for(int i = 0; i < particleCount; i++)
+			manParticleSystem.addForce(system, i, &force);
+		manParticleSystem.integrateAll(system, tickTime);
+	}
+	double systemTime = (manClock.getMilliseconds() - start)/tickCount;
+
+	//Time the kernel on its own too, as addForce through a handle isn't free.
+	start = manClock.getMilliseconds();
+	for(int t = 0; t < tickCount; t++)
+		manParticleSystem.integrateAll(system, tickTime);
+	double kernelTime = (manClock.getMilliseconds() - start)/tickCount;
+
+	//Run the particles the extra ticks the kernel timing added so the results line up.
+	for(int t = 0; t < tickCount; t++)
+		for(int i = 0; i < particleCount; i++)
+			manParticle.integrate(particles[i], tickTime);
+
+	int mismatches = 0;
+	for(int i = 0; i < particleCount; i++) {
+		Vec3 pos = manParticleSystem.getPosition(system, i);
+		if ((pos.x != particles[i]->position->x) || (pos.y != particles[i]->position->y) || (pos.z != particles[i]->position->z))
+			mismatches++;
+	}
+
+	printf("[Particle Benchmark] %d particles, integrate %.3f ms/tick, system %.3f ms/tick, integrateAll %.3f ms/tick, %d mismatches\n",
+	       particleCount, particleTime, systemTime, kernelTime, mismatches);
+
+	for(int i = 0; i < particleCount; i++) {
+		manParticle.delete(particles[i]);
+		free(particles[i]);
+	}
+	free(particles);
+
+	manParticleSystem.delete(system);
+	free(system);
+
+	for(int c = 0; c < copyCountCount; c++) {
+		double inPlaceTime, copiedTime;
+		timeCopy(copyCounts[c], &inPlaceTime, &copiedTime);
+		printf("[Particle Benchmark] %6d objects, integrate in place %.4f ms/tick, copied through a system %.4f ms/tick (%.2fx)\n",
+		       copyCounts[c], inPlaceTime, copiedTime, inPlaceTime/copiedTime);
+	}
+}
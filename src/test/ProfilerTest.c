@@ -0,0 +1,52 @@
+#include "Tests.h"
+
+#include "util/Profiler.h"
+#include "glfw/Display.h"
+
+#include <stdio.h>
+
+/*
+ * Runs frames with nested zones where one frame in fifty has a 20ms spike,
+ * and checks the spike shows up in the p99 but not the p50. The zones are
+ * recorded directly, so this works without building with profile=1.
+ */
+
+static const int frameCount = 200;
+
+static void spin(double milliseconds) {
+	double start = manWin.getMilliseconds();
+	while(manWin.getMilliseconds() - start < milliseconds);
+}
+
+void runProfilerTest() {
+	manProfiler.reset();
+
+	for(int f = 0; f < frameCount; f++) {
+		manProfiler.beginFrame();
+
+		manProfiler.begin("testUpdate");
+		manProfiler.begin("testPhysics");
+		spin(f%50 == 49 ? 20 : 0.5);
+		manProfiler.end();
+		manProfiler.begin("testCollision");
+		spin(0.2);
+		manProfiler.end();
+		manProfiler.end();
+
+		manProfiler.begin("testRender");
+		spin(0.3);
+		manProfiler.end();
+
+		manProfiler.endFrame();
+	}
+
+	manProfiler.printStats();
+
+	ProfilerStats physics;
+	bool found = manProfiler.getStats("testPhysics", &physics);
+	bool passed = found && (physics.samples == frameCount) && (physics.p50 < 5) && (physics.p99 >= 20);
+
+	bool written = manProfiler.writeChromeTrace("./profile_test.json");
+
+	printf("[Profiler Test] p50 %.3f ms, p99 %.3f ms, trace %s, %s\n", physics.p50, physics.p99, written ? "written" : "NOT WRITTEN", passed ? "passed" : "FAILED");
+}
@@ -0,0 +1,195 @@
+#include "Tests.h"
+
+#include "engine/GameObjectRegistry.h"
+#include "physics/AnchoredSpringForceGenerator.h"
+#include "col/SpatialHash.h"
+#include "util/Replay.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * Records the input of a scene of cubes pulled together by a spring, colliding, being pushed
+ * about and having their springs removed and added again, with the state hash after each tick.
+ * Then checks replaying the input into a fresh scene matches every tick, with one thread and
+ * with four, before and after saving the replay to a file, and that changing one tick's input
+ * is reported as diverging at that tick.
+ */
+
+static const int cubeSide = 4;
+static const int recordedTicks = 600;
+static const float tickDelta = 1/120.0;
+static const char* replayFile = "./replayTest.rep";
+
+typedef enum ReplayAction_e {
+	REPLAY_ACTION_NONE,
+	REPLAY_ACTION_PUSH,
+	REPLAY_ACTION_DETACH,
+	REPLAY_ACTION_ATTACH
+} ReplayAction;
+
+/*
+ * What the "player" did in a tick.
+ */
+typedef struct ReplayInput_s {
+	int action;
+	int cube;
+	Vec3 force;
+} ReplayInput;
+
+typedef struct ReplayScene_s {
+	GameObjectRegist* regist;
+	SpatialHash* broadphase;
+	JobSystem* jobs;
+	AnchoredSpringForceGenerator* spring;
+	Vec3 anchor;
+	int count;
+	GameObject** cubes;
+	ParticleForceHandle* springs;
+} ReplayScene;
+
+static ReplayScene* newScene(int threads) {
+	ReplayScene* scene = malloc(sizeof(ReplayScene));
+	scene->regist = manGameObjRegist.new(manMatMan.new());
+	scene->broadphase = manSpatialHash.new(0);
+	manColResolver.setBroadphase(scene->regist->collisionResolver, &scene->broadphase->broadphase);
+	scene->jobs = manJobSystem.new(threads);
+	manGameObjRegist.setJobSystem(scene->regist, scene->jobs);
+
+	scene->anchor = manVec3.create(NULL, 0, 0, 0);
+	scene->spring = manAnchoredSpringForceGenerator.new(&scene->anchor, 5, 0.5, 0);
+
+	scene->count = cubeSide*cubeSide*cubeSide;
+	scene->cubes = malloc(sizeof(GameObject*)*scene->count);
+	scene->springs = malloc(sizeof(ParticleForceHandle)*scene->count);
+	for(int i = 0; i < scene->count; i++) {
+		GameObject* cube = manGameObj.new("cube", NULL, true, false, NULL, NULL, NULL, NULL, NULL);
+		manGameObj.setPositionXYZ(cube, (i%cubeSide)*6 - 9, ((i/cubeSide)%cubeSide)*6 - 9, (i/(cubeSide*cubeSide))*6 - 9);
+		manGameObj.setVelocityXYZ(cube, (i%3) - 1, (i%5) - 2, (i%7) - 3);
+
+		attachTestCube(cube->physCollider, sqrt(3));
+
+		manGameObjRegist.add(scene->regist, cube);
+		scene->cubes[i] = cube;
+		scene->springs[i] = manForceRegistry.add(scene->regist->pfRegistry, cube->particle, &scene->spring->forceGenerator);
+	}
+
+	return scene;
+}
+
+static void deleteScene(ReplayScene* scene) {
+	manGameObjRegist.delete(scene->regist);
+	free(scene->regist);
+	manSpatialHash.delete(scene->broadphase);
+	free(scene->broadphase);
+	manJobSystem.delete(scene->jobs);
+	free(scene->jobs);
+	manAnchoredSpringForceGenerator.delete(scene->spring);
+	free(scene->cubes);
+	free(scene->springs);
+	free(scene);
+}
+
+static unsigned long long step(void* data, const void* in, int tick) {
+	ReplayScene* scene = (ReplayScene*)data;
+	const ReplayInput* input = (const ReplayInput*)in;
+	GameObject* cube = scene->cubes[input->cube];
+
+	switch(input->action) {
+		case REPLAY_ACTION_PUSH:
+			manGameObj.addForceXYZ(cube, input->force.x, input->force.y, input->force.z);
+			break;
+
+		case REPLAY_ACTION_DETACH:
+			if (scene->springs[input->cube] != NULL) {
+				manForceRegistry.remove(scene->regist->pfRegistry, scene->springs[input->cube]);
+				scene->springs[input->cube] = NULL;
+			}
+			break;
+
+		case REPLAY_ACTION_ATTACH:
+			if (scene->springs[input->cube] == NULL)
+				scene->springs[input->cube] = manForceRegistry.add(scene->regist->pfRegistry, cube->particle, &scene->spring->forceGenerator);
+			break;
+	}
+
+	manGameObjRegist.update(scene->regist, tickDelta);
+	return manGameObjRegist.hashState(scene->regist);
+}
+
+/*
+ * Input made up from a fixed seed, the same every run.
+ */
+static ReplayInput makeInput(unsigned int* seed, int count) {
+	*seed = *seed*1103515245u + 12345u;
+	unsigned int r = *seed >> 8;
+
+	ReplayInput input;
+	memset(&input, 0, sizeof(input));
+	input.cube = r%count;
+	input.action = (r/count)%8 < 4 ? (r/count)%8 : REPLAY_ACTION_NONE;
+	input.force = manVec3.create(NULL, (int)(r%201) - 100, (int)((r/7)%201) - 100, (int)((r/49)%201) - 100);
+	return input;
+}
+
+static int verifyFresh(Replay* replay, int threads) {
+	ReplayScene* scene = newScene(threads);
+	int diverged = manReplay.verify(replay, step, scene);
+	deleteScene(scene);
+	return diverged;
+}
+
+void runReplayTest() {
+#ifdef COH_DETERMINISTIC
+	printf("[Replay Test] deterministic build\n");
+#else
+	printf("[Replay Test] not a deterministic build, only runs of this binary are compared\n");
+#endif
+
+	Replay* replay = manReplay.new(sizeof(ReplayInput));
+	ReplayScene* scene = newScene(1);
+	unsigned int seed = 1;
+	int contacts = 0;
+	for(int t = 0; t < recordedTicks; t++) {
+		ReplayInput input = makeInput(&seed, scene->count);
+		manReplay.record(replay, &input, step(scene, &input, t));
+		contacts += scene->regist->collisionResolver->collisionRecords->size;
+	}
+	deleteScene(scene);
+
+	int sameThreads = verifyFresh(replay, 1);
+	int moreThreads = verifyFresh(replay, 4);
+
+	bool saved = manReplay.save(replay, replayFile);
+	Replay* loaded = manReplay.load(replayFile);
+	remove(replayFile);
+	int fromFile = loaded != NULL ? verifyFresh(loaded, 1) : recordedTicks;
+
+	//A push at one tick only changes the state from that tick on.
+	int changedTick = recordedTicks/2;
+	ReplayInput* changed = (ReplayInput*)manDynamicArray.get(replay->inputs, changedTick);
+	changed->action = REPLAY_ACTION_PUSH;
+	changed->force.x += 10;
+	int divergence = verifyFresh(replay, 1);
+
+	bool passed = sameThreads == -1 && moreThreads == -1 && saved && fromFile == -1 && divergence == changedTick;
+	printf("[Replay Test] %d ticks of %d cubes, %d contacts: replayed on 1 thread %s, on 4 threads %s, from file %s\n",
+	       recordedTicks, cubeSide*cubeSide*cubeSide, contacts,
+	       sameThreads == -1 ? "matched" : "DIVERGED", moreThreads == -1 ? "matched" : "DIVERGED", fromFile == -1 ? "matched" : "DIVERGED");
+	printf("[Replay Test] input changed at tick %d, divergence reported at tick %d\n", changedTick, divergence);
+
+	long inputBytes = (long)recordedTicks*(sizeof(ReplayInput) + sizeof(unsigned long long));
+	long stateBytes = (long)recordedTicks*cubeSide*cubeSide*cubeSide*2*sizeof(Vec3);
+	printf("[Replay Test] recording %ld bytes, against %ld for a position and velocity snapshot every tick (%.0fx)\n",
+	       inputBytes, stateBytes, (double)stateBytes/inputBytes);
+
+	if (loaded != NULL) {
+		manReplay.delete(loaded);
+		free(loaded);
+	}
+	manReplay.delete(replay);
+	free(replay);
+
+	printf("[Replay Test] %s\n", passed ? "passed" : "FAILED");
+}
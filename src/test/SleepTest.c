@@ -0,0 +1,256 @@
+#include "Tests.h"
+
+#include "engine/GameObjectRegistry.h"
+#include "col/CollisionResolver.h"
+#include "col/SpatialHash.h"
+#include "col/SweepAndPrune.h"
+#include "col/AABBTree.h"
+#include "physics/AnchoredGravityForceGenerator.h"
+#include "util/Clock.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <string.h>
+
+/*
+ * Checks a chain of touching colliders falls asleep as one island and wakes as one, and
+ * that every broadphase leaves out the pairs of resting colliders and nothing else. Then
+ * lets a field of still cubes, close enough for their broadphase spheres to overlap, fall
+ * asleep in a registry and times a tick with them awake and asleep, which must be at least
+ * minSpeedup times faster. Also checks a sleeping cube wakes when a force is put on it and
+ * when a moving cube runs into it, and that a cube in a field too weak to get it past the
+ * sleep velocity within the sleep time stays awake and keeps falling.
+ */
+
+static const int fieldSide = 16;
+static const scalar fieldSpacing = 3;
+static const double minSpeedup = 2;
+static const int sphereCount = 600;
+static const int timedTicks = 120;
+static const float tickDelta = 1/120.0;
+static const scalar weakFieldDistance = 10;
+static const scalar weakFieldAcceleration = 0.05;
+static const int weakFieldTicks = 600;
+
+static int countSleeping(CollisionResolver* resolver) {
+	int count = 0;
+	for(int i = 0; i < resolver->colliders->size; i++) {
+		if ((*(PhysicsCollider**)manDynamicArray.get(resolver->colliders, i))->sleeping)
+			count++;
+	}
+	return count;
+}
+
+/*
+ * Three overlapping cubes and one on its own. Collisions are found but never resolved,
+ * so the chain stays in contact and has to sleep and wake as a single island.
+ */
+static bool testIslands() {
+	CollisionResolver* resolver = manColResolver.new();
+	manColResolver.setSleepEnabled(resolver, true);
+
+	scalar xs[4] = {0, 1.5, 3, 20};
+	for(int i = 0; i < 4; i++) {
+		PhysicsCollider* col = manPhysCollider.new(NULL, NULL, NULL, NULL, NULL);
+		manVec3.create(col->position, xs[i], 0, 0);
+		attachTestCube(col, sqrt(3));
+		manColResolver.addCollider(resolver, col);
+	}
+
+	manColResolver.reset(resolver);
+	bool awakeEarly = true;
+	for(int t = 0; t < 130; t++) {
+		manColResolver.prepare(resolver);
+		manColResolver.check(resolver);
+		manColResolver.updateSleep(resolver, tickDelta);
+
+		if (t < 100)
+			awakeEarly = awakeEarly && countSleeping(resolver) == 0;
+	}
+	bool asleep = countSleeping(resolver) == 4;
+
+	//Waking the end of the chain wakes the whole chain, but not the cube on its own.
+	manColResolver.wake(resolver, 2);
+	bool chainWoke = countSleeping(resolver) == 1 && (*(PhysicsCollider**)manDynamicArray.get(resolver->colliders, 3))->sleeping;
+
+	printf("[Sleep Test] island: awake before the sleep time %s, asleep after %s, woke as one %s\n",
+	       awakeEarly ? "yes" : "NO", asleep ? "yes" : "NO", chainWoke ? "yes" : "NO");
+
+	manColResolver.delete(resolver);
+	free(resolver);
+
+	return awakeEarly && asleep && chainWoke;
+}
+
+static int comparePairs(const void* p1, const void* p2) {
+	const BroadphasePair* pair1 = (const BroadphasePair*)p1;
+	const BroadphasePair* pair2 = (const BroadphasePair*)p2;
+	if (pair1->collider1 != pair2->collider1)
+		return pair1->collider1 - pair2->collider1;
+	return pair1->collider2 - pair2->collider2;
+}
+
+/*
+ * Finds the pairs of random spheres, a third of them resting, with each broadphase and checks
+ * they are the brute-force pairs without those where both spheres are resting.
+ */
+static bool testBroadphases() {
+	ColliderSphere* bounds = malloc(sizeof(ColliderSphere)*sphereCount);
+	bool* resting = malloc(sizeof(bool)*sphereCount);
+	scalar range = 4*cbrt(sphereCount);
+	srand(3);
+	for(int i = 0; i < sphereCount; i++) {
+		bounds[i].center = manVec3.create(NULL, range*rand()/RAND_MAX, range*rand()/RAND_MAX, range*rand()/RAND_MAX);
+		bounds[i].radius = 1 + (i%50 == 0 ? 6 : 2.0*rand()/RAND_MAX);
+		resting[i] = i%3 == 0;
+	}
+
+	DynamicArray* expected = manDynamicArray.new(16, sizeof(BroadphasePair));
+	DynamicArray* pairs = manDynamicArray.new(16, sizeof(BroadphasePair));
+	Broadphase* bruteForce = manBroadphase.newBruteForce();
+	bruteForce->findPairs(bruteForce, bounds, sphereCount, pairs);
+	for(int p = 0; p < pairs->size; p++) {
+		BroadphasePair* pair = (BroadphasePair*)manDynamicArray.get(pairs, p);
+		if (!resting[pair->collider1] || !resting[pair->collider2])
+			manDynamicArray.append(expected, pair);
+	}
+	qsort(expected->contents, expected->size, sizeof(BroadphasePair), comparePairs);
+
+	SpatialHash* hash = manSpatialHash.new(0);
+	SweepAndPrune* sap = manSweepAndPrune.new();
+	AABBTree* tree = manAABBTree.new(0.1);
+	Broadphase* broadphases[4] = {bruteForce, &hash->broadphase, &sap->broadphase, &tree->broadphase};
+	bool matched = true;
+	for(int b = 0; b < 4; b++) {
+		broadphases[b]->resting = resting;
+		broadphases[b]->findPairs(broadphases[b], bounds, sphereCount, pairs);
+		qsort(pairs->contents, pairs->size, sizeof(BroadphasePair), comparePairs);
+		matched = matched && pairs->size == expected->size && memcmp(pairs->contents, expected->contents, sizeof(BroadphasePair)*pairs->size) == 0;
+	}
+
+	printf("[Sleep Test] broadphases: %d pairs with a collider that can move, all broadphases %s\n", expected->size, matched ? "match" : "DIFFER");
+
+	manBroadphase.delete(bruteForce);
+	free(bruteForce);
+	manSpatialHash.delete(hash);
+	free(hash);
+	manSweepAndPrune.delete(sap);
+	free(sap);
+	manAABBTree.delete(tree);
+	free(tree);
+	manDynamicArray.delete(expected);
+	free(expected);
+	manDynamicArray.delete(pairs);
+	free(pairs);
+	free(bounds);
+	free(resting);
+
+	return matched;
+}
+
+static GameObject* newCube(GameObjectRegist* regist, scalar x, scalar y, scalar z) {
+	GameObject* cube = manGameObj.new("cube", NULL, true, false, NULL, NULL, NULL, NULL, NULL);
+	manGameObj.setPositionXYZ(cube, x, y, z);
+	attachTestCube(cube->physCollider, sqrt(3));
+	manGameObjRegist.add(regist, cube);
+	return cube;
+}
+
+static double timeTicks(GameObjectRegist* regist, int ticks) {
+	double start = manClock.getMilliseconds();
+	for(int t = 0; t < ticks; t++)
+		manGameObjRegist.update(regist, tickDelta);
+	return (manClock.getMilliseconds() - start)/ticks;
+}
+
+static bool testField() {
+	GameObjectRegist* regist = manGameObjRegist.new(manMatMan.new());
+	SpatialHash* broadphase = manSpatialHash.new(0);
+	manColResolver.setBroadphase(regist->collisionResolver, &broadphase->broadphase);
+
+	int count = fieldSide*fieldSide*fieldSide;
+	GameObject** cubes = malloc(sizeof(GameObject*)*count);
+	for(int i = 0; i < count; i++)
+		cubes[i] = newCube(regist, (i%fieldSide)*fieldSpacing, ((i/fieldSide)%fieldSide)*fieldSpacing, (i/(fieldSide*fieldSide))*fieldSpacing);
+
+	CollisionResolver* resolver = regist->collisionResolver;
+	double awakeTime = timeTicks(regist, timedTicks);
+
+	manGameObjRegist.setSleepEnabled(regist, true);
+	timeTicks(regist, (int)(COLLISION_RESOLVER_SLEEP_TIME/tickDelta) + 2);
+	bool asleep = countSleeping(resolver) == count;
+	double asleepTime = timeTicks(regist, timedTicks);
+
+	//A force large enough to get a cube moving wakes it.
+	GameObject* pushed = cubes[count-1];
+	manGameObj.addForceXYZ(pushed, 1000, 0, 0);
+	manGameObjRegist.update(regist, tickDelta);
+	bool forceWoke = !pushed->physCollider->sleeping && pushed->velocity.x > 0;
+
+	//A cube moving into the corner of the field wakes the cube it hits, which is knocked away.
+	GameObject* struck = cubes[0];
+	GameObject* projectile = newCube(regist, -3, 0, 0);
+	manGameObj.setVelocityXYZ(projectile, 20, 0, 0);
+	for(int t = 0; t < 30; t++)
+		manGameObjRegist.update(regist, tickDelta);
+	bool hitWoke = !struck->physCollider->sleeping && struck->position.x != 0;
+
+	bool faster = awakeTime >= minSpeedup*asleepTime;
+	bool passed = asleep && forceWoke && hitWoke && faster;
+	printf("[Sleep Test] field of %d: all asleep %s, woken by force %s, woken by hit %s\n",
+	       count, asleep ? "yes" : "NO", forceWoke ? "yes" : "NO", hitWoke ? "yes" : "NO");
+	printf("[Sleep Test] tick awake %.3f ms, asleep %.3f ms (%.2fx, %s %.0fx)\n", awakeTime, asleepTime, awakeTime/asleepTime,
+	       faster ? "at least" : "UNDER", minSpeedup);
+
+	manGameObjRegist.delete(regist);
+	free(regist);
+	manSpatialHash.delete(broadphase);
+	free(broadphase);
+	free(cubes);
+
+	return passed;
+}
+
+/*
+ * A cube pulled toward an anchor at weakFieldAcceleration, well under COLLISION_RESOLVER_SLEEP_VELOCITY
+ * per COLLISION_RESOLVER_SLEEP_TIME, must not be put to sleep while it is still picking up speed.
+ */
+static bool testWeakField() {
+	GameObjectRegist* regist = manGameObjRegist.new(manMatMan.new());
+	manGameObjRegist.setSleepEnabled(regist, true);
+
+	Particle* anchor = manParticle.new(NULL, NULL, NULL, NULL);
+	manParticle.setMass(anchor, weakFieldAcceleration*weakFieldDistance*weakFieldDistance/6.67384e-11);
+	AnchoredGravityForceGenerator* fg = manAnchoredGravityForceGenerator.new(anchor);
+
+	GameObject* cube = newCube(regist, weakFieldDistance, 0, 0);
+	cube->particle->damping = 1;
+	manGameObj.addForceGenerator(cube, &fg->forceGenerator);
+	for(int t = 0; t < weakFieldTicks; t++)
+		manGameObjRegist.update(regist, tickDelta);
+
+	//Undamped and falling from rest, with the pull growing as it gets closer, it covers at least a*t^2/2.
+	scalar time = weakFieldTicks*tickDelta;
+	scalar fallen = weakFieldDistance - cube->position.x;
+	bool moved = fallen >= 0.5*weakFieldAcceleration*time*time;
+	bool awake = !cube->physCollider->sleeping;
+	printf("[Sleep Test] weak field: awake %s, fell %.3f in %.0f s %s\n", awake ? "yes" : "NO", fallen, time, moved ? "yes" : "NO");
+
+	manGameObjRegist.delete(regist);
+	free(regist);
+	manAnchoredGravityForceGenerator.delete(fg);
+	free(fg);
+	manParticle.delete(anchor);
+	free(anchor);
+
+	return awake && moved;
+}
+
+void runSleepTest() {
+	bool islands = testIslands();
+	bool broadphases = testBroadphases();
+	bool field = testField();
+	bool weakField = testWeakField();
+	printf("[Sleep Test] %s\n", (islands && broadphases && field && weakField) ? "passed" : "FAILED");
+}
@@ -0,0 +1,207 @@
+#include "Tests.h"
+
+#include "engine/GameObjectRegistry.h"
+#include "physics/AnchoredSpringForceGenerator.h"
+#include "col/SpatialHash.h"
+#include "util/Clock.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * Times snapshotting and restoring a world of 10000 cubes, some pulled about by one of two springs,
+ * some free and left to fall asleep, against a budget of a millisecond each, taking the median of the
+ * runs. Then checks a rollback,
+ * restoring after the springs and cubes have been changed, gives the same ticks as carrying on from
+ * the snapshot did, and so does restoring into a second world built the same way. A world without an
+ * id for one of the springs must refuse the snapshot, and snapshotting the restored world again must
+ * give the same bytes.
+ */
+
+static const int gridX = 25;
+static const int gridY = 20;
+static const int gridZ = 20;
+static const int warmTicks = 75;
+static const int checkTicks = 30;
+static const int repeats = 50;
+static const float tickDelta = 1/60.0;
+static const double budget = 1;
+
+typedef struct SnapshotScene_s {
+	GameObjectRegist* regist;
+	SpatialHash* broadphase;
+	Vec3 anchors[2];
+	AnchoredSpringForceGenerator* springs[2];
+	int count;
+	ParticleForceHandle* handles;
+} SnapshotScene;
+
+static SnapshotScene* newScene() {
+	SnapshotScene* scene = malloc(sizeof(SnapshotScene));
+	scene->regist = manGameObjRegist.new(manMatMan.new());
+	scene->broadphase = manSpatialHash.new(0);
+	manColResolver.setBroadphase(scene->regist->collisionResolver, &scene->broadphase->broadphase);
+	manGameObjRegist.setSleepEnabled(scene->regist, true);
+
+	ContactSolverSettings settings = scene->regist->collisionResolver->solverSettings;
+	settings.restitution = 0.2;
+	settings.friction = 0.5;
+	manColResolver.setSolverSettings(scene->regist->collisionResolver, &settings);
+
+	scene->anchors[0] = manVec3.create(NULL, 32, 38, 38);
+	scene->anchors[1] = manVec3.create(NULL, 64, 38, 38);
+	for(int s = 0; s < 2; s++) {
+		scene->springs[s] = manAnchoredSpringForceGenerator.new(&scene->anchors[s], 0.002, 0.5, 0);
+		manGameObjRegist.setForceGeneratorId(scene->regist, &scene->springs[s]->forceGenerator, s);
+	}
+
+	scene->count = gridX*gridY*gridZ;
+	scene->handles = malloc(sizeof(ParticleForceHandle)*scene->count);
+	for(int i = 0; i < scene->count; i++) {
+		GameObject* cube = manGameObj.new("cube", NULL, true, false, NULL, NULL, NULL, NULL, NULL);
+		manGameObj.setPositionXYZ(cube, (i%gridX)*4, ((i/gridX)%gridY)*4, (i/(gridX*gridY))*4);
+
+		attachTestCube(cube->physCollider, sqrt(3));
+
+		manGameObjRegist.add(scene->regist, cube);
+
+		//Every fourth cube is on a spring, the rest are still until something hits them.
+		scene->handles[i] = NULL;
+		if (i%4 == 0) {
+			manGameObj.setVelocityXYZ(cube, (i%3) - 1, (i%5) - 2, (i%7) - 3);
+			scene->handles[i] = manForceRegistry.add(scene->regist->pfRegistry, cube->particle, &scene->springs[(i/4)%2]->forceGenerator);
+		}
+	}
+
+	return scene;
+}
+
+static void deleteScene(SnapshotScene* scene) {
+	manGameObjRegist.delete(scene->regist);
+	free(scene->regist);
+	manSpatialHash.delete(scene->broadphase);
+	free(scene->broadphase);
+	for(int s = 0; s < 2; s++)
+		manAnchoredSpringForceGenerator.delete(scene->springs[s]);
+	free(scene->handles);
+	free(scene);
+}
+
+static unsigned long long runTicks(SnapshotScene* scene, int ticks) {
+	for(int t = 0; t < ticks; t++)
+		manGameObjRegist.update(scene->regist, tickDelta);
+	return manGameObjRegist.hashState(scene->regist);
+}
+
+static int compareTimes(const void* a, const void* b) {
+	double difference = *(const double*)a - *(const double*)b;
+	return (difference > 0) - (difference < 0);
+}
+
+/*
+ * The middle of the times taken, so the odd run the machine spent elsewhere doesn't decide the result.
+ */
+static double median(double* times, int count) {
+	qsort(times, count, sizeof(double), compareTimes);
+	return times[count/2];
+}
+
+static int countSleeping(SnapshotScene* scene) {
+	int sleeping = 0;
+	for(int i = 0; i < scene->count; i++)
+		sleeping += manGameObjRegist.getGameObject(scene->regist, i)->physCollider->sleeping;
+	return sleeping;
+}
+
+void runSnapshotBenchmark() {
+	SnapshotScene* scene = newScene();
+	runTicks(scene, warmTicks);
+
+	WorldSnapshot snapshot = {NULL, 0, 0};
+	double* times = malloc(sizeof(double)*repeats);
+	for(int r = 0; r < repeats; r++) {
+		double start = manClock.getMilliseconds();
+		manGameObjRegist.snapshot(scene->regist, &snapshot);
+		times[r] = manClock.getMilliseconds() - start;
+	}
+	double snapshotTime = median(times, repeats);
+
+	//How long just copying that much memory takes here, what snapshot and restore can't beat.
+	char* copy = malloc(snapshot.size);
+	for(int r = 0; r < repeats; r++) {
+		double start = manClock.getMilliseconds();
+		memcpy(copy, snapshot.data, snapshot.size);
+		times[r] = manClock.getMilliseconds() - start;
+	}
+	double copyTime = median(times, repeats);
+	bool copied = memcmp(copy, snapshot.data, snapshot.size) == 0;
+	free(copy);
+
+	int sleeping = countSleeping(scene);
+	int contacts = scene->regist->collisionResolver->contactPairs->size;
+	unsigned long long expected = runTicks(scene, checkTicks);
+
+	//Throw the world off course: drop some springs, push cubes and add a registration the snapshot doesn't have.
+	for(int i = 0; i < scene->count; i += 10) {
+		if (scene->handles[i] != NULL)
+			manForceRegistry.remove(scene->regist->pfRegistry, scene->handles[i]);
+		manGameObj.addForceXYZ(manGameObjRegist.getGameObject(scene->regist, i), 50, 0, 0);
+	}
+	manForceRegistry.add(scene->regist->pfRegistry, manGameObjRegist.getGameObject(scene->regist, 1)->particle, &scene->springs[0]->forceGenerator);
+	runTicks(scene, checkTicks);
+
+	double start = manClock.getMilliseconds();
+	bool restored = manGameObjRegist.restore(scene->regist, &snapshot);
+	double rebuildTime = manClock.getMilliseconds() - start;
+	unsigned long long rolledBack = runTicks(scene, checkTicks);
+
+	//Restoring again over the same registrations, as a rollback every tick would.
+	for(int r = 0; r < repeats; r++) {
+		start = manClock.getMilliseconds();
+		restored = manGameObjRegist.restore(scene->regist, &snapshot) && restored;
+		times[r] = manClock.getMilliseconds() - start;
+	}
+	double restoreTime = median(times, repeats);
+	unsigned long long rolledBackAgain = runTicks(scene, checkTicks);
+
+	SnapshotScene* other = newScene();
+	bool migrated = manGameObjRegist.restore(other->regist, &snapshot);
+	unsigned long long otherWorld = runTicks(other, checkTicks);
+	deleteScene(other);
+
+	//A snapshot cut short is refused, leaving the world as it was.
+	WorldSnapshot truncated = snapshot;
+	truncated.size -= 1;
+	bool refused = !manGameObjRegist.restore(scene->regist, &truncated);
+
+	//So is one with a generator the world has no id for.
+	SnapshotScene* unnamed = newScene();
+	manGameObjRegist.setForceGeneratorId(unnamed->regist, &unnamed->springs[1]->forceGenerator, 2);
+	bool unmatched = !manGameObjRegist.restore(unnamed->regist, &snapshot);
+	deleteScene(unnamed);
+
+	//Snapshots of the same world are the same bytes.
+	WorldSnapshot again = {NULL, 0, 0};
+	manGameObjRegist.snapshot(scene->regist, &again);
+	manGameObjRegist.restore(scene->regist, &snapshot);
+	manGameObjRegist.snapshot(scene->regist, &again);
+	bool reproduced = again.size == snapshot.size && memcmp(again.data, snapshot.data, snapshot.size) == 0;
+	free(again.data);
+
+	bool fast = snapshotTime < budget && restoreTime < budget;
+	bool matched = copied && restored && migrated && refused && unmatched && reproduced && rolledBack == expected && rolledBackAgain == expected && otherWorld == expected;
+
+	printf("[Snapshot Benchmark] %d objects, %d asleep, %d contact pairs: snapshot %d bytes (%.0f an object)\n",
+	       scene->count, sleeping, contacts, snapshot.size, (double)snapshot.size/scene->count);
+	printf("[Snapshot Benchmark] snapshot %.3f ms, restore %.3f ms, restore replacing force registrations %.3f ms, copying the snapshot %.3f ms: %s\n",
+	       snapshotTime, restoreTime, rebuildTime, copyTime, fast ? "within 1 ms" : "OVER 1 ms");
+	printf("[Snapshot Benchmark] %d ticks after the snapshot %016llx, rolled back %016llx, again %016llx, in a new world %016llx\n",
+	       checkTicks, expected, rolledBack, rolledBackAgain, otherWorld);
+	printf("[Snapshot Benchmark] unnamed generator %s, snapshot bytes %s\n", unmatched ? "refused" : "RESTORED", reproduced ? "reproduced" : "DIFFER");
+	printf("[Snapshot Benchmark] %s\n", matched && fast ? "passed" : "FAILED");
+
+	free(times);
+	free(snapshot.data);
+	deleteScene(scene);
+}
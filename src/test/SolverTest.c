@@ -0,0 +1,184 @@
+#include "Tests.h"
+
+#include "col/CollisionResolver.h"
+#include "util/Clock.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+/*
+ * Drops a stack of cubes, the top one much heavier than the rest, onto an immovable floor
+ * under gravity and checks it comes to rest stacked with the default iterations, against
+ * a single iteration of each solver like the old one pass resolve. Then checks a cube dropped on the floor bounces back
+ * with the restitution it is given, and a cube sliding along it stops as soon as
+ * friction says it should.
+ */
+
+static const int stackHeight = 6;
+static const int settleTicks = 300;
+static const float tickDelta = 1/60.0;
+static const scalar gravity = 9.8;
+static const scalar tolerance = 0.05;
+static const scalar topMass = 20;
+
+static PhysicsCollider* newCube(CollisionResolver* resolver, scalar x, scalar y, bool immovable) {
+	PhysicsCollider* col = manPhysCollider.new(NULL, NULL, NULL, NULL, NULL);
+	manVec3.create(col->position, x, y, 0);
+	col->immovable = immovable;
+	attachTestCube(col, sqrt(3));
+
+	manColResolver.addCollider(resolver, col);
+	return col;
+}
+
+/*
+ * A floor of half height 1 with its top at y = 0, the shared cube scaled out wide enough to slide along.
+ */
+static PhysicsCollider* newFloor(CollisionResolver* resolver) {
+	PhysicsCollider* floor = newCube(resolver, 0, -1, true);
+	manVec3.create(floor->scale, 50, 1, 50);
+	return floor;
+}
+
+static PhysicsCollider* getCollider(CollisionResolver* resolver, int i) {
+	return *(PhysicsCollider**)manDynamicArray.get(resolver->colliders, i);
+}
+
+/*
+ * Moves every movable collider by its velocity, with gravity if asked, then finds and resolves
+ * collisions the way the registry's update does. Returns the velocity iterations the solver took.
+ */
+static int tick(CollisionResolver* resolver, bool falling) {
+	for(int i = 0; i < resolver->colliders->size; i++) {
+		PhysicsCollider* col = getCollider(resolver, i);
+		if (col->immovable)
+			continue;
+
+		if (falling)
+			col->velocity->y -= gravity*tickDelta;
+		Vec3 step = manVec3.postMulScalar(col->velocity, tickDelta);
+		*col->position = manVec3.sum(col->position, &step);
+	}
+
+	manColResolver.reset(resolver);
+	manColResolver.prepare(resolver);
+	if (!manColResolver.check(resolver))
+		return 0;
+	manColResolver.resolve(resolver);
+	return resolver->velocityIterationsUsed;
+}
+
+static void deleteResolver(CollisionResolver* resolver) {
+	manColResolver.delete(resolver);
+	free(resolver);
+}
+
+static bool testStack(const char* name, int velocityIterations, int positionIterations) {
+	CollisionResolver* resolver = manColResolver.new();
+	ContactSolverSettings settings = resolver->solverSettings;
+	settings.velocityIterations = velocityIterations;
+	settings.positionIterations = positionIterations;
+	settings.restitution = 0;
+	settings.friction = 0.5;
+	manColResolver.setSolverSettings(resolver, &settings);
+
+	newFloor(resolver);
+	PhysicsCollider** stack = malloc(sizeof(PhysicsCollider*)*stackHeight);
+	for(int i = 0; i < stackHeight; i++)
+		stack[i] = newCube(resolver, 0, 1 + i*2.1, false);
+	*stack[stackHeight - 1]->inverseMass = 1/topMass;
+
+	int iterations = 0;
+	int collidingTicks = 0;
+	double start = manClock.getMilliseconds();
+	for(int t = 0; t < settleTicks; t++) {
+		int used = tick(resolver, true);
+		iterations += used;
+		collidingTicks += used > 0;
+	}
+	double time = (manClock.getMilliseconds() - start)/settleTicks;
+
+	//Each cube should rest on the one below, overlapping it by no more than about the slop.
+	scalar worstHeight = 0;
+	scalar fastest = 0;
+	for(int i = 0; i < stackHeight; i++) {
+		worstHeight = fmaxf(worstHeight, fabsf(stack[i]->position->y - (1 + i*2)));
+		fastest = fmaxf(fastest, sqrtf(manVec3.dot(stack[i]->velocity, stack[i]->velocity)));
+	}
+	bool stable = worstHeight < tolerance*stackHeight && fastest < tolerance;
+
+	printf("[Solver Test] %-10s %2d/%d iterations: furthest from rest %.4f, fastest %.4f u/s, %.2f velocity iterations a tick, %.3f ms: %s\n",
+	       name, velocityIterations, positionIterations, worstHeight, fastest, (double)iterations/fmax(collidingTicks, 1), time, stable ? "stable" : "UNSTABLE");
+
+	free(stack);
+	deleteResolver(resolver);
+	return stable;
+}
+
+/*
+ * Drops a cube onto the floor at 10 u/s without gravity and returns its speed away from it afterwards.
+ */
+static scalar bounce(scalar restitution) {
+	CollisionResolver* resolver = manColResolver.new();
+	ContactSolverSettings settings = resolver->solverSettings;
+	settings.restitution = restitution;
+	manColResolver.setSolverSettings(resolver, &settings);
+
+	newFloor(resolver);
+	PhysicsCollider* cube = newCube(resolver, 0, 3, false);
+	cube->velocity->y = -10;
+	for(int t = 0; t < 30; t++)
+		tick(resolver, false);
+
+	scalar speed = cube->velocity->y;
+	deleteResolver(resolver);
+	return speed;
+}
+
+/*
+ * Slides a cube resting on the floor at 5 u/s and returns how far it goes before it stops.
+ */
+static scalar slide(scalar friction, int* ticks) {
+	CollisionResolver* resolver = manColResolver.new();
+	ContactSolverSettings settings = resolver->solverSettings;
+	settings.restitution = 0;
+	settings.friction = friction;
+	manColResolver.setSolverSettings(resolver, &settings);
+
+	newFloor(resolver);
+	PhysicsCollider* cube = newCube(resolver, 0, 1, false);
+	cube->velocity->x = 5;
+	for(*ticks = 0; *ticks < settleTicks && cube->velocity->x > 1e-4; (*ticks)++)
+		tick(resolver, true);
+
+	scalar distance = cube->position->x;
+	deleteResolver(resolver);
+	return distance;
+}
+
+void runSolverTest() {
+	bool passed = testStack("iterated", COLLISION_RESOLVER_VELOCITY_ITERATIONS, COLLISION_RESOLVER_POSITION_ITERATIONS);
+	testStack("one pass", 1, 1);
+
+	scalar elastic = bounce(1);
+	scalar half = bounce(0.5);
+	scalar dead = bounce(0);
+	bool bounced = fabs(elastic - 10) < tolerance && fabs(half - 5) < tolerance && fabs(dead) < tolerance;
+	printf("[Solver Test] bounce at 10 u/s: restitution 1 %.3f u/s, 0.5 %.3f u/s, 0 %.3f u/s: %s\n",
+	       elastic, half, dead, bounced ? "ok" : "WRONG");
+	passed = passed && bounced;
+
+	//Kinetic friction slows the cube at friction*gravity, so it should slide v^2/(2*friction*gravity).
+	int ticks;
+	scalar distance = slide(0.5, &ticks);
+	scalar expected = 5*5/(2*0.5*gravity);
+	int frictionlessTicks;
+	slide(0, &frictionlessTicks);
+	bool slid = fabs(distance - expected) < 0.1 && frictionlessTicks == settleTicks;
+	printf("[Solver Test] slide at 5 u/s: friction 0.5 stopped after %.3f (expected %.3f) in %d ticks, frictionless still sliding %s: %s\n",
+	       distance, expected, ticks, frictionlessTicks == settleTicks ? "yes" : "NO", slid ? "ok" : "WRONG");
+	passed = passed && slid;
+
+	printf("[Solver Test] %s\n", passed ? "passed" : "FAILED");
+}
@@ -0,0 +1,189 @@
+#include "Tests.h"
+
+#include "col/CollisionDetection.h"
+#include "util/ObjLoader.h"
+#include "util/Clock.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+/*
+ * Checks climbing the hull finds a vertex as far along as trying every vertex does, for
+ * random directions on the game's collision hulls, and times it cold, warm started from a
+ * nearby direction, and against the linear scan. Then times the SAT and GJK narrowphases
+ * with and without adjacency on the same placements and checks they agree.
+ */
+
+static const int directionCount = 20000;
+static const int placementCount = 1000;
+static const scalar stepAngle = 0.05;
+static const scalar tolerance = 1e-3;
+static const char* hullFiles[] = {"./data/models/meteor.col.obj", "./data/models/grav.col.obj", "./data/models/Spaceship.col.obj"};
+static const char* hullNames[] = {"meteor", "grav", "Spaceship"};
+static const int hullCount = 3;
+
+static scalar randomRange(scalar range) {
+	return ((scalar)rand()/(scalar)RAND_MAX)*range - range/2;
+}
+
+static Vec3 randomDirection() {
+	Vec3 direction;
+	do {
+		direction = manVec3.create(NULL, randomRange(2), randomRange(2), randomRange(2));
+	} while (manVec3.dot(&direction, &direction) < 0.01);
+
+	return manVec3.normalize(&direction);
+}
+
+/*
+ * The same mesh without adjacency, so every query tries every vertex.
+ */
+static SATMesh withoutAdjacency(SATMesh* mesh) {
+	SATMesh linear = *mesh;
+	linear.adjacencyStart = NULL;
+	linear.adjacency = NULL;
+	return linear;
+}
+
+static bool testSupport(PhysicsCollider* hull, const char* name) {
+	SATMesh* mesh = &hull->nPhase.satMesh;
+	SATMesh linear = withoutAdjacency(mesh);
+	Vec3* directions = malloc(sizeof(Vec3)*directionCount);
+	int* results = malloc(sizeof(int)*directionCount);
+
+	//A direction turning a little each query, like a body rotating between ticks.
+	Vec3 axis = randomDirection();
+	directions[0] = randomDirection();
+	for(int i = 1; i < directionCount; i++) {
+		Vec3 turn = manVec3.cross(&axis, &directions[i-1]);
+		turn = manVec3.postMulScalar(&turn, stepAngle);
+		directions[i] = manVec3.sum(&directions[i-1], &turn);
+		directions[i] = manVec3.normalize(&directions[i]);
+		if (i%500 == 0)
+			axis = randomDirection();
+	}
+
+	double start = manClock.getMilliseconds();
+	for(int i = 0; i < directionCount; i++)
+		results[i] = sat.support(&linear, &directions[i], 0);
+	double linearTime = manClock.getMilliseconds() - start;
+
+	int wrong = 0;
+	start = manClock.getMilliseconds();
+	for(int i = 0; i < directionCount; i++) {
+		int vert = sat.support(mesh, &directions[i], 0);
+		wrong += manVec3.dot(&mesh->verts[vert], &directions[i]) < manVec3.dot(&mesh->verts[results[i]], &directions[i]) - tolerance;
+	}
+	double coldTime = manClock.getMilliseconds() - start;
+
+	start = manClock.getMilliseconds();
+	int vert = 0;
+	for(int i = 0; i < directionCount; i++) {
+		vert = sat.support(mesh, &directions[i], vert);
+		wrong += manVec3.dot(&mesh->verts[vert], &directions[i]) < manVec3.dot(&mesh->verts[results[i]], &directions[i]) - tolerance;
+	}
+	double warmTime = manClock.getMilliseconds() - start;
+
+	int degree = mesh->adjacency == NULL ? 0 : mesh->adjacencyStart[mesh->vCount];
+	printf("[Support Mapping Test] %-10s %6d %8.2f %10.3f %10.3f %10.3f %8.2fx %6d\n", name, mesh->vCount, (double)degree/mesh->vCount,
+	       linearTime*1000/directionCount, coldTime*1000/directionCount, warmTime*1000/directionCount, linearTime/warmTime, wrong);
+
+	free(directions);
+	free(results);
+
+	return mesh->adjacency != NULL && wrong == 0;
+}
+
+static void placeMesh(ColliderSimpleMesh* dest, PhysicsCollider* hull, scalar range) {
+	Vec3 position = manVec3.create(NULL, randomRange(range), randomRange(range), randomRange(range));
+	Vec3 rotation = manVec3.create(NULL, randomRange(360), randomRange(360), randomRange(360));
+	Vec3 scale = manVec3.create(NULL, 1, 1, 1);
+
+	dest->satMesh.verts = malloc(sizeof(Vec3)*hull->nPhase.satMesh.vCount);
+	dest->satMesh.norms = malloc(sizeof(Vec3)*hull->nPhase.satMesh.nCount);
+	Mat4 transform = manColMesh.makeTransformationMatrix(&position, &rotation, &scale);
+	manColMesh.transformSimpleMeshInto(dest, &hull->nPhase, &transform);
+}
+
+static bool sameResult(CollisionResult* r1, CollisionResult* r2) {
+	return (r1->isColliding == r2->isColliding) && (fabs(r1->distance - r2->distance) < tolerance);
+}
+
+static double timeNarrowphase(CollisionResult(* narrowphase)(ColliderSimpleMesh*, ColliderSimpleMesh*), ColliderSimpleMesh* meshes1, ColliderSimpleMesh* meshes2, CollisionResult* results) {
+	double start = manClock.getMilliseconds();
+	for(int i = 0; i < placementCount; i++)
+		results[i] = narrowphase(&meshes1[i], &meshes2[i]);
+	return manClock.getMilliseconds() - start;
+}
+
+static bool testNarrowphase(PhysicsCollider* hull1, PhysicsCollider* hull2, const char* name) {
+	ColliderSimpleMesh* meshes1 = malloc(sizeof(ColliderSimpleMesh)*placementCount);
+	ColliderSimpleMesh* meshes2 = malloc(sizeof(ColliderSimpleMesh)*placementCount);
+	ColliderSimpleMesh* linear1 = malloc(sizeof(ColliderSimpleMesh)*placementCount);
+	ColliderSimpleMesh* linear2 = malloc(sizeof(ColliderSimpleMesh)*placementCount);
+	CollisionResult* climbed = malloc(sizeof(CollisionResult)*placementCount);
+	CollisionResult* scanned = malloc(sizeof(CollisionResult)*placementCount);
+
+	scalar range = 2*(hull1->bPhase.radius + hull2->bPhase.radius);
+	for(int i = 0; i < placementCount; i++) {
+		placeMesh(&meshes1[i], hull1, 0);
+		placeMesh(&meshes2[i], hull2, range);
+		linear1[i] = meshes1[i];
+		linear2[i] = meshes2[i];
+		linear1[i].satMesh = withoutAdjacency(&meshes1[i].satMesh);
+		linear2[i].satMesh = withoutAdjacency(&meshes2[i].satMesh);
+	}
+
+	int differ = 0;
+	double satLinear = timeNarrowphase(manColDetection.checkStaticNarrowphase, linear1, linear2, scanned);
+	double satClimb = timeNarrowphase(manColDetection.checkStaticNarrowphase, meshes1, meshes2, climbed);
+	for(int i = 0; i < placementCount; i++)
+		differ += !sameResult(&climbed[i], &scanned[i]);
+
+	double gjkLinear = timeNarrowphase(manColDetection.checkGJKNarrowphase, linear1, linear2, scanned);
+	double gjkClimb = timeNarrowphase(manColDetection.checkGJKNarrowphase, meshes1, meshes2, climbed);
+	for(int i = 0; i < placementCount; i++)
+		differ += !sameResult(&climbed[i], &scanned[i]);
+
+	printf("[Support Mapping Test] %-20s SAT %8.2f -> %8.2f us (%5.2fx)   GJK %8.2f -> %8.2f us (%5.2fx)   differ %d\n", name,
+	       satLinear*1000/placementCount, satClimb*1000/placementCount, satLinear/satClimb,
+	       gjkLinear*1000/placementCount, gjkClimb*1000/placementCount, gjkLinear/gjkClimb, differ);
+
+	for(int i = 0; i < placementCount; i++) {
+		free(meshes1[i].satMesh.verts);
+		free(meshes1[i].satMesh.norms);
+		free(meshes2[i].satMesh.verts);
+		free(meshes2[i].satMesh.norms);
+	}
+	free(meshes1);
+	free(meshes2);
+	free(linear1);
+	free(linear2);
+	free(climbed);
+	free(scanned);
+
+	return differ == 0;
+}
+
+void runSupportMappingTest() {
+	PhysicsCollider* hulls[3];
+	for(int h = 0; h < hullCount; h++)
+		hulls[h] = objLoader.loadCollisionMesh(hullFiles[h], NULL, NULL, NULL, NULL);
+
+	srand(1);
+	bool passed = true;
+
+	printf("[Support Mapping Test] %d directions per hull, turning %.2f radians each\n", directionCount, stepAngle);
+	printf("[Support Mapping Test] %-10s %6s %8s %10s %10s %10s %9s %6s\n", "hull", "verts", "degree", "linear us", "cold us", "warm us", "speedup", "wrong");
+	for(int h = 0; h < hullCount; h++)
+		passed = testSupport(hulls[h], hullNames[h]) && passed;
+
+	for(int h = 0; h < hullCount; h++) {
+		char pairName[32];
+		snprintf(pairName, sizeof(pairName), "%s/%s", hullNames[h], hullNames[h]);
+		passed = testNarrowphase(hulls[h], hulls[h], pairName) && passed;
+	}
+
+	printf("[Support Mapping Test] %s\n", passed ? "passed" : "FAILED");
+}
@@ -0,0 +1,27 @@
+#include "Tests.h"
+
+#include <stdlib.h>
+
+/*
+ * The cube the collision tests are built from, corners at -1 and 1, scaled by the collider.
+ */
+
+static Vec3 cubeVerts[8] = {
+	{-1,-1,-1}, { 1,-1,-1}, {-1, 1,-1}, { 1, 1,-1},
+	{-1,-1, 1}, { 1,-1, 1}, {-1, 1, 1}, { 1, 1, 1}
+};
+static Vec3 cubeNorms[3] = {{1,0,0}, {0,1,0}, {0,0,1}};
+static int cubeMin[3] = {0, 0, 0};
+static int cubeMax[3] = {7, 7, 7};
+
+ColliderSimpleMesh* newTestCubeMesh() {
+	return manColMesh.newSimpleMesh(8, cubeVerts, 3, cubeNorms, cubeMin, cubeMax);
+}
+
+void attachTestCube(PhysicsCollider* col, scalar broadphaseRadius) {
+	manPhysCollider.setBroadphase(col, NULL, broadphaseRadius);
+
+	ColliderSimpleMesh* mesh = newTestCubeMesh();
+	manPhysCollider.attachNarrowphaseSimpleMesh(col, mesh);
+	free(mesh);
+}
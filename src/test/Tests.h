@@ -1,6 +1,8 @@
 #ifndef COH_TESTS_H
 #define COH_TESTS_H
 
+#include "col/PhysicsCollider.h"
+
 void runGameLoopTest();
 void runPhysicsGLFWTest();
 void runShipMotionTest();
@@ -11,5 +13,37 @@ void runNewtonsCradle();
 void runGravity();
 void runQuitScreen();
 void runBallistics();
+void runBroadphaseBenchmark();
+void runCollisionAllocTest();
+void runParticleBenchmark();
+void runMathSimdTest();
+void runMathBenchmark();
+void runProfilerTest();
+void runJobSystemBenchmark();
+void runForceRegistryTest();
+void runNBodyTest();
+void runIntegratorBenchmark();
+void runSleepTest();
+void runContinuousCollisionTest();
+void runNarrowphaseBenchmark();
+void runSupportMappingTest();
+void runContactManifoldTest();
+void runSolverTest();
+void runReplayTest();
+void runSnapshotBenchmark();
+void runCollisionMeshCookTest();
+void runMeshCookTest();
+void runAABBTreeTest();
+
+/**
+ * Creates the mesh of the cube the collision tests share, corners at -1 and 1. Free it once attached or copied.
+ */
+ColliderSimpleMesh* newTestCubeMesh();
+
+/**
+ * Gives the collider the shared cube as its narrowphase mesh, scaled by the collider's scale like any other.
+ * @param broadphaseRadius The radius of the collider's broadphase sphere, sqrt(3) to just hold the unscaled cube.
+ */
+void attachTestCube(PhysicsCollider* col, scalar broadphaseRadius);
 
 #endif
@@ -0,0 +1,28 @@
+#ifndef COH_CLOCK_H
+#define COH_CLOCK_H
+
+#include <stdint.h>
+
+/**
+ *	Monotonic wall clock that doesn't depend on GLFW being initialised,
+ * 	for timing code that runs without a window.
+ */
+typedef struct ClockManager_s {
+	/**
+	 *	Gets the current time from an arbitrary origin.
+	 *
+	 * 	@return	uint64_t, the time in nanoseconds.
+	 */
+	uint64_t(* getNanoseconds)();
+
+	/**
+	 *	Gets the current time from an arbitrary origin.
+	 *
+	 * 	@return	double, the time in milliseconds.
+	 */
+	double(* getMilliseconds)();
+} ClockManager;
+
+extern const ClockManager manClock;
+
+#endif
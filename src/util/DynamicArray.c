@@ -57,4 +57,8 @@ static void append(DynamicArray *array, void *const element) {
     ++(array->size);
 }
 
-const DynamicArrayManager manDynamicArray = {new, delete, get, append};
+static void clear(DynamicArray *array) {
+    array->size = 0;
+}
+
+const DynamicArrayManager manDynamicArray = {new, delete, get, append, clear};
@@ -78,6 +78,14 @@ typedef struct DynamicArrayManager_s {
      */
     void (*append)(struct DynamicArray_s *array, void *const element);
 
+    /**
+     *  Empties the DynamicArray without releasing its memory. The capacity of the
+     *  array is retained so refilling it will not reallocate.
+     *
+     *  @param  array       pointer to DynamicArray to empty.
+     */
+    void (*clear)(struct DynamicArray_s *array);
+
 } DynamicArrayManager;
 
 extern const DynamicArrayManager manDynamicArray;
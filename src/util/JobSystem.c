@@ -0,0 +1,236 @@
+#ifndef _WIN32
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include "JobSystem.h"
+
+#include <stdlib.h>
+#include <sched.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+typedef struct WorkerStart_s {
+	JobSystem* jobs;
+	int index;
+} WorkerStart;
+
+//The system and index of the calling thread, for threads that belong to a pool.
+static _Thread_local JobSystem* currentSystem = NULL;
+static _Thread_local int currentIndex = 0;
+
+static int getHardwareThreadCount() {
+#ifdef _WIN32
+	SYSTEM_INFO info;
+	GetSystemInfo(&info);
+	int count = (int)info.dwNumberOfProcessors;
+#else
+	int count = (int)sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+	return count > 0 ? count : 1;
+}
+
+static int getThreadIndex(JobSystem* jobs) {
+	return currentSystem == jobs ? currentIndex : 0;
+}
+
+/*
+ * Queues the ranges of a parallelFor. They are pushed in reverse, so the owner
+ * pops the first ranges and thieves take the last. Like all deque operations
+ * this holds the deque's lock throughout.
+ */
+static void pushRanges(JobDeque* deque, ParallelForFunc* func, void* data, int count, int chunkSize, int chunkCount, atomic_int* remaining) {
+	pthread_mutex_lock(&deque->lock);
+
+	if (deque->tail + chunkCount > deque->capacity) {
+		//Slide the live jobs back to the start before growing.
+		int live = deque->tail - deque->head;
+		for(int i = 0; i < live; i++)
+			deque->jobs[i] = deque->jobs[deque->head + i];
+		deque->head = 0;
+		deque->tail = live;
+
+		if (live + chunkCount > deque->capacity) {
+			while(deque->capacity < live + chunkCount)
+				deque->capacity = deque->capacity == 0 ? 64 : deque->capacity*2;
+			deque->jobs = realloc(deque->jobs, sizeof(Job)*deque->capacity);
+		}
+	}
+
+	for(int i = chunkCount-1; i >= 0; i--) {
+		Job* job = &deque->jobs[deque->tail++];
+		job->func = func;
+		job->data = data;
+		job->start = i*chunkSize;
+		job->end = job->start + chunkSize < count ? job->start + chunkSize : count;
+		job->remaining = remaining;
+	}
+
+	pthread_mutex_unlock(&deque->lock);
+}
+
+static bool popJob(JobDeque* deque, Job* job) {
+	bool found = false;
+
+	pthread_mutex_lock(&deque->lock);
+	if (deque->tail > deque->head) {
+		*job = deque->jobs[--deque->tail];
+		found = true;
+	}
+	if (deque->tail == deque->head)
+		deque->head = deque->tail = 0;
+	pthread_mutex_unlock(&deque->lock);
+
+	return found;
+}
+
+static bool stealJob(JobDeque* deque, Job* job) {
+	bool found = false;
+
+	pthread_mutex_lock(&deque->lock);
+	if (deque->tail > deque->head) {
+		*job = deque->jobs[deque->head++];
+		found = true;
+	}
+	pthread_mutex_unlock(&deque->lock);
+
+	return found;
+}
+
+/*
+ * Takes from the thread's own deque first, then steals from the others in turn.
+ */
+static bool takeJob(JobSystem* jobs, int index, Job* job) {
+	bool found = popJob(&jobs->deques[index], job);
+
+	for(int i = 1; !found && i < jobs->threadCount; i++)
+		found = stealJob(&jobs->deques[(index + i) % jobs->threadCount], job);
+
+	if (found)
+		atomic_fetch_sub_explicit(&jobs->pendingJobs, 1, memory_order_relaxed);
+
+	return found;
+}
+
+static void runJob(Job* job, int index) {
+	job->func(job->data, job->start, job->end, index);
+	atomic_fetch_sub_explicit(job->remaining, 1, memory_order_release);
+}
+
+static void* workerMain(void* arg) {
+	WorkerStart start = *(WorkerStart*)arg;
+	free(arg);
+
+	JobSystem* jobs = start.jobs;
+	currentSystem = jobs;
+	currentIndex = start.index;
+
+	while(atomic_load(&jobs->running)) {
+		Job job;
+		if (takeJob(jobs, start.index, &job)) {
+			runJob(&job, start.index);
+			continue;
+		}
+
+		pthread_mutex_lock(&jobs->sleepLock);
+		while(atomic_load(&jobs->running) && atomic_load(&jobs->pendingJobs) == 0)
+			pthread_cond_wait(&jobs->wake, &jobs->sleepLock);
+		pthread_mutex_unlock(&jobs->sleepLock);
+	}
+
+	return NULL;
+}
+
+static JobSystem* new(int threadCount) {
+	JobSystem* jobs = malloc(sizeof(JobSystem));
+
+	jobs->threadCount = threadCount > 0 ? threadCount : getHardwareThreadCount();
+	jobs->deques = malloc(sizeof(JobDeque)*jobs->threadCount);
+	jobs->threads = malloc(sizeof(pthread_t)*(jobs->threadCount > 1 ? jobs->threadCount-1 : 1));
+
+	for(int i = 0; i < jobs->threadCount; i++) {
+		pthread_mutex_init(&jobs->deques[i].lock, NULL);
+		jobs->deques[i].jobs = NULL;
+		jobs->deques[i].head = 0;
+		jobs->deques[i].tail = 0;
+		jobs->deques[i].capacity = 0;
+	}
+
+	atomic_init(&jobs->pendingJobs, 0);
+	atomic_init(&jobs->running, true);
+	pthread_mutex_init(&jobs->sleepLock, NULL);
+	pthread_cond_init(&jobs->wake, NULL);
+
+	for(int i = 1; i < jobs->threadCount; i++) {
+		WorkerStart* start = malloc(sizeof(WorkerStart));
+		start->jobs = jobs;
+		start->index = i;
+		pthread_create(&jobs->threads[i-1], NULL, workerMain, start);
+	}
+
+	return jobs;
+}
+
+static void parallelFor(JobSystem* jobs, int count, int chunkSize, ParallelForFunc* func, void* data) {
+	if (count <= 0)
+		return;
+
+	if (chunkSize < 1)
+		chunkSize = 1;
+
+	int chunkCount = (count + chunkSize - 1)/chunkSize;
+	if (jobs == NULL || jobs->threadCount == 1 || chunkCount == 1) {
+		func(data, 0, count, jobs == NULL ? 0 : getThreadIndex(jobs));
+		return;
+	}
+
+	int index = getThreadIndex(jobs);
+	atomic_int remaining;
+	atomic_init(&remaining, chunkCount);
+
+	pushRanges(&jobs->deques[index], func, data, count, chunkSize, chunkCount, &remaining);
+
+	atomic_fetch_add(&jobs->pendingJobs, chunkCount);
+	pthread_mutex_lock(&jobs->sleepLock);
+	pthread_cond_broadcast(&jobs->wake);
+	pthread_mutex_unlock(&jobs->sleepLock);
+
+	//Help out until every range is done, including ranges of other parallelFors.
+	while(atomic_load_explicit(&remaining, memory_order_acquire) > 0) {
+		Job job;
+		if (takeJob(jobs, index, &job))
+			runJob(&job, index);
+		else
+			sched_yield();
+	}
+}
+
+static int getThreadCount(JobSystem* jobs) {
+	return jobs == NULL ? 1 : jobs->threadCount;
+}
+
+static void delete(JobSystem* jobs) {
+	pthread_mutex_lock(&jobs->sleepLock);
+	atomic_store(&jobs->running, false);
+	pthread_cond_broadcast(&jobs->wake);
+	pthread_mutex_unlock(&jobs->sleepLock);
+
+	for(int i = 1; i < jobs->threadCount; i++)
+		pthread_join(jobs->threads[i-1], NULL);
+
+	for(int i = 0; i < jobs->threadCount; i++) {
+		pthread_mutex_destroy(&jobs->deques[i].lock);
+		free(jobs->deques[i].jobs);
+	}
+
+	pthread_mutex_destroy(&jobs->sleepLock);
+	pthread_cond_destroy(&jobs->wake);
+
+	free(jobs->deques);
+	free(jobs->threads);
+}
+
+const JobSystemManager manJobSystem = {new, getHardwareThreadCount, parallelFor, getThreadCount, delete};
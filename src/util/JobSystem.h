@@ -0,0 +1,119 @@
+#ifndef COH_JOBSYSTEM_H
+#define COH_JOBSYSTEM_H
+
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <pthread.h>
+
+/**
+ *	Work done by parallelFor, called with a range of indices to process.
+ *
+ * 	@param	data		pointer to void, the data given to parallelFor.
+ * 	@param	start		int, first index of the range.
+ * 	@param	end			int, one past the last index of the range.
+ * 	@param	threadIndex	int, index of the thread running the range, from 0 to threadCount-1.
+ * 						Ranges running at the same time always have different indices, so
+ * 						it can be used to pick a per-thread buffer.
+ */
+typedef void ParallelForFunc(void* data, int start, int end, int threadIndex);
+
+/**
+ *	A range of a parallelFor waiting to be run.
+ */
+typedef struct Job_s {
+	ParallelForFunc* func;
+	void* data;
+	int start;
+	int end;
+	/** Count of the parallelFor's ranges that haven't finished yet. **/
+	atomic_int* remaining;
+} Job;
+
+/**
+ *	One thread's queue of jobs. The owning thread pushes and pops at the tail,
+ * 	other threads steal from the head, so the oldest work is what gets stolen.
+ */
+typedef struct JobDeque_s {
+	pthread_mutex_t lock;
+	Job* jobs;
+	int head;
+	int tail;
+	int capacity;
+} JobDeque;
+
+/**
+ *	A fixed pool of worker threads with work stealing.
+ *
+ * 	The thread calling parallelFor counts as thread 0 and runs jobs too while it waits,
+ * 	so a system with threadCount 1 has no workers and runs everything inline.
+ */
+typedef struct JobSystem_s {
+	/** Number of threads work is spread across, including the calling thread. **/
+	int threadCount;
+	/** The worker threads, threadCount-1 long. **/
+	pthread_t* threads;
+	/** A deque per thread, indexed by thread index. **/
+	JobDeque* deques;
+
+	/** Jobs queued that no thread has taken yet, workers sleep while it is 0. **/
+	atomic_int pendingJobs;
+	atomic_bool running;
+	pthread_mutex_t sleepLock;
+	pthread_cond_t wake;
+} JobSystem;
+
+/**
+ *	Manager for job systems.
+ */
+typedef struct JobSystemManager_s {
+	/**
+	 *	Creates a job system and starts its worker threads.
+	 *
+	 * 	@param	threadCount	int, number of threads to use including the caller, 0 for one per hardware thread.
+	 * 	@return				pointer to JobSystem, the new job system.
+	 */
+	JobSystem*(* new)(int threadCount);
+
+	/**
+	 *	Gets the number of hardware threads available.
+	 *
+	 * 	@return	int, the number of hardware threads, at least 1.
+	 */
+	int(* getHardwareThreadCount)();
+
+	/**
+	 *	Splits [0, count) into ranges of chunkSize and runs func on them across the pool,
+	 * 	returning once every range is done. Any thread may call it, including from inside
+	 * 	a job, but only one thread outside the pool may use a system at a time.
+	 *
+	 * 	Ranges are always the same for the same count and chunkSize, only which thread runs
+	 * 	them changes, so work that writes its results by index gives the same results
+	 * 	whatever the thread count.
+	 *
+	 * 	@param	jobs		pointer to JobSystem, the system to use, or NULL to run func on the calling thread.
+	 * 	@param	count		int, number of indices.
+	 * 	@param	chunkSize	int, number of indices in each range.
+	 * 	@param	func		pointer to ParallelForFunc, the work to do.
+	 * 	@param	data		pointer to void, passed to func.
+	 */
+	void(* parallelFor)(JobSystem* jobs, int count, int chunkSize, ParallelForFunc* func, void* data);
+
+	/**
+	 *	Gets the number of threads a parallelFor on the given system can use.
+	 *
+	 * 	@param	jobs	pointer to JobSystem, the system, or NULL.
+	 * 	@return			int, the thread count, 1 if jobs is NULL.
+	 */
+	int(* getThreadCount)(JobSystem* jobs);
+
+	/**
+	 *	Stops and joins the worker threads and frees the system's memory, not including the system itself.
+	 *
+	 * 	@param	jobs	pointer to JobSystem to delete.
+	 */
+	void(* delete)(JobSystem* jobs);
+} JobSystemManager;
+
+extern const JobSystemManager manJobSystem;
+
+#endif
@@ -1,6 +1,18 @@
 #ifndef COH_MEMUTIL_H
 #define COH_MEMUTIL_H
 
+#include <stdint.h>
+
+/**
+ * Hints that the memory at address is about to be used, so loops following pointers can start
+ * fetching a few elements ahead. Does nothing where the compiler has no way to say it.
+ */
+#ifdef __GNUC__
+#define MEM_PREFETCH(address) __builtin_prefetch(address)
+#else
+#define MEM_PREFETCH(address) ((void)(address))
+#endif
+
 typedef struct MemUtil_s {
 	void** (* malloc2D)(uint64_t elementSize, uint64_t xCount, uint64_t yCount);
 	void (* free2D)(void** array, uint64_t xCount);
@@ -1,5 +1,19 @@
+#ifndef _WIN32
+#define _POSIX_C_SOURCE 200112L
+#endif
+
 #include "ObjLoader.h"
 
+#include <stdlib.h>
+#include <stdint.h>
+#include <sys/stat.h>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#endif
+
 #include "util/DynamicArray.h"
 #include "col/SAT.h"
 
@@ -270,17 +284,86 @@ static void loadObj(    const char *const filename,
                 } while (*handle != '\n');
             }
         }
+
+        fclose(ifp);
     } else {
         fprintf(stderr, "Can't open file '%s' for reading.", filename);
     }
+}
 
-    fclose(ifp);
+/*
+ * The name of the cooked file for an obj file, with the given extension: "meteor.col.obj" and "meteor.obj" both
+ * cook to "meteor.colbin". Returns false if it doesn't fit in COOKED_MAX_PATH characters.
+ */
+static bool getCookedFilename(const char *const filename, const char *const extension, char* cooked) {
+    size_t length = strlen(filename);
+    if (length >= 4 && strcmp(filename + length - 4, ".obj") == 0)
+        length -= 4;
+    if (length >= 4 && strncmp(filename + length - 4, ".col", 4) == 0)
+        length -= 4;
+
+    if (length + strlen(extension) >= COOKED_MAX_PATH)
+        return false;
+
+    memcpy(cooked, filename, length);
+    strcpy(cooked + length, extension);
+    return true;
 }
 
 /*
- *  Fill vertex buffer object and index buffer object with data from file.
+ * Maps a whole file into memory read only. Windows has no mmap, so there it is read into memory instead.
  */
-static void setupBuffers(VBO *vbo, GLuint ibo, VBO *positionVBO, VBO *normalVBO, VBO *texCoordVBO, const char *const filename, int *const numIndicesToDraw) {
+static const char* mapFile(const char *const filename, size_t* size) {
+#ifdef _WIN32
+    FILE* file = fopen(filename, "rb");
+    if (file == NULL)
+        return NULL;
+
+    char* data = NULL;
+    long length = -1;
+    if (fseek(file, 0, SEEK_END) == 0 && (length = ftell(file)) > 0 && fseek(file, 0, SEEK_SET) == 0) {
+        data = malloc(length);
+        if (fread(data, 1, length, file) != (size_t)length) {
+            free(data);
+            data = NULL;
+        }
+    }
+    fclose(file);
+
+    *size = length;
+    return data;
+#else
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0)
+        return NULL;
+
+    void* data = MAP_FAILED;
+    struct stat st;
+    if (fstat(fd, &st) == 0 && st.st_size > 0) {
+        *size = st.st_size;
+        data = mmap(NULL, *size, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    // The mapping stays valid after the file is closed.
+    close(fd);
+
+    return data != MAP_FAILED ? (const char*)data : NULL;
+#endif
+}
+
+static void unmapFile(const char* data, size_t size) {
+#ifdef _WIN32
+    free((char*)data);
+#else
+    munmap((void*)data, size);
+#endif
+}
+
+/*
+ *  Loads an obj file and expands its faces into one vertex per corner, three to a triangle, as they are drawn.
+ *  The vertices are zeroed where the obj has no data for them, and all of them are if it has no normals.
+ *  Returns the vertices, which the caller frees, and sets vertexCount.
+ */
+static GLVertex* buildVertices(const char *const filename, int *const vertexCount) {
     // Setup data structures for receiving information
     DynamicArray* vertices = manDynamicArray.new(100, sizeof(float));
     DynamicArray* normals = manDynamicArray.new(100, sizeof(float));
@@ -302,103 +385,46 @@ static void setupBuffers(VBO *vbo, GLuint ibo, VBO *positionVBO, VBO *normalVBO,
             &vertexStride, &normalStride, &texCoordStride, &vIndexStride, &nIndexStride, &tIndexStride);
 
     // Number of faces (triangles or quads) in object = number of indices / number of indices per face.
-    int numFaces = vIndices->size / vIndexStride;
-
-    *numIndicesToDraw = vIndices->size;
-
-    // Prepare OpenGL data structure
-    DynamicArray    *verticesInternal = manDynamicArray.new(vertices->size, sizeof(struct Vertex_s));
-    DynamicArray    *indicesInternal = manDynamicArray.new(vIndices->size, sizeof(unsigned int));
-
-    // Initialize verticesInternal array
-    struct Vertex_s *vvp = (struct Vertex_s *) calloc(1, sizeof(struct Vertex_s));
-    for (int i = 0; i < vIndices->size; ++i) {
-        manDynamicArray.append(verticesInternal, vvp);
-    }
-    struct Vertex_s *vp = (struct Vertex_s *) manDynamicArray.get(verticesInternal, 0);
-
-    // Initialize indicesInternal array
-    unsigned int *iip = (unsigned int *) calloc(1, sizeof(unsigned int));
-    for (int i = 0; i < vIndices->size; ++i) {
-        manDynamicArray.append(indicesInternal, iip);
-    }
-    unsigned int *ip = (unsigned int *) manDynamicArray.get(indicesInternal, 0);
-
-    for (int j = 0, i = 0; i < numFaces; ++i) {
-        // If object has normals, use normals
-        if (normals->size > 0) {
-            if (vertexStride != 0) {
-                (*(struct Vertex_s *)manDynamicArray.get(verticesInternal, j)).x = *(float*)manDynamicArray.get(vertices, *(int*)manDynamicArray.get(vIndices, i * vIndexStride) * vertexStride);
-                (*(struct Vertex_s *)manDynamicArray.get(verticesInternal, j)).y = *(float*)manDynamicArray.get(vertices, *(int*)manDynamicArray.get(vIndices, i * vIndexStride) * vertexStride + 1);
-                (*(struct Vertex_s *)manDynamicArray.get(verticesInternal, j)).z = *(float*)manDynamicArray.get(vertices, *(int*)manDynamicArray.get(vIndices, i * vIndexStride) * vertexStride + 2);
-            }
-            if (normalStride != 0) {
-                (*(struct Vertex_s *)manDynamicArray.get(verticesInternal, j)).nx = *(float*)manDynamicArray.get(normals, *(int*)manDynamicArray.get(nIndices, i * nIndexStride) * normalStride);
-                (*(struct Vertex_s *)manDynamicArray.get(verticesInternal, j)).ny = *(float*)manDynamicArray.get(normals, *(int*)manDynamicArray.get(nIndices, i * nIndexStride) * normalStride + 1);
-                (*(struct Vertex_s *)manDynamicArray.get(verticesInternal, j)).nz = *(float*)manDynamicArray.get(normals, *(int*)manDynamicArray.get(nIndices, i * nIndexStride) * normalStride + 2);
-            }
-            if (texCoordStride != 0) {
-                (*(struct Vertex_s *)manDynamicArray.get(verticesInternal, j)).u = *(float*)manDynamicArray.get(texCoords, *(int*)manDynamicArray.get(tIndices, i * tIndexStride) * texCoordStride);
-                (*(struct Vertex_s *)manDynamicArray.get(verticesInternal, j)).v = *(float*)manDynamicArray.get(texCoords, *(int*)manDynamicArray.get(tIndices, i * tIndexStride) * texCoordStride + 1);
-            }
-            (*(unsigned int *)manDynamicArray.get(indicesInternal, j)) = j;
-            ++j;
-
-            if (vertexStride != 0) {
-                (*(struct Vertex_s *)manDynamicArray.get(verticesInternal, j)).x = *(float*)manDynamicArray.get(vertices, *(int*)manDynamicArray.get(vIndices, i * vIndexStride + 1) * vertexStride);
-                (*(struct Vertex_s *)manDynamicArray.get(verticesInternal, j)).y = *(float*)manDynamicArray.get(vertices, *(int*)manDynamicArray.get(vIndices, i * vIndexStride + 1) * vertexStride + 1);
-                (*(struct Vertex_s *)manDynamicArray.get(verticesInternal, j)).z = *(float*)manDynamicArray.get(vertices, *(int*)manDynamicArray.get(vIndices, i * vIndexStride + 1) * vertexStride + 2);
-            }
-            if (normalStride != 0) {
-                (*(struct Vertex_s *)manDynamicArray.get(verticesInternal, j)).nx = *(float*)manDynamicArray.get(normals, *(int*)manDynamicArray.get(nIndices, i * nIndexStride + 1) * normalStride);
-                (*(struct Vertex_s *)manDynamicArray.get(verticesInternal, j)).ny = *(float*)manDynamicArray.get(normals, *(int*)manDynamicArray.get(nIndices, i * nIndexStride + 1) * normalStride + 1);
-                (*(struct Vertex_s *)manDynamicArray.get(verticesInternal, j)).nz = *(float*)manDynamicArray.get(normals, *(int*)manDynamicArray.get(nIndices, i * nIndexStride + 1) * normalStride + 2);
-            }
-            if (texCoordStride != 0) {
-                (*(struct Vertex_s *)manDynamicArray.get(verticesInternal, j)).u = *(float*)manDynamicArray.get(texCoords, *(int*)manDynamicArray.get(tIndices, i * tIndexStride + 1) * texCoordStride);
-                (*(struct Vertex_s *)manDynamicArray.get(verticesInternal, j)).v = *(float*)manDynamicArray.get(texCoords, *(int*)manDynamicArray.get(tIndices, i * tIndexStride + 1) * texCoordStride + 1);
-            }
-            (*(unsigned int *)manDynamicArray.get(indicesInternal, j)) = j;
-            ++j;
-
-
-            if (vertexStride != 0) {
-                (*(struct Vertex_s *)manDynamicArray.get(verticesInternal, j)).x = *(float*)manDynamicArray.get(vertices, *(int*)manDynamicArray.get(vIndices, i * vIndexStride + 2) * vertexStride);
-                (*(struct Vertex_s *)manDynamicArray.get(verticesInternal, j)).y = *(float*)manDynamicArray.get(vertices, *(int*)manDynamicArray.get(vIndices, i * vIndexStride + 2) * vertexStride + 1);
-                (*(struct Vertex_s *)manDynamicArray.get(verticesInternal, j)).z = *(float*)manDynamicArray.get(vertices, *(int*)manDynamicArray.get(vIndices, i * vIndexStride + 2) * vertexStride + 2);
-            }
-            if (normalStride != 0) {
-                (*(struct Vertex_s *)manDynamicArray.get(verticesInternal, j)).nx = *(float*)manDynamicArray.get(normals, *(int*)manDynamicArray.get(nIndices, i * nIndexStride + 2) * normalStride);
-                (*(struct Vertex_s *)manDynamicArray.get(verticesInternal, j)).ny = *(float*)manDynamicArray.get(normals, *(int*)manDynamicArray.get(nIndices, i * nIndexStride + 2) * normalStride + 1);
-                (*(struct Vertex_s *)manDynamicArray.get(verticesInternal, j)).nz = *(float*)manDynamicArray.get(normals, *(int*)manDynamicArray.get(nIndices, i * nIndexStride + 2) * normalStride + 2);
-            }
-            if (texCoordStride != 0) {
-                (*(struct Vertex_s *)manDynamicArray.get(verticesInternal, j)).u = *(float*)manDynamicArray.get(texCoords, *(int*)manDynamicArray.get(tIndices, i * tIndexStride + 2) * texCoordStride);
-                (*(struct Vertex_s *)manDynamicArray.get(verticesInternal, j)).v = *(float*)manDynamicArray.get(texCoords, *(int*)manDynamicArray.get(tIndices, i * tIndexStride + 2) * texCoordStride + 1);
+    int numFaces = vIndexStride > 0 ? vIndices->size / vIndexStride : 0;
+
+    *vertexCount = vIndices->size;
+    GLVertex *result = (GLVertex *) calloc(vIndices->size > 0 ? vIndices->size : 1, sizeof(GLVertex));
+
+    // Read the arrays directly, this runs for every corner of every face.
+    const float *vp = (const float *) vertices->contents;
+    const float *np = (const float *) normals->contents;
+    const float *tp = (const float *) texCoords->contents;
+    const int *vip = (const int *) vIndices->contents;
+    const int *nip = (const int *) nIndices->contents;
+    const int *tip = (const int *) tIndices->contents;
+
+    // If object has normals, use normals
+    if (normals->size > 0) {
+        for (int j = 0, i = 0; i < numFaces; ++i) {
+            for (int corner = 0; corner < 3; ++corner, ++j) {
+                GLVertex *out = &result[j];
+
+                if (vertexStride != 0) {
+                    const float *position = vp + vip[i * vIndexStride + corner] * vertexStride;
+                    out->x = position[0];
+                    out->y = position[1];
+                    out->z = position[2];
+                }
+                if (normalStride != 0) {
+                    const float *normal = np + nip[i * nIndexStride + corner] * normalStride;
+                    out->nx = normal[0];
+                    out->ny = normal[1];
+                    out->nz = normal[2];
+                }
+                if (texCoordStride != 0) {
+                    const float *texCoord = tp + tip[i * tIndexStride + corner] * texCoordStride;
+                    out->u = texCoord[0];
+                    out->v = texCoord[1];
+                }
             }
-            (*(unsigned int *)manDynamicArray.get(indicesInternal, j)) = j;
-            ++j;
         }
     }
 
-    manVBO.setData(vbo, vp, vIndices->size*sizeof(struct Vertex_s), GL_STATIC_DRAW);
-
-    manVBO.setData(positionVBO, vp, vIndices->size*sizeof(struct Vertex_s), GL_STATIC_DRAW);
-    manVBO.setRenderInfo(positionVBO, vIndices->size, 3, sizeof(struct Vertex_s), 0);
-
-    manVBO.setData(normalVBO, vp, vIndices->size*sizeof(struct Vertex_s), GL_STATIC_DRAW);
-    manVBO.setRenderInfo(normalVBO, vIndices->size, 3, sizeof(struct Vertex_s), (char *)NULL + sizeof(float)*3);
-
-    manVBO.setData(texCoordVBO, vp, vIndices->size*sizeof(struct Vertex_s), GL_STATIC_DRAW);
-    manVBO.setRenderInfo(texCoordVBO, vIndices->size, 2, sizeof(struct Vertex_s), (char *)NULL + sizeof(float)*6);
-
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, vIndices->size*sizeof(unsigned int), ip, GL_STATIC_DRAW);
-
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
-
-    manDynamicArray.delete(verticesInternal);
-    manDynamicArray.delete(indicesInternal);
     manDynamicArray.delete(vertices);
     manDynamicArray.delete(normals);
     manDynamicArray.delete(texCoords);
@@ -406,8 +432,6 @@ static void setupBuffers(VBO *vbo, GLuint ibo, VBO *positionVBO, VBO *normalVBO,
     manDynamicArray.delete(nIndices);
     manDynamicArray.delete(tIndices);
 
-    free(verticesInternal);
-    free(indicesInternal);
     free(vertices);
     free(normals);
     free(texCoords);
@@ -415,47 +439,140 @@ static void setupBuffers(VBO *vbo, GLuint ibo, VBO *positionVBO, VBO *normalVBO,
     free(nIndices);
     free(tIndices);
 
-    free(vvp);
-    free(iip);
+    return result;
 }
 
-static VAO *genVAOFromFile(const char *const filename, int vertexLocation, int normalLocation, int texcoordLocation) {
-    // GLuint vao, ibo;
-    GLuint ibo;
-    VAO *vao = manVAO.new();
-    VBO *vbo = manVBO.new();
-    VBO *positionVBO = manVBO.new();
-    VBO *normalVBO = manVBO.new();
-    VBO *texCoordVBO = manVBO.new();
-    int numIndicesToDraw;
+/*
+ *  Header of a .meshbin file, a mesh cooked by cookMesh. The vertices follow it, exactly as they are uploaded,
+ *  in the machine's byte order.
+ */
+typedef struct MeshbinHeader_s {
+    char magic[4];
+    int32_t version;
+    int32_t vertexSize;
+    int32_t vertexCount;
+} MeshbinHeader;
+
+static bool loadMeshBinary(const char *const filename, MeshUploadFunc* upload, void* data) {
+    size_t size;
+    const char* file = mapFile(filename, &size);
+    if (file == NULL)
+        return false;
+
+    // The vertices aren't looked at, only the sizes are checked.
+    const MeshbinHeader* header = (const MeshbinHeader*)file;
+    bool valid = size >= sizeof(MeshbinHeader) && memcmp(header->magic, MESHBIN_FILE_MAGIC, 4) == 0 && header->version == MESHBIN_FILE_VERSION &&
+                 header->vertexSize == sizeof(GLVertex) && header->vertexCount > 0 &&
+                 size == sizeof(MeshbinHeader) + (size_t)header->vertexCount*sizeof(GLVertex);
+    if (valid)
+        upload(data, (const GLVertex*)(file + sizeof(MeshbinHeader)), header->vertexCount);
+
+    unmapFile(file, size);
+    return valid;
+}
+
+static bool loadMesh(const char *const filename, MeshUploadFunc* upload, void* data) {
+    // Use the cooked mesh if there is one, the vertices are uploaded straight from the file.
+    char cooked[COOKED_MAX_PATH];
+    if (getCookedFilename(filename, ".meshbin", cooked) && loadMeshBinary(cooked, upload, data))
+        return true;
+
+    int vertexCount;
+    GLVertex* vertices = buildVertices(filename, &vertexCount);
+    if (vertexCount > 0)
+        upload(data, vertices, vertexCount);
+    free(vertices);
+
+    return vertexCount > 0;
+}
+
+static bool cookMesh(const char *const objFilename, const char *const meshbinFilename) {
+    char cooked[COOKED_MAX_PATH];
+    const char* path = meshbinFilename;
+    if (path == NULL) {
+        if (!getCookedFilename(objFilename, ".meshbin", cooked))
+            return false;
+        path = cooked;
+    }
+
+    int vertexCount;
+    GLVertex* vertices = buildVertices(objFilename, &vertexCount);
+
+    MeshbinHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, MESHBIN_FILE_MAGIC, 4);
+    header.version = MESHBIN_FILE_VERSION;
+    header.vertexSize = sizeof(GLVertex);
+    header.vertexCount = vertexCount;
+
+    // A missing or empty obj has nothing to draw, so isn't worth writing.
+    bool written = false;
+    FILE* file = vertexCount > 0 ? fopen(path, "wb") : NULL;
+    if (file != NULL) {
+        written = fwrite(&header, sizeof(header), 1, file) == 1 &&
+                  fwrite(vertices, sizeof(GLVertex), vertexCount, file) == vertexCount;
+
+        written = (fclose(file) == 0) && written;
+        if (!written)
+            remove(path);
+    }
+
+    free(vertices);
+
+    return written;
+}
 
-    // Generate ibo buffer
-    glGenBuffers(1, &ibo);
+/*
+ *  Where genVAOFromFile wants its mesh.
+ */
+typedef struct VAOUpload_s {
+    VAO *vao;
+    int vertexLocation;
+    int normalLocation;
+    int texcoordLocation;
+} VAOUpload;
 
-    // Fill buffers with data
-    setupBuffers(vbo, ibo, positionVBO, normalVBO, texCoordVBO, filename, &numIndicesToDraw);
+/*
+ *  Fill one vertex buffer object with the vertices, and point the VAO's position, normal and texCoord at it.
+ */
+static void uploadToVAO(void* data, const GLVertex* vertices, int vertexCount) {
+    VAOUpload *upload = (VAOUpload *) data;
+    VBO *vbo = manVBO.new();
 
-    manVAO.setRenderInfo(vao, numIndicesToDraw);
+    manVBO.setData(vbo, (void *) vertices, vertexCount*sizeof(GLVertex), GL_STATIC_DRAW);
+    manVAO.setRenderInfo(upload->vao, vertexCount);
 
     // Let VAO know where data is in vbo
     // position
-    manVAO.attachVBO(vao, positionVBO, vertexLocation, GL_FLOAT);
+    manVBO.setRenderInfo(vbo, vertexCount, 3, sizeof(GLVertex), 0);
+    manVAO.attachVBO(upload->vao, vbo, upload->vertexLocation, GL_FLOAT);
 
     // normal
-    manVAO.attachVBO(vao, normalVBO, normalLocation, GL_FLOAT);
+    manVBO.setRenderInfo(vbo, vertexCount, 3, sizeof(GLVertex), (char *)NULL + sizeof(float)*3);
+    manVAO.attachVBO(upload->vao, vbo, upload->normalLocation, GL_FLOAT);
 
     // texCoord
-    manVAO.attachVBO(vao, texCoordVBO, texcoordLocation, GL_FLOAT);
+    manVBO.setRenderInfo(vbo, vertexCount, 2, sizeof(GLVertex), (char *)NULL + sizeof(float)*6);
+    manVAO.attachVBO(upload->vao, vbo, upload->texcoordLocation, GL_FLOAT);
 
     free(vbo);
-    free(positionVBO);
-    free(normalVBO);
-    free(texCoordVBO);
+}
+
+static VAO *genVAOFromFile(const char *const filename, int vertexLocation, int normalLocation, int texcoordLocation) {
+    VAOUpload upload = {manVAO.new(), vertexLocation, normalLocation, texcoordLocation};
+    manVAO.setRenderInfo(upload.vao, 0);
 
-    return vao;
+    loadMesh(filename, uploadToVAO, &upload);
+
+    return upload.vao;
 }
 
-static PhysicsCollider* loadCollisionMesh(const char *const filename, Vec3* position, Vec3* rotation, Vec3* scale, Vec3* velocity) {
+/*
+ * Builds the optimised collision mesh for an obj file: normals that are the same axis as another are dropped,
+ * and only the vertices at the min or max along some remaining normal are kept. Also finds the bounding sphere
+ * around the origin and builds the hull adjacency.
+ */
+static ColliderSimpleMesh* buildCollisionMesh(const char *const filename, Vec3* center, scalar* radius) {
     // Setup data structures for receiving information
     DynamicArray* vertices = manDynamicArray.new(100, sizeof(float));
     DynamicArray* normals = manDynamicArray.new(100, sizeof(float));
@@ -504,6 +621,8 @@ static PhysicsCollider* loadCollisionMesh(const char *const filename, Vec3* posi
     tmpMesh.norms = (Vec3*)optiNorms->contents;
     tmpMesh.vCount = verts->size;
     tmpMesh.verts = (Vec3*)verts->contents;
+    tmpMesh.adjacencyStart = NULL;
+    tmpMesh.adjacency = NULL;
 
     DynamicArray* optiVerts = manDynamicArray.new(1, sizeof(Vec3));
     int* minPoints = malloc(sizeof(int)*optiNorms->size);
@@ -551,28 +670,283 @@ static PhysicsCollider* loadCollisionMesh(const char *const filename, Vec3* posi
     manDynamicArray.delete(vertices);
     manDynamicArray.delete(normals);
 
-    Vec3 center = manVec3.create(NULL, 0,0,0);
-    scalar radius = 0;
+    *center = manVec3.create(NULL, 0,0,0);
+    *radius = 0;
     for(int i = 0; i < optiVerts->size; i++) {
     	Vec3* vert = (Vec3*)manDynamicArray.get(optiVerts, i);
-    	Vec3 dispVec = manVec3.sub(vert, &center);
+    	Vec3 dispVec = manVec3.sub(vert, center);
     	scalar dist = manVec3.magnitude(&dispVec);
-    	if (dist>radius)
-    		radius = dist;
+    	if (dist>*radius)
+    		*radius = dist;
     }
 
-
-    PhysicsCollider* result = manPhysCollider.new(position, rotation, scale, velocity, NULL);
     ColliderSimpleMesh* colMesh = manColMesh.newSimpleMesh(optiVerts->size, (Vec3*)optiVerts->contents, optiNorms->size, (Vec3*)optiNorms->contents, minPoints, maxPoints);
-    manPhysCollider.attachNarrowphaseSimpleMesh(result, colMesh);
-    manPhysCollider.setBroadphase(result, &center, radius);
+    manColMesh.buildAdjacency(colMesh);
 
     free(optiNorms);
     free(optiVerts);
 
+    return colMesh;
+}
+
+/*
+ * Header of a .colbin file, a collision mesh cooked by cookCollisionMesh. The mesh follows it laid out as
+ * ColliderSimpleMesh uses it: the vertices, the normals, the min point for each normal, the max point for each
+ * normal, then if the hull was built the vertCount+1 adjacency starts and the adjacency. Everything is in the
+ * machine's byte order.
+ */
+typedef struct ColbinHeader_s {
+    char magic[4];
+    int32_t version;
+    int32_t scalarSize;
+    int32_t vertCount;
+    int32_t normCount;
+    /* Number of adjacency entries, 0 if the hull wasn't built. */
+    int32_t adjacencyCount;
+    Vec3 center;
+    scalar radius;
+} ColbinHeader;
+
+/*
+ * Size in bytes of the .colbin file the header describes.
+ */
+static size_t getColbinSize(const ColbinHeader* header) {
+    size_t size = sizeof(ColbinHeader) + ((size_t)header->vertCount + header->normCount)*sizeof(Vec3) + (size_t)header->normCount*2*sizeof(int);
+    if (header->adjacencyCount > 0)
+        size += ((size_t)header->vertCount + 1 + header->adjacencyCount)*sizeof(int);
+    return size;
+}
+
+/*
+ * A .colbin mapped by loadCollisionMeshBinary, and which file was at the path then. The meshes loaded from it point
+ * into the mapping, so it is never unmapped.
+ */
+typedef struct ColbinMapping_s {
+    char path[COOKED_MAX_PATH];
+    struct stat file;
+    const char* data;
+} ColbinMapping;
+
+/*
+ * The mapping of each .colbin loaded so far, so loading the same mesh again, as each asteroid does, maps and checks
+ * the file only once. Not locked, meshes are loaded on the main thread.
+ */
+static DynamicArray* colbinMappings = NULL;
+
+static bool sameFile(const struct stat* a, const struct stat* b) {
+    return a->st_dev == b->st_dev && a->st_ino == b->st_ino && a->st_size == b->st_size && a->st_mtime == b->st_mtime;
+}
+
+/*
+ * The entry for a path, or NULL if it hasn't been loaded or is too long to keep.
+ */
+static ColbinMapping* findColbinMapping(const char *const filename) {
+    for(int i = 0; colbinMappings != NULL && i < (int)colbinMappings->size; i++) {
+        ColbinMapping* mapping = (ColbinMapping*)manDynamicArray.get(colbinMappings, i);
+        if (strcmp(mapping->path, filename) == 0)
+            return mapping;
+    }
+    return NULL;
+}
+
+/*
+ * Keeps the mapping of the file at a path, replacing the one for a file that was there before.
+ */
+static void keepColbinMapping(const char *const filename, const struct stat* file, const char* data) {
+    // Longer paths aren't worth a bigger entry, they are just mapped on every load.
+    if (strlen(filename) >= COOKED_MAX_PATH)
+        return;
+
+    ColbinMapping* mapping = findColbinMapping(filename);
+    if (mapping == NULL) {
+        if (colbinMappings == NULL)
+            colbinMappings = manDynamicArray.new(4, sizeof(ColbinMapping));
+
+        ColbinMapping added;
+        strcpy(added.path, filename);
+        manDynamicArray.append(colbinMappings, &added);
+        mapping = (ColbinMapping*)manDynamicArray.get(colbinMappings, colbinMappings->size - 1);
+    }
+
+    mapping->file = *file;
+    mapping->data = data;
+}
+
+/*
+ * Points mesh into the contents of a .colbin whose sizes have been checked.
+ */
+static void getColbinMesh(const ColbinHeader* header, ColliderSimpleMesh* mesh) {
+    const char* contents = (const char*)header + sizeof(ColbinHeader);
+    mesh->satMesh.vCount = header->vertCount;
+    mesh->satMesh.verts = (Vec3*)contents;
+    contents += header->vertCount*sizeof(Vec3);
+    mesh->satMesh.nCount = header->normCount;
+    mesh->satMesh.norms = (Vec3*)contents;
+    contents += header->normCount*sizeof(Vec3);
+    mesh->minPointForAxis = (int*)contents;
+    contents += header->normCount*sizeof(int);
+    mesh->maxPointForAxis = (int*)contents;
+    contents += header->normCount*sizeof(int);
+    mesh->satMesh.adjacencyStart = NULL;
+    mesh->satMesh.adjacency = NULL;
+    if (header->adjacencyCount > 0) {
+        mesh->satMesh.adjacencyStart = (int*)contents;
+        contents += (header->vertCount + 1)*sizeof(int);
+        mesh->satMesh.adjacency = (int*)contents;
+    }
+}
+
+/*
+ * Checks every index in a .colbin's mesh is one of its vertices, and that the adjacency starts run in order
+ * from 0 to the number of adjacency entries, so nothing reading the mesh can be sent outside the file.
+ */
+static bool validColbinIndices(const ColliderSimpleMesh* mesh, int adjacencyCount) {
+    const SATMesh* satMesh = &mesh->satMesh;
+    for(int i = 0; i < satMesh->nCount; i++) {
+        if ((unsigned)mesh->minPointForAxis[i] >= (unsigned)satMesh->vCount || (unsigned)mesh->maxPointForAxis[i] >= (unsigned)satMesh->vCount)
+            return false;
+    }
+
+    if (adjacencyCount == 0)
+        return true;
+
+    if (satMesh->adjacencyStart[0] != 0 || satMesh->adjacencyStart[satMesh->vCount] != adjacencyCount)
+        return false;
+    for(int i = 0; i < satMesh->vCount; i++) {
+        if (satMesh->adjacencyStart[i] > satMesh->adjacencyStart[i + 1])
+            return false;
+    }
+    for(int i = 0; i < adjacencyCount; i++) {
+        if ((unsigned)satMesh->adjacency[i] >= (unsigned)satMesh->vCount)
+            return false;
+    }
+
+    return true;
+}
+
+static PhysicsCollider* loadCollisionMeshBinary(const char *const filename, Vec3* position, Vec3* rotation, Vec3* scale, Vec3* velocity) {
+    // The file is only mapped and checked again if a different one is at the path now.
+    struct stat file;
+    if (stat(filename, &file) != 0)
+        return NULL;
+
+    ColliderSimpleMesh mesh;
+    ColbinMapping* mapping = findColbinMapping(filename);
+    const char* data = (mapping != NULL && sameFile(&mapping->file, &file)) ? mapping->data : NULL;
+    if (data != NULL) {
+        getColbinMesh((const ColbinHeader*)data, &mesh);
+    } else {
+        size_t size;
+        data = mapFile(filename, &size);
+        if (data == NULL)
+            return NULL;
+
+        // The vertices and normals are used as they are, but the sizes and indices are checked.
+        const ColbinHeader* header = (const ColbinHeader*)data;
+        bool valid = size >= sizeof(ColbinHeader) && memcmp(header->magic, COLBIN_FILE_MAGIC, 4) == 0 && header->version == COLBIN_FILE_VERSION &&
+                     header->scalarSize == sizeof(scalar) && header->vertCount > 0 && header->normCount >= 0 && header->adjacencyCount >= 0 &&
+                     size == getColbinSize(header);
+        if (valid) {
+            getColbinMesh(header, &mesh);
+            valid = validColbinIndices(&mesh, header->adjacencyCount);
+        }
+        if (!valid) {
+            unmapFile(data, size);
+            return NULL;
+        }
+
+        keepColbinMapping(filename, &file, data);
+    }
+
+    const ColbinHeader* header = (const ColbinHeader*)data;
+    Vec3 center = header->center;
+    PhysicsCollider* result = manPhysCollider.new(position, rotation, scale, velocity, NULL);
+    manPhysCollider.attachNarrowphaseSimpleMesh(result, &mesh);
+    manPhysCollider.setBroadphase(result, &center, header->radius);
+
     return result;
 }
 
 
+static PhysicsCollider* loadCollisionMesh(const char *const filename, Vec3* position, Vec3* rotation, Vec3* scale, Vec3* velocity) {
+    // Use the cooked mesh if there is one, it needs no parsing or optimising.
+    char cooked[COOKED_MAX_PATH];
+    if (getCookedFilename(filename, ".colbin", cooked)) {
+        PhysicsCollider* result = loadCollisionMeshBinary(cooked, position, rotation, scale, velocity);
+        if (result != NULL)
+            return result;
+    }
+
+    Vec3 center;
+    scalar radius;
+    ColliderSimpleMesh* colMesh = buildCollisionMesh(filename, &center, &radius);
+
+    PhysicsCollider* result = manPhysCollider.new(position, rotation, scale, velocity, NULL);
+    manPhysCollider.attachNarrowphaseSimpleMesh(result, colMesh);
+    manPhysCollider.setBroadphase(result, &center, radius);
+    free(colMesh);
+
+    return result;
+}
+
+
+
+static bool cookCollisionMesh(const char *const objFilename, const char *const colbinFilename) {
+    char cooked[COOKED_MAX_PATH];
+    const char* path = colbinFilename;
+    if (path == NULL) {
+        if (!getCookedFilename(objFilename, ".colbin", cooked))
+            return false;
+        path = cooked;
+    }
+
+    ColbinHeader header;
+    memset(&header, 0, sizeof(header));
+    ColliderSimpleMesh* colMesh = buildCollisionMesh(objFilename, &header.center, &header.radius);
+    SATMesh* satMesh = &colMesh->satMesh;
+
+    memcpy(header.magic, COLBIN_FILE_MAGIC, 4);
+    header.version = COLBIN_FILE_VERSION;
+    header.scalarSize = sizeof(scalar);
+    header.vertCount = satMesh->vCount;
+    header.normCount = satMesh->nCount;
+    header.adjacencyCount = satMesh->adjacencyStart != NULL ? satMesh->adjacencyStart[satMesh->vCount] : 0;
+
+    // Written beside the old file then renamed over it, so meshes loaded from the old file's mapping stay valid.
+    char temporary[COOKED_MAX_PATH + 4];
+    bool named = snprintf(temporary, sizeof(temporary), "%s.tmp", path) < (int)sizeof(temporary);
+
+    // A missing or empty obj gives a mesh without vertices, which isn't worth writing.
+    bool written = false;
+    FILE* file = (named && satMesh->vCount > 0) ? fopen(temporary, "wb") : NULL;
+    if (file != NULL) {
+        size_t nCount = satMesh->nCount;
+        written = fwrite(&header, sizeof(header), 1, file) == 1 &&
+                  fwrite(satMesh->verts, sizeof(Vec3), satMesh->vCount, file) == satMesh->vCount &&
+                  fwrite(satMesh->norms, sizeof(Vec3), nCount, file) == nCount &&
+                  fwrite(colMesh->minPointForAxis, sizeof(int), nCount, file) == nCount &&
+                  fwrite(colMesh->maxPointForAxis, sizeof(int), nCount, file) == nCount;
+        if (header.adjacencyCount > 0) {
+            written = written && fwrite(satMesh->adjacencyStart, sizeof(int), satMesh->vCount + 1, file) == satMesh->vCount + 1 &&
+                      fwrite(satMesh->adjacency, sizeof(int), header.adjacencyCount, file) == header.adjacencyCount;
+        }
+
+        written = (fclose(file) == 0) && written;
+        if (written) {
+#ifdef _WIN32
+            // Windows won't rename over a file. Its loads read the file rather than map it, so nothing points into it.
+            remove(path);
+#endif
+            written = rename(temporary, path) == 0;
+        }
+        if (!written)
+            remove(temporary);
+    }
+
+    manColMesh.deleteSimpleMesh(colMesh);
+    free(colMesh);
+
+    return written;
+}
 
-const ObjLoader objLoader = {loadObj, genVAOFromFile, loadCollisionMesh};
+const ObjLoader objLoader = {loadObj, genVAOFromFile, loadCollisionMesh, loadCollisionMeshBinary, cookCollisionMesh, loadMesh, loadMeshBinary, cookMesh};
@@ -11,6 +11,34 @@
 #include "lib/ogl.h"
 #include "gl/EAB.h"
 
+/** First bytes of a cooked collision mesh (.colbin) file. **/
+#define COLBIN_FILE_MAGIC "COHC"
+#define COLBIN_FILE_VERSION 1
+/** First bytes of a cooked render mesh (.meshbin) file. **/
+#define MESHBIN_FILE_MAGIC "COHM"
+#define MESHBIN_FILE_VERSION 1
+/** Longest path, including the terminator, loadCollisionMesh and loadMesh will look for a cooked file at. **/
+#define COOKED_MAX_PATH 1024
+
+/**
+ *  Internal representation of a vertex in OpenGL.
+ */
+typedef struct Vertex_s {
+    GLfloat     x, y, z;
+    GLfloat     nx, ny, nz;
+    GLfloat     u, v;
+    GLfloat     padding[4];
+} GLVertex;
+
+/**
+ *  Takes a loaded mesh's vertices, to put them on the GPU.
+ *
+ *  @param  data        pointer to void, the data given to loadMesh.
+ *  @param  vertices    const pointer to const GLVertex, three to a triangle, drawn in order. Only valid during the call.
+ *  @param  vertexCount int, the number of vertices, more than 0.
+ */
+typedef void MeshUploadFunc(void* data, const GLVertex* vertices, int vertexCount);
+
 /**
  *  Singleton used for loading .obj files.
  */
@@ -41,6 +69,7 @@ typedef struct ObjLoader_s {
                         int *vIndexStride, int *nIndexStride, int *tIndexStride);
     /**
      *  Loads an obj file, sets up the appropriate VBOs and returns a 'ready-to-go' VAO.
+     *  The mesh is loaded with loadMesh, so a cooked .meshbin is used if there is one.
      *
      *  @param  filename            const pointer to const char, path to file.
      *  @param  numIndicesToDraw    const pointer to int, when function returns, will contain the number
@@ -52,6 +81,8 @@ typedef struct ObjLoader_s {
     /**
      * Loads a simple collision mesh from a obj file.
      * Calculates the broadphase params as well.
+     * If the mesh has been cooked by cookCollisionMesh to its default name next to the obj,
+     * the cooked mesh is loaded instead (see loadCollisionMeshBinary), so it must be cooked again after the obj changes.
      *
      * @param filename const pointer to const char, path to file.
      * @param position The vec3 to be used for positioning.
@@ -62,6 +93,69 @@ typedef struct ObjLoader_s {
      */
     PhysicsCollider*(* loadCollisionMesh)(const char *const filename, Vec3* position, Vec3* rotation, Vec3* scale, Vec3* velocity);
 
+    /**
+     * Loads a collision mesh cooked by cookCollisionMesh. The file is mapped into memory and the mesh
+     * points straight into it, nothing is parsed or recomputed, though every index in it is checked to
+     * be one of its vertices. The mapping belongs to the loader: it is read only, shared by every mesh
+     * loaded from the same path until a different file is put there, and lives as long as the program,
+     * so the mesh must not be changed or passed to deleteSimpleMesh. Not thread safe.
+     *
+     * @param filename const pointer to const char, path to the .colbin file.
+     * @param position The vec3 to be used for positioning.
+     * @param rotation The vec3 to be used for rotation.
+     * @param scale The vec3 to be used for scaling.
+     * @param velocity The vec3 to be used for velocity.
+     * @return The collider, or NULL if the file could not be read, isn't a .colbin of this version,
+     *         has an index outside its vertices, or was cooked by a build with a different scalar.
+     */
+    PhysicsCollider*(* loadCollisionMeshBinary)(const char *const filename, Vec3* position, Vec3* rotation, Vec3* scale, Vec3* velocity);
+
+    /**
+     * Builds the collision mesh for an obj file, as loadCollisionMesh does, and writes it with its
+     * bounding sphere and hull adjacency to a .colbin file for loadCollisionMeshBinary. Any file already
+     * there is replaced rather than written over, so meshes loaded from it are unaffected.
+     *
+     * @param objFilename const pointer to const char, path to the obj file.
+     * @param colbinFilename const pointer to const char, path to write to, or NULL for the name
+     *                       loadCollisionMesh looks for: "meteor.col.obj" cooks to "meteor.colbin".
+     * @return false if the obj has no vertices or the file could not be written.
+     */
+    bool(* cookCollisionMesh)(const char *const objFilename, const char *const colbinFilename);
+
+    /**
+     *  Loads the triangles of an obj file as they are drawn and passes them to upload. If the mesh has been
+     *  cooked by cookMesh to its default name next to the obj, the cooked mesh is loaded instead, so it must
+     *  be cooked again after the obj changes.
+     *
+     *  @param  filename    const pointer to const char, path to the obj file.
+     *  @param  upload      pointer to MeshUploadFunc, given the vertices once they are loaded.
+     *  @param  data        pointer to void, passed to upload.
+     *  @return             bool, false if there were no vertices, in which case upload isn't called.
+     */
+    bool(* loadMesh)(const char *const filename, MeshUploadFunc* upload, void* data);
+
+    /**
+     *  Loads a mesh cooked by cookMesh. The file is mapped into memory and upload is given the vertices
+     *  straight from the mapping, nothing is parsed or copied. The mapping is released after upload returns.
+     *
+     *  @param  filename    const pointer to const char, path to the .meshbin file.
+     *  @param  upload      pointer to MeshUploadFunc, given the vertices.
+     *  @param  data        pointer to void, passed to upload.
+     *  @return             bool, false if the file could not be read, isn't a .meshbin of this version
+     *                      or has a different vertex layout, in which case upload isn't called.
+     */
+    bool(* loadMeshBinary)(const char *const filename, MeshUploadFunc* upload, void* data);
+
+    /**
+     *  Loads an obj file's triangles, as loadMesh does, and writes the vertices to a .meshbin file for loadMeshBinary.
+     *
+     *  @param  objFilename     const pointer to const char, path to the obj file.
+     *  @param  meshbinFilename const pointer to const char, path to write to, or NULL for the name loadMesh
+     *                          looks for: "town.obj" cooks to "town.meshbin".
+     *  @return                 bool, false if the obj has no vertices or the file could not be written.
+     */
+    bool(* cookMesh)(const char *const objFilename, const char *const meshbinFilename);
+
 } ObjLoader;
 
 /**
@@ -69,14 +163,4 @@ typedef struct ObjLoader_s {
  */
 extern const ObjLoader objLoader;
 
-/**
- *  Internal representation of a vertex in OpenGL.
- */
-typedef struct Vertex_s {
-    GLfloat     x, y, z;
-    GLfloat     nx, ny, nz;
-    GLfloat     u, v;
-    GLfloat     padding[4];
-} GLVertex;
-
 #endif
@@ -0,0 +1,245 @@
+#include "Profiler.h"
+
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "util/Clock.h"
+
+/*
+ * A ring buffer slot. sequence is the index the slot was written for plus one,
+ * or 0 while it is being written, so readers can skip slots that are incomplete
+ * or have been overwritten.
+ */
+typedef struct ProfilerSlot_s {
+	ProfilerEvent event;
+	atomic_uint_fast64_t sequence;
+} ProfilerSlot;
+
+typedef struct ProfilerZone_s {
+	const char* name;
+	/** Time spent in the zone so far this frame, in nanoseconds. **/
+	uint64_t frameTotal;
+	bool inFrame;
+	/** Per-frame totals in milliseconds, a ring of PROFILER_FRAME_WINDOW. **/
+	float samples[PROFILER_FRAME_WINDOW];
+	int sampleCount;
+} ProfilerZone;
+
+static ProfilerSlot slots[PROFILER_EVENT_CAPACITY];
+static atomic_uint_fast64_t writeIndex = 0;
+static atomic_uint_fast32_t nextThreadID = 0;
+static atomic_bool enabled = true;
+
+//Only touched by the thread running frames.
+static uint64_t collectedIndex = 0;
+static ProfilerZone zones[PROFILER_MAX_ZONES];
+static int zoneCount = 0;
+
+//Each thread's open zones.
+static _Thread_local uint32_t threadID = UINT32_MAX;
+static _Thread_local const char* openNames[PROFILER_MAX_DEPTH];
+static _Thread_local uint64_t openStarts[PROFILER_MAX_DEPTH];
+static _Thread_local int openCount = 0;
+
+static void setEnabled(bool enable) {
+	atomic_store(&enabled, enable);
+}
+
+static void begin(const char* name) {
+	//Zones deeper than the limit are still counted so ends stay matched, but aren't recorded.
+	if (openCount < PROFILER_MAX_DEPTH) {
+		openNames[openCount] = name;
+		openStarts[openCount] = manClock.getNanoseconds();
+	}
+	openCount++;
+}
+
+static void record(const char* name, uint64_t start, uint64_t end, uint32_t depth) {
+	if (threadID == UINT32_MAX)
+		threadID = atomic_fetch_add(&nextThreadID, 1);
+
+	uint64_t index = atomic_fetch_add_explicit(&writeIndex, 1, memory_order_relaxed);
+	ProfilerSlot* slot = &slots[index & (PROFILER_EVENT_CAPACITY-1)];
+
+	atomic_store_explicit(&slot->sequence, 0, memory_order_relaxed);
+	atomic_thread_fence(memory_order_release);
+
+	slot->event.name = name;
+	slot->event.start = start;
+	slot->event.end = end;
+	slot->event.threadID = threadID;
+	slot->event.depth = depth;
+
+	atomic_store_explicit(&slot->sequence, index+1, memory_order_release);
+}
+
+static void end() {
+	if (openCount == 0)
+		return;
+
+	openCount--;
+	if (openCount < PROFILER_MAX_DEPTH && atomic_load_explicit(&enabled, memory_order_relaxed))
+		record(openNames[openCount], openStarts[openCount], manClock.getNanoseconds(), openCount);
+}
+
+/*
+ * Copies out the event written for the given index, if it is still in the ring.
+ */
+static bool readEvent(uint64_t index, ProfilerEvent* event) {
+	ProfilerSlot* slot = &slots[index & (PROFILER_EVENT_CAPACITY-1)];
+
+	if (atomic_load_explicit(&slot->sequence, memory_order_acquire) != index+1)
+		return false;
+
+	*event = slot->event;
+
+	//If the writer lapped us while copying, the copy may be torn.
+	atomic_thread_fence(memory_order_acquire);
+	return atomic_load_explicit(&slot->sequence, memory_order_relaxed) == index+1;
+}
+
+static ProfilerZone* findZone(const char* name, bool create) {
+	for(int i = 0; i < zoneCount; i++) {
+		if (zones[i].name == name || strcmp(zones[i].name, name) == 0)
+			return &zones[i];
+	}
+
+	if (!create || zoneCount == PROFILER_MAX_ZONES)
+		return NULL;
+
+	ProfilerZone* zone = &zones[zoneCount++];
+	zone->name = name;
+	zone->frameTotal = 0;
+	zone->inFrame = false;
+	zone->sampleCount = 0;
+	return zone;
+}
+
+static void beginFrame() {
+	begin("frame");
+}
+
+static void endFrame() {
+	end();
+
+	uint64_t last = atomic_load_explicit(&writeIndex, memory_order_acquire);
+	if (last - collectedIndex > PROFILER_EVENT_CAPACITY)
+		collectedIndex = last - PROFILER_EVENT_CAPACITY;
+
+	for(; collectedIndex < last; collectedIndex++) {
+		ProfilerEvent event;
+		if (!readEvent(collectedIndex, &event))
+			continue;
+
+		ProfilerZone* zone = findZone(event.name, true);
+		if (zone != NULL) {
+			zone->frameTotal += event.end - event.start;
+			zone->inFrame = true;
+		}
+	}
+
+	for(int i = 0; i < zoneCount; i++) {
+		ProfilerZone* zone = &zones[i];
+		if (zone->inFrame) {
+			zone->samples[zone->sampleCount % PROFILER_FRAME_WINDOW] = zone->frameTotal/1e6;
+			zone->sampleCount++;
+			zone->frameTotal = 0;
+			zone->inFrame = false;
+		}
+	}
+}
+
+static int compareFloats(const void* a, const void* b) {
+	float fa = *(const float*)a;
+	float fb = *(const float*)b;
+	return (fa > fb) - (fa < fb);
+}
+
+static double percentile(const float* sorted, int count, double fraction) {
+	int index = (int)(fraction*(count-1) + 0.5);
+	return sorted[index];
+}
+
+static void calculateStats(ProfilerZone* zone, ProfilerStats* stats) {
+	static float sorted[PROFILER_FRAME_WINDOW];
+	int count = zone->sampleCount < PROFILER_FRAME_WINDOW ? zone->sampleCount : PROFILER_FRAME_WINDOW;
+
+	memcpy(sorted, zone->samples, sizeof(float)*count);
+	qsort(sorted, count, sizeof(float), compareFloats);
+
+	double sum = 0;
+	for(int i = 0; i < count; i++)
+		sum += sorted[i];
+
+	stats->name = zone->name;
+	stats->samples = count;
+	stats->mean = count > 0 ? sum/count : 0;
+	stats->p50 = count > 0 ? percentile(sorted, count, 0.50) : 0;
+	stats->p95 = count > 0 ? percentile(sorted, count, 0.95) : 0;
+	stats->p99 = count > 0 ? percentile(sorted, count, 0.99) : 0;
+	stats->max = count > 0 ? sorted[count-1] : 0;
+}
+
+static bool getStats(const char* name, ProfilerStats* stats) {
+	ProfilerZone* zone = findZone(name, false);
+	if (zone == NULL)
+		return false;
+
+	calculateStats(zone, stats);
+	return true;
+}
+
+static void printStats() {
+	printf("[Profiler] %-20s %8s %10s %10s %10s %10s %10s\n", "zone", "frames", "mean ms", "p50 ms", "p95 ms", "p99 ms", "max ms");
+	for(int i = 0; i < zoneCount; i++) {
+		ProfilerStats stats;
+		calculateStats(&zones[i], &stats);
+		printf("[Profiler] %-20s %8d %10.3f %10.3f %10.3f %10.3f %10.3f\n", stats.name, stats.samples, stats.mean, stats.p50, stats.p95, stats.p99, stats.max);
+	}
+}
+
+static bool writeChromeTrace(const char* filename) {
+	FILE* file = fopen(filename, "w");
+	if (file == NULL) {
+		fprintf(stderr, "ERROR: could not open profiler trace %s for writing\n", filename);
+		return false;
+	}
+
+	uint64_t last = atomic_load_explicit(&writeIndex, memory_order_acquire);
+	uint64_t first = last > PROFILER_EVENT_CAPACITY ? last - PROFILER_EVENT_CAPACITY : 0;
+
+	//Timestamps are written relative to the earliest event so they stay readable.
+	uint64_t origin = UINT64_MAX;
+	for(uint64_t i = first; i < last; i++) {
+		ProfilerEvent event;
+		if (readEvent(i, &event) && event.start < origin)
+			origin = event.start;
+	}
+
+	fprintf(file, "{\"traceEvents\":[\n");
+	bool firstEvent = true;
+	for(uint64_t i = first; i < last; i++) {
+		ProfilerEvent event;
+		if (!readEvent(i, &event))
+			continue;
+
+		fprintf(file, "%s{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+		        firstEvent ? "" : ",\n", event.name, event.threadID, (event.start - origin)/1e3, (event.end - event.start)/1e3);
+		firstEvent = false;
+	}
+	fprintf(file, "\n],\"displayTimeUnit\":\"ms\"}\n");
+
+	return fclose(file) == 0;
+}
+
+static void reset() {
+	for(int i = 0; i < PROFILER_EVENT_CAPACITY; i++)
+		atomic_store(&slots[i].sequence, 0);
+
+	collectedIndex = atomic_load(&writeIndex);
+	zoneCount = 0;
+}
+
+const ProfilerManager manProfiler = {setEnabled, begin, end, beginFrame, endFrame, getStats, printStats, writeChromeTrace, reset};
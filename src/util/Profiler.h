@@ -0,0 +1,133 @@
+#ifndef COH_PROFILER_H
+#define COH_PROFILER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/** Number of zone events kept, must be a power of two. **/
+#define PROFILER_EVENT_CAPACITY (1 << 16)
+/** Number of frames statistics are calculated over. **/
+#define PROFILER_FRAME_WINDOW 1024
+/** Maximum number of distinctly named zones. **/
+#define PROFILER_MAX_ZONES 64
+/** Maximum zone nesting depth on one thread. **/
+#define PROFILER_MAX_DEPTH 32
+/** Where the game loop writes the trace when it exits. **/
+#define PROFILER_TRACE_FILE "./profile.json"
+
+/**
+ *	Zone instrumentation, compiled out unless COH_PROFILE is defined (scons profile=1).
+ * 	Zones nest, every PROFILE_BEGIN must be matched by a PROFILE_END on the same thread.
+ * 	Names must be string literals, or otherwise live as long as the profiler.
+ */
+#ifdef COH_PROFILE
+#define PROFILE_BEGIN(name) manProfiler.begin(name)
+#define PROFILE_END() manProfiler.end()
+#define PROFILE_FRAME_BEGIN() manProfiler.beginFrame()
+#define PROFILE_FRAME_END() manProfiler.endFrame()
+#else
+#define PROFILE_BEGIN(name)
+#define PROFILE_END()
+#define PROFILE_FRAME_BEGIN()
+#define PROFILE_FRAME_END()
+#endif
+
+/**
+ *	A timed zone, recorded when the zone ends.
+ */
+typedef struct ProfilerEvent_s {
+	const char* name;
+	/** Start and end of the zone in nanoseconds, from an arbitrary origin. **/
+	uint64_t start;
+	uint64_t end;
+	/** Small ID of the thread the zone ran on, 0 is the first thread to record a zone. **/
+	uint32_t threadID;
+	/** How many zones this one is nested inside. **/
+	uint32_t depth;
+} ProfilerEvent;
+
+/**
+ *	Statistics for one zone over the last PROFILER_FRAME_WINDOW frames it ran in.
+ * 	Times are the zone's total time in each frame, in milliseconds.
+ */
+typedef struct ProfilerStats_s {
+	const char* name;
+	int samples;
+	double mean;
+	double p50;
+	double p95;
+	double p99;
+	double max;
+} ProfilerStats;
+
+/**
+ *	Hierarchical zone profiler.
+ *
+ * 	Zones from any thread are appended to a lock-free ring buffer, so recording
+ * 	never blocks. At the end of each frame the main thread totals the time spent
+ * 	in each zone that frame, and keeps a window of those totals for percentiles.
+ * 	The raw events left in the ring can be written out as a Chrome trace
+ * 	(load it in chrome://tracing or ui.perfetto.dev).
+ */
+typedef struct ProfilerManager_s {
+	/**
+	 *	Enables or disables recording, enabled by default.
+	 *
+	 * 	@param	enabled	bool, whether zones should be recorded.
+	 */
+	void(* setEnabled)(bool enabled);
+
+	/**
+	 *	Starts a zone on the calling thread.
+	 *
+	 * 	@param	name	pointer to const char, name of the zone.
+	 */
+	void(* begin)(const char* name);
+
+	/**
+	 *	Ends the innermost zone on the calling thread and records it.
+	 */
+	void(* end)();
+
+	/**
+	 *	Starts a frame, which is recorded as a zone called "frame".
+	 */
+	void(* beginFrame)();
+
+	/**
+	 *	Ends the frame and updates the per-zone statistics with the zones recorded since the last frame.
+	 * 	Must be called from the thread that called beginFrame.
+	 */
+	void(* endFrame)();
+
+	/**
+	 *	Gets the statistics for a zone.
+	 *
+	 * 	@param	name	pointer to const char, name of the zone.
+	 * 	@param	stats	pointer to ProfilerStats to fill.
+	 * 	@return			bool, false if the zone has never been recorded.
+	 */
+	bool(* getStats)(const char* name, ProfilerStats* stats);
+
+	/**
+	 *	Prints the statistics of every zone to stdout.
+	 */
+	void(* printStats)();
+
+	/**
+	 *	Writes the events still in the ring buffer as a Chrome trace JSON file.
+	 *
+	 * 	@param	filename	pointer to const char, file to write.
+	 * 	@return				bool, whether the file could be written.
+	 */
+	bool(* writeChromeTrace)(const char* filename);
+
+	/**
+	 *	Discards all recorded events and statistics.
+	 */
+	void(* reset)();
+} ProfilerManager;
+
+extern const ProfilerManager manProfiler;
+
+#endif
@@ -0,0 +1,105 @@
+#include "Replay.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+static Replay* new(int inputSize) {
+	Replay* replay = malloc(sizeof(Replay));
+	replay->inputSize = inputSize;
+	replay->inputs = manDynamicArray.new(64, inputSize > 0 ? inputSize : 1);
+	replay->hashes = manDynamicArray.new(64, sizeof(unsigned long long));
+	return replay;
+}
+
+static void record(Replay* replay, const void* input, unsigned long long hash) {
+	if (replay->inputSize > 0)
+		manDynamicArray.append(replay->inputs, (void*)input);
+	manDynamicArray.append(replay->hashes, &hash);
+}
+
+static int getTicks(Replay* replay) {
+	return replay->hashes->size;
+}
+
+static const void* getInput(Replay* replay, int tick) {
+	return replay->inputSize > 0 ? manDynamicArray.get(replay->inputs, tick) : NULL;
+}
+
+static unsigned long long getHash(Replay* replay, int tick) {
+	return *(unsigned long long*)manDynamicArray.get(replay->hashes, tick);
+}
+
+static int verify(Replay* replay, ReplayStepFunc* step, void* data) {
+	for(int tick = 0; tick < getTicks(replay); tick++) {
+		if (step(data, getInput(replay, tick), tick) != getHash(replay, tick))
+			return tick;
+	}
+	return -1;
+}
+
+/*
+ * The header is the magic, then the version, input size and tick count as 32 bit ints.
+ * The inputs follow, then the hashes, all in the machine's byte order.
+ */
+static bool save(Replay* replay, const char* filename) {
+	FILE* file = fopen(filename, "wb");
+	if (file == NULL)
+		return false;
+
+	int32_t header[3] = {REPLAY_FILE_VERSION, replay->inputSize, getTicks(replay)};
+	bool written = fwrite(REPLAY_FILE_MAGIC, 1, 4, file) == 4 && fwrite(header, sizeof(int32_t), 3, file) == 3;
+	if (replay->inputSize > 0)
+		written = written && fwrite(replay->inputs->contents, replay->inputSize, header[2], file) == header[2];
+	written = written && fwrite(replay->hashes->contents, sizeof(unsigned long long), header[2], file) == header[2];
+
+	return (fclose(file) == 0) && written;
+}
+
+static void delete(Replay* replay) {
+	manDynamicArray.delete(replay->inputs);
+	free(replay->inputs);
+	manDynamicArray.delete(replay->hashes);
+	free(replay->hashes);
+}
+
+static Replay* load(const char* filename) {
+	FILE* file = fopen(filename, "rb");
+	if (file == NULL)
+		return NULL;
+
+	char magic[4];
+	int32_t header[3];
+	if (fread(magic, 1, 4, file) != 4 || memcmp(magic, REPLAY_FILE_MAGIC, 4) != 0 ||
+	    fread(header, sizeof(int32_t), 3, file) != 3 || header[0] != REPLAY_FILE_VERSION || header[1] < 0 || header[2] < 0) {
+		fclose(file);
+		return NULL;
+	}
+
+	Replay* replay = new(header[1]);
+	char* input = malloc(header[1] > 0 ? header[1] : 1);
+	bool read = true;
+	for(int tick = 0; tick < header[2] && read; tick++) {
+		read = fread(input, 1, header[1], file) == header[1];
+		if (read && header[1] > 0)
+			manDynamicArray.append(replay->inputs, input);
+	}
+	for(int tick = 0; tick < header[2] && read; tick++) {
+		unsigned long long hash;
+		read = fread(&hash, sizeof(hash), 1, file) == 1;
+		if (read)
+			manDynamicArray.append(replay->hashes, &hash);
+	}
+	free(input);
+	fclose(file);
+
+	if (!read) {
+		delete(replay);
+		free(replay);
+		return NULL;
+	}
+	return replay;
+}
+
+const ReplayManager manReplay = {new, record, getTicks, getInput, getHash, verify, save, load, delete};
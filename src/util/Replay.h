@@ -0,0 +1,107 @@
+#ifndef COH_REPLAY_H
+#define COH_REPLAY_H
+
+#include <stdbool.h>
+
+#include "util/DynamicArray.h"
+
+/** First bytes of a replay file. **/
+#define REPLAY_FILE_MAGIC "COHR"
+#define REPLAY_FILE_VERSION 1
+
+/**
+ *	Applies one tick's input and steps the simulation a tick, as the recorded run did.
+ *
+ * 	@param	data	pointer to void, the data given to verify.
+ * 	@param	input	const pointer to const void, the tick's input, inputSize bytes.
+ * 	@param	tick	int, the tick being replayed, from 0.
+ * 	@return			unsigned long long, the state hash after the tick.
+ */
+typedef unsigned long long ReplayStepFunc(void* data, const void* input, int tick);
+
+/**
+ *	A recording of the input given to a simulation each tick, with the hash of the state
+ * 	after it. Replaying the inputs into the same starting state, in a build made with
+ * 	COH_DETERMINISTIC, gives the same state every tick, so the hashes are enough to check
+ * 	a replay without storing the state itself. That holds across platforms and C libraries
+ * 	too, see scalar_pow and scalar_sin in Precision.h.
+ */
+typedef struct Replay_s {
+	/** Size in bytes of each tick's input. **/
+	int inputSize;
+	/** Each tick's input, inputSize bytes per element. **/
+	DynamicArray* inputs;
+	/** The state hash after each tick, as unsigned long long. **/
+	DynamicArray* hashes;
+} Replay;
+
+/**
+ *	Manager for replays.
+ */
+typedef struct ReplayManager_s {
+	/**
+	 *	Creates an empty replay.
+	 *
+	 * 	@param	inputSize	int, size in bytes of the input recorded each tick, can be 0.
+	 * 	@return				pointer to Replay, the new replay.
+	 */
+	Replay*(* new)(int inputSize);
+
+	/**
+	 *	Records a tick, after it has been simulated.
+	 *
+	 * 	@param	replay	pointer to Replay to add to.
+	 * 	@param	input	const pointer to const void, the input the tick was given, inputSize bytes.
+	 * 	@param	hash	unsigned long long, the state hash after the tick.
+	 */
+	void(* record)(Replay* replay, const void* input, unsigned long long hash);
+
+	/**
+	 *	Gets how many ticks have been recorded.
+	 */
+	int(* getTicks)(Replay* replay);
+
+	/**
+	 *	Gets the input recorded for a tick.
+	 */
+	const void*(* getInput)(Replay* replay, int tick);
+
+	/**
+	 *	Gets the state hash recorded for a tick.
+	 */
+	unsigned long long(* getHash)(Replay* replay, int tick);
+
+	/**
+	 *	Replays every recorded tick through step, starting from the state the recording started
+	 * 	from, and compares each hash step returns with the recorded one. Stops at the first that differs.
+	 *
+	 * 	@param	replay	pointer to Replay to check.
+	 * 	@param	step	pointer to ReplayStepFunc, applies an input and simulates a tick.
+	 * 	@param	data	pointer to void, passed to step.
+	 * 	@return			int, the first tick whose state differs, or -1 if every tick matched.
+	 */
+	int(* verify)(Replay* replay, ReplayStepFunc* step, void* data);
+
+	/**
+	 *	Writes the replay to a file.
+	 *
+	 * 	@return	bool, false if the file could not be written.
+	 */
+	bool(* save)(Replay* replay, const char* filename);
+
+	/**
+	 *	Reads a replay written by save.
+	 *
+	 * 	@return	pointer to Replay, or NULL if the file could not be read or isn't a replay.
+	 */
+	Replay*(* load)(const char* filename);
+
+	/**
+	 *	Frees all memory associated with the replay, not including the replay itself.
+	 */
+	void(* delete)(Replay* replay);
+} ReplayManager;
+
+extern const ReplayManager manReplay;
+
+#endif